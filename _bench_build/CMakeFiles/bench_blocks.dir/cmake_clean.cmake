@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_blocks.dir/benchmarks/bench_blocks.cpp.o"
+  "CMakeFiles/bench_blocks.dir/benchmarks/bench_blocks.cpp.o.d"
+  "bench_blocks"
+  "bench_blocks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_blocks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
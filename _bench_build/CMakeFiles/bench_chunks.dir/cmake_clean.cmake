@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_chunks.dir/benchmarks/bench_chunks.cpp.o"
+  "CMakeFiles/bench_chunks.dir/benchmarks/bench_chunks.cpp.o.d"
+  "bench_chunks"
+  "bench_chunks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_chunks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
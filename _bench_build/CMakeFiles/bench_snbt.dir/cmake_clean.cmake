@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_snbt.dir/benchmarks/bench_snbt.cpp.o"
+  "CMakeFiles/bench_snbt.dir/benchmarks/bench_snbt.cpp.o.d"
+  "bench_snbt"
+  "bench_snbt.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_snbt.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
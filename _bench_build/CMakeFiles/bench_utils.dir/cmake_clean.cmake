@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_utils.dir/benchmarks/bench_utils.cpp.o"
+  "CMakeFiles/bench_utils.dir/benchmarks/bench_utils.cpp.o.d"
+  "bench_utils"
+  "bench_utils.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_utils.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
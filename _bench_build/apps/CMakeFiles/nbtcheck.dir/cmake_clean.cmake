@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nbtcheck.dir/nbtcheck.cpp.o"
+  "CMakeFiles/nbtcheck.dir/nbtcheck.cpp.o.d"
+  "nbtcheck"
+  "nbtcheck.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nbtcheck.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
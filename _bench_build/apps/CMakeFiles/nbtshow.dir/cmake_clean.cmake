@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nbtshow.dir/nbtshow.cpp.o"
+  "CMakeFiles/nbtshow.dir/nbtshow.cpp.o.d"
+  "nbtshow"
+  "nbtshow.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nbtshow.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,39 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/nbtview/Archive.cpp" "nbtview/CMakeFiles/nbtview.dir/Archive.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Archive.cpp.o.d"
+  "/root/repo/nbtview/BinaryDeserializer.cpp" "nbtview/CMakeFiles/nbtview.dir/BinaryDeserializer.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/BinaryDeserializer.cpp.o.d"
+  "/root/repo/nbtview/BlockCounts.cpp" "nbtview/CMakeFiles/nbtview.dir/BlockCounts.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/BlockCounts.cpp.o.d"
+  "/root/repo/nbtview/BlockStates.cpp" "nbtview/CMakeFiles/nbtview.dir/BlockStates.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/BlockStates.cpp.o.d"
+  "/root/repo/nbtview/Columns.cpp" "nbtview/CMakeFiles/nbtview.dir/Columns.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Columns.cpp.o.d"
+  "/root/repo/nbtview/CompactTree.cpp" "nbtview/CMakeFiles/nbtview.dir/CompactTree.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/CompactTree.cpp.o.d"
+  "/root/repo/nbtview/Document.cpp" "nbtview/CMakeFiles/nbtview.dir/Document.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Document.cpp.o.d"
+  "/root/repo/nbtview/Entities.cpp" "nbtview/CMakeFiles/nbtview.dir/Entities.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Entities.cpp.o.d"
+  "/root/repo/nbtview/Hash.cpp" "nbtview/CMakeFiles/nbtview.dir/Hash.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Hash.cpp.o.d"
+  "/root/repo/nbtview/IncrementalParser.cpp" "nbtview/CMakeFiles/nbtview.dir/IncrementalParser.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/IncrementalParser.cpp.o.d"
+  "/root/repo/nbtview/KeyTable.cpp" "nbtview/CMakeFiles/nbtview.dir/KeyTable.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/KeyTable.cpp.o.d"
+  "/root/repo/nbtview/Region.cpp" "nbtview/CMakeFiles/nbtview.dir/Region.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Region.cpp.o.d"
+  "/root/repo/nbtview/RegionIndex.cpp" "nbtview/CMakeFiles/nbtview.dir/RegionIndex.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/RegionIndex.cpp.o.d"
+  "/root/repo/nbtview/Scanner.cpp" "nbtview/CMakeFiles/nbtview.dir/Scanner.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Scanner.cpp.o.d"
+  "/root/repo/nbtview/SharedTag.cpp" "nbtview/CMakeFiles/nbtview.dir/SharedTag.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/SharedTag.cpp.o.d"
+  "/root/repo/nbtview/SnbtDeserializer.cpp" "nbtview/CMakeFiles/nbtview.dir/SnbtDeserializer.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/SnbtDeserializer.cpp.o.d"
+  "/root/repo/nbtview/SnbtWriter.cpp" "nbtview/CMakeFiles/nbtview.dir/SnbtWriter.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/SnbtWriter.cpp.o.d"
+  "/root/repo/nbtview/Tape.cpp" "nbtview/CMakeFiles/nbtview.dir/Tape.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Tape.cpp.o.d"
+  "/root/repo/nbtview/Validation.cpp" "nbtview/CMakeFiles/nbtview.dir/Validation.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/Validation.cpp.o.d"
+  "/root/repo/nbtview/nbtview.cpp" "nbtview/CMakeFiles/nbtview.dir/nbtview.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/nbtview.cpp.o.d"
+  "/root/repo/nbtview/zlib_utils.cpp" "nbtview/CMakeFiles/nbtview.dir/zlib_utils.cpp.o" "gcc" "nbtview/CMakeFiles/nbtview.dir/zlib_utils.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
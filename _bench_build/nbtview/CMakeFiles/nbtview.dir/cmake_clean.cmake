@@ -0,0 +1,51 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nbtview.dir/Archive.cpp.o"
+  "CMakeFiles/nbtview.dir/Archive.cpp.o.d"
+  "CMakeFiles/nbtview.dir/BinaryDeserializer.cpp.o"
+  "CMakeFiles/nbtview.dir/BinaryDeserializer.cpp.o.d"
+  "CMakeFiles/nbtview.dir/BlockCounts.cpp.o"
+  "CMakeFiles/nbtview.dir/BlockCounts.cpp.o.d"
+  "CMakeFiles/nbtview.dir/BlockStates.cpp.o"
+  "CMakeFiles/nbtview.dir/BlockStates.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Columns.cpp.o"
+  "CMakeFiles/nbtview.dir/Columns.cpp.o.d"
+  "CMakeFiles/nbtview.dir/CompactTree.cpp.o"
+  "CMakeFiles/nbtview.dir/CompactTree.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Document.cpp.o"
+  "CMakeFiles/nbtview.dir/Document.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Entities.cpp.o"
+  "CMakeFiles/nbtview.dir/Entities.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Hash.cpp.o"
+  "CMakeFiles/nbtview.dir/Hash.cpp.o.d"
+  "CMakeFiles/nbtview.dir/IncrementalParser.cpp.o"
+  "CMakeFiles/nbtview.dir/IncrementalParser.cpp.o.d"
+  "CMakeFiles/nbtview.dir/KeyTable.cpp.o"
+  "CMakeFiles/nbtview.dir/KeyTable.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Region.cpp.o"
+  "CMakeFiles/nbtview.dir/Region.cpp.o.d"
+  "CMakeFiles/nbtview.dir/RegionIndex.cpp.o"
+  "CMakeFiles/nbtview.dir/RegionIndex.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Scanner.cpp.o"
+  "CMakeFiles/nbtview.dir/Scanner.cpp.o.d"
+  "CMakeFiles/nbtview.dir/SharedTag.cpp.o"
+  "CMakeFiles/nbtview.dir/SharedTag.cpp.o.d"
+  "CMakeFiles/nbtview.dir/SnbtDeserializer.cpp.o"
+  "CMakeFiles/nbtview.dir/SnbtDeserializer.cpp.o.d"
+  "CMakeFiles/nbtview.dir/SnbtWriter.cpp.o"
+  "CMakeFiles/nbtview.dir/SnbtWriter.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Tape.cpp.o"
+  "CMakeFiles/nbtview.dir/Tape.cpp.o.d"
+  "CMakeFiles/nbtview.dir/Validation.cpp.o"
+  "CMakeFiles/nbtview.dir/Validation.cpp.o.d"
+  "CMakeFiles/nbtview.dir/nbtview.cpp.o"
+  "CMakeFiles/nbtview.dir/nbtview.cpp.o.d"
+  "CMakeFiles/nbtview.dir/zlib_utils.cpp.o"
+  "CMakeFiles/nbtview.dir/zlib_utils.cpp.o.d"
+  "libnbtview.a"
+  "libnbtview.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nbtview.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
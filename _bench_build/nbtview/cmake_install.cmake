@@ -0,0 +1,81 @@
+# Install script for directory: /root/repo/nbtview
+
+# Set the install prefix
+if(NOT DEFINED CMAKE_INSTALL_PREFIX)
+  set(CMAKE_INSTALL_PREFIX "/usr/local")
+endif()
+string(REGEX REPLACE "/$" "" CMAKE_INSTALL_PREFIX "${CMAKE_INSTALL_PREFIX}")
+
+# Set the install configuration name.
+if(NOT DEFINED CMAKE_INSTALL_CONFIG_NAME)
+  if(BUILD_TYPE)
+    string(REGEX REPLACE "^[^A-Za-z0-9_]+" ""
+           CMAKE_INSTALL_CONFIG_NAME "${BUILD_TYPE}")
+  else()
+    set(CMAKE_INSTALL_CONFIG_NAME "Release")
+  endif()
+  message(STATUS "Install configuration: \"${CMAKE_INSTALL_CONFIG_NAME}\"")
+endif()
+
+# Set the component getting installed.
+if(NOT CMAKE_INSTALL_COMPONENT)
+  if(COMPONENT)
+    message(STATUS "Install component: \"${COMPONENT}\"")
+    set(CMAKE_INSTALL_COMPONENT "${COMPONENT}")
+  else()
+    set(CMAKE_INSTALL_COMPONENT)
+  endif()
+endif()
+
+# Install shared libraries without execute permission?
+if(NOT DEFINED CMAKE_INSTALL_SO_NO_EXE)
+  set(CMAKE_INSTALL_SO_NO_EXE "1")
+endif()
+
+# Is this installation the result of a crosscompile?
+if(NOT DEFINED CMAKE_CROSSCOMPILING)
+  set(CMAKE_CROSSCOMPILING "FALSE")
+endif()
+
+# Set default install directory permissions.
+if(NOT DEFINED CMAKE_OBJDUMP)
+  set(CMAKE_OBJDUMP "/usr/bin/objdump")
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/lib" TYPE STATIC_LIBRARY FILES "/root/repo/_bench_build/nbtview/libnbtview.a")
+endif()
+
+if(CMAKE_INSTALL_COMPONENT STREQUAL "Unspecified" OR NOT CMAKE_INSTALL_COMPONENT)
+  file(INSTALL DESTINATION "${CMAKE_INSTALL_PREFIX}/include" TYPE FILE FILES
+    "/root/repo/nbtview/Archive.hpp"
+    "/root/repo/nbtview/Binding.hpp"
+    "/root/repo/nbtview/BinaryReader.hpp"
+    "/root/repo/nbtview/BlockCounts.hpp"
+    "/root/repo/nbtview/BlockStates.hpp"
+    "/root/repo/nbtview/Columns.hpp"
+    "/root/repo/nbtview/CompactTree.hpp"
+    "/root/repo/nbtview/Deserializer.hpp"
+    "/root/repo/nbtview/Document.hpp"
+    "/root/repo/nbtview/Encoding.hpp"
+    "/root/repo/nbtview/Entities.hpp"
+    "/root/repo/nbtview/Hash.hpp"
+    "/root/repo/nbtview/IncrementalParser.hpp"
+    "/root/repo/nbtview/KeyTable.hpp"
+    "/root/repo/nbtview/nbtview.hpp"
+    "/root/repo/nbtview/Parallel.hpp"
+    "/root/repo/nbtview/Pipeline.hpp"
+    "/root/repo/nbtview/Region.hpp"
+    "/root/repo/nbtview/RegionIndex.hpp"
+    "/root/repo/nbtview/Scanner.hpp"
+    "/root/repo/nbtview/SharedTag.hpp"
+    "/root/repo/nbtview/SnbtDeserializer.hpp"
+    "/root/repo/nbtview/SnbtWriter.hpp"
+    "/root/repo/nbtview/Tag.hpp"
+    "/root/repo/nbtview/Tape.hpp"
+    "/root/repo/nbtview/utils.hpp"
+    "/root/repo/nbtview/Validation.hpp"
+    "/root/repo/nbtview/zlib_utils.hpp"
+    )
+endif()
+
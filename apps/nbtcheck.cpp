@@ -0,0 +1,98 @@
+// nbtcheck.cpp
+
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Region.hpp"
+#include "Validation.hpp"
+
+namespace nbt = nbtview;
+
+//! The most threads --threads may ask for
+static const unsigned max_threads = 1024;
+
+int main(int argc, const char *argv[]) {
+    unsigned thread_count = 0;
+    bool quiet = false;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; ++argi) {
+        std::string_view option(argv[argi]);
+        if (option == "--threads" && argi + 1 < argc) {
+            // A count of digits alone, of at most max_threads; 0 chooses
+            // one thread per core.
+            std::string_view count(argv[++argi]);
+            auto [end, error] = std::from_chars(
+                count.data(), count.data() + count.size(), thread_count);
+            if (error != std::errc() || end != count.data() + count.size() ||
+                thread_count > max_threads) {
+                argi = argc;
+            }
+        } else if (option == "--quiet") {
+            quiet = true;
+        } else {
+            argi = argc;
+        }
+    }
+    if (argi >= argc) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--threads N] [--quiet] region_file|directory..."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // A directory, such as a world's region directory, stands for all of
+    // its region files.
+    std::vector<std::string> filenames;
+    for (; argi < argc; ++argi) {
+        if (std::filesystem::is_directory(argv[argi])) {
+            for (auto &file : nbt::region_files(argv[argi])) {
+                filenames.push_back(std::move(file));
+            }
+        } else {
+            filenames.emplace_back(argv[argi]);
+        }
+    }
+
+    std::vector<nbt::Region_Report> reports;
+    try {
+        reports = nbt::validate_regions(filenames, thread_count);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::size_t chunk_count = 0;
+    std::size_t bad_file_count = 0;
+    std::size_t fault_count = 0;
+    for (const auto &report : reports) {
+        chunk_count += report.chunk_count;
+        fault_count += report.faults.size();
+        bad_file_count += !report.ok();
+        if (!quiet || !report.ok()) {
+            std::cout << report.filename << ": " << report.valid_chunk_count
+                      << " of " << report.chunk_count << " chunks valid"
+                      << std::endl;
+        }
+        for (const auto &fault : report.faults) {
+            std::cout << "  ";
+            if (fault.chunk >= 0) {
+                std::cout << "chunk " << fault.chunk << " ("
+                          << fault.chunk % nbt::Region::region_width << ", "
+                          << fault.chunk / nbt::Region::region_width << ") ";
+            }
+            std::cout << "sector " << fault.sector << ": "
+                      << nbt::region_problem_name(fault.problem) << ": "
+                      << fault.message << std::endl;
+        }
+    }
+    std::cout << reports.size() << " files, " << chunk_count << " chunks, "
+              << fault_count << " problems in " << bad_file_count << " files"
+              << std::endl;
+    return bad_file_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,68 +1,107 @@
 // nbtshow.cpp
 
-#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "Scanner.hpp"
+#include "SnbtWriter.hpp"
 #include "Tag.hpp"
 #include "nbtview.hpp"
+#include "zlib_utils.hpp"
 
 namespace nbt = nbtview;
 
-int32_t extract_int32(const std::vector<unsigned char> &data,
-                      std::vector<unsigned char>::const_iterator &iter) {
-    // Check if data has sufficient length
-    auto end_offset = data.end() - iter;
-    if (end_offset < 4) {
-        throw std::runtime_error("Insufficient data length");
-    }
-    return __builtin_bswap32(*reinterpret_cast<const int32_t *>(&(*iter)));
-}
-
-int64_t extract_int64(const std::vector<unsigned char> &data,
-                      std::vector<unsigned char>::const_iterator &iter) {
-    // Check if data has sufficient length
-    auto end_offset = data.end() - iter;
-    if (end_offset < 8) {
-        throw std::runtime_error("Insufficient data length");
-    }
-
-    return __builtin_bswap64(*reinterpret_cast<const int64_t *>(&(*iter)));
-}
+// Type names accepted by --find, indexed by TypeCode
+const char *const type_names[] = {"End",       "Byte",      "Short",
+                                  "Int",       "Long",      "Float",
+                                  "Double",    "Byte_Array", "String",
+                                  "List",      "Compound",  "Int_Array",
+                                  "Long_Array"};
 
-void print_int_tag(std::vector<unsigned char> &data, const std::string &name) {
-    auto ret = nbt::fast_find_named_tag(data.begin(), data.end(),
-                                        nbt::TypeCode::Int, name);
-    if (ret != data.end()) {
-        auto val = extract_int32(data, ret);
-        std::cout << "Found '" << name << " = " << val << " at "
-                  << ret - data.begin() << std::endl;
+nbt::Scan_Pattern parse_pattern(std::string_view spec) {
+    auto colon = spec.find(':');
+    if (colon != std::string_view::npos) {
+        auto type_name = spec.substr(0, colon);
+        for (std::size_t t = 1; t < std::size(type_names); ++t) {
+            if (type_name == type_names[t]) {
+                return {static_cast<nbt::TypeCode>(t),
+                        std::string(spec.substr(colon + 1))};
+            }
+        }
     }
+    throw std::runtime_error("Expected TYPE:NAME but found '" +
+                             std::string(spec) + "'");
 }
 
-void print_long_tag(std::vector<unsigned char> &data, const std::string &name) {
-    auto ret = nbt::fast_find_named_tag(data.begin(), data.end(),
-                                        nbt::TypeCode::Long, name);
-    if (ret != data.end()) {
-        auto val = extract_int64(data, ret);
-        std::cout << "Found '" << name << " = " << val << " at "
-                  << ret - data.begin() << std::endl;
+// Prints every tag matching one of the patterns, finding them all in a
+// single pass over the data without decoding the rest of it.
+void print_found_tags(const std::vector<unsigned char> &data,
+                      const nbt::Scanner &scanner, nbt::snbt_format format) {
+    for (const auto &hit : scanner.scan(data.data(), data.size(), true)) {
+        const auto &pattern = scanner[hit.pattern];
+        auto tag = nbt::read_tag_at(data.data(), data.size(),
+                                    {pattern.type, hit.offset, hit.payload});
+        std::cout << pattern.name << " at " << hit.offset << ": ";
+        nbt::write_snbt(tag, std::cout, format);
+        std::cout << std::endl;
     }
 }
 
 int main(int argc, const char *argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " filename" << std::endl;
+    nbt::snbt_format format;
+    int argi = 1;
+    std::vector<nbt::Scan_Pattern> patterns;
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1]; ++argi) {
+        std::string_view option(argv[argi]);
+        if (option == "--pretty") {
+            format.pretty = true;
+        } else if (option == "--find" && argi + 1 < argc) {
+            try {
+                patterns.push_back(parse_pattern(argv[++argi]));
+            } catch (const std::runtime_error &e) {
+                std::cerr << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            argi = argc;
+        }
+    }
+    if (argi >= argc) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--pretty] [--find TYPE:NAME]... filename|-"
+                  << std::endl;
         return EXIT_FAILURE;
     }
-    std::string filename(argv[1]);
-    std::ifstream infile(filename);
+    // "-" reads from a pipe on standard input.
+    std::string filename(argv[argi]);
+    std::ifstream infile;
+    if (filename != "-") {
+        infile.open(filename, std::ios::binary);
+    }
+    std::istream &input = filename == "-" ? std::cin : infile;
+
+    if (!patterns.empty()) {
+        std::vector<unsigned char> data{std::istreambuf_iterator<char>(input),
+                                        std::istreambuf_iterator<char>()};
+        if (nbt::has_compression_header(data.data(), data.size())) {
+            data = nbt::decompress_data(data.data(), data.size());
+        }
+        print_found_tags(data, nbt::Scanner(std::move(patterns)), format);
+        return EXIT_SUCCESS;
+    }
 
-    auto [root_name, root_tag] = nbt::read_binary(infile);
+    auto [root_name, root_tag] = nbt::read_binary(input);
     std::cout << "root_name: " << root_name << std::endl;
-    std::cout << "root_tag: " << root_tag << std::endl;
+    std::cout << "root_tag: ";
+    nbt::write_snbt(root_tag, std::cout, format);
+    std::cout << std::endl;
 
     return EXIT_SUCCESS;
 }
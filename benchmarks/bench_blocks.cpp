@@ -0,0 +1,223 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "BlockCounts.hpp"
+#include "BlockStates.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+// Returns random section indices of the given width, packed.
+static nbt::Long_Array random_block_states(unsigned bits,
+                                           nbt::Bit_Packing packing) {
+    std::mt19937_64 rng(42);
+    nbt::Long_Array packed(
+        nbt::packed_length(nbt::section_volume, bits, packing));
+    for (auto &word : packed) {
+        word = static_cast<nbt::Long>(rng());
+    }
+    return packed;
+}
+
+// The straightforward loop which unpack_indices replaces
+static void unpack_scalar(const nbt::Long_Array &packed, unsigned bits,
+                          nbt::Bit_Packing packing, uint16_t *out) {
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    const unsigned per_word = 64 / bits;
+    for (std::size_t i = 0; i < nbt::section_volume; ++i) {
+        if (packing == nbt::Bit_Packing::aligned) {
+            auto word = static_cast<uint64_t>(packed[i / per_word]);
+            out[i] = static_cast<uint16_t>(
+                (word >> ((i % per_word) * bits)) & mask);
+        } else {
+            std::size_t bit = i * bits;
+            auto value = static_cast<uint64_t>(packed[bit / 64]) >> (bit % 64);
+            if (bit % 64 + bits > 64) {
+                value |= static_cast<uint64_t>(packed[bit / 64 + 1])
+                         << (64 - bit % 64);
+            }
+            out[i] = static_cast<uint16_t>(value & mask);
+        }
+    }
+}
+
+static void BM_unpack_scalar(benchmark::State &state) {
+    auto bits = static_cast<unsigned>(state.range(0));
+    auto packing = static_cast<nbt::Bit_Packing>(state.range(1));
+    auto packed = random_block_states(bits, packing);
+    std::array<uint16_t, nbt::section_volume> out;
+
+    // timing loop
+    for (auto _ : state) {
+        unpack_scalar(packed, bits, packing, out.data());
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+static void BM_unpack_indices(benchmark::State &state) {
+    auto bits = static_cast<unsigned>(state.range(0));
+    auto packing = static_cast<nbt::Bit_Packing>(state.range(1));
+    auto packed = random_block_states(bits, packing);
+    std::array<uint16_t, nbt::section_volume> out;
+
+    // timing loop
+    for (auto _ : state) {
+        nbt::unpack_indices(packed, bits, packing, out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+// Arguments: bits per entry, packing (0 = spanning, 1 = aligned)
+BENCHMARK(BM_unpack_scalar)->ArgsProduct({{4, 5, 9}, {0, 1}});
+BENCHMARK(BM_unpack_indices)->ArgsProduct({{4, 5, 9}, {0, 1}});
+
+// Block IDs for a section: layers of common blocks with scattered ores
+static std::array<uint32_t, nbt::section_volume> section_blocks() {
+    std::mt19937 rng(7);
+    std::array<uint32_t, nbt::section_volume> blocks;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = static_cast<uint32_t>(i / 512) * 17;
+        if (rng() % 50 == 0) {
+            blocks[i] = 20000 + rng() % 12;
+        }
+    }
+    return blocks;
+}
+
+// The straightforward repacking which Block_State_Packer replaces
+static void BM_repack_scalar(benchmark::State &state) {
+    auto blocks = section_blocks();
+
+    // timing loop
+    for (auto _ : state) {
+        std::map<uint32_t, uint16_t> index_of;
+        std::vector<uint32_t> palette;
+        std::vector<uint16_t> indices(nbt::section_volume);
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            auto [it, inserted] = index_of.emplace(
+                blocks[i], static_cast<uint16_t>(palette.size()));
+            if (inserted) {
+                palette.push_back(blocks[i]);
+            }
+            indices[i] = it->second;
+        }
+        unsigned bits = nbt::palette_bits(palette.size());
+        nbt::Long_Array packed(nbt::packed_length(
+            indices.size(), bits, nbt::Bit_Packing::aligned));
+        unsigned per_word = 64 / bits;
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            packed[i / per_word] |= nbt::Long(indices[i])
+                                    << ((i % per_word) * bits);
+        }
+        benchmark::DoNotOptimize(packed);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+BENCHMARK(BM_repack_scalar);
+
+static void BM_block_state_packer(benchmark::State &state) {
+    auto blocks = section_blocks();
+    nbt::Block_State_Packer packer;
+
+    // timing loop
+    for (auto _ : state) {
+        packer.pack(blocks, nbt::Bit_Packing::aligned);
+        benchmark::DoNotOptimize(packer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+BENCHMARK(BM_block_state_packer);
+
+// Counts the blocks of the test region by decoding each chunk in full.
+static nbt::Byte_Array random_nibbles() {
+    std::mt19937 rng(42);
+    nbt::Byte_Array nibbles(nbt::nibble_array_length);
+    for (auto &b : nibbles) {
+        b = static_cast<nbt::Byte>(rng());
+    }
+    return nibbles;
+}
+
+// Unpacks a light array one entry at a time, as unpack_nibbles replaces.
+static void BM_unpack_nibbles_scalar(benchmark::State &state) {
+    auto light = random_nibbles();
+    std::array<uint8_t, nbt::section_volume> out;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] = nbt::get_nibble(light, i);
+        }
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+BENCHMARK(BM_unpack_nibbles_scalar);
+
+static void BM_unpack_nibbles(benchmark::State &state) {
+    auto light = random_nibbles();
+    std::array<uint8_t, nbt::section_volume> out;
+    for (auto _ : state) {
+        nbt::unpack_nibbles(light, out);
+        benchmark::DoNotOptimize(out);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+BENCHMARK(BM_unpack_nibbles);
+
+static void BM_pack_nibbles(benchmark::State &state) {
+    auto light = random_nibbles();
+    std::array<uint8_t, nbt::section_volume> values;
+    nbt::unpack_nibbles(light, values);
+    for (auto _ : state) {
+        nbt::pack_nibbles(values, light);
+        benchmark::DoNotOptimize(light);
+    }
+    state.SetItemsProcessed(state.iterations() * nbt::section_volume);
+}
+
+BENCHMARK(BM_pack_nibbles);
+
+static void BM_region_block_counts_scalar(benchmark::State &state) {
+    for (auto _ : state) {
+        nbt::Region_File reg("test_data/r.0.0.mca");
+        std::map<int, uint64_t> counts;
+        for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+            if (reg.chunk_length(i) == 0) {
+                continue;
+            }
+            auto root = nbt::read_binary(reg.get_chunk_data(i)).second;
+            for (auto &section : root["Level"]["Sections"].get<nbt::List>()) {
+                for (auto b : section["Blocks"].get<nbt::Byte_Array>()) {
+                    ++counts[static_cast<uint8_t>(b)];
+                }
+            }
+        }
+        benchmark::DoNotOptimize(counts);
+    }
+}
+
+BENCHMARK(BM_region_block_counts_scalar)->Unit(benchmark::kMillisecond);
+
+static void BM_region_block_counts(benchmark::State &state) {
+    for (auto _ : state) {
+        auto counts = nbt::count_blocks({"test_data/r.0.0.mca"},
+                                        nbt::Count_Grouping::world);
+        benchmark::DoNotOptimize(counts);
+    }
+}
+
+BENCHMARK(BM_region_block_counts)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,9 +1,25 @@
 #include <benchmark/benchmark.h>
 
+#include <filesystem>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "Archive.hpp"
+#include "Binding.hpp"
+#include "Columns.hpp"
+#include "Document.hpp"
+#include "Entities.hpp"
+#include "Hash.hpp"
+#include "Pipeline.hpp"
 #include "Region.hpp"
+#include "RegionIndex.hpp"
+#include "Scanner.hpp"
+#include "Tape.hpp"
+#include "Validation.hpp"
 #include "nbtview.hpp"
 #include "zlib_utils.hpp"
 
@@ -56,6 +72,119 @@ static void BM_chunk_file_reads(benchmark::State &state) {
 
 BENCHMARK(BM_chunk_file_reads);
 
+// Reads the same fields as BM_chunk_file_reads through run_pipeline(), with
+// the given queue depth and one inflate and one parse thread.
+static void BM_chunk_pipeline(benchmark::State &state) {
+    nbt::Pipeline_Options options{static_cast<std::size_t>(state.range(0)),
+                                  1, 1};
+    auto parse = [](const nbt::Pipeline_Chunk &chunk) {
+        auto [root_name, root_tag] =
+            nbt::read_binary(chunk.data.data(), chunk.data.size());
+        if (!root_tag.is<nbt::Compound>() || !root_tag.contains("Level")) {
+            return std::pair<nbt::Int, nbt::Int>(0, 0);
+        }
+        nbt::Tag &level = root_tag["Level"];
+        return std::pair(level["xPos"].get<nbt::Int>(),
+                         level["zPos"].get<nbt::Int>());
+    };
+    for (auto _ : state) {
+        nbt::run_pipeline<std::pair<nbt::Int, nbt::Int>>(
+            {"test_data/r.0.0.mca"}, parse,
+            [](std::size_t, int, std::pair<nbt::Int, nbt::Int> position) {
+                benchmark::DoNotOptimize(position);
+            },
+            options);
+    }
+}
+
+BENCHMARK(BM_chunk_pipeline)->Arg(4)->Arg(64)->UseRealTime();
+
+// Reads the same fields as BM_chunk_file_reads into columns.
+static void BM_region_columns(benchmark::State &state) {
+    const std::vector<std::string> paths = {"Level.xPos", "Level.zPos"};
+    for (auto _ : state) {
+        auto table = nbt::extract_columns("test_data/r.0.0.mca", paths,
+                                          state.range(0));
+        benchmark::DoNotOptimize(table);
+    }
+}
+
+BENCHMARK(BM_region_columns)->Arg(1)->Arg(0);
+
+static void BM_region_entity_index(benchmark::State &state) {
+    for (auto _ : state) {
+        auto index = nbt::build_entity_index({"test_data/r.0.0.mca"}, {},
+                                             state.range(0));
+        benchmark::DoNotOptimize(index);
+    }
+}
+
+BENCHMARK(BM_region_entity_index)->Arg(1)->Arg(0);
+
+// Indexes every chunk of a region (0), or loads an up-to-date sidecar and
+// checks it against the region header (1).
+static void BM_region_index(benchmark::State &state) {
+    const std::vector<std::string> paths = {"Level.xPos", "Level.zPos",
+                                            "Level.Sections"};
+    auto region = std::filesystem::temp_directory_path() / "r.0.0.mca";
+    std::filesystem::copy_file(
+        "test_data/r.0.0.mca", region,
+        std::filesystem::copy_options::overwrite_existing);
+    auto sidecar = nbt::Region_Index::sidecar_path(region.string());
+    nbt::Region_Index::open(region.string(), paths, 1);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            nbt::Region_Index index(paths);
+            index.update(region.string(), 1);
+            benchmark::DoNotOptimize(index);
+        } else {
+            auto index = nbt::Region_Index::open(region.string(), paths, 1);
+            benchmark::DoNotOptimize(index);
+        }
+    }
+    std::filesystem::remove(sidecar);
+    std::filesystem::remove(region);
+}
+
+BENCHMARK(BM_region_index)->Arg(0)->Arg(1);
+
+static void BM_region_validation(benchmark::State &state) {
+    for (auto _ : state) {
+        auto report =
+            nbt::validate_region("test_data/r.0.0.mca", state.range(0));
+        benchmark::DoNotOptimize(report);
+    }
+    state.SetBytesProcessed(state.iterations() *
+                            std::filesystem::file_size("test_data/r.0.0.mca"));
+}
+
+BENCHMARK(BM_region_validation)->Arg(1)->Arg(0);
+
+// Exports the region to an archive, or reads every chunk back from the
+// archive at random.
+static void BM_world_archive(benchmark::State &state) {
+    auto archive_name =
+        (std::filesystem::temp_directory_path() / "bench.nbtw").string();
+    nbt::export_archive({"test_data/r.0.0.mca"}, archive_name,
+                        nbt::Export_Mode::create, 1);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            nbt::export_archive({"test_data/r.0.0.mca"}, archive_name,
+                                nbt::Export_Mode::create, 1);
+        } else {
+            nbt::World_Archive archive(archive_name);
+            for (int i = nbt::Region::chunk_count - 1; i >= 0; --i) {
+                if (auto entry = archive.find(0, 0, i)) {
+                    benchmark::DoNotOptimize(archive.read_chunk(*entry));
+                }
+            }
+        }
+    }
+    std::filesystem::remove(archive_name);
+}
+
+BENCHMARK(BM_world_archive)->Arg(0)->Arg(1);
+
 static void BM_chunk_decoding(benchmark::State &state) {
     const auto filename = "test_data/r.0.0.mca";
     int region_x = 0;
@@ -111,4 +240,246 @@ static void BM_chunk_decoding(benchmark::State &state) {
 
 BENCHMARK(BM_chunk_decoding);
 
+struct Chunk_Position {
+    nbt::Int xPos;
+    nbt::Int zPos;
+};
+
+struct Chunk_Root {
+    Chunk_Position level;
+};
+
+template <> struct nbt::Schema<Chunk_Position> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"xPos">(&Chunk_Position::xPos),
+                   nbt::field<"zPos">(&Chunk_Position::zPos)};
+};
+
+template <> struct nbt::Schema<Chunk_Root> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"Level">(&Chunk_Root::level)};
+};
+
+static void BM_chunk_binding(benchmark::State &state) {
+    const auto filename = "test_data/r.0.0.mca";
+
+    // read and decompress chunk data
+
+    nbt::Region_File reg(filename);
+
+    std::vector<std::vector<unsigned char>> chunk_data;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        chunk_data.push_back(reg.get_chunk_data(i));
+        while (nbt::has_compression_header(chunk_data[i].data(),
+                                           chunk_data[i].size())) {
+            chunk_data[i] = nbt::decompress_data(chunk_data[i].data(),
+                                                 chunk_data[i].size());
+        }
+    }
+
+    // timing loop: decode chunk positions without building Tags
+    for (auto _ : state) {
+        for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+            if (reg.chunk_length(i) == 0) {
+                continue;
+            }
+            auto root = nbt::read_binary_as<Chunk_Root>(chunk_data[i]);
+            benchmark::DoNotOptimize(root);
+        }
+    }
+}
+
+BENCHMARK(BM_chunk_binding);
+
+static void BM_chunk_document(benchmark::State &state) {
+    const auto filename = "test_data/r.0.0.mca";
+
+    // read and decompress chunk data
+
+    nbt::Region_File reg(filename);
+
+    std::vector<std::vector<unsigned char>> chunk_data;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        chunk_data.push_back(reg.get_chunk_data(i));
+        while (nbt::has_compression_header(chunk_data[i].data(),
+                                           chunk_data[i].size())) {
+            chunk_data[i] = nbt::decompress_data(chunk_data[i].data(),
+                                                 chunk_data[i].size());
+        }
+    }
+
+    // timing loop: index each chunk, copied into a Document, and read its
+    // position and block arrays in place
+    for (auto _ : state) {
+        for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+            if (reg.chunk_length(i) == 0) {
+                continue;
+            }
+            nbt::Document doc(chunk_data[i]);
+            auto level = doc.root()["Level"];
+            benchmark::DoNotOptimize(level["xPos"].get<nbt::Int>());
+            benchmark::DoNotOptimize(level["zPos"].get<nbt::Int>());
+            auto sections = level["Sections"];
+            for (std::size_t s = 0; s < sections.size(); ++s) {
+                auto section = sections[s];
+                if (section.contains("Blocks")) {
+                    auto blocks = section["Blocks"].get_array<nbt::Byte>();
+                    benchmark::DoNotOptimize(blocks[0]);
+                }
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_chunk_document);
+
+static void BM_chunk_hashing(benchmark::State &state) {
+    const auto filename = "test_data/r.0.0.mca";
+
+    // read and decompress chunk data
+
+    nbt::Region_File reg(filename);
+
+    std::vector<std::vector<unsigned char>> chunk_data;
+    size_t total_bytes = 0;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        chunk_data.push_back(reg.get_chunk_data(i));
+        while (nbt::has_compression_header(chunk_data[i].data(),
+                                           chunk_data[i].size())) {
+            chunk_data[i] = nbt::decompress_data(chunk_data[i].data(),
+                                                 chunk_data[i].size());
+        }
+        total_bytes += chunk_data[i].size();
+    }
+
+    // timing loop: hash encoded chunks without building Tags
+    for (auto _ : state) {
+        for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+            if (reg.chunk_length(i) == 0) {
+                continue;
+            }
+            auto h =
+                nbt::hash_binary(chunk_data[i].data(), chunk_data[i].size());
+            benchmark::DoNotOptimize(h);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * total_bytes);
+}
+
+BENCHMARK(BM_chunk_hashing);
+
+static const std::vector<nbt::Scan_Pattern> chunk_fields = {
+    {nbt::TypeCode::Int, "xPos"},
+    {nbt::TypeCode::Int, "zPos"},
+    {nbt::TypeCode::Long, "LastUpdate"},
+    {nbt::TypeCode::Long, "InhabitedTime"},
+    {nbt::TypeCode::Byte, "TerrainPopulated"},
+    {nbt::TypeCode::Byte, "LightPopulated"},
+    {nbt::TypeCode::Byte, "V"},
+    {nbt::TypeCode::Int, "DataVersion"},
+    {nbt::TypeCode::String, "Status"},
+    {nbt::TypeCode::Int_Array, "HeightMap"},
+    {nbt::TypeCode::Byte_Array, "Biomes"}};
+
+static std::vector<std::vector<unsigned char>>
+decompressed_chunks(nbt::Region_File &reg) {
+    std::vector<std::vector<unsigned char>> chunk_data;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        chunk_data.push_back(reg.get_chunk_data(i));
+        while (nbt::has_compression_header(chunk_data.back().data(),
+                                           chunk_data.back().size())) {
+            chunk_data.back() = nbt::decompress_data(
+                chunk_data.back().data(), chunk_data.back().size());
+        }
+    }
+    return chunk_data;
+}
+
+// Finds each field with its own pass over the chunk.
+static void BM_chunk_field_search(benchmark::State &state) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    auto chunk_data = decompressed_chunks(reg);
+    for (auto _ : state) {
+        for (const auto &data : chunk_data) {
+            for (const auto &field : chunk_fields) {
+                auto it = nbt::fast_find_named_tag(data.begin(), data.end(),
+                                                   field.type, field.name);
+                benchmark::DoNotOptimize(it);
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_chunk_field_search);
+
+// Finds every field in one pass over the chunk.
+static void BM_chunk_field_scan(benchmark::State &state) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    auto chunk_data = decompressed_chunks(reg);
+    nbt::Scanner scanner(chunk_fields);
+    std::vector<nbt::Scan_Hit> hits;
+    for (auto _ : state) {
+        for (const auto &data : chunk_data) {
+            scanner.scan(data.data(), data.size(), hits, state.range(0));
+            benchmark::DoNotOptimize(hits.data());
+        }
+    }
+}
+
+BENCHMARK(BM_chunk_field_scan)->Arg(0)->Arg(1);
+
+// Encodes every chunk of the test region as one large document.
+static std::string large_document() {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    nbt::Tag chunks(nbt::List{});
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        chunks.push_back(nbt::read_binary(reg.get_chunk_data(i)).second);
+    }
+    nbt::Tag root(nbt::Compound{});
+    root.emplace("chunks", std::move(chunks));
+    std::ostringstream os;
+    nbt::write_binary(root, "world", os);
+    return os.str();
+}
+
+static void BM_large_document_decoding(benchmark::State &state) {
+    auto document = large_document();
+    auto data = reinterpret_cast<const unsigned char *>(document.data());
+
+    // timing loop
+    for (auto _ : state) {
+        auto result = nbt::read_binary(data, document.size());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BM_large_document_decoding)->Unit(benchmark::kMillisecond);
+
+static void BM_large_document_parallel(benchmark::State &state) {
+    auto document = large_document();
+    auto data = reinterpret_cast<const unsigned char *>(document.data());
+
+    // timing loop
+    for (auto _ : state) {
+        auto result =
+            nbt::read_binary_parallel(data, document.size(), state.range(0));
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(state.iterations() * document.size());
+}
+
+BENCHMARK(BM_large_document_parallel)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 BENCHMARK_MAIN();
@@ -0,0 +1,165 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "CompactTree.hpp"
+#include "Region.hpp"
+#include "SharedTag.hpp"
+#include "nbtview.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+
+// Count live heap bytes so that the memory held by a decoded tree can be
+// reported.  Each allocation is prefixed with its size.
+static size_t live_bytes = 0;
+
+void *operator new(size_t size) {
+    auto block = static_cast<size_t *>(std::malloc(size + sizeof(size_t)));
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+    *block = size;
+    live_bytes += size;
+    return block + 1;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        auto block = static_cast<size_t *>(ptr) - 1;
+        live_bytes -= *block;
+        std::free(block);
+    }
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
+static std::vector<std::vector<unsigned char>> inflated_chunks() {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    std::vector<std::vector<unsigned char>> chunks;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto data = reg.get_chunk_data(i);
+        chunks.push_back(nbt::decompress_data(data.data(), data.size()));
+    }
+    return chunks;
+}
+
+static void BM_tag_memory(benchmark::State &state) {
+    auto chunks = inflated_chunks();
+    size_t total_bytes = 0;
+
+    // timing loop
+    for (auto _ : state) {
+        total_bytes = 0;
+        for (auto &chunk : chunks) {
+            size_t before = live_bytes;
+            auto [root_name, root_tag] =
+                nbt::read_binary(chunk.data(), chunk.size());
+            total_bytes += live_bytes - before;
+            benchmark::DoNotOptimize(root_tag);
+        }
+    }
+    state.counters["bytes_per_chunk"] =
+        static_cast<double>(total_bytes) / chunks.size();
+}
+
+BENCHMARK(BM_tag_memory);
+
+static void BM_packed_tag_memory(benchmark::State &state) {
+    auto chunks = inflated_chunks();
+    size_t total_bytes = 0;
+
+    // timing loop
+    for (auto _ : state) {
+        total_bytes = 0;
+        for (auto &chunk : chunks) {
+            size_t before = live_bytes;
+            auto [root_name, root_tag] =
+                nbt::read_binary(chunk.data(), chunk.size(),
+                                 {.packed_lists = true});
+            total_bytes += live_bytes - before;
+            benchmark::DoNotOptimize(root_tag);
+        }
+    }
+    state.counters["bytes_per_chunk"] =
+        static_cast<double>(total_bytes) / chunks.size();
+}
+
+BENCHMARK(BM_packed_tag_memory);
+
+static void BM_compact_tree_memory(benchmark::State &state) {
+    auto chunks = inflated_chunks();
+    size_t total_bytes = 0;
+
+    // timing loop
+    for (auto _ : state) {
+        total_bytes = 0;
+        for (auto &chunk : chunks) {
+            size_t before = live_bytes;
+            nbt::CompactTree tree(chunk.data(), chunk.size());
+            total_bytes += live_bytes - before;
+            benchmark::DoNotOptimize(tree);
+        }
+    }
+    state.counters["bytes_per_chunk"] =
+        static_cast<double>(total_bytes) / chunks.size();
+}
+
+BENCHMARK(BM_compact_tree_memory);
+
+// Bytes allocated to take a snapshot of each chunk and then change one
+// value in the copy.
+static void BM_tag_snapshot_memory(benchmark::State &state) {
+    std::vector<nbt::Tag> tags;
+    for (auto &chunk : inflated_chunks()) {
+        tags.push_back(nbt::read_binary(chunk.data(), chunk.size()).second);
+    }
+    size_t total_bytes = 0;
+
+    // timing loop
+    for (auto _ : state) {
+        total_bytes = 0;
+        for (auto &tag : tags) {
+            size_t before = live_bytes;
+            nbt::Tag snapshot = tag;
+            snapshot["Level"]["LastUpdate"] = nbt::Long(0);
+            total_bytes += live_bytes - before;
+            benchmark::DoNotOptimize(snapshot);
+        }
+    }
+    state.counters["bytes_per_chunk"] =
+        static_cast<double>(total_bytes) / tags.size();
+}
+
+BENCHMARK(BM_tag_snapshot_memory);
+
+static void BM_shared_tag_snapshot_memory(benchmark::State &state) {
+    std::vector<nbt::SharedTag> tags;
+    for (auto &chunk : inflated_chunks()) {
+        tags.emplace_back(nbt::read_binary(chunk.data(), chunk.size()).second);
+    }
+    size_t total_bytes = 0;
+
+    // timing loop
+    for (auto _ : state) {
+        total_bytes = 0;
+        for (auto &tag : tags) {
+            size_t before = live_bytes;
+            nbt::SharedTag snapshot = tag;
+            snapshot["Level"]["LastUpdate"] = nbt::Long(0);
+            total_bytes += live_bytes - before;
+            benchmark::DoNotOptimize(snapshot);
+        }
+    }
+    state.counters["bytes_per_chunk"] =
+        static_cast<double>(total_bytes) / tags.size();
+}
+
+BENCHMARK(BM_shared_tag_snapshot_memory);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+
+#include "SnbtWriter.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+// Returns a List holding the given number of copies of bigtest's root tag.
+static nbt::Tag bigtest_copies(int copies) {
+    std::ifstream bigtest_stream("test_data/bigtest.nbt");
+    auto [root_name, root_tag] = nbt::read_binary(bigtest_stream);
+    nbt::Tag lst(nbt::List{});
+    for (int i = 0; i < copies; ++i) {
+        lst.push_back(root_tag);
+    }
+    return lst;
+}
+
+static void BM_snbt_parse_bigtest(benchmark::State &state) {
+    auto snbt = nbt::to_string(bigtest_copies(state.range(0)));
+
+    // timing loop
+    for (auto _ : state) {
+        auto tag = nbt::read_snbt(snbt);
+        benchmark::DoNotOptimize(tag);
+    }
+    state.SetBytesProcessed(state.iterations() * snbt.size());
+}
+
+BENCHMARK(BM_snbt_parse_bigtest)->Arg(1)->Arg(64);
+
+static void BM_snbt_write_bigtest(benchmark::State &state) {
+    auto tag = bigtest_copies(state.range(0));
+    std::string buffer;
+
+    // timing loop
+    for (auto _ : state) {
+        buffer.clear();
+        nbt::write_snbt(tag, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+BENCHMARK(BM_snbt_write_bigtest)->Arg(1)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,503 @@
+// Archive.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Archive.hpp"
+#include "BinaryReader.hpp"
+#include "BinaryWriter.hpp"
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    const char archive_magic[4] = {'N', 'B', 'T', 'W'};
+
+    // Length of an index entry, and of the trailer after the index
+    const std::size_t entry_length = 27;
+    const std::size_t trailer_length = 8 + sizeof(archive_magic);
+
+    const int chunk_header_length = 5;
+
+    // Number of chunks whose frames are held in memory at once while an
+    // archive is written
+    const std::size_t export_batch_size = 1024;
+
+    // A chunk of a region file, to be copied to an archive
+    struct Export_Job {
+        std::size_t file;
+        Int region_x;
+        Int region_z;
+        uint16_t chunk;
+        uint32_t timestamp;
+        uint32_t sector;
+        uint8_t sector_count;
+    };
+
+    struct Frame {
+        uint8_t compression;
+        std::vector<unsigned char> bytes;
+    };
+
+    auto entry_key(const Archive_Entry &entry) {
+        return std::tuple(entry.region_x, entry.region_z, entry.chunk,
+                          entry.timestamp);
+    }
+
+    // Reads a chunk from a region file as a compressed frame.
+    Frame read_export_frame(const Export_Job &job, const std::string &name,
+                            std::ifstream &input) {
+        std::vector<unsigned char> bytes(std::size_t(job.sector_count) *
+                                         Region::sector_length);
+        input.clear();
+        input.seekg(std::streamoff(job.sector) * Region::sector_length);
+        input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+        bytes.resize(input.gcount());
+        auto fail = [&](const std::string &problem) {
+            return std::runtime_error("Chunk " + std::to_string(job.chunk) +
+                                      " of region file " + name + " " +
+                                      problem);
+        };
+        if (bytes.size() < chunk_header_length) {
+            throw fail("lies past the end of the file");
+        }
+        uint32_t length = (uint32_t(bytes[0]) << 24) |
+                          (uint32_t(bytes[1]) << 16) |
+                          (uint32_t(bytes[2]) << 8) | bytes[3];
+        if (length == 0 || length > bytes.size() - 4) {
+            throw fail("has an invalid length");
+        }
+        auto compression = bytes[4];
+        auto data = bytes.data() + chunk_header_length;
+        std::size_t data_length = length - 1;
+        // An external chunk's data is the whole of its .mcc file.
+        if (compression & Region::external_flag) {
+            compression &= ~Region::external_flag;
+            bytes = read_external_chunk(name, job.chunk);
+            data = bytes.data();
+            data_length = bytes.size();
+        }
+        switch (compression) {
+        case 1:
+        case 2:
+            return {compression, {data, data + data_length}};
+        case 3:
+            return {2, compress_data(data, data_length)};
+        default:
+            throw fail("has unknown compression type " +
+                       std::to_string(compression));
+        }
+    }
+
+    std::vector<unsigned char> read_archive_frame(std::ifstream &input,
+                                                  const std::string &name,
+                                                  const Archive_Entry &entry) {
+        std::vector<unsigned char> frame(entry.length);
+        input.clear();
+        input.seekg(std::streamoff(entry.offset));
+        input.read(reinterpret_cast<char *>(frame.data()), frame.size());
+        if (!input) {
+            throw std::runtime_error("Could not read from offset " +
+                                     std::to_string(entry.offset) +
+                                     " of archive " + name);
+        }
+        return frame;
+    }
+
+    // Writes one region file from the latest versions of its chunks.
+    // Chunks too large for the region's sectors are written to .mcc files
+    // beside it, as Minecraft does.
+    void write_region(const std::string &filename,
+                      const std::vector<Archive_Entry> &entries,
+                      std::ifstream &input, const std::string &name) {
+        Region region{};
+        std::vector<unsigned char> body;
+        for (const auto &entry : entries) {
+            auto frame = read_archive_frame(input, name, entry);
+            auto compression = entry.compression;
+            std::size_t sectors = (chunk_header_length + frame.size() +
+                                   Region::sector_length - 1) /
+                                  Region::sector_length;
+            if (sectors > 255) {
+                auto path = external_chunk_path(filename, entry.chunk);
+                std::ofstream external(path, std::ios::binary);
+                external.write(reinterpret_cast<const char *>(frame.data()),
+                               frame.size());
+                if (!external) {
+                    throw std::runtime_error("Could not write " + path);
+                }
+                compression |= Region::external_flag;
+                frame.clear();
+                sectors = 1;
+            }
+            auto &chunk = region.chunk[entry.chunk];
+            chunk.offset = static_cast<uint32_t>(
+                2 + body.size() / Region::sector_length);
+            chunk.length = static_cast<uint8_t>(sectors);
+            chunk.timestamp = entry.timestamp;
+
+            uint32_t length = static_cast<uint32_t>(frame.size() + 1);
+            body.push_back(length >> 24);
+            body.push_back((length >> 16) & 0xFF);
+            body.push_back((length >> 8) & 0xFF);
+            body.push_back(length & 0xFF);
+            body.push_back(compression);
+            body.insert(body.end(), frame.begin(), frame.end());
+            body.resize(body.size() + sectors * Region::sector_length -
+                        chunk_header_length - frame.size());
+        }
+        Region::Sector_Data offsets(Region::sector_length);
+        Region::Sector_Data timestamps(Region::sector_length);
+        region.save_to_sectors(offsets, timestamps);
+
+        std::ofstream output(filename, std::ios::binary);
+        output.write(reinterpret_cast<const char *>(offsets.data()),
+                     offsets.size());
+        output.write(reinterpret_cast<const char *>(timestamps.data()),
+                     timestamps.size());
+        output.write(reinterpret_cast<const char *>(body.data()),
+                     body.size());
+        if (!output) {
+            throw std::runtime_error("Could not write region file " +
+                                     filename);
+        }
+    }
+
+    // Writes the frames of the jobs from offset on, then the index of
+    // them and of the entries already in index, and the trailer.
+    void write_archive(std::ostream &output, uint64_t offset,
+                       const std::vector<Export_Job> &jobs,
+                       const std::vector<std::string> &region_files,
+                       std::vector<Archive_Entry> &index,
+                       unsigned thread_count) {
+        // Each worker keeps the file of its last job open.
+        struct Worker {
+            std::size_t file = 0;
+            std::ifstream input;
+        };
+        std::vector<Worker> workers(
+            detail::worker_count(thread_count, export_batch_size));
+        std::vector<Frame> frames;
+        for (std::size_t first = 0; first < jobs.size();
+             first += export_batch_size) {
+            auto count = std::min(export_batch_size, jobs.size() - first);
+            frames.assign(count, Frame());
+            auto read_job = [&](std::size_t j, unsigned w) {
+                const auto &job = jobs[first + j];
+                auto &worker = workers[w];
+                if (!worker.input.is_open() || worker.file != job.file) {
+                    worker.input.close();
+                    worker.input.open(region_files[job.file], std::ios::binary);
+                    if (!worker.input) {
+                        throw std::runtime_error("Could not open region file " +
+                                                 region_files[job.file]);
+                    }
+                    worker.file = job.file;
+                }
+                frames[j] = read_export_frame(job, region_files[job.file],
+                                              worker.input);
+            };
+            detail::parallel_for(count, thread_count, read_job);
+
+            for (std::size_t j = 0; j < count; ++j) {
+                const auto &job = jobs[first + j];
+                const auto &frame = frames[j].bytes;
+                index.push_back({job.region_x, job.region_z, job.chunk,
+                                 job.timestamp, frames[j].compression, offset,
+                                 static_cast<uint32_t>(frame.size())});
+                output.write(reinterpret_cast<const char *>(frame.data()),
+                             frame.size());
+                offset += frame.size();
+            }
+        }
+
+        std::sort(index.begin(), index.end(),
+                  [](const Archive_Entry &a, const Archive_Entry &b) {
+                      return entry_key(a) < entry_key(b);
+                  });
+        BinaryWriter::write(static_cast<uint64_t>(index.size()), output);
+        for (const auto &entry : index) {
+            BinaryWriter::write(entry.region_x, output);
+            BinaryWriter::write(entry.region_z, output);
+            BinaryWriter::write(entry.chunk, output);
+            BinaryWriter::write(entry.timestamp, output);
+            BinaryWriter::write(entry.compression, output);
+            BinaryWriter::write(entry.offset, output);
+            BinaryWriter::write(entry.length, output);
+        }
+        BinaryWriter::write(offset, output);
+        output.write(archive_magic, sizeof(archive_magic));
+    }
+
+} // namespace
+
+void export_archive(const std::vector<std::string> &region_files,
+                    const std::string &archive_filename, Export_Mode mode,
+                    unsigned thread_count) {
+    std::vector<Archive_Entry> index;
+    bool appending = mode == Export_Mode::append &&
+                     std::filesystem::exists(archive_filename);
+    if (appending) {
+        index = World_Archive(archive_filename).entries();
+    }
+    // Versions the archive already holds are not added again.
+    auto archived = [&](const Archive_Entry &entry) {
+        return std::binary_search(
+            index.begin(), index.end(), entry,
+            [](const Archive_Entry &a, const Archive_Entry &b) {
+                return entry_key(a) < entry_key(b);
+            });
+    };
+
+    std::vector<Export_Job> jobs;
+    for (std::size_t f = 0; f < region_files.size(); ++f) {
+        int region_x, region_z;
+        if (!parse_region_filename(region_files[f], region_x, region_z)) {
+            throw std::runtime_error("Not a region file name: " +
+                                     region_files[f]);
+        }
+        if (std::filesystem::file_size(region_files[f]) == 0) {
+            continue;
+        }
+        Region_File region(region_files[f]);
+        for (int i = 0; i < Region::chunk_count; ++i) {
+            Archive_Entry version{region_x, region_z,
+                                  static_cast<uint16_t>(i),
+                                  region.chunk_timestamp(i), 0, 0, 0};
+            if (region.chunk_length(i) != 0 && !archived(version)) {
+                jobs.push_back({f, region_x, region_z,
+                                static_cast<uint16_t>(i),
+                                region.chunk_timestamp(i),
+                                region.chunk_offset(i),
+                                region.chunk_length(i)});
+            }
+        }
+    }
+
+    // A new archive is written under a name of its own and renamed over
+    // any old one once it is complete.  An archive appended to is cut back
+    // to its old length if the export fails, so that its old trailer ends
+    // it again.
+    auto output_filename =
+        appending ? archive_filename : temporary_path(archive_filename);
+    std::ofstream output;
+    uint64_t offset;
+    if (appending) {
+        offset = std::filesystem::file_size(archive_filename);
+        output.open(output_filename,
+                    std::ios::binary | std::ios::in | std::ios::out);
+        output.seekp(std::streamoff(offset));
+    } else {
+        output.open(output_filename, std::ios::binary);
+        output.write(archive_magic, sizeof(archive_magic));
+        offset = sizeof(archive_magic);
+    }
+    auto original_length = offset;
+    try {
+        if (!output) {
+            throw std::runtime_error("Could not write archive " +
+                                     archive_filename);
+        }
+        write_archive(output, offset, jobs, region_files, index,
+                      thread_count);
+        output.close();
+        if (!output) {
+            throw std::runtime_error("Could not write archive " +
+                                     archive_filename);
+        }
+        if (!appending) {
+            std::filesystem::rename(output_filename, archive_filename);
+        }
+    } catch (...) {
+        output.close();
+        std::error_code ignored;
+        if (appending) {
+            std::filesystem::resize_file(archive_filename, original_length,
+                                         ignored);
+        } else {
+            std::filesystem::remove(output_filename, ignored);
+        }
+        throw;
+    }
+}
+
+void export_world_archive(const std::string &directory,
+                          const std::string &archive_filename,
+                          Export_Mode mode, unsigned thread_count) {
+    export_archive(region_files(directory), archive_filename, mode,
+                   thread_count);
+}
+
+World_Archive::World_Archive(const std::string &filename)
+    : name(filename), file(filename, std::ios::binary) {
+    if (!file) {
+        throw std::runtime_error("Could not open archive " + filename);
+    }
+    auto invalid = [&] {
+        return std::runtime_error(filename + " is not a valid archive");
+    };
+    file.seekg(0, std::ios::end);
+    uint64_t file_length = file.tellg();
+    if (file_length < sizeof(archive_magic) + 8 + trailer_length) {
+        throw invalid();
+    }
+    std::vector<unsigned char> head(sizeof(archive_magic));
+    std::vector<unsigned char> trailer(trailer_length);
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(head.data()), head.size());
+    file.seekg(file_length - trailer_length);
+    file.read(reinterpret_cast<char *>(trailer.data()), trailer.size());
+    BinaryReader trailer_reader(trailer.data(), trailer.size());
+    auto index_offset = trailer_reader.read<uint64_t>();
+    std::string_view magic(archive_magic, sizeof(archive_magic));
+    if (!file ||
+        std::string_view(reinterpret_cast<char *>(head.data()), 4) != magic ||
+        trailer_reader.read_string_view(sizeof(archive_magic)) != magic ||
+        index_offset < sizeof(archive_magic) ||
+        index_offset > file_length - trailer_length - 8) {
+        throw invalid();
+    }
+
+    std::vector<unsigned char> bytes(file_length - trailer_length -
+                                     index_offset);
+    file.seekg(index_offset);
+    file.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+    BinaryReader reader(bytes.data(), bytes.size());
+    auto count = reader.read<uint64_t>();
+    if (!file || count != reader.remaining_length() / entry_length ||
+        reader.remaining_length() % entry_length != 0) {
+        throw invalid();
+    }
+    index.resize(count);
+    for (auto &entry : index) {
+        entry.region_x = reader.read<Int>();
+        entry.region_z = reader.read<Int>();
+        entry.chunk = reader.read<uint16_t>();
+        entry.timestamp = reader.read<uint32_t>();
+        entry.compression = reader.read<uint8_t>();
+        entry.offset = reader.read<uint64_t>();
+        entry.length = reader.read<uint32_t>();
+        if (entry.chunk >= Region::chunk_count ||
+            (entry.compression != 1 && entry.compression != 2) ||
+            entry.offset < sizeof(archive_magic) ||
+            entry.offset + entry.length > index_offset) {
+            throw invalid();
+        }
+    }
+    if (!std::is_sorted(index.begin(), index.end(),
+                        [](const Archive_Entry &a, const Archive_Entry &b) {
+                            return entry_key(a) < entry_key(b);
+                        })) {
+        throw invalid();
+    }
+}
+
+std::optional<Archive_Entry> World_Archive::find(Int region_x, Int region_z,
+                                                 int chunk) const {
+    if (chunk < 0 || chunk >= Region::chunk_count) {
+        return std::nullopt;
+    }
+    // The latest version is the last one before the next chunk.
+    auto next = std::lower_bound(
+        index.begin(), index.end(),
+        std::tuple(region_x, region_z, chunk + 1),
+        [](const Archive_Entry &entry, const auto &key) {
+            return std::tuple(entry.region_x, entry.region_z,
+                              int(entry.chunk)) < key;
+        });
+    if (next == index.begin()) {
+        return std::nullopt;
+    }
+    auto &latest = *std::prev(next);
+    if (latest.region_x != region_x || latest.region_z != region_z ||
+        latest.chunk != chunk) {
+        return std::nullopt;
+    }
+    return latest;
+}
+
+std::optional<Archive_Entry> World_Archive::find(Int region_x, Int region_z,
+                                                 int chunk,
+                                                 uint32_t timestamp) const {
+    if (chunk < 0 || chunk >= Region::chunk_count) {
+        return std::nullopt;
+    }
+    auto key = std::tuple(region_x, region_z, static_cast<uint16_t>(chunk),
+                          timestamp);
+    auto found = std::lower_bound(
+        index.begin(), index.end(), key,
+        [](const Archive_Entry &entry, const auto &key) {
+            return entry_key(entry) < key;
+        });
+    if (found == index.end() || entry_key(*found) != key) {
+        return std::nullopt;
+    }
+    return *found;
+}
+
+std::vector<unsigned char>
+World_Archive::read_frame(const Archive_Entry &entry) {
+    return read_archive_frame(file, name, entry);
+}
+
+std::vector<unsigned char>
+World_Archive::read_chunk(const Archive_Entry &entry) {
+    auto frame = read_frame(entry);
+    return decompress_data(frame.data(), frame.size());
+}
+
+void World_Archive::import_regions(const std::string &directory,
+                                   unsigned thread_count) const {
+    // The latest version of each chunk is the last of its run in the
+    // index, which is already ordered by region.
+    std::vector<std::vector<Archive_Entry>> regions;
+    for (std::size_t i = 0; i < index.size(); ++i) {
+        const auto &entry = index[i];
+        if (i + 1 < index.size() && index[i + 1].chunk == entry.chunk &&
+            index[i + 1].region_x == entry.region_x &&
+            index[i + 1].region_z == entry.region_z) {
+            continue;
+        }
+        if (regions.empty() ||
+            regions.back().back().region_x != entry.region_x ||
+            regions.back().back().region_z != entry.region_z) {
+            regions.emplace_back();
+        }
+        regions.back().push_back(entry);
+    }
+
+    std::vector<std::ifstream> inputs(
+        detail::worker_count(thread_count, regions.size()));
+    auto import_region = [&](std::size_t r, unsigned w) {
+        auto &input = inputs[w];
+        if (!input.is_open()) {
+            input.open(name, std::ios::binary);
+            if (!input) {
+                throw std::runtime_error("Could not open archive " + name);
+            }
+        }
+        const auto &first = regions[r].front();
+        auto filename = (std::filesystem::path(directory) /
+                         ("r." + std::to_string(first.region_x) + "." +
+                          std::to_string(first.region_z) + ".mca"))
+                            .string();
+        write_region(filename, regions[r], input, name);
+    };
+    detail::parallel_for(regions.size(), thread_count, import_region);
+}
+
+} // namespace nbtview
@@ -0,0 +1,142 @@
+/**
+ * @file Archive.hpp
+ * @brief A seekable archive of the chunks of a world, for backups
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_ARCHIVE_H_
+#define NBT_ARCHIVE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! Where an archive holds one version of a chunk
+struct Archive_Entry {
+    Int region_x;
+    Int region_z;
+    //! Index of the chunk within its region
+    uint16_t chunk;
+    //! The chunk's timestamp in its region header
+    uint32_t timestamp;
+    //! Compression type of the frame, as in a region file: 1 for gzip or 2
+    //! for zlib
+    uint8_t compression;
+    //! Offset and length of the frame within the archive
+    uint64_t offset;
+    uint32_t length;
+
+    bool operator==(const Archive_Entry &other) const = default;
+};
+
+//! Whether export_archive() starts a new archive or adds to one
+enum class Export_Mode {
+    //! Replace any existing archive
+    create,
+    //! Add to an existing archive each chunk whose timestamp it does not
+    //! yet hold, keeping the versions already there; an archive which does
+    //! not exist is created
+    append,
+};
+
+/**
+ * @brief Writes the chunks of some region files to an archive.
+ *
+ * Each chunk is stored as an independently compressed frame: chunks which
+ * are already compressed are copied as they are, and others are compressed
+ * with zlib.  Chunks stored outside their region file are read from their
+ * .mcc files.  Frames are prepared on several threads, a bounded batch at
+ * a time, and written in order of region file and chunk.
+ *
+ * Exporting a world at intervals with Export_Mode::append keeps each
+ * version of each chunk, so that the archive holds the world's history.
+ * Appended frames, and then a new index, are written after the end of the
+ * archive; the old index is left in place, unused.
+ *
+ * An export which fails leaves any existing archive as it was: a new
+ * archive is written to a temporary file and renamed over the old one once
+ * complete, and an archive appended to is cut back to its old length.
+ *
+ * All values are big-endian.  The archive holds the magic bytes "NBTW",
+ * the frames end to end, then an index: the entry count as a uint64 and
+ * the entries ordered by region X and Z, chunk and timestamp, each as its
+ * region X and Z (Ints), chunk (uint16), timestamp (uint32), compression
+ * (byte), offset (uint64) and length (uint32).  The archive ends with the
+ * offset of the index as a uint64 and the magic bytes again, so that the
+ * index can be found by seeking to the end.
+ *
+ * @param region_files region files named r.X.Z.mca
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * @throw std::runtime_error if a region file cannot be read, or the
+ * archive cannot be written, or appended to as it is not a valid archive
+ */
+void export_archive(const std::vector<std::string> &region_files,
+                    const std::string &archive_filename,
+                    Export_Mode mode = Export_Mode::create,
+                    unsigned thread_count = 0);
+
+//! Writes an archive of every region file r.X.Z.mca in a directory, such
+//! as a world's region directory.
+void export_world_archive(const std::string &directory,
+                          const std::string &archive_filename,
+                          Export_Mode mode = Export_Mode::create,
+                          unsigned thread_count = 0);
+
+/**
+ * @brief World_Archive reads chunks from an archive written by
+ * export_archive().
+ *
+ * Only the index is read when the archive is opened; each chunk is then
+ * read with one seek, and inflated alone.
+ */
+class World_Archive {
+  public:
+    //! @throw std::runtime_error if the file is not a valid archive
+    explicit World_Archive(const std::string &filename);
+
+    //! Every entry, ordered by region X and Z, chunk and timestamp
+    const std::vector<Archive_Entry> &entries() const { return index; }
+
+    //! Returns the latest version of a chunk, if the archive holds one.
+    std::optional<Archive_Entry> find(Int region_x, Int region_z,
+                                      int chunk) const;
+    //! Returns the version of a chunk with the given timestamp.
+    std::optional<Archive_Entry> find(Int region_x, Int region_z, int chunk,
+                                      uint32_t timestamp) const;
+
+    //! Returns the compressed frame of an entry.
+    std::vector<unsigned char> read_frame(const Archive_Entry &entry);
+
+    //! Returns the uncompressed data of an entry.
+    std::vector<unsigned char> read_chunk(const Archive_Entry &entry);
+
+    /**
+     * @brief Writes a region file r.X.Z.mca into a directory for each
+     * region in the archive, holding the latest version of each chunk.
+     *
+     * Regions are written on several threads, each reading through its own
+     * handle on the archive.
+     */
+    void import_regions(const std::string &directory,
+                        unsigned thread_count = 0) const;
+
+  private:
+    std::string name;
+    std::ifstream file;
+    std::vector<Archive_Entry> index;
+};
+
+} // namespace nbtview
+
+#endif // NBT_ARCHIVE_H_
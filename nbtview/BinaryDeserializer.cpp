@@ -1,5 +1,6 @@
 // BinaryDeserializer.cpp
 
+#include <algorithm>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -11,74 +12,192 @@
 
 namespace nbtview {
 
+namespace {
+
+    bool is_container(TypeCode type) {
+        return type == TypeCode::Compound || type == TypeCode::List;
+    }
+
+} // namespace
+
 // deserialize reads the tag type, tag name, and tag payload, and returns the
 // tag's name and value.
-std::pair<std::string, Tag> BinaryDeserializer::deserialize() {
+template <typename Encoding>
+std::pair<std::string, Tag> BasicBinaryDeserializer<Encoding>::deserialize() {
+    // Each call reads a new root, even if an earlier call threw partway.
+    stack.clear();
+    element_count = 0;
     // read type id byte
-    TypeCode type = static_cast<TypeCode>(scanner.read<int8_t>());
+    auto type = static_cast<TypeCode>(scanner.template read<int8_t>());
     if (type == TypeCode::End) {
         return {"", Tag(End())};
     }
     std::string tag_name = deserialize_string();
-    return std::make_pair(tag_name, deserialize_typed_value(type));
+    count_elements(1);
+    if (!is_container(type)) {
+        return std::make_pair(tag_name, deserialize_typed_value(type));
+    }
+
+    open_container(type, std::move(tag_name));
+    while (true) {
+        Frame &top = stack.back();
+        if (auto cmpd = std::get_if<Compound>(&top.value)) {
+            auto child_type =
+                static_cast<TypeCode>(scanner.template read<int8_t>());
+            if (child_type != TypeCode::End) {
+                auto child_name = deserialize_string();
+                count_elements(1);
+                if (is_container(child_type)) {
+                    open_container(child_type, std::move(child_name));
+                } else {
+                    cmpd->emplace(std::move(child_name),
+                                  deserialize_typed_value(child_type));
+                }
+                continue;
+            }
+        } else if (top.remaining > 0) {
+            --top.remaining;
+            count_elements(1);
+            if (is_container(top.list_type)) {
+                open_container(top.list_type, {});
+            } else {
+                detail::append_element(
+                    top.value, deserialize_typed_value(top.list_type));
+            }
+            continue;
+        }
+        if (stack.size() == 1) {
+            break;
+        }
+        close_container();
+    }
+    auto root = std::move(stack.back());
+    stack.pop_back();
+    return {std::move(root.name), std::move(root.value)};
 }
 
-List BinaryDeserializer::deserialize_list() {
-    auto list_type = static_cast<TypeCode>(scanner.read<int8_t>());
-    auto list_length = scanner.read<int32_t>();
-    List lst;
-    lst.reserve(list_length);
-    for (int32_t idx = 0; idx < list_length; ++idx) {
-        auto next_tag_data = deserialize_typed_value(list_type);
-        lst.emplace_back(std::move(next_tag_data));
+template <typename Encoding>
+void BasicBinaryDeserializer<Encoding>::count_elements(std::size_t n) {
+    element_count += n;
+    if (element_count > options.max_elements) {
+        throw LimitExceededException("NBT data has more than " +
+                                     std::to_string(options.max_elements) +
+                                     " tags");
     }
-    return lst;
 }
 
-Compound BinaryDeserializer::deserialize_compound() {
-    Compound cmpd;
-    while (true) {
-        auto [next_name, next_tag] = deserialize();
-        if (next_tag.is<nbtview::End>()) {
+template <typename Encoding>
+void BasicBinaryDeserializer<Encoding>::open_container(TypeCode type,
+                                                       std::string name) {
+    if (stack.size() >= options.max_depth) {
+        throw LimitExceededException("NBT data is nested more than " +
+                                     std::to_string(options.max_depth) +
+                                     " levels deep");
+    }
+    Frame frame{Compound(), std::move(name), TypeCode::End, 0};
+    if (type == TypeCode::List) {
+        frame.list_type =
+            static_cast<TypeCode>(scanner.template read<int8_t>());
+        // A negative List length is read as an empty List.
+        auto length = std::max(scanner.template read<int32_t>(), 0);
+        switch (frame.list_type) {
+        case TypeCode::Byte:
+            frame.value = deserialize_numeric_list<Byte>(length);
+            break;
+        case TypeCode::Short:
+            frame.value = deserialize_numeric_list<Short>(length);
+            break;
+        case TypeCode::Int:
+            frame.value = deserialize_numeric_list<Int>(length);
+            break;
+        case TypeCode::Long:
+            frame.value = deserialize_numeric_list<Long>(length);
+            break;
+        case TypeCode::Float:
+            frame.value = deserialize_numeric_list<Float>(length);
+            break;
+        case TypeCode::Double:
+            frame.value = deserialize_numeric_list<Double>(length);
+            break;
+        default: {
+            // Every element takes at least one byte, so the length cannot
+            // exceed the remaining input unless the input is invalid.
+            frame.value = detail::empty_list(
+                frame.list_type, options,
+                std::min<std::size_t>(length, scanner.remaining_length()));
+            frame.remaining = length;
             break;
         }
-        cmpd.emplace(std::move(next_name), std::move(next_tag));
+        }
+    }
+    stack.push_back(std::move(frame));
+}
+
+template <typename Encoding>
+void BasicBinaryDeserializer<Encoding>::close_container() {
+    auto child = std::move(stack.back());
+    stack.pop_back();
+    auto &parent = stack.back().value;
+    if (auto cmpd = std::get_if<Compound>(&parent)) {
+        cmpd->emplace(std::move(child.name), std::move(child.value));
+    } else {
+        detail::append_element(parent, std::move(child.value));
     }
-    return cmpd;
 }
 
-template <typename T> std::vector<T> BinaryDeserializer::deserialize_array() {
-    int32_t n_values = scanner.read<int32_t>();
-    return scanner.read_array<T>(n_values);
+template <typename Encoding>
+template <typename T>
+TagValue
+BasicBinaryDeserializer<Encoding>::deserialize_numeric_list(int32_t length) {
+    if (static_cast<std::size_t>(length) >
+        scanner.remaining_length() /
+            detail::min_encoded_size<Encoding, T>) {
+        throw UnexpectedEndOfInputException();
+    }
+    count_elements(length);
+    if (options.packed_lists) {
+        return Packed_List(scanner.template read_array<T>(length));
+    }
+    List lst;
+    lst.reserve(length);
+    for (int32_t idx = 0; idx < length; ++idx) {
+        lst.emplace_back(scanner.template read<T>());
+    }
+    return lst;
+}
+
+template <typename Encoding>
+template <typename T>
+std::vector<T> BasicBinaryDeserializer<Encoding>::deserialize_array() {
+    int32_t n_values = scanner.template read<int32_t>();
+    return scanner.template read_array<T>(n_values);
 }
 
-std::string BinaryDeserializer::deserialize_string() {
-    uint16_t bytes = scanner.read<uint16_t>();
-    return scanner.read_string(bytes);
+template <typename Encoding>
+std::string BasicBinaryDeserializer<Encoding>::deserialize_string() {
+    return scanner.read_string(scanner.read_string_length());
 }
 
-TagValue BinaryDeserializer::deserialize_typed_value(TypeCode type) {
+template <typename Encoding>
+TagValue
+BasicBinaryDeserializer<Encoding>::deserialize_typed_value(TypeCode type) {
     switch (type) {
     case TypeCode::Byte:
-        return scanner.read<Byte>();
+        return scanner.template read<Byte>();
     case TypeCode::Short:
-        return scanner.read<Short>();
+        return scanner.template read<Short>();
     case TypeCode::Int:
-        return scanner.read<Int>();
+        return scanner.template read<Int>();
     case TypeCode::Long:
-        return scanner.read<Long>();
+        return scanner.template read<Long>();
     case TypeCode::Float:
-        return scanner.read<Float>();
+        return scanner.template read<Float>();
     case TypeCode::Double:
-        return scanner.read<Double>();
+        return scanner.template read<Double>();
     case TypeCode::Byte_Array:
         return deserialize_array<Byte>();
     case TypeCode::String:
         return deserialize_string();
-    case TypeCode::List:
-        return deserialize_list();
-    case TypeCode::Compound:
-        return deserialize_compound();
     case TypeCode::Int_Array:
         return deserialize_array<Int>();
     case TypeCode::Long_Array:
@@ -88,4 +207,8 @@ TagValue BinaryDeserializer::deserialize_typed_value(TypeCode type) {
     }
 }
 
+template class BasicBinaryDeserializer<Big_Endian>;
+template class BasicBinaryDeserializer<Little_Endian>;
+template class BasicBinaryDeserializer<Network_Varint>;
+
 } // namespace nbtview
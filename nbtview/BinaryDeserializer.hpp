@@ -11,35 +11,83 @@
 #ifndef BINARYDESERIALIZER_H_
 #define BINARYDESERIALIZER_H_
 
+#include <algorithm>
+#include <cstddef>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "BinaryReader.hpp"
 #include "Deserializer.hpp"
+#include "Encoding.hpp"
 #include "Tag.hpp"
 
 namespace nbtview {
 
-class BinaryDeserializer : public Deserializer {
+/**
+ * @brief BasicBinaryDeserializer decodes binary NBT data without recursion.
+ *
+ * Compounds and Lists which are still being read are kept on an explicit
+ * stack, so that deeply nested input cannot exhaust the native stack.  The
+ * nesting depth and total number of tags are limited by read_options;
+ * exceeding either throws LimitExceededException.
+ *
+ * The encoding is a compile-time policy (Encoding.hpp); the encoding of
+ * read_options is not consulted.  BinaryDeserializer decodes Java NBT.
+ */
+template <typename Encoding>
+class BasicBinaryDeserializer : public Deserializer {
   private:
-    BinaryReader scanner;
+    // A Compound or List which is being read
+    struct Frame {
+        //! The Compound or List read so far
+        TagValue value;
+        //! Name of the container within its parent Compound
+        std::string name;
+        //! Element type, for a List
+        TypeCode list_type;
+        //! Number of elements still to be read, for a List
+        int32_t remaining;
+    };
+
+    BasicBinaryReader<Encoding> scanner;
+    read_options options;
+    std::vector<Frame> stack;
+    std::size_t element_count = 0;
 
   public:
-    BinaryDeserializer(const unsigned char *buffer, size_t buffer_length)
-        : scanner(buffer, buffer_length) {}
-    ~BinaryDeserializer() = default;
+    BasicBinaryDeserializer(const unsigned char *buffer, size_t buffer_length,
+                            const read_options &options = {})
+        : scanner(buffer, buffer_length), options(options) {
+        stack.reserve(std::min<std::size_t>(options.max_depth, 32));
+    }
+    ~BasicBinaryDeserializer() = default;
 
     std::pair<std::string, Tag> deserialize() override;
 
   private:
-    List deserialize_list();
+    void count_elements(std::size_t n);
 
-    Compound deserialize_compound();
+    //! Reads the header of a Compound or List and pushes it on the stack.
+    void open_container(TypeCode type, std::string name);
+
+    //! Pops the completed container on top of the stack into its parent.
+    void close_container();
+
+    template <typename T> TagValue deserialize_numeric_list(int32_t length);
 
     template <typename T> std::vector<T> deserialize_array();
     std::string deserialize_string();
 
+    //! Reads the payload of a tag which is not a Compound or List.
     TagValue deserialize_typed_value(TypeCode type);
 };
 
+extern template class BasicBinaryDeserializer<Big_Endian>;
+extern template class BasicBinaryDeserializer<Little_Endian>;
+extern template class BasicBinaryDeserializer<Network_Varint>;
+
+using BinaryDeserializer = BasicBinaryDeserializer<Big_Endian>;
+
 } // namespace nbtview
 #endif // BINARYDESERIALIZER_H_
@@ -1,6 +1,6 @@
 /**
  * @file BinaryReader.hpp
- * @brief Read big-endian numeric values, arrays, and strings
+ * @brief Read numeric values, arrays, and strings in a binary NBT encoding
  * @author Michael Spitznagel
  * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
  * Software License 1.0
@@ -11,13 +11,18 @@
 #ifndef BINARYREADER_H_
 #define BINARYREADER_H_
 
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <numeric>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
+#include "Encoding.hpp"
+
 namespace nbtview {
 
 class UnexpectedEndOfInputException : public std::runtime_error {
@@ -26,47 +31,95 @@ class UnexpectedEndOfInputException : public std::runtime_error {
         : std::runtime_error("Unexpected end of input") {}
 };
 
-// BinaryReader scans and reads big-endian binary data.
-class BinaryReader {
+// BasicBinaryReader scans and reads binary data in the encoding given by
+// its policy (Encoding.hpp).  BinaryReader reads big-endian Java NBT.
+template <typename Encoding> class BasicBinaryReader {
   private:
     const unsigned char *buffer;
     size_t buffer_length;
 
   public:
-    BinaryReader(const unsigned char *buffer, size_t buffer_length)
+    BasicBinaryReader(const unsigned char *buffer, size_t buffer_length)
         : buffer(buffer), buffer_length(buffer_length) {}
 
+    //! Reads a value.  Ints and Longs, which include the lengths of Lists
+    //! and arrays, are zig-zag varints if the encoding uses varints.
     template <typename T> inline T read();
 
+    //! Reads the length of a String or of a Compound key.
+    inline size_t read_string_length();
+
     inline std::string read_string(size_t str_len);
 
+    //! Returns a view of the next str_len bytes without copying them.
+    inline std::string_view read_string_view(size_t str_len);
+
     template <typename T> inline std::vector<T> read_array(size_t vec_len);
+
+    //! Reads vec_len values into the storage pointed to by output.
+    template <typename T> inline void read_array(T *output, size_t vec_len);
+
+    //! Advances past the next n bytes.
+    inline void skip(size_t n);
+
+    //! Returns the number of bytes not yet read.
+    size_t remaining_length() const { return buffer_length; }
+
+  private:
+    //! Reads an unsigned varint of at most max_bytes bytes.
+    inline uint64_t read_varint(unsigned max_bytes);
 };
 
-template <typename T> inline T BinaryReader::read() {
-    if (sizeof(T) > buffer_length) {
-        throw UnexpectedEndOfInputException();
-    }
-    T result = 0;
-    for (size_t i = 0; i < sizeof(T); ++i) {
-        result = static_cast<T>(*(buffer++)) | (result << 8);
+using BinaryReader = BasicBinaryReader<Big_Endian>;
+
+template <typename Encoding>
+template <typename T>
+inline T BasicBinaryReader<Encoding>::read() {
+    if constexpr (detail::is_varint<Encoding, T>) {
+        using U = std::make_unsigned_t<T>;
+        auto n = static_cast<U>(read_varint(sizeof(T) == 4 ? 5 : 10));
+        // Zig-zag encoding interleaves negative and positive values.
+        return static_cast<T>((n >> 1) ^ (~(n & 1) + 1));
+    } else {
+        if (sizeof(T) > buffer_length) {
+            throw UnexpectedEndOfInputException();
+        }
+        typename detail::uint_of_size<sizeof(T)>::type bits;
+        std::memcpy(&bits, buffer, sizeof(T));
+        buffer += sizeof(T);
+        buffer_length -= sizeof(T);
+        return std::bit_cast<T>(detail::swap_bytes<Encoding>(bits));
     }
-    buffer_length -= sizeof(T);
-    return result;
 }
 
-template <> inline float BinaryReader::read<float>() {
-    static_assert(sizeof(float) == 4, "float must have 32 bits");
-    uint32_t fval = read<uint32_t>();
-    return std::bit_cast<float>(fval);
+template <typename Encoding>
+inline uint64_t BasicBinaryReader<Encoding>::read_varint(unsigned max_bytes) {
+    uint64_t result = 0;
+    for (unsigned i = 0; i < max_bytes; ++i) {
+        if (buffer_length == 0) {
+            throw UnexpectedEndOfInputException();
+        }
+        auto byte = *(buffer++);
+        --buffer_length;
+        result |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return result;
+        }
+    }
+    throw std::runtime_error("Varint is too long");
 }
 
-template <> inline double BinaryReader::read<double>() {
-    static_assert(sizeof(double) == 8, "double must have 64 bits");
-    return std::bit_cast<double>(read<uint64_t>());
+template <typename Encoding>
+inline size_t BasicBinaryReader<Encoding>::read_string_length() {
+    if constexpr (Encoding::varints) {
+        return static_cast<size_t>(read_varint(5));
+    } else {
+        return read<uint16_t>();
+    }
 }
 
-inline std::string BinaryReader::read_string(size_t str_len) {
+template <typename Encoding>
+inline std::string BasicBinaryReader<Encoding>::read_string(size_t str_len) {
     if (str_len > buffer_length) {
         throw UnexpectedEndOfInputException();
     }
@@ -76,18 +129,62 @@ inline std::string BinaryReader::read_string(size_t str_len) {
     return result;
 }
 
-template <typename T>
-inline std::vector<T> BinaryReader::read_array(size_t vec_len) {
-    if (vec_len * sizeof(T) > buffer_length) {
+template <typename Encoding>
+inline std::string_view
+BasicBinaryReader<Encoding>::read_string_view(size_t str_len) {
+    if (str_len > buffer_length) {
         throw UnexpectedEndOfInputException();
     }
-    std::vector<T> result;
-    for (size_t i = 0; i < vec_len; ++i) {
-        result.push_back(read<T>());
+    std::string_view result(reinterpret_cast<const char *>(buffer), str_len);
+    buffer += str_len;
+    buffer_length -= str_len;
+    return result;
+}
+
+template <typename Encoding>
+inline void BasicBinaryReader<Encoding>::skip(size_t n) {
+    if (n > buffer_length) {
+        throw UnexpectedEndOfInputException();
     }
+    buffer += n;
+    buffer_length -= n;
+}
+
+template <typename Encoding>
+template <typename T>
+inline std::vector<T> BasicBinaryReader<Encoding>::read_array(size_t vec_len) {
+    if (vec_len > buffer_length / detail::min_encoded_size<Encoding, T>) {
+        throw UnexpectedEndOfInputException();
+    }
+    std::vector<T> result(vec_len);
+    read_array(result.data(), vec_len);
     return result;
 }
 
+template <typename Encoding>
+template <typename T>
+inline void BasicBinaryReader<Encoding>::read_array(T *output,
+                                                    size_t vec_len) {
+    if (vec_len > buffer_length / detail::min_encoded_size<Encoding, T>) {
+        throw UnexpectedEndOfInputException();
+    }
+    if constexpr (detail::is_varint<Encoding, T>) {
+        for (size_t i = 0; i < vec_len; ++i) {
+            output[i] = read<T>();
+        }
+    } else {
+        // Copy the values, then put their bytes in native order.
+        std::memcpy(output, buffer, vec_len * sizeof(T));
+        buffer += vec_len * sizeof(T);
+        buffer_length -= vec_len * sizeof(T);
+        using U = typename detail::uint_of_size<sizeof(T)>::type;
+        for (size_t i = 0; i < vec_len; ++i) {
+            output[i] = std::bit_cast<T>(
+                detail::swap_bytes<Encoding>(std::bit_cast<U>(output[i])));
+        }
+    }
+}
+
 } // namespace nbtview
 
 #endif // BINARYREADER_H_
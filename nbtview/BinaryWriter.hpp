@@ -1,6 +1,6 @@
 /**
  * @file BinaryWriter.hpp
- * @brief Write big-endian numeric values, arrays, and strings
+ * @brief Write numeric values, arrays, and strings in a binary NBT encoding
  * @author Michael Spitznagel
  * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
  * Software License 1.0
@@ -12,34 +12,41 @@
 #define BINARYWRITER_H_
 
 #include <algorithm>
+#include <bit>
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 #include <string_view>
 #include <type_traits>
 #include <vector>
 
+#include "Encoding.hpp"
+
 namespace nbtview {
 
-// BinaryWriter encodes and writes big-endian binary data to a given output
-// stream
+// BasicBinaryWriter encodes and writes binary data to a given output stream
+// in the encoding given by its policy (Encoding.hpp).  BinaryWriter writes
+// big-endian Java NBT.
 
-class BinaryWriter {
+template <typename Encoding> class BasicBinaryWriter {
   public:
+    //! Writes a value.  Ints and Longs, which include the lengths of Lists
+    //! and arrays, are zig-zag varints if the encoding uses varints.
     template <typename T>
     typename std::enable_if<std::is_trivial_v<T> && !std::is_array_v<T>,
                             void>::type static write(T value,
                                                      std::ostream &output) {
-        char *bytePointer = reinterpret_cast<char *>(&value);
-#ifndef TARGET_BIG_ENDIAN
-        // If targeted architecture is not big endian, do byte swapping and
-        // output.
-        std::reverse(bytePointer, bytePointer + sizeof(T));
-#endif
-        output.write(bytePointer, sizeof(T));
+        char bytes[max_encoded_size];
+        output.write(bytes, encode(value, bytes));
     }
 
     static void write_string(std::string_view s, std::ostream &output) {
-        write(static_cast<uint16_t>(s.size()), output);
+        if constexpr (Encoding::varints) {
+            char bytes[max_encoded_size];
+            output.write(bytes, encode_varint(s.size(), bytes));
+        } else {
+            write(static_cast<uint16_t>(s.size()), output);
+        }
         output.write(s.data(), s.size());
     }
 
@@ -48,12 +55,62 @@ class BinaryWriter {
         type static write_vector(const std::vector<T> &values,
                                  std::ostream &output) {
         write(static_cast<int32_t>(values.size()), output);
-        for (auto val : values) {
-            write(val, output);
+        write_array(values.data(), values.size(), output);
+    }
+
+    // write_array encodes values in fixed-size blocks, so that the stream
+    // is written once per block rather than once per value.
+    template <typename T>
+    typename std::enable_if<std::is_trivial_v<T>, void>::type static
+    write_array(const T *values, size_t count, std::ostream &output) {
+        const size_t block_length = 4096;
+        char block[block_length];
+        size_t used = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (used + max_encoded_size > block_length) {
+                output.write(block, used);
+                used = 0;
+            }
+            used += encode(values[i], block + used);
         }
+        output.write(block, used);
+    }
+
+  private:
+    //! The most bytes taken by a value: a 64-bit varint
+    static constexpr size_t max_encoded_size = 10;
+
+    //! Encodes a value into bytes, returning the number of bytes used.
+    template <typename T> static size_t encode(T value, char *bytes) {
+        if constexpr (detail::is_varint<Encoding, T>) {
+            using U = std::make_unsigned_t<T>;
+            // Zig-zag encoding interleaves negative and positive values.
+            auto n = static_cast<U>(value);
+            return encode_varint(
+                (n << 1) ^ static_cast<U>(value >> (8 * sizeof(T) - 1)),
+                bytes);
+        } else {
+            using U = typename detail::uint_of_size<sizeof(T)>::type;
+            auto bits =
+                detail::swap_bytes<Encoding>(std::bit_cast<U>(value));
+            std::memcpy(bytes, &bits, sizeof(T));
+            return sizeof(T);
+        }
+    }
+
+    static size_t encode_varint(uint64_t n, char *bytes) {
+        size_t length = 0;
+        while (n >= 0x80) {
+            bytes[length++] = static_cast<char>((n & 0x7f) | 0x80);
+            n >>= 7;
+        }
+        bytes[length++] = static_cast<char>(n);
+        return length;
     }
 };
 
+using BinaryWriter = BasicBinaryWriter<Big_Endian>;
+
 } // namespace nbtview
 
 #endif // BINARYWRITER_H_
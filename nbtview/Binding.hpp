@@ -0,0 +1,406 @@
+/**
+ * @file Binding.hpp
+ * @brief Decode binary NBT data directly into C++ structs
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ *
+ * A struct is bound to NBT by specializing Schema with a constexpr tuple of
+ * fields, each pairing an NBT key with a data member:
+ *
+ * @code
+ * struct Level {
+ *     nbtview::Int xPos;
+ *     nbtview::Int zPos;
+ *     std::optional<nbtview::Long> InhabitedTime;
+ * };
+ * template <> struct nbtview::Schema<Level> {
+ *     static constexpr auto fields = std::tuple{
+ *         nbtview::field<"xPos">(&Level::xPos),
+ *         nbtview::field<"zPos">(&Level::zPos),
+ *         nbtview::field<"InhabitedTime">(&Level::InhabitedTime)};
+ * };
+ * @endcode
+ *
+ * read_binary_as<T>() then fills a T from the encoded compound without
+ * building any Tag objects.  Keys which are not in the schema are skipped,
+ * and members whose keys are absent keep their default values.
+ */
+
+#ifndef NBT_BINDING_H_
+#define NBT_BINDING_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Tag.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+//! A string literal usable as a template argument.
+template <std::size_t N> struct fixed_string {
+    char chars[N]{};
+    constexpr fixed_string(const char (&str)[N]) {
+        std::copy_n(str, N, chars);
+    }
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+//! Binds the NBT key Name to the data member pointed to by member.
+template <fixed_string Name, typename Class, typename Member> struct Field {
+    using class_type = Class;
+    using member_type = Member;
+    static constexpr std::string_view name = Name.view();
+    Member Class::*member;
+};
+
+template <fixed_string Name, typename Class, typename Member>
+constexpr Field<Name, Class, Member> field(Member Class::*member) {
+    return {member};
+}
+
+/**
+ * @brief Specialize Schema<T> with a static constexpr member `fields`, a
+ * tuple of field<"key">(&T::member) values, to make T decodable.
+ */
+template <typename T> struct Schema;
+
+template <typename T>
+concept Bound = requires { Schema<T>::fields; };
+
+namespace detail {
+
+    //! Returns the length of a payload of the given type if it is the same
+    //! for every payload, or 0 if not.
+    inline std::size_t fixed_payload_length(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+            return 1;
+        case TypeCode::Short:
+            return 2;
+        case TypeCode::Int:
+        case TypeCode::Float:
+            return 4;
+        case TypeCode::Long:
+        case TypeCode::Double:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    //! Returns the least number of bytes that encode a payload of the given
+    //! type.
+    inline std::size_t min_payload_length(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte_Array:
+        case TypeCode::Int_Array:
+        case TypeCode::Long_Array:
+            return 4;
+        case TypeCode::String:
+            return 2;
+        case TypeCode::List:
+            return 5;
+        case TypeCode::Compound:
+            return 1;
+        default:
+            return fixed_payload_length(type);
+        }
+    }
+
+} // namespace detail
+
+/**
+ * @brief Advances reader past an encoded payload of the given type.
+ *
+ * Nested Lists and Compounds are tracked on an explicit stack rather than
+ * by recursion, so deeply nested input cannot overflow the call stack.
+ */
+inline void skip_payload(BinaryReader &reader, TypeCode type) {
+    // The Lists and Compounds being skipped, innermost last: for a List,
+    // its element type and the number of elements left; for a Compound,
+    // End and -1.
+    struct Frame {
+        TypeCode element_type;
+        int32_t remaining;
+    };
+    std::vector<Frame> stack;
+    while (true) {
+        switch (type) {
+        case TypeCode::Byte:
+        case TypeCode::Short:
+        case TypeCode::Int:
+        case TypeCode::Float:
+        case TypeCode::Long:
+        case TypeCode::Double:
+            reader.skip(detail::fixed_payload_length(type));
+            break;
+        case TypeCode::Byte_Array:
+            reader.skip(static_cast<uint32_t>(reader.read<int32_t>()));
+            break;
+        case TypeCode::Int_Array:
+            reader.skip(4 * static_cast<size_t>(static_cast<uint32_t>(
+                                reader.read<int32_t>())));
+            break;
+        case TypeCode::Long_Array:
+            reader.skip(8 * static_cast<size_t>(static_cast<uint32_t>(
+                                reader.read<int32_t>())));
+            break;
+        case TypeCode::String:
+            reader.skip(reader.read<uint16_t>());
+            break;
+        case TypeCode::List: {
+            auto elt_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            if (length <= 0) {
+                break;
+            }
+            if (auto elt_length = detail::fixed_payload_length(elt_type)) {
+                reader.skip(elt_length * static_cast<size_t>(length));
+            } else {
+                stack.push_back({elt_type, length});
+            }
+            break;
+        }
+        case TypeCode::Compound:
+            stack.push_back({TypeCode::End, -1});
+            break;
+        default:
+            throw std::runtime_error("Unhandled tag type");
+        }
+
+        // Find the next payload to skip, leaving each List or Compound
+        // which has none left.
+        while (true) {
+            if (stack.empty()) {
+                return;
+            }
+            auto &top = stack.back();
+            if (top.remaining < 0) {
+                type = static_cast<TypeCode>(reader.read<int8_t>());
+                if (type == TypeCode::End) {
+                    stack.pop_back();
+                    continue;
+                }
+                reader.skip(reader.read<uint16_t>());
+                break;
+            }
+            if (top.remaining == 0) {
+                stack.pop_back();
+                continue;
+            }
+            --top.remaining;
+            type = top.element_type;
+            break;
+        }
+    }
+}
+
+namespace detail {
+
+    template <typename T> struct is_vector : std::false_type {};
+    template <typename T>
+    struct is_vector<std::vector<T>> : std::true_type {};
+
+    template <typename T> struct is_optional : std::false_type {};
+    template <typename T>
+    struct is_optional<std::optional<T>> : std::true_type {};
+
+    // The tag type which encodes a member of type T.
+    template <typename T> constexpr TypeCode bound_type() {
+        if constexpr (std::is_same_v<T, Byte> || std::is_same_v<T, bool>) {
+            return TypeCode::Byte;
+        } else if constexpr (std::is_same_v<T, Short>) {
+            return TypeCode::Short;
+        } else if constexpr (std::is_same_v<T, Int>) {
+            return TypeCode::Int;
+        } else if constexpr (std::is_same_v<T, Long>) {
+            return TypeCode::Long;
+        } else if constexpr (std::is_same_v<T, Float>) {
+            return TypeCode::Float;
+        } else if constexpr (std::is_same_v<T, Double>) {
+            return TypeCode::Double;
+        } else if constexpr (std::is_same_v<T, String>) {
+            return TypeCode::String;
+        } else if constexpr (std::is_same_v<T, Byte_Array>) {
+            return TypeCode::Byte_Array;
+        } else if constexpr (std::is_same_v<T, Int_Array>) {
+            return TypeCode::Int_Array;
+        } else if constexpr (std::is_same_v<T, Long_Array>) {
+            return TypeCode::Long_Array;
+        } else if constexpr (is_vector<T>::value) {
+            return TypeCode::List;
+        } else {
+            static_assert(Bound<T>, "member type has no NBT binding");
+            return TypeCode::Compound;
+        }
+    }
+
+    [[noreturn]] inline void type_mismatch(std::string_view key,
+                                           TypeCode found) {
+        throw std::runtime_error("Bound field '" + std::string(key) +
+                                 "' has unexpected type " +
+                                 typecode_to_string(found));
+    }
+
+    template <Bound T> void read_compound(BinaryReader &reader, T &obj);
+
+    // Reads a payload of the given type into value.  Returns false, without
+    // consuming input, if the type cannot be decoded into T.
+    template <typename T>
+    bool read_payload(BinaryReader &reader, TypeCode type, T &value) {
+        if constexpr (is_optional<T>::value) {
+            typename T::value_type inner{};
+            if (!read_payload(reader, type, inner)) {
+                return false;
+            }
+            value = std::move(inner);
+            return true;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (type != TypeCode::Byte) {
+                return false;
+            }
+            value = reader.read<Byte>() != 0;
+            return true;
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (type != bound_type<T>()) {
+                return false;
+            }
+            value = reader.read<T>();
+            return true;
+        } else if constexpr (std::is_same_v<T, String>) {
+            if (type != TypeCode::String) {
+                return false;
+            }
+            value = reader.read_string(reader.read<uint16_t>());
+            return true;
+        } else if constexpr (is_vector<T>::value) {
+            using Elt = typename T::value_type;
+            // Byte, Int and Long vectors may be encoded as arrays or lists.
+            if constexpr (bound_type<T>() != TypeCode::List) {
+                if (type == bound_type<T>()) {
+                    auto length = reader.read<int32_t>();
+                    if (length < 0) {
+                        throw std::runtime_error("Negative array length");
+                    }
+                    value = reader.read_array<Elt>(length);
+                    return true;
+                }
+            }
+            if (type != TypeCode::List) {
+                return false;
+            }
+            auto elt_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            value.clear();
+            if (length <= 0) {
+                return true;
+            }
+            if (elt_type != bound_type<Elt>()) {
+                throw std::runtime_error(
+                    std::string("Bound list has unexpected element type ") +
+                    typecode_to_string(elt_type));
+            }
+            // Check the length against the input before allocating for it.
+            if (static_cast<size_t>(length) >
+                reader.remaining_length() / min_payload_length(elt_type)) {
+                throw UnexpectedEndOfInputException();
+            }
+            value.resize(length);
+            for (auto &elt : value) {
+                read_payload(reader, elt_type, elt);
+            }
+            return true;
+        } else {
+            if (type != TypeCode::Compound) {
+                return false;
+            }
+            read_compound(reader, value);
+            return true;
+        }
+    }
+
+    // Decodes the payload for key into the matching field of obj, if any.
+    // The comparisons against each field's key are unrolled at compile time.
+    template <typename T, std::size_t... I>
+    bool read_field(BinaryReader &reader, std::string_view key,
+                    TypeCode type, T &obj, std::index_sequence<I...>) {
+        constexpr auto &fields = Schema<T>::fields;
+        bool found = false;
+        auto try_field = [&](const auto &f) {
+            if (key == f.name) {
+                if (!read_payload(reader, type, obj.*(f.member))) {
+                    type_mismatch(key, type);
+                }
+                found = true;
+            }
+            return found;
+        };
+        (try_field(std::get<I>(fields)) || ...);
+        return found;
+    }
+
+    template <Bound T> void read_compound(BinaryReader &reader, T &obj) {
+        using Fields = std::remove_cvref_t<decltype(Schema<T>::fields)>;
+        constexpr auto indices =
+            std::make_index_sequence<std::tuple_size_v<Fields>>();
+        while (true) {
+            auto type = static_cast<TypeCode>(reader.read<int8_t>());
+            if (type == TypeCode::End) {
+                return;
+            }
+            auto key = reader.read_string_view(reader.read<uint16_t>());
+            if (!read_field(reader, key, type, obj, indices)) {
+                skip_payload(reader, type);
+            }
+        }
+    }
+
+} // namespace detail
+
+/**
+ * @brief Decodes a binary encoded root compound directly into a T.
+ * @param data NBT data, optionally zlib or gzip compressed.
+ * @param data_length Length of the data in bytes.
+ *
+ * @throw std::runtime_error if the input could not be decoded, or if a bound
+ * key is present with a type that cannot be stored in its member.
+ * */
+template <Bound T> T read_binary_as(const unsigned char *data,
+                                    size_t data_length) {
+    std::vector<unsigned char> inflated_data_holder;
+    if (has_compression_header(data, data_length)) {
+        inflated_data_holder = decompress_data(data, data_length);
+        data = inflated_data_holder.data();
+        data_length = inflated_data_holder.size();
+    }
+    BinaryReader reader(data, data_length);
+    auto type = static_cast<TypeCode>(reader.read<int8_t>());
+    if (type != TypeCode::Compound) {
+        throw std::runtime_error("Root tag is not a Compound");
+    }
+    reader.skip(reader.read<uint16_t>());
+    T obj{};
+    detail::read_compound(reader, obj);
+    return obj;
+}
+
+template <Bound T>
+T read_binary_as(const std::vector<unsigned char> &bytes) {
+    return read_binary_as<T>(bytes.data(), bytes.size());
+}
+
+} // namespace nbtview
+
+#endif // NBT_BINDING_H_
@@ -0,0 +1,406 @@
+// BlockCounts.cpp
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Binding.hpp"
+#include "BlockCounts.hpp"
+#include "BlockStates.hpp"
+#include "KeyTable.hpp"
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "Scanner.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    constexpr uint16_t no_index = 0xffff;
+
+    // Counts kept by one worker thread, and buffers reused for each
+    // section
+    struct Worker {
+        std::map<Count_Key, std::vector<uint64_t>> groups;
+        // Block name of each palette index
+        std::vector<Key> palette;
+        std::vector<Long> states;
+        std::array<uint16_t, section_volume> indices;
+        std::vector<uint32_t> section_counts;
+        // Palette index of each legacy block ID, or no_index
+        std::vector<uint16_t> legacy_index =
+            std::vector<uint16_t>(section_volume, no_index);
+        std::vector<uint16_t> legacy_ids;
+        std::array<uint16_t, section_volume> block_ids;
+        // Keys of the names this worker has seen, so that each is interned
+        // in the shared table only once.  Views are of the table's own
+        // storage, which never moves.
+        std::unordered_map<std::string_view, Key> name_keys;
+        // Key of each legacy block ID seen, if any
+        std::vector<std::optional<Key>> legacy_keys =
+            std::vector<std::optional<Key>>(section_volume);
+    };
+
+    // The parts of a section which give its blocks
+    struct Section {
+        Int y = 0;
+        bool has_palette = false;
+        bool has_states = false;
+        // Legacy Blocks and Add arrays, within the chunk data
+        const unsigned char *blocks = nullptr;
+        const unsigned char *add = nullptr;
+    };
+
+    // Block_Counter reads only the block data of each section, straight
+    // from the chunk's binary NBT data; everything else is skipped.
+    class Block_Counter {
+      public:
+        Block_Counter(Count_Grouping grouping, KeyTable &names)
+            : grouping(grouping), names(names) {}
+
+        void count_chunk(Worker &worker, const unsigned char *data,
+                         size_t data_length, Int chunk_x, Int chunk_z,
+                         Count_Key region_key) const {
+            // Sections are at the root from Minecraft 1.18, and within
+            // Level before that.
+            auto location = find_tag(data, data_length, {"sections"});
+            if (!location || location->type != TypeCode::List) {
+                location = find_tag(data, data_length, {"Level", "Sections"});
+            }
+            if (!location || location->type != TypeCode::List) {
+                return;
+            }
+            Count_Key key;
+            if (grouping == Count_Grouping::region) {
+                key = region_key;
+            } else if (grouping == Count_Grouping::chunk) {
+                key = {chunk_x, chunk_z, 0};
+            }
+            BinaryReader reader(data + location->payload,
+                                data_length - location->payload);
+            auto element_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            if (length <= 0) {
+                return;
+            }
+            if (element_type != TypeCode::Compound) {
+                throw std::runtime_error("Sections is not a List of "
+                                         "Compounds");
+            }
+            for (int32_t i = 0; i < length; ++i) {
+                auto section = read_section(worker, reader);
+                if (section_indices(worker, section)) {
+                    count_section(worker, section.y, key);
+                }
+            }
+        }
+
+      private:
+        Count_Grouping grouping;
+        KeyTable &names;
+
+        Key intern(Worker &worker, std::string_view name) const {
+            auto it = worker.name_keys.find(name);
+            if (it != worker.name_keys.end()) {
+                return it->second;
+            }
+            auto key = names.intern(name);
+            worker.name_keys.emplace(names.name(key), key);
+            return key;
+        }
+
+        static const unsigned char *read_bytes(BinaryReader &reader,
+                                               std::size_t expected) {
+            auto length = reader.read<int32_t>();
+            if (length < 0 || static_cast<std::size_t>(length) != expected) {
+                throw std::runtime_error("Section has a malformed Blocks "
+                                         "or Add array");
+            }
+            auto bytes = reinterpret_cast<const unsigned char *>(
+                reader.read_string_view(expected).data());
+            return bytes;
+        }
+
+        void read_states(Worker &worker, BinaryReader &reader,
+                         Section &section) const {
+            auto length = reader.read<int32_t>();
+            if (length < 0) {
+                throw std::runtime_error("Negative array length");
+            }
+            // Check the length before sizing the buffer for it.
+            if (static_cast<std::size_t>(length) >
+                reader.remaining_length() / sizeof(Long)) {
+                throw UnexpectedEndOfInputException();
+            }
+            worker.states.resize(length);
+            reader.read_array(worker.states.data(), length);
+            section.has_states = true;
+        }
+
+        // Interns the Name of each entry of a List of block states; an
+        // entry with several Names is named by the first.
+        void read_palette(Worker &worker, BinaryReader &reader,
+                          Section &section) const {
+            auto element_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            if (length > 0 && element_type != TypeCode::Compound) {
+                throw std::runtime_error("Palette is not a List of "
+                                         "Compounds");
+            }
+            for (int32_t i = 0; i < length; ++i) {
+                bool named = false;
+                while (true) {
+                    auto type = static_cast<TypeCode>(reader.read<int8_t>());
+                    if (type == TypeCode::End) {
+                        break;
+                    }
+                    auto name =
+                        reader.read_string_view(reader.read<uint16_t>());
+                    if (name == "Name" && type == TypeCode::String &&
+                        !named) {
+                        worker.palette.push_back(intern(
+                            worker,
+                            reader.read_string_view(reader.read<uint16_t>())));
+                        named = true;
+                    } else {
+                        skip_payload(reader, type);
+                    }
+                }
+                if (!named) {
+                    throw std::runtime_error("Palette entry has no Name");
+                }
+            }
+            section.has_palette = length > 0;
+        }
+
+        Section read_section(Worker &worker, BinaryReader &reader) const {
+            Section section;
+            worker.palette.clear();
+            while (true) {
+                auto type = static_cast<TypeCode>(reader.read<int8_t>());
+                if (type == TypeCode::End) {
+                    return section;
+                }
+                auto name = reader.read_string_view(reader.read<uint16_t>());
+                if (name == "Y" && type == TypeCode::Byte) {
+                    section.y = reader.read<Byte>();
+                } else if (name == "Y" && type == TypeCode::Int) {
+                    section.y = reader.read<Int>();
+                } else if (name == "block_states" &&
+                           type == TypeCode::Compound) {
+                    // Minecraft 1.18 and later
+                    while (true) {
+                        type = static_cast<TypeCode>(reader.read<int8_t>());
+                        if (type == TypeCode::End) {
+                            break;
+                        }
+                        name = reader.read_string_view(reader.read<uint16_t>());
+                        if (name == "palette" && type == TypeCode::List) {
+                            read_palette(worker, reader, section);
+                        } else if (name == "data" &&
+                                   type == TypeCode::Long_Array) {
+                            read_states(worker, reader, section);
+                        } else {
+                            skip_payload(reader, type);
+                        }
+                    }
+                } else if (name == "Palette" && type == TypeCode::List) {
+                    // Minecraft 1.13 to 1.17
+                    read_palette(worker, reader, section);
+                } else if (name == "BlockStates" &&
+                           type == TypeCode::Long_Array) {
+                    read_states(worker, reader, section);
+                } else if (name == "Blocks" && type == TypeCode::Byte_Array) {
+                    // Before Minecraft 1.13
+                    section.blocks = read_bytes(reader, section_volume);
+                } else if (name == "Add" && type == TypeCode::Byte_Array) {
+                    section.add = read_bytes(reader, nibble_array_length);
+                } else {
+                    skip_payload(reader, type);
+                }
+            }
+        }
+
+        // Sets the palette and the palette index of each block of a
+        // section; returns false if the section has no blocks.
+        bool section_indices(Worker &worker, const Section &section) const {
+            if (section.has_palette) {
+                std::span<const Long> packed;
+                if (section.has_states) {
+                    packed = worker.states;
+                }
+                unpack_block_states(packed, worker.palette.size(),
+                                    worker.indices);
+                auto palette_size = worker.palette.size();
+                for (auto index : worker.indices) {
+                    if (index >= palette_size) {
+                        throw std::runtime_error(
+                            "Block state index exceeds palette size");
+                    }
+                }
+                return true;
+            }
+            if (section.blocks == nullptr) {
+                return false;
+            }
+            // Legacy block IDs have no palette, so make one of the IDs
+            // which occur.
+            worker.palette.clear();
+            worker.legacy_ids.clear();
+            std::span<const Byte> add;
+            if (section.add != nullptr) {
+                add = {reinterpret_cast<const Byte *>(section.add),
+                       nibble_array_length};
+            }
+            legacy_block_ids(
+                std::span<const Byte, section_volume>(
+                    reinterpret_cast<const Byte *>(section.blocks),
+                    section_volume),
+                add, worker.block_ids);
+            for (std::size_t i = 0; i < section_volume; ++i) {
+                auto &index = worker.legacy_index[worker.block_ids[i]];
+                if (index == no_index) {
+                    index = static_cast<uint16_t>(worker.legacy_ids.size());
+                    worker.legacy_ids.push_back(worker.block_ids[i]);
+                }
+                worker.indices[i] = index;
+            }
+            for (auto id : worker.legacy_ids) {
+                auto &key = worker.legacy_keys[id];
+                if (!key) {
+                    key = names.intern("legacy:" + std::to_string(id));
+                }
+                worker.palette.push_back(*key);
+                worker.legacy_index[id] = no_index;
+            }
+            return true;
+        }
+
+        void count_section(Worker &worker, Int section_y,
+                           const Count_Key &key) const {
+            auto palette_size = worker.palette.size();
+            if (grouping != Count_Grouping::y_level) {
+                worker.section_counts.assign(palette_size, 0);
+                for (auto index : worker.indices) {
+                    ++worker.section_counts[index];
+                }
+                add_counts(worker, key, worker.section_counts.data());
+                return;
+            }
+            // Blocks are ordered by Y, then Z, then X.
+            const std::size_t layer_area = section_volume / 16;
+            worker.section_counts.assign(16 * palette_size, 0);
+            for (std::size_t i = 0; i < section_volume; ++i) {
+                auto layer = i / layer_area;
+                ++worker.section_counts[layer * palette_size +
+                                        worker.indices[i]];
+            }
+            for (Int layer = 0; layer < 16; ++layer) {
+                add_counts(worker, {0, 0, section_y * 16 + layer},
+                           worker.section_counts.data() +
+                               layer * palette_size);
+            }
+        }
+
+        // Adds the counts of each palette entry to a group.
+        void add_counts(Worker &worker, const Count_Key &key,
+                        const uint32_t *counts) const {
+            auto &group = worker.groups[key];
+            for (std::size_t p = 0; p < worker.palette.size(); ++p) {
+                if (counts[p] == 0) {
+                    continue;
+                }
+                auto id = worker.palette[p].id;
+                if (id >= group.size()) {
+                    group.resize(id + 1);
+                }
+                group[id] += counts[p];
+            }
+        }
+    };
+
+} // namespace
+
+uint64_t Block_Counts::count(std::string_view name) const {
+    uint64_t total = 0;
+    for (const auto &[key, group] : groups) {
+        total += count(key, name);
+    }
+    return total;
+}
+
+uint64_t Block_Counts::count(const Count_Key &key,
+                             std::string_view name) const {
+    auto it = std::find(names.begin(), names.end(), name);
+    auto group = groups.find(key);
+    if (it == names.end() || group == groups.end()) {
+        return 0;
+    }
+    auto id = static_cast<std::size_t>(it - names.begin());
+    return id < group->second.size() ? group->second[id] : 0;
+}
+
+Block_Counts count_blocks(const std::vector<std::string> &filenames,
+                          Count_Grouping grouping, unsigned thread_count) {
+    std::vector<Count_Key> region_keys;
+    for (const auto &filename : filenames) {
+        Count_Key key;
+        if (!parse_region_filename(filename, key.x, key.z)) {
+            throw std::runtime_error("Region file name '" + filename +
+                                     "' does not have the form r.X.Z.mca");
+        }
+        region_keys.push_back(key);
+    }
+
+    // Block names are interned in a table shared by every worker, so that
+    // their counts can be merged by ID.
+    KeyTable names;
+    Block_Counter counter(grouping, names);
+    std::vector<Worker> workers(
+        detail::chunk_worker_count(thread_count, filenames.size()));
+    auto count_chunk = [&](std::size_t file, int i, const unsigned char *data,
+                           size_t data_length, unsigned worker) {
+        const auto &region_key = region_keys[file];
+        counter.count_chunk(
+            workers[worker], data, data_length,
+            region_key.x * Region::region_width + i % Region::region_width,
+            region_key.z * Region::region_width + i / Region::region_width,
+            region_key);
+    };
+    detail::for_each_chunk(filenames, thread_count, count_chunk);
+
+    Block_Counts result;
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        result.names.emplace_back(names.name(Key{id}));
+    }
+    for (auto &worker : workers) {
+        for (auto &[key, counts] : worker.groups) {
+            auto &group = result.groups[key];
+            if (group.size() < counts.size()) {
+                group.resize(counts.size());
+            }
+            for (std::size_t id = 0; id < counts.size(); ++id) {
+                group[id] += counts[id];
+            }
+        }
+    }
+    return result;
+}
+
+Block_Counts count_world_blocks(const std::string &directory,
+                                Count_Grouping grouping,
+                                unsigned thread_count) {
+    return count_blocks(region_files(directory), grouping, thread_count);
+}
+
+} // namespace nbtview
@@ -0,0 +1,97 @@
+/**
+ * @file BlockCounts.hpp
+ * @brief Count the blocks of each kind in regions and worlds
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_BLOCKCOUNTS_H_
+#define NBT_BLOCKCOUNTS_H_
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! How block counts are grouped
+enum class Count_Grouping {
+    //! A single group for everything counted
+    world,
+    //! A group for each region, keyed by region coordinates
+    region,
+    //! A group for each chunk, keyed by chunk coordinates
+    chunk,
+    //! A group for each block Y coordinate
+    y_level,
+};
+
+/**
+ * @brief Identifies a group of block counts.
+ *
+ * Region and chunk groups set x and z; Y-level groups set y.  The other
+ * coordinates are zero.
+ */
+struct Count_Key {
+    Int x = 0;
+    Int z = 0;
+    Int y = 0;
+
+    auto operator<=>(const Count_Key &) const = default;
+};
+
+/**
+ * @brief Block_Counts holds the number of blocks of each name in each
+ * group.
+ *
+ * Blocks are named as in their section's palette, such as
+ * "minecraft:diamond_ore"; block properties are ignored.  Sections from
+ * before Minecraft 1.13 have no palette, and their blocks are named by
+ * numeric ID, as "legacy:56".
+ */
+struct Block_Counts {
+    //! Name of each block ID
+    std::vector<std::string> names;
+    //! Counts of each group, indexed by block ID; IDs past the end of a
+    //! group's vector have no blocks in that group
+    std::map<Count_Key, std::vector<uint64_t>> groups;
+
+    //! Returns the number of blocks named name in all groups.
+    uint64_t count(std::string_view name) const;
+    //! Returns the number of blocks named name in one group.
+    uint64_t count(const Count_Key &key, std::string_view name) const;
+};
+
+/**
+ * @brief Counts the blocks in the chunks of some region files.
+ *
+ * Chunks are read, inflated and counted on several threads, each of which
+ * keeps its own counts; these are merged at the end.  Only the sections of
+ * each chunk are decoded.
+ *
+ * @param filenames region files named r.X.Z.mca, where X and Z give their
+ * region coordinates
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * @throw std::runtime_error if a chunk cannot be read or decoded
+ */
+Block_Counts count_blocks(const std::vector<std::string> &filenames,
+                          Count_Grouping grouping,
+                          unsigned thread_count = 0);
+
+//! Counts the blocks in every region file r.X.Z.mca in a directory, such
+//! as a world's region directory.
+Block_Counts count_world_blocks(const std::string &directory,
+                                Count_Grouping grouping,
+                                unsigned thread_count = 0);
+
+} // namespace nbtview
+
+#endif // NBT_BLOCKCOUNTS_H_
@@ -0,0 +1,402 @@
+// BlockStates.cpp
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "BlockStates.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    constexpr unsigned max_bits = 16;
+
+    template <unsigned Bits>
+    constexpr uint64_t entry_mask = (uint64_t(1) << Bits) - 1;
+
+    // Extracts entry I of a group of 64 spanning entries held in Bits words.
+    template <unsigned Bits, std::size_t I>
+    inline uint16_t extract_spanning(const uint64_t *words) {
+        constexpr std::size_t bit = I * Bits;
+        constexpr std::size_t word = bit / 64;
+        constexpr unsigned offset = bit % 64;
+        if constexpr (offset + Bits <= 64) {
+            return static_cast<uint16_t>((words[word] >> offset) &
+                                         entry_mask<Bits>);
+        } else {
+            uint64_t value =
+                (words[word] >> offset) | (words[word + 1] << (64 - offset));
+            return static_cast<uint16_t>(value & entry_mask<Bits>);
+        }
+    }
+
+    // Adds entry I of a group of 64 spanning entries to its Bits words.
+    template <unsigned Bits, std::size_t I>
+    inline void insert_spanning(uint16_t entry, uint64_t *words) {
+        constexpr std::size_t bit = I * Bits;
+        constexpr std::size_t word = bit / 64;
+        constexpr unsigned offset = bit % 64;
+        uint64_t value = entry & entry_mask<Bits>;
+        words[word] |= value << offset;
+        if constexpr (offset + Bits > 64) {
+            words[word + 1] |= value >> (64 - offset);
+        }
+    }
+
+    // Unpacks entries one at a time; used for a final partial group.
+    void unpack_spanning_tail(const uint64_t *words, std::size_t count,
+                              unsigned bits, uint16_t *out) {
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::size_t bit = i * bits;
+            std::size_t word = bit / 64;
+            unsigned offset = bit % 64;
+            uint64_t value = words[word] >> offset;
+            if (offset + bits > 64) {
+                value |= words[word + 1] << (64 - offset);
+            }
+            out[i] = static_cast<uint16_t>(value & mask);
+        }
+    }
+
+    // Any 64 consecutive spanning entries occupy exactly Bits words, so the
+    // position of each entry within such a group is a constant.
+    template <unsigned Bits>
+    void unpack_spanning(const uint64_t *words, std::size_t count,
+                         uint16_t *out) {
+        std::size_t groups = count / 64;
+        for (std::size_t g = 0; g < groups; ++g) {
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ((out[I] = extract_spanning<Bits, I>(words)), ...);
+            }(std::make_index_sequence<64>());
+            words += Bits;
+            out += 64;
+        }
+        unpack_spanning_tail(words, count % 64, Bits, out);
+    }
+
+    template <unsigned Bits>
+    void unpack_aligned(const uint64_t *words, std::size_t count,
+                        uint16_t *out) {
+        constexpr unsigned per_word = 64 / Bits;
+        std::size_t full_words = count / per_word;
+        for (std::size_t w = 0; w < full_words; ++w) {
+            uint64_t word = words[w];
+            [&]<std::size_t... K>(std::index_sequence<K...>) {
+                ((out[K] = static_cast<uint16_t>((word >> (K * Bits)) &
+                                                 entry_mask<Bits>)),
+                 ...);
+            }(std::make_index_sequence<per_word>());
+            out += per_word;
+        }
+        std::size_t rest = count % per_word;
+        for (std::size_t k = 0; k < rest; ++k) {
+            out[k] = static_cast<uint16_t>((words[full_words] >> (k * Bits)) &
+                                           entry_mask<Bits>);
+        }
+    }
+
+    template <unsigned Bits>
+    void pack_spanning(const uint16_t *in, std::size_t count,
+                       uint64_t *words) {
+        std::size_t groups = count / 64;
+        for (std::size_t g = 0; g < groups; ++g) {
+            uint64_t group[Bits] = {};
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                (insert_spanning<Bits, I>(in[I], group), ...);
+            }(std::make_index_sequence<64>());
+            std::copy(group, group + Bits, words);
+            in += 64;
+            words += Bits;
+        }
+        std::size_t rest = count % 64;
+        std::fill(words, words + (rest * Bits + 63) / 64, 0);
+        for (std::size_t i = 0; i < rest; ++i) {
+            std::size_t bit = i * Bits;
+            unsigned offset = bit % 64;
+            uint64_t value = in[i] & entry_mask<Bits>;
+            words[bit / 64] |= value << offset;
+            if (offset + Bits > 64) {
+                words[bit / 64 + 1] |= value >> (64 - offset);
+            }
+        }
+    }
+
+    template <unsigned Bits>
+    void pack_aligned(const uint16_t *in, std::size_t count, uint64_t *words) {
+        constexpr unsigned per_word = 64 / Bits;
+        std::size_t full_words = count / per_word;
+        for (std::size_t w = 0; w < full_words; ++w) {
+            words[w] = [&]<std::size_t... K>(std::index_sequence<K...>) {
+                return ((uint64_t(in[K] & entry_mask<Bits>) << (K * Bits)) |
+                        ...);
+            }(std::make_index_sequence<per_word>());
+            in += per_word;
+        }
+        std::size_t rest = count % per_word;
+        if (rest != 0) {
+            uint64_t word = 0;
+            for (std::size_t k = 0; k < rest; ++k) {
+                word |= uint64_t(in[k] & entry_mask<Bits>) << (k * Bits);
+            }
+            words[full_words] = word;
+        }
+    }
+
+    using Kernel = void (*)(const uint64_t *, std::size_t, uint16_t *);
+    using Pack_Kernel = void (*)(const uint16_t *, std::size_t, uint64_t *);
+
+    template <std::size_t... B>
+    constexpr std::array<Kernel, sizeof...(B)>
+    spanning_kernels(std::index_sequence<B...>) {
+        return {&unpack_spanning<B + 1>...};
+    }
+
+    template <std::size_t... B>
+    constexpr std::array<Kernel, sizeof...(B)>
+    aligned_kernels(std::index_sequence<B...>) {
+        return {&unpack_aligned<B + 1>...};
+    }
+
+    template <std::size_t... B>
+    constexpr std::array<Pack_Kernel, sizeof...(B)>
+    spanning_pack_kernels(std::index_sequence<B...>) {
+        return {&pack_spanning<B + 1>...};
+    }
+
+    template <std::size_t... B>
+    constexpr std::array<Pack_Kernel, sizeof...(B)>
+    aligned_pack_kernels(std::index_sequence<B...>) {
+        return {&pack_aligned<B + 1>...};
+    }
+
+    // Kernels indexed by bits - 1
+    constexpr auto spanning_table =
+        spanning_kernels(std::make_index_sequence<max_bits>());
+    constexpr auto aligned_table =
+        aligned_kernels(std::make_index_sequence<max_bits>());
+    constexpr auto spanning_pack_table =
+        spanning_pack_kernels(std::make_index_sequence<max_bits>());
+    constexpr auto aligned_pack_table =
+        aligned_pack_kernels(std::make_index_sequence<max_bits>());
+
+    // Nibble arrays are converted in blocks of this many bytes; the inner
+    // loops then have constant trip counts.
+    constexpr std::size_t nibble_block = 64;
+
+    template <std::size_t N>
+    void unpack_nibble_block(const uint8_t *in, uint8_t *out) {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[2 * i] = in[i] & 0xf;
+            out[2 * i + 1] = in[i] >> 4;
+        }
+    }
+
+    template <std::size_t N>
+    void pack_nibble_block(const uint8_t *in, uint8_t *out) {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = (in[2 * i] & 0xf) | (in[2 * i + 1] << 4);
+        }
+    }
+
+    void check_bits(unsigned bits) {
+        if (bits == 0 || bits > max_bits) {
+            throw std::runtime_error(
+                "Packed indices must be 1 to 16 bits wide");
+        }
+    }
+
+} // namespace
+
+std::size_t packed_length(std::size_t count, unsigned bits,
+                          Bit_Packing packing) {
+    if (packing == Bit_Packing::spanning) {
+        return (count * bits + 63) / 64;
+    }
+    std::size_t per_word = 64 / bits;
+    return (count + per_word - 1) / per_word;
+}
+
+unsigned palette_bits(std::size_t palette_size, unsigned min_bits) {
+    unsigned bits = palette_size > 1 ? std::bit_width(palette_size - 1) : 0;
+    return std::max(bits, min_bits);
+}
+
+Bit_Packing detect_packing(std::size_t long_count, std::size_t count,
+                           unsigned bits) {
+    if (long_count == packed_length(count, bits, Bit_Packing::aligned)) {
+        return Bit_Packing::aligned;
+    }
+    if (long_count == packed_length(count, bits, Bit_Packing::spanning)) {
+        return Bit_Packing::spanning;
+    }
+    throw std::runtime_error(std::to_string(long_count) +
+                             " Longs do not hold " + std::to_string(count) +
+                             " entries of " + std::to_string(bits) + " bits");
+}
+
+void unpack_indices(std::span<const Long> packed, unsigned bits,
+                    Bit_Packing packing, std::span<uint16_t> out) {
+    check_bits(bits);
+    if (packed.size() < packed_length(out.size(), bits, packing)) {
+        throw std::runtime_error("Packed index array is too short");
+    }
+    auto words = reinterpret_cast<const uint64_t *>(packed.data());
+    // The layouts coincide when bits divides 64.
+    bool spanning = packing == Bit_Packing::spanning && 64 % bits != 0;
+    auto &table = spanning ? spanning_table : aligned_table;
+    table[bits - 1](words, out.size(), out.data());
+}
+
+void unpack_indices(std::span<const Long> packed, unsigned bits,
+                    std::span<uint16_t> out) {
+    check_bits(bits);
+    unpack_indices(packed, bits,
+                   detect_packing(packed.size(), out.size(), bits), out);
+}
+
+void unpack_block_states(std::span<const Long> block_states,
+                         std::size_t palette_size,
+                         std::span<uint16_t, section_volume> out) {
+    // A section of a single block state has no data array (1.18 and later).
+    if (palette_size <= 1 && block_states.empty()) {
+        std::fill(out.begin(), out.end(), 0);
+        return;
+    }
+    unpack_indices(block_states, palette_bits(palette_size), out);
+}
+
+void pack_indices(std::span<const uint16_t> indices, unsigned bits,
+                  Bit_Packing packing, std::span<Long> out) {
+    check_bits(bits);
+    if (out.size() < packed_length(indices.size(), bits, packing)) {
+        throw std::runtime_error("Packed index array is too short");
+    }
+    auto words = reinterpret_cast<uint64_t *>(out.data());
+    bool spanning = packing == Bit_Packing::spanning && 64 % bits != 0;
+    auto &table = spanning ? spanning_pack_table : aligned_pack_table;
+    table[bits - 1](indices.data(), indices.size(), words);
+}
+
+void unpack_nibbles(std::span<const Byte> nibbles, std::span<uint8_t> out) {
+    if (out.size() < 2 * nibbles.size()) {
+        throw std::runtime_error("Unpacked nibble array is too short");
+    }
+    auto in = reinterpret_cast<const uint8_t *>(nibbles.data());
+    std::size_t i = 0;
+    for (; i + nibble_block <= nibbles.size(); i += nibble_block) {
+        unpack_nibble_block<nibble_block>(in + i, out.data() + 2 * i);
+    }
+    for (; i < nibbles.size(); ++i) {
+        unpack_nibble_block<1>(in + i, out.data() + 2 * i);
+    }
+}
+
+void pack_nibbles(std::span<const uint8_t> values, std::span<Byte> out) {
+    if (values.size() % 2 != 0) {
+        throw std::runtime_error("Nibble values must come in pairs");
+    }
+    auto length = values.size() / 2;
+    if (out.size() < length) {
+        throw std::runtime_error("Nibble array is too short");
+    }
+    auto bytes = reinterpret_cast<uint8_t *>(out.data());
+    std::size_t i = 0;
+    for (; i + nibble_block <= length; i += nibble_block) {
+        pack_nibble_block<nibble_block>(values.data() + 2 * i, bytes + i);
+    }
+    for (; i < length; ++i) {
+        pack_nibble_block<1>(values.data() + 2 * i, bytes + i);
+    }
+}
+
+void legacy_block_ids(std::span<const Byte, section_volume> blocks,
+                      std::span<const Byte> add,
+                      std::span<uint16_t, section_volume> out) {
+    auto low = reinterpret_cast<const uint8_t *>(blocks.data());
+    if (add.empty()) {
+        for (std::size_t i = 0; i < section_volume; ++i) {
+            out[i] = low[i];
+        }
+        return;
+    }
+    if (add.size() != nibble_array_length) {
+        throw std::runtime_error("Add array must hold " +
+                                 std::to_string(nibble_array_length) +
+                                 " bytes");
+    }
+    std::array<uint8_t, section_volume> high;
+    unpack_nibbles(add, high);
+    for (std::size_t i = 0; i < section_volume; ++i) {
+        out[i] = static_cast<uint16_t>(low[i] | high[i] << 8);
+    }
+}
+
+Block_State_Packer::Block_State_Packer() : table(table_size) {
+    palette_values.reserve(section_volume);
+    packed.reserve(packed_length(section_volume, max_bits,
+                                 Bit_Packing::aligned));
+}
+
+void Block_State_Packer::pack(
+    std::span<const uint32_t, section_volume> values, Bit_Packing packing,
+    unsigned min_bits) {
+    build_palette(values);
+    pack_palette_indices(packing, min_bits);
+}
+
+void Block_State_Packer::pack(
+    std::span<const uint16_t, section_volume> values, Bit_Packing packing,
+    unsigned min_bits) {
+    build_palette(values);
+    pack_palette_indices(packing, min_bits);
+}
+
+template <typename T>
+void Block_State_Packer::build_palette(
+    std::span<const T, section_volume> values) {
+    if (++generation == 0) {
+        // The stamps have wrapped around; forget every slot.
+        std::fill(table.begin(), table.end(), Slot{});
+        generation = 1;
+    }
+    palette_values.clear();
+    // Neighbouring blocks are often the same, so remember the last lookup.
+    // The initial last_value cannot match the first value.
+    uint32_t last_value = ~static_cast<uint32_t>(values[0]);
+    uint16_t last_index = 0;
+    for (std::size_t i = 0; i < section_volume; ++i) {
+        uint32_t value = values[i];
+        if (value != last_value) {
+            // Fibonacci hashing, then linear probing
+            std::size_t slot = (value * 0x9e3779b1u) >> (32 - table_bits);
+            while (table[slot].stamp == generation &&
+                   table[slot].value != value) {
+                slot = (slot + 1) & (table_size - 1);
+            }
+            if (table[slot].stamp != generation) {
+                table[slot] = {generation, value,
+                               static_cast<uint16_t>(palette_values.size())};
+                palette_values.push_back(value);
+            }
+            last_value = value;
+            last_index = table[slot].index;
+        }
+        palette_indices[i] = last_index;
+    }
+}
+
+void Block_State_Packer::pack_palette_indices(Bit_Packing packing,
+                                              unsigned min_bits) {
+    index_bits = std::max(palette_bits(palette_values.size(), min_bits), 1u);
+    packed.resize(packed_length(section_volume, index_bits, packing));
+    pack_indices(palette_indices, index_bits, packing, packed);
+}
+
+} // namespace nbtview
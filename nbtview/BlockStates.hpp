@@ -0,0 +1,218 @@
+/**
+ * @file BlockStates.hpp
+ * @brief Decode the bit-packed palette indices and nibble arrays of chunk
+ * sections
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_BLOCKSTATES_H_
+#define NBT_BLOCKSTATES_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! Number of blocks in a chunk section
+inline constexpr std::size_t section_volume = 4096;
+
+/**
+ * @brief Layout of an array of fixed-width indices packed into Longs, such
+ * as BlockStates or block_states.data.
+ *
+ * Index i always starts in the low-order bits: entries fill each Long from
+ * its least significant bit upwards.
+ */
+enum class Bit_Packing {
+    //! Entries are packed end to end, so an entry may continue from one
+    //! Long into the next (Minecraft 1.13 to 1.15).
+    spanning,
+    //! Each Long holds floor(64 / bits) entries and any remaining high bits
+    //! are unused (Minecraft 1.16 and later).
+    aligned,
+};
+
+//! Returns the number of Longs which hold count entries of the given width.
+std::size_t packed_length(std::size_t count, unsigned bits,
+                          Bit_Packing packing);
+
+//! Returns the width of an index into a palette with palette_size entries;
+//! Minecraft stores block states with at least 4 bits.
+unsigned palette_bits(std::size_t palette_size, unsigned min_bits = 4);
+
+/**
+ * @brief Determines the layout of packed indices from the array length.
+ *
+ * When bits divides 64 both layouts are identical, and aligned is returned.
+ * @throw std::runtime_error if the length fits neither layout
+ */
+Bit_Packing detect_packing(std::size_t long_count, std::size_t count,
+                           unsigned bits);
+
+/**
+ * @brief Unpacks out.size() indices of the given width.
+ *
+ * Each width from 1 to 16 bits has its own kernel in which every shift and
+ * mask is a compile-time constant, so that the compiler can unroll and
+ * vectorize it.
+ *
+ * @throw std::runtime_error if bits is not in [1, 16] or packed is too short
+ */
+void unpack_indices(std::span<const Long> packed, unsigned bits,
+                    Bit_Packing packing, std::span<uint16_t> out);
+
+//! Unpacks out.size() indices, inferring the layout from packed.size().
+void unpack_indices(std::span<const Long> packed, unsigned bits,
+                    std::span<uint16_t> out);
+
+//! Unpacks the 4096 palette indices of a section, whose width follows from
+//! the size of its palette and whose layout follows from the array length.
+//! An empty array with a palette of one entry unpacks to all zeros.
+void unpack_block_states(std::span<const Long> block_states,
+                         std::size_t palette_size,
+                         std::span<uint16_t, section_volume> out);
+
+/**
+ * @brief Packs indices of the given width into out, the inverse of
+ * unpack_indices().
+ *
+ * out must hold at least packed_length(indices.size(), bits, packing)
+ * Longs; unused bits of those Longs are cleared.
+ *
+ * @throw std::runtime_error if bits is not in [1, 16] or out is too short
+ */
+void pack_indices(std::span<const uint16_t> indices, unsigned bits,
+                  Bit_Packing packing, std::span<Long> out);
+
+//! Number of bytes in a section's nibble array, such as SkyLight,
+//! BlockLight, or the legacy Data and Add arrays
+inline constexpr std::size_t nibble_array_length = section_volume / 2;
+
+//! Returns the index within a section of the block at local coordinates
+//! x, y and z, each in [0, 16).  Blocks are ordered by Y, then Z, then X.
+constexpr std::size_t section_index(unsigned x, unsigned y, unsigned z) {
+    return (std::size_t(y) * 16 + z) * 16 + x;
+}
+
+//! Returns entry index of a nibble array.  Each byte holds two entries,
+//! the first in its low-order nibble.
+inline uint8_t get_nibble(std::span<const Byte> nibbles, std::size_t index) {
+    return (static_cast<uint8_t>(nibbles[index / 2]) >> (index % 2 * 4)) &
+           0xf;
+}
+
+//! Sets entry index of a nibble array to the low-order nibble of value.
+inline void set_nibble(std::span<Byte> nibbles, std::size_t index,
+                       uint8_t value) {
+    auto shift = index % 2 * 4;
+    auto byte = static_cast<uint8_t>(nibbles[index / 2]);
+    byte = (byte & ~(0xf << shift)) | ((value & 0xf) << shift);
+    nibbles[index / 2] = static_cast<Byte>(byte);
+}
+
+/**
+ * @brief Unpacks each entry of a nibble array into a byte of out, which
+ * must hold 2 * nibbles.size() bytes.
+ *
+ * Bytes are converted in blocks of constant length, so that the compiler
+ * can vectorize the conversion.
+ *
+ * @throw std::runtime_error if out is too short
+ */
+void unpack_nibbles(std::span<const Byte> nibbles, std::span<uint8_t> out);
+
+/**
+ * @brief Packs pairs of values into the bytes of a nibble array, the
+ * inverse of unpack_nibbles(); only the low-order nibble of each value is
+ * kept.
+ *
+ * @throw std::runtime_error if values has an odd size or out is too short
+ */
+void pack_nibbles(std::span<const uint8_t> values, std::span<Byte> out);
+
+/**
+ * @brief Combines a legacy section's Blocks array with its optional Add
+ * array, which holds the high nibble of each block ID, into 12-bit IDs.
+ *
+ * @param add an Add array of nibble_array_length bytes, or empty
+ * @throw std::runtime_error if add is neither empty nor full length
+ */
+void legacy_block_ids(std::span<const Byte, section_volume> blocks,
+                      std::span<const Byte> add,
+                      std::span<uint16_t, section_volume> out);
+
+/**
+ * @brief Block_State_Packer builds a compact palette for a section's 4096
+ * values and packs their palette indices at the fewest bits per entry.
+ *
+ * The values may be block IDs, or indices into an existing palette which
+ * is to be compacted.  The new palette lists each distinct value once, in
+ * order of first appearance, so that palette()[index] is the value of each
+ * block whose packed index is index.
+ *
+ * The packer's buffers are reused by each call to pack(), which therefore
+ * does not allocate once they have grown to their working size.
+ */
+class Block_State_Packer {
+  public:
+    Block_State_Packer();
+
+    //! Rebuilds the palette for values and packs their indices.
+    //! @param min_bits the least width to use; 4 for block states
+    void pack(std::span<const uint32_t, section_volume> values,
+              Bit_Packing packing = Bit_Packing::aligned,
+              unsigned min_bits = 4);
+    void pack(std::span<const uint16_t, section_volume> values,
+              Bit_Packing packing = Bit_Packing::aligned,
+              unsigned min_bits = 4);
+
+    //! Distinct values, in order of first appearance
+    const std::vector<uint32_t> &palette() const { return palette_values; }
+    //! Palette index of each block
+    std::span<const uint16_t, section_volume> indices() const {
+        return palette_indices;
+    }
+    //! Packed palette indices, suitable for BlockStates or
+    //! block_states.data
+    const Long_Array &data() const { return packed; }
+    //! Bits per packed index
+    unsigned bits() const { return index_bits; }
+
+  private:
+    // Open-addressed table mapping values to palette indices, with room
+    // for every value in a section at a load factor of at most one half.
+    // A slot is in use only if its stamp equals the current generation, so
+    // the table never needs clearing.
+    static const unsigned table_bits = 13;
+    static const std::size_t table_size = std::size_t(1) << table_bits;
+    static_assert(table_size >= 2 * section_volume);
+    struct Slot {
+        uint32_t stamp;
+        uint32_t value;
+        uint16_t index;
+    };
+    std::vector<Slot> table;
+    uint32_t generation = 0;
+
+    std::vector<uint32_t> palette_values;
+    std::array<uint16_t, section_volume> palette_indices;
+    Long_Array packed;
+    unsigned index_bits = 0;
+
+    template <typename T>
+    void build_palette(std::span<const T, section_volume> values);
+    void pack_palette_indices(Bit_Packing packing, unsigned min_bits);
+};
+
+} // namespace nbtview
+
+#endif // NBT_BLOCKSTATES_H_
@@ -0,0 +1,393 @@
+// Columns.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "BinaryWriter.hpp"
+#include "Binding.hpp"
+#include "Columns.hpp"
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // The paths to extract, as a tree of names.  A node with a column
+    // index names a field; a node with children names a Compound.
+    struct Path_Node {
+        std::string name;
+        int column = -1;
+        std::vector<Path_Node> children;
+
+        const Path_Node *find(std::string_view child_name) const {
+            for (const auto &child : children) {
+                if (child.name == child_name) {
+                    return &child;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    Path_Node build_path_tree(const std::vector<std::string> &paths) {
+        Path_Node root;
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            Path_Node *node = &root;
+            std::string_view rest = paths[i];
+            while (true) {
+                auto dot = rest.find('.');
+                auto name = rest.substr(0, dot);
+                if (name.empty()) {
+                    throw std::runtime_error("Invalid column path '" +
+                                             paths[i] + "'");
+                }
+                auto child = std::find_if(
+                    node->children.begin(), node->children.end(),
+                    [&](const Path_Node &n) { return n.name == name; });
+                if (child == node->children.end()) {
+                    node->children.push_back({std::string(name), -1, {}});
+                    child = node->children.end() - 1;
+                }
+                node = &*child;
+                if (dot == std::string_view::npos) {
+                    break;
+                }
+                rest = rest.substr(dot + 1);
+            }
+            if (node->column >= 0) {
+                throw std::runtime_error("Duplicate column path '" +
+                                         paths[i] + "'");
+            }
+            node->column = static_cast<int>(i);
+        }
+        return root;
+    }
+
+    bool is_field_type(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+        case TypeCode::Short:
+        case TypeCode::Int:
+        case TypeCode::Long:
+        case TypeCode::Float:
+        case TypeCode::Double:
+        case TypeCode::String:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    Tag read_field(BinaryReader &reader, TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+            return reader.read<Byte>();
+        case TypeCode::Short:
+            return reader.read<Short>();
+        case TypeCode::Int:
+            return reader.read<Int>();
+        case TypeCode::Long:
+            return reader.read<Long>();
+        case TypeCode::Float:
+            return reader.read<Float>();
+        case TypeCode::Double:
+            return reader.read<Double>();
+        default:
+            return reader.read_string(reader.read<uint16_t>());
+        }
+    }
+
+    // Decodes the fields of one chunk into cells, descending only into
+    // the Compounds on a path.  Returns true once every field is found,
+    // so that the rest of the chunk need not be read.
+    bool project_compound(BinaryReader &reader, const Path_Node &node,
+                          Tag *cells, std::size_t &remaining) {
+        while (true) {
+            auto type = static_cast<TypeCode>(reader.read<int8_t>());
+            if (type == TypeCode::End) {
+                return false;
+            }
+            auto name = reader.read_string_view(reader.read<uint16_t>());
+            auto child = node.find(name);
+            if (child == nullptr) {
+                skip_payload(reader, type);
+            } else if (child->column >= 0 && is_field_type(type)) {
+                auto &cell = cells[child->column];
+                if (cell.is<None>()) {
+                    --remaining;
+                }
+                cell = read_field(reader, type);
+                if (remaining == 0) {
+                    return true;
+                }
+            } else if (!child->children.empty() &&
+                       type == TypeCode::Compound) {
+                if (project_compound(reader, *child, cells, remaining)) {
+                    return true;
+                }
+            } else {
+                skip_payload(reader, type);
+            }
+        }
+    }
+
+    void project_chunk(const unsigned char *data, size_t data_length,
+                       const Path_Node &root, std::size_t column_count,
+                       Tag *cells) {
+        BinaryReader reader(data, data_length);
+        if (static_cast<TypeCode>(reader.read<int8_t>()) !=
+            TypeCode::Compound) {
+            throw std::runtime_error("Chunk root is not a Compound");
+        }
+        reader.skip(reader.read<uint16_t>());
+        project_compound(reader, root, cells, column_count);
+    }
+
+    // Rows of cells, one per chunk, with a cell for each column.
+    struct Row_Cells {
+        std::vector<Int> chunk_x;
+        std::vector<Int> chunk_z;
+        std::vector<Tag> cells;
+    };
+
+    void extract_region(const std::string &filename, const Path_Node &root,
+                        std::size_t column_count, unsigned thread_count,
+                        Row_Cells &rows) {
+        int region_x, region_z;
+        if (!parse_region_filename(filename, region_x, region_z)) {
+            throw std::runtime_error("Region file name '" + filename +
+                                     "' does not have the form r.X.Z.mca");
+        }
+
+        // Reading is sequential; inflating and decoding are parallel.
+        Region_File region(filename);
+        std::vector<std::vector<unsigned char>> chunks;
+        auto first_row = rows.chunk_x.size();
+        for (int i = 0; i < Region::chunk_count; ++i) {
+            if (region.chunk_length(i) == 0) {
+                continue;
+            }
+            chunks.push_back(region.get_chunk_data(i));
+            rows.chunk_x.push_back(region_x * Region::region_width +
+                                   i % Region::region_width);
+            rows.chunk_z.push_back(region_z * Region::region_width +
+                                   i / Region::region_width);
+        }
+        rows.cells.resize(rows.chunk_x.size() * column_count);
+
+        auto project = [&](std::size_t j, unsigned) {
+            auto &data = chunks[j];
+            if (has_compression_header(data.data(), data.size())) {
+                data = decompress_data(data.data(), data.size());
+            }
+            project_chunk(data.data(), data.size(), root, column_count,
+                          rows.cells.data() + (first_row + j) * column_count);
+            std::vector<unsigned char>().swap(data);
+        };
+        detail::parallel_for(chunks.size(), thread_count, project);
+    }
+
+    template <typename T>
+    void fill_column(Column &column, std::vector<Tag> &cells,
+                     std::size_t index, std::size_t column_count,
+                     std::size_t row_count) {
+        std::vector<T> values(row_count);
+        for (std::size_t row = 0; row < row_count; ++row) {
+            auto &cell = cells[row * column_count + index];
+            if (cell.is<T>()) {
+                values[row] = std::move(cell.get<T>());
+                column.present[row] = true;
+            }
+        }
+        column.values = std::move(values);
+    }
+
+    Column_Table make_table(const std::vector<std::string> &paths,
+                            Row_Cells &rows) {
+        Column_Table table;
+        auto row_count = rows.chunk_x.size();
+        auto column_count = paths.size();
+        table.chunk_x = std::move(rows.chunk_x);
+        table.chunk_z = std::move(rows.chunk_z);
+        table.columns.resize(column_count);
+        for (std::size_t c = 0; c < column_count; ++c) {
+            auto &column = table.columns[c];
+            column.path = paths[c];
+            column.present.assign(row_count, false);
+            for (std::size_t row = 0; row < row_count; ++row) {
+                auto &cell = rows.cells[row * column_count + c];
+                if (!cell.is<None>()) {
+                    column.type = cell.get_id();
+                    break;
+                }
+            }
+            switch (column.type) {
+            case TypeCode::Short:
+                fill_column<Short>(column, rows.cells, c, column_count,
+                                   row_count);
+                break;
+            case TypeCode::Int:
+                fill_column<Int>(column, rows.cells, c, column_count,
+                                 row_count);
+                break;
+            case TypeCode::Long:
+                fill_column<Long>(column, rows.cells, c, column_count,
+                                  row_count);
+                break;
+            case TypeCode::Float:
+                fill_column<Float>(column, rows.cells, c, column_count,
+                                   row_count);
+                break;
+            case TypeCode::Double:
+                fill_column<Double>(column, rows.cells, c, column_count,
+                                    row_count);
+                break;
+            case TypeCode::String:
+                fill_column<String>(column, rows.cells, c, column_count,
+                                    row_count);
+                break;
+            default:
+                // Byte, or a column with no values
+                fill_column<Byte>(column, rows.cells, c, column_count,
+                                  row_count);
+                break;
+            }
+        }
+        return table;
+    }
+
+    const char columns_magic[4] = {'N', 'B', 'T', 'C'};
+
+    template <typename T>
+    void write_values(const std::vector<T> &values, std::ostream &output) {
+        if constexpr (std::is_same_v<T, String>) {
+            for (const auto &s : values) {
+                BinaryWriter::write_string(s, output);
+            }
+        } else {
+            BinaryWriter::write_array(values.data(), values.size(), output);
+        }
+    }
+
+    template <typename T>
+    Column_Values read_values(BinaryReader &reader, std::size_t row_count) {
+        if constexpr (std::is_same_v<T, String>) {
+            std::vector<String> values(row_count);
+            for (auto &s : values) {
+                s = reader.read_string(reader.read<uint16_t>());
+            }
+            return values;
+        } else {
+            return reader.read_array<T>(row_count);
+        }
+    }
+
+} // namespace
+
+Column_Table extract_columns(const std::string &filename,
+                             const std::vector<std::string> &paths,
+                             unsigned thread_count) {
+    auto root = build_path_tree(paths);
+    Row_Cells rows;
+    extract_region(filename, root, paths.size(), thread_count, rows);
+    return make_table(paths, rows);
+}
+
+Column_Table extract_world_columns(const std::string &directory,
+                                   const std::vector<std::string> &paths,
+                                   unsigned thread_count) {
+    auto root = build_path_tree(paths);
+    Row_Cells rows;
+    for (const auto &file : region_files(directory)) {
+        extract_region(file, root, paths.size(), thread_count, rows);
+    }
+    return make_table(paths, rows);
+}
+
+void write_columns(const Column_Table &table, std::ostream &output) {
+    output.write(columns_magic, sizeof(columns_magic));
+    BinaryWriter::write(static_cast<uint64_t>(table.size()), output);
+    BinaryWriter::write(static_cast<uint32_t>(table.columns.size()), output);
+    write_values(table.chunk_x, output);
+    write_values(table.chunk_z, output);
+    for (const auto &column : table.columns) {
+        BinaryWriter::write_string(column.path, output);
+        BinaryWriter::write(static_cast<int8_t>(column.type), output);
+        for (bool present : column.present) {
+            BinaryWriter::write(static_cast<uint8_t>(present), output);
+        }
+        std::visit([&](const auto &values) { write_values(values, output); },
+                   column.values);
+    }
+}
+
+Column_Table read_columns(std::istream &input) {
+    std::vector<unsigned char> bytes{std::istreambuf_iterator<char>(input),
+                                     std::istreambuf_iterator<char>()};
+    BinaryReader reader(bytes.data(), bytes.size());
+    auto magic = reader.read_string_view(sizeof(columns_magic));
+    if (magic != std::string_view(columns_magic, sizeof(columns_magic))) {
+        throw std::runtime_error("Not a columnar file");
+    }
+    auto row_count = reader.read<uint64_t>();
+    auto column_count = reader.read<uint32_t>();
+    // Each row takes at least 8 bytes for its coordinates.
+    if (row_count > reader.remaining_length() / 8) {
+        throw UnexpectedEndOfInputException();
+    }
+    Column_Table table;
+    table.chunk_x = reader.read_array<Int>(row_count);
+    table.chunk_z = reader.read_array<Int>(row_count);
+    for (uint32_t c = 0; c < column_count; ++c) {
+        Column column;
+        column.path = reader.read_string(reader.read<uint16_t>());
+        column.type = static_cast<TypeCode>(reader.read<int8_t>());
+        column.present.resize(row_count);
+        for (uint64_t row = 0; row < row_count; ++row) {
+            column.present[row] = reader.read<uint8_t>() != 0;
+        }
+        switch (column.type) {
+        case TypeCode::Short:
+            column.values = read_values<Short>(reader, row_count);
+            break;
+        case TypeCode::Int:
+            column.values = read_values<Int>(reader, row_count);
+            break;
+        case TypeCode::Long:
+            column.values = read_values<Long>(reader, row_count);
+            break;
+        case TypeCode::Float:
+            column.values = read_values<Float>(reader, row_count);
+            break;
+        case TypeCode::Double:
+            column.values = read_values<Double>(reader, row_count);
+            break;
+        case TypeCode::String:
+            column.values = read_values<String>(reader, row_count);
+            break;
+        case TypeCode::Byte:
+        case TypeCode::None:
+            column.values = read_values<Byte>(reader, row_count);
+            break;
+        default:
+            throw std::runtime_error("Column has an invalid type");
+        }
+        table.columns.push_back(std::move(column));
+    }
+    return table;
+}
+
+} // namespace nbtview
@@ -0,0 +1,107 @@
+/**
+ * @file Columns.hpp
+ * @brief Extract fields of every chunk in a region or world into columns
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_COLUMNS_H_
+#define NBT_COLUMNS_H_
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! The values of a column, one per chunk
+using Column_Values =
+    std::variant<std::vector<Byte>, std::vector<Short>, std::vector<Int>,
+                 std::vector<Long>, std::vector<Float>, std::vector<Double>,
+                 std::vector<String>>;
+
+/**
+ * @brief Column holds the value of one field for each chunk.
+ *
+ * The type of a column is that of the first value found for it.  Where a
+ * chunk has no such field, or it has a different type, the value is
+ * default-initialized and present is false.
+ */
+struct Column {
+    //! Names of the nested Compounds and field, separated by '.'
+    std::string path;
+    //! Type of the values; None if the field was found in no chunk
+    TypeCode type = TypeCode::None;
+    Column_Values values;
+    std::vector<bool> present;
+
+    template <typename T> const std::vector<T> &get() const {
+        return std::get<std::vector<T>>(values);
+    }
+};
+
+/**
+ * @brief Column_Table holds the extracted columns of a set of chunks.
+ *
+ * Row i holds the fields of the chunk at (chunk_x[i], chunk_z[i]), in
+ * chunk coordinates.  Rows are ordered by region, then by position within
+ * the region.
+ */
+struct Column_Table {
+    std::vector<Int> chunk_x;
+    std::vector<Int> chunk_z;
+    std::vector<Column> columns;
+
+    std::size_t size() const { return chunk_x.size(); }
+};
+
+/**
+ * @brief Extracts fields from each chunk of a region file.
+ *
+ * Chunks are inflated and searched on several threads.  Only the Compounds
+ * on a path are decoded; other tags are skipped, and a chunk is abandoned
+ * as soon as every field has been found.  Fields must be numeric or String
+ * tags.  An external chunk is read from its file c.X.Z.mcc.
+ *
+ * @param filename a region file named r.X.Z.mca, where X and Z give its
+ * region coordinates
+ * @param paths paths of fields within each chunk, such as "Level.xPos"
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * @throw std::runtime_error if a chunk cannot be read or decoded
+ */
+Column_Table extract_columns(const std::string &filename,
+                             const std::vector<std::string> &paths,
+                             unsigned thread_count = 0);
+
+//! Extracts fields from each chunk of every region file r.X.Z.mca in a
+//! directory, such as a world's region directory, in order of filename.
+Column_Table extract_world_columns(const std::string &directory,
+                                   const std::vector<std::string> &paths,
+                                   unsigned thread_count = 0);
+
+/**
+ * @brief Writes a Column_Table as a simple binary columnar file.
+ *
+ * All values are big-endian.  The file holds the magic bytes "NBTC", the
+ * row count as a uint64 and the column count as a uint32, then the
+ * chunk_x and chunk_z columns as Ints.  Each column follows as its path
+ * (a uint16 length and UTF-8 bytes), its TypeCode as a byte, a byte per
+ * row which is 1 where the value is present, and the values: numbers are
+ * packed end to end, and Strings have a uint16 length.
+ */
+void write_columns(const Column_Table &table, std::ostream &output);
+
+//! Reads a file written by write_columns().
+//! @throw std::runtime_error if the file is not a valid columnar file
+Column_Table read_columns(std::istream &input);
+
+} // namespace nbtview
+
+#endif // NBT_COLUMNS_H_
@@ -0,0 +1,402 @@
+// CompactTree.cpp
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "CompactTree.hpp"
+#include "Deserializer.hpp"
+#include "KeyTable.hpp"
+#include "Tag.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+// CompactTreeBuilder decodes binary NBT data into a CompactTree.
+//
+// The children of a Compound or List are gathered in a scratch vector for
+// their nesting depth, then appended to the node pool as one contiguous
+// range once the container has been fully read.
+class CompactTreeBuilder {
+  public:
+    CompactTreeBuilder(CompactTree &tree, const unsigned char *data,
+                       size_t data_length, KeyTable *key_table,
+                       std::size_t max_depth)
+        : tree(tree), reader(data, data_length), key_table(key_table),
+          max_depth(max_depth) {}
+
+    void build() {
+        CompactTree::Node root{};
+        root.type = static_cast<TypeCode>(reader.read<int8_t>());
+        if (root.type == TypeCode::End) {
+            throw std::runtime_error("Root tag is an End tag");
+        }
+        read_name(root);
+        read_payload(root, 0);
+        tree.root_index = static_cast<uint32_t>(tree.nodes.size());
+        tree.nodes.push_back(root);
+        tree.nodes.shrink_to_fit();
+        tree.pool.shrink_to_fit();
+    }
+
+  private:
+    CompactTree &tree;
+    BinaryReader reader;
+    KeyTable *key_table;
+    std::size_t max_depth;
+    std::vector<std::vector<CompactTree::Node>> scratch;
+
+    uint32_t append_to_pool(const void *bytes, size_t length) {
+        auto offset = tree.pool.size();
+        tree.pool.resize(offset + length);
+        std::memcpy(tree.pool.data() + offset, bytes, length);
+        return static_cast<uint32_t>(offset);
+    }
+
+    void read_name(CompactTree::Node &node) {
+        auto name = reader.read_string_view(reader.read<uint16_t>());
+        node.name_length = static_cast<uint16_t>(name.size());
+        if (key_table != nullptr) {
+            node.name = key_table->intern(name).id;
+        } else if (name.size() <= CompactTree::inline_name_length) {
+            std::memcpy(&node.name, name.data(), name.size());
+        } else {
+            node.name = append_to_pool(name.data(), name.size());
+        }
+    }
+
+    template <typename T> void read_packed(CompactTree::Node &node) {
+        auto length = reader.read<int32_t>();
+        if (length < 0) {
+            throw std::runtime_error("Negative array length");
+        }
+        read_packed_elements<T>(node, length);
+    }
+
+    template <typename T>
+    void read_packed_elements(CompactTree::Node &node, int32_t length) {
+        if (length <= 0) {
+            node.range = {0, 0};
+            return;
+        }
+        // Check the length before allocating pool space for it.
+        if (static_cast<size_t>(length) * sizeof(T) >
+            reader.remaining_length()) {
+            throw UnexpectedEndOfInputException();
+        }
+        auto offset = (tree.pool.size() + alignof(T) - 1) & ~(alignof(T) - 1);
+        tree.pool.resize(offset + length * sizeof(T));
+        reader.read_array(reinterpret_cast<T *>(tree.pool.data() + offset),
+                          length);
+        node.range = {static_cast<uint32_t>(offset),
+                      static_cast<uint32_t>(length)};
+    }
+
+    void read_payload(CompactTree::Node &node, size_t depth) {
+        switch (node.type) {
+        case TypeCode::Byte:
+            node.bits = static_cast<uint64_t>(reader.read<Byte>());
+            break;
+        case TypeCode::Short:
+            node.bits = static_cast<uint64_t>(reader.read<Short>());
+            break;
+        case TypeCode::Int:
+        case TypeCode::Float:
+            node.bits = static_cast<uint64_t>(reader.read<Int>());
+            break;
+        case TypeCode::Long:
+        case TypeCode::Double:
+            node.bits = static_cast<uint64_t>(reader.read<Long>());
+            break;
+        case TypeCode::Byte_Array:
+            read_packed<Byte>(node);
+            break;
+        case TypeCode::Int_Array:
+            read_packed<Int>(node);
+            break;
+        case TypeCode::Long_Array:
+            read_packed<Long>(node);
+            break;
+        case TypeCode::String: {
+            auto str = reader.read_string_view(reader.read<uint16_t>());
+            node.range = {append_to_pool(str.data(), str.size()),
+                          static_cast<uint32_t>(str.size())};
+            break;
+        }
+        case TypeCode::List:
+            check_depth(depth);
+            read_list(node, depth);
+            break;
+        case TypeCode::Compound:
+            check_depth(depth);
+            read_compound(node, depth);
+            break;
+        default:
+            throw std::runtime_error("Unhandled tag type");
+        }
+    }
+
+    // Containers are read recursively, so their nesting is limited.
+    void check_depth(size_t depth) const {
+        if (depth >= max_depth) {
+            throw LimitExceededException("NBT data is nested more than " +
+                                         std::to_string(max_depth) +
+                                         " levels deep");
+        }
+    }
+
+    void read_list(CompactTree::Node &node, size_t depth) {
+        node.list_type = static_cast<TypeCode>(reader.read<int8_t>());
+        auto length = reader.read<int32_t>();
+        switch (node.list_type) {
+        case TypeCode::Byte:
+            return read_packed_elements<Byte>(node, length);
+        case TypeCode::Short:
+            return read_packed_elements<Short>(node, length);
+        case TypeCode::Int:
+            return read_packed_elements<Int>(node, length);
+        case TypeCode::Long:
+            return read_packed_elements<Long>(node, length);
+        case TypeCode::Float:
+            return read_packed_elements<Float>(node, length);
+        case TypeCode::Double:
+            return read_packed_elements<Double>(node, length);
+        default:
+            break;
+        }
+        if (scratch.size() <= depth) {
+            scratch.resize(depth + 1);
+        }
+        for (int32_t i = 0; i < length; ++i) {
+            CompactTree::Node child{};
+            child.type = node.list_type;
+            read_payload(child, depth + 1);
+            scratch[depth].push_back(child);
+        }
+        append_children(node, depth);
+    }
+
+    void read_compound(CompactTree::Node &node, size_t depth) {
+        if (scratch.size() <= depth) {
+            scratch.resize(depth + 1);
+        }
+        while (true) {
+            CompactTree::Node child{};
+            child.type = static_cast<TypeCode>(reader.read<int8_t>());
+            if (child.type == TypeCode::End) {
+                break;
+            }
+            read_name(child);
+            read_payload(child, depth + 1);
+            scratch[depth].push_back(child);
+        }
+        append_children(node, depth);
+    }
+
+    void append_children(CompactTree::Node &node, size_t depth) {
+        auto &children = scratch[depth];
+        node.range = {static_cast<uint32_t>(tree.nodes.size()),
+                      static_cast<uint32_t>(children.size())};
+        tree.nodes.insert(tree.nodes.end(), children.begin(), children.end());
+        children.clear();
+    }
+};
+
+namespace {
+
+    // Decodes data into tree, decompressing it first if necessary.
+    void build_tree(CompactTree &tree, const unsigned char *data,
+                    size_t data_length, KeyTable *key_table,
+                    const read_options &options) {
+        std::vector<unsigned char> inflated_data_holder;
+        if (has_compression_header(data, data_length)) {
+            inflated_data_holder = decompress_data(data, data_length);
+            data = inflated_data_holder.data();
+            data_length = inflated_data_holder.size();
+        }
+        CompactTreeBuilder builder(tree, data, data_length, key_table,
+                                   options.max_depth);
+        builder.build();
+    }
+
+} // namespace
+
+CompactTree::CompactTree(const unsigned char *data, size_t data_length,
+                         const read_options &options) {
+    build_tree(*this, data, data_length, nullptr, options);
+}
+
+CompactTree::CompactTree(const unsigned char *data, size_t data_length,
+                         KeyTable &key_table, const read_options &options)
+    : keys(&key_table) {
+    build_tree(*this, data, data_length, &key_table, options);
+}
+
+std::size_t CompactTree::Ref::size() const {
+    switch (node->type) {
+    case TypeCode::Compound:
+    case TypeCode::List:
+    case TypeCode::Byte_Array:
+    case TypeCode::Int_Array:
+    case TypeCode::Long_Array:
+        return node->range.count;
+    default:
+        throw std::runtime_error("Called size() on a CompactTree node which "
+                                 "is neither a container nor an array.");
+    }
+}
+
+const CompactTree::Node *CompactTree::Ref::find(std::string_view key) const {
+    if (tree->keys != nullptr) {
+        // A name which was never interned cannot be present.
+        auto interned = tree->keys->find(key);
+        return interned ? find(*interned) : nullptr;
+    }
+    require(TypeCode::Compound);
+    for (uint32_t i = 0; i < node->range.count; ++i) {
+        Ref child(*tree, node->range.first + i);
+        if (child.name() == key) {
+            return child.node;
+        }
+    }
+    return nullptr;
+}
+
+const CompactTree::Node *CompactTree::Ref::find(Key key) const {
+    if (tree->keys == nullptr) {
+        throw std::runtime_error(
+            "Looked up a Key in a CompactTree which has no KeyTable");
+    }
+    require(TypeCode::Compound);
+    auto first = tree->nodes.data() + node->range.first;
+    auto last = first + node->range.count;
+    for (auto child = first; child != last; ++child) {
+        if (child->name == key.id) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+bool CompactTree::Ref::contains(std::string_view key) const {
+    return find(key) != nullptr;
+}
+
+bool CompactTree::Ref::contains(Key key) const {
+    return find(key) != nullptr;
+}
+
+CompactTree::Ref CompactTree::Ref::operator[](std::string_view key) const {
+    auto child = find(key);
+    if (child == nullptr) {
+        throw std::out_of_range("CompactTree compound has no key '" +
+                                std::string(key) + "'");
+    }
+    return Ref(*tree, static_cast<uint32_t>(child - tree->nodes.data()));
+}
+
+CompactTree::Ref CompactTree::Ref::operator[](Key key) const {
+    auto child = find(key);
+    if (child == nullptr) {
+        throw std::out_of_range("CompactTree compound has no key '" +
+                                std::string(tree->keys->name(key)) + "'");
+    }
+    return Ref(*tree, static_cast<uint32_t>(child - tree->nodes.data()));
+}
+
+CompactTree::Ref CompactTree::Ref::operator[](std::size_t index) const {
+    bool has_child_nodes =
+        node->type == TypeCode::Compound ||
+        (node->type == TypeCode::List && node->list_type > TypeCode::Double);
+    if (!has_child_nodes) {
+        throw std::runtime_error(
+            "Indexed a CompactTree node which has no child nodes");
+    }
+    if (index >= node->range.count) {
+        throw std::out_of_range("CompactTree child index out of range");
+    }
+    return Ref(*tree, node->range.first + static_cast<uint32_t>(index));
+}
+
+namespace {
+
+    template <typename T> std::vector<T> to_vector(std::span<const T> span) {
+        return std::vector<T>(span.begin(), span.end());
+    }
+
+    template <typename T> List packed_to_list(std::span<const T> span) {
+        List lst;
+        lst.reserve(span.size());
+        for (auto elt : span) {
+            lst.emplace_back(elt);
+        }
+        return lst;
+    }
+
+} // namespace
+
+Tag CompactTree::Ref::to_tag() const {
+    switch (node->type) {
+    case TypeCode::Byte:
+        return get<Byte>();
+    case TypeCode::Short:
+        return get<Short>();
+    case TypeCode::Int:
+        return get<Int>();
+    case TypeCode::Long:
+        return get<Long>();
+    case TypeCode::Float:
+        return get<Float>();
+    case TypeCode::Double:
+        return get<Double>();
+    case TypeCode::Byte_Array:
+        return to_vector(get_array<Byte>());
+    case TypeCode::Int_Array:
+        return to_vector(get_array<Int>());
+    case TypeCode::Long_Array:
+        return to_vector(get_array<Long>());
+    case TypeCode::String:
+        return String(get_string());
+    case TypeCode::Compound: {
+        Compound cmpd;
+        for (uint32_t i = 0; i < node->range.count; ++i) {
+            Ref child(*tree, node->range.first + i);
+            cmpd.emplace(std::string(child.name()), child.to_tag());
+        }
+        return cmpd;
+    }
+    case TypeCode::List:
+        switch (node->list_type) {
+        case TypeCode::Byte:
+            return packed_to_list(get_array<Byte>());
+        case TypeCode::Short:
+            return packed_to_list(get_array<Short>());
+        case TypeCode::Int:
+            return packed_to_list(get_array<Int>());
+        case TypeCode::Long:
+            return packed_to_list(get_array<Long>());
+        case TypeCode::Float:
+            return packed_to_list(get_array<Float>());
+        case TypeCode::Double:
+            return packed_to_list(get_array<Double>());
+        default: {
+            List lst;
+            lst.reserve(node->range.count);
+            for (uint32_t i = 0; i < node->range.count; ++i) {
+                lst.push_back(Ref(*tree, node->range.first + i).to_tag());
+            }
+            return lst;
+        }
+        }
+    default:
+        return Tag();
+    }
+}
+
+} // namespace nbtview
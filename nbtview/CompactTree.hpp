@@ -0,0 +1,238 @@
+/**
+ * @file CompactTree.hpp
+ * @brief A memory-compact, read-only representation of decoded NBT data
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_COMPACTTREE_H_
+#define NBT_COMPACTTREE_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Deserializer.hpp"
+#include "KeyTable.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief CompactTree stores a decoded NBT tree as a pool of 16-byte nodes
+ * plus a byte pool holding names, strings and array payloads.
+ *
+ * The children of each Compound, and the elements of each List of
+ * non-numeric type, occupy a contiguous range of nodes.  Lists of numeric
+ * type are packed into the byte pool like arrays.  Names of up to four bytes
+ * are stored inline in their node.
+ *
+ * Array payloads take as many bytes as in a Tag, so the saving is in the
+ * overhead of each tag: for chunks whose memory is mostly block arrays,
+ * the tree as a whole is only somewhat smaller than the Tag.
+ *
+ * If a KeyTable is supplied, names are instead interned in it and each node
+ * stores the name's Key, so that lookups compare Keys rather than strings
+ * and trees sharing the table do not store duplicate names.  The KeyTable
+ * must outlive the tree.
+ *
+ * A CompactTree is immutable once decoded; use Ref::to_tag() to obtain a
+ * mutable Tag for any subtree.
+ */
+class CompactTree {
+  public:
+    struct Node {
+        TypeCode type;
+        //! Element type, for List nodes
+        TypeCode list_type;
+        uint16_t name_length;
+        //! Byte pool offset of the name, the name itself if it fits, or the
+        //! id of its Key if the tree has a KeyTable
+        uint32_t name;
+        union {
+            //! Bit pattern of a numeric value
+            uint64_t bits;
+            //! Node index (Compound or List) or pool offset, and count
+            struct {
+                uint32_t first;
+                uint32_t count;
+            } range;
+        };
+    };
+    static_assert(sizeof(Node) == 16, "CompactTree::Node must be 16 bytes");
+
+    //! Names no longer than this are stored inline in their node.
+    static const std::size_t inline_name_length = sizeof(uint32_t);
+
+    /**
+     * @brief Ref is a lightweight handle to one node of a CompactTree.
+     *
+     * A Ref must not outlive the tree it refers to.
+     */
+    class Ref {
+      public:
+        Ref(const CompactTree &tree, uint32_t index)
+            : tree(&tree), node(&tree.nodes[index]) {}
+
+        TypeCode type() const { return node->type; }
+        std::string_view name() const;
+
+        //! Returns a numeric value; T must match the node type exactly.
+        template <typename T> T get() const;
+
+        std::string_view get_string() const;
+
+        //! Returns the elements of an array, or of a List of numeric type.
+        template <typename T> std::span<const T> get_array() const;
+
+        //! Element type of a List node
+        TypeCode list_type() const { return node->list_type; }
+
+        //! Number of entries in a Compound, List or array
+        std::size_t size() const;
+
+        bool contains(std::string_view key) const;
+        bool contains(Key key) const;
+        //! Returns the named child of a Compound.
+        Ref operator[](std::string_view key) const;
+        //! Returns the named child of a Compound in a tree with a KeyTable.
+        Ref operator[](Key key) const;
+        //! Returns the child at an index of a Compound or non-numeric List.
+        Ref operator[](std::size_t index) const;
+
+        //! Builds an equivalent, independent Tag.
+        Tag to_tag() const;
+
+      private:
+        const CompactTree *tree;
+        const Node *node;
+
+        const Node *find(std::string_view key) const;
+        const Node *find(Key key) const;
+        void require(TypeCode t) const;
+    };
+
+    CompactTree() = default;
+
+    //! Decodes binary NBT data, which may be zlib or gzip compressed.
+    //! Only options.max_depth is consulted: deeper nesting throws
+    //! LimitExceededException.
+    CompactTree(const unsigned char *data, size_t data_length,
+                const read_options &options = {});
+
+    //! Decodes binary NBT data, interning names in a KeyTable.
+    CompactTree(const unsigned char *data, size_t data_length,
+                KeyTable &keys, const read_options &options = {});
+
+    Ref root() const { return Ref(*this, root_index); }
+    std::string_view root_name() const { return root().name(); }
+
+    std::size_t node_count() const { return nodes.size(); }
+
+    //! Total bytes allocated for the node pool and byte pool
+    std::size_t memory_usage() const {
+        return nodes.capacity() * sizeof(Node) + pool.capacity();
+    }
+
+  private:
+    friend class CompactTreeBuilder;
+
+    std::vector<Node> nodes;
+    std::vector<unsigned char> pool;
+    uint32_t root_index = 0;
+    const KeyTable *keys = nullptr;
+
+    std::string_view pool_string(uint32_t offset, std::size_t length) const {
+        return {reinterpret_cast<const char *>(pool.data()) + offset, length};
+    }
+};
+
+inline std::string_view CompactTree::Ref::name() const {
+    if (tree->keys != nullptr) {
+        return tree->keys->name(Key{node->name});
+    }
+    if (node->name_length <= inline_name_length) {
+        return {reinterpret_cast<const char *>(&node->name),
+                node->name_length};
+    }
+    return tree->pool_string(node->name, node->name_length);
+}
+
+inline void CompactTree::Ref::require(TypeCode t) const {
+    if (node->type != t) {
+        throw std::runtime_error(std::string("CompactTree node is ") +
+                                 typecode_to_string(node->type) + ", not " +
+                                 typecode_to_string(t));
+    }
+}
+
+template <typename T> T CompactTree::Ref::get() const {
+    static_assert(std::is_arithmetic_v<T>, "get<T>() requires a numeric T");
+    if constexpr (std::is_same_v<T, Float>) {
+        require(TypeCode::Float);
+        return std::bit_cast<Float>(static_cast<uint32_t>(node->bits));
+    } else if constexpr (std::is_same_v<T, Double>) {
+        require(TypeCode::Double);
+        return std::bit_cast<Double>(node->bits);
+    } else {
+        require(typecode_of<T>);
+        return static_cast<T>(node->bits);
+    }
+}
+
+inline std::string_view CompactTree::Ref::get_string() const {
+    require(TypeCode::String);
+    return tree->pool_string(node->range.first, node->range.count);
+}
+
+template <typename T> std::span<const T> CompactTree::Ref::get_array() const {
+    constexpr TypeCode elt_type = typecode_of<T>;
+    static_assert(elt_type == TypeCode::Byte || elt_type == TypeCode::Short ||
+                      elt_type == TypeCode::Int || elt_type == TypeCode::Long ||
+                      elt_type == TypeCode::Float ||
+                      elt_type == TypeCode::Double,
+                  "get_array<T>() requires a numeric T");
+    bool matches = false;
+    switch (node->type) {
+    case TypeCode::Byte_Array:
+        matches = elt_type == TypeCode::Byte;
+        break;
+    case TypeCode::Int_Array:
+        matches = elt_type == TypeCode::Int;
+        break;
+    case TypeCode::Long_Array:
+        matches = elt_type == TypeCode::Long;
+        break;
+    case TypeCode::List:
+        matches = node->list_type == elt_type || node->range.count == 0;
+        break;
+    default:
+        break;
+    }
+    if (!matches) {
+        throw std::runtime_error(std::string("get_array() element type ") +
+                                 typecode_to_string(elt_type) +
+                                 " does not match " +
+                                 typecode_to_string(type()));
+    }
+    if (node->range.count == 0) {
+        return {};
+    }
+    auto elts =
+        reinterpret_cast<const T *>(tree->pool.data() + node->range.first);
+    return {elts, node->range.count};
+}
+
+} // namespace nbtview
+
+#endif // NBT_COMPACTTREE_H_
@@ -8,9 +8,16 @@
  * https://github.com/maspitz/nbtview
  */
 
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <variant>
+#include <vector>
 
+#include "Encoding.hpp"
 #include "Tag.hpp"
 
 #ifndef DESERIALIZER_H_
@@ -18,6 +25,77 @@
 
 namespace nbtview {
 
+/**
+ * @brief Parameter object which provides options for deserialization.
+ */
+struct read_options {
+    //! Store Lists of numbers, Strings or Compounds as Packed_List rather
+    //! than List.
+    bool packed_lists = false;
+    //! Maximum nesting depth of Compounds and Lists, counting the root
+    std::size_t max_depth = 512;
+    //! Maximum total number of tags, counting each element of a List
+    std::size_t max_elements = std::numeric_limits<std::size_t>::max();
+    //! Encoding of binary input: Java NBT by default
+    Binary_Encoding encoding = Binary_Encoding::big_endian;
+    //! Size of the blocks in which read_binary() pulls input from a stream
+    //! and inflates it
+    std::size_t stream_block_size = 64 * 1024;
+};
+
+//! Thrown when input exceeds a limit given in read_options
+class LimitExceededException : public std::runtime_error {
+  public:
+    explicit LimitExceededException(const std::string &what)
+        : std::runtime_error(what) {}
+};
+
+namespace detail {
+
+    //! Returns an empty List for elements of a type other than a number:
+    //! a Packed_List if options.packed_lists and the elements are Strings
+    //! or Compounds.  Room is reserved for capacity elements.
+    inline TagValue empty_list(TypeCode element_type,
+                               const read_options &options,
+                               std::size_t capacity) {
+        if (options.packed_lists && element_type == TypeCode::String) {
+            std::vector<String> elements;
+            elements.reserve(capacity);
+            return Packed_List(std::move(elements));
+        }
+        if (options.packed_lists && element_type == TypeCode::Compound) {
+            std::vector<Compound> elements;
+            elements.reserve(capacity);
+            return Packed_List(std::move(elements));
+        }
+        List lst;
+        lst.reserve(capacity);
+        return lst;
+    }
+
+    //! Appends an element to a List made by empty_list().
+    inline void append_element(TagValue &list, TagValue &&element) {
+        if (auto lst = std::get_if<List>(&list)) {
+            lst->emplace_back(std::move(element));
+            return;
+        }
+        std::visit(
+            [&element](auto &elements) {
+                using T = typename std::remove_cvref_t<
+                    decltype(elements)>::value_type;
+                if constexpr (std::is_same_v<T, String> ||
+                              std::is_same_v<T, Compound>) {
+                    elements.push_back(std::get<T>(std::move(element)));
+                } else {
+                    throw std::logic_error("Element appended to a List of "
+                                           "numbers");
+                }
+            },
+            std::get<Packed_List>(list).storage());
+    }
+
+} // namespace detail
+
 // Builder design pattern: the concrete subclasses of Deserializer are
 // responsible for building Tag objects.
 
@@ -0,0 +1,276 @@
+// Document.cpp
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NBTVIEW_HAVE_MMAP 1
+#endif
+
+#include "BinaryReader.hpp"
+#include "Binding.hpp"
+#include "Document.hpp"
+#include "Tag.hpp"
+#include "Tape.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+// The bytes of a Document and their Tape, which are shared by all of its
+// views.  The Tape is built last, once the bytes are in place.
+struct Document::Storage {
+    std::vector<unsigned char> raw;
+    std::vector<unsigned char> inflated;
+    // A mapping of a file, which replaces raw if present
+    void *mapping = nullptr;
+    std::size_t mapping_length = 0;
+    bool compressed = false;
+    std::optional<Tape> tape;
+
+    Storage() = default;
+    Storage(const Storage &) = delete;
+    Storage &operator=(const Storage &) = delete;
+
+    ~Storage() {
+#ifdef NBTVIEW_HAVE_MMAP
+        if (mapping != nullptr) {
+            munmap(mapping, mapping_length);
+        }
+#endif
+    }
+
+    std::span<const unsigned char> raw_bytes() const {
+        if (mapping != nullptr) {
+            return {static_cast<const unsigned char *>(mapping),
+                    mapping_length};
+        }
+        return raw;
+    }
+
+    std::span<const unsigned char> bytes() const {
+        return compressed ? std::span<const unsigned char>(inflated)
+                          : raw_bytes();
+    }
+
+    // Inflates the raw bytes if need be, and indexes the result.
+    void index() {
+        auto data = raw_bytes();
+        compressed = has_compression_header(data.data(), data.size());
+        if (compressed) {
+            inflated = decompress_data(data.data(), data.size());
+        }
+        auto uncompressed = bytes();
+        tape.emplace(uncompressed.data(), uncompressed.size());
+    }
+};
+
+Document::Document(std::vector<unsigned char> bytes) {
+    auto s = std::make_shared<Storage>();
+    s->raw = std::move(bytes);
+    s->index();
+    storage = std::move(s);
+}
+
+Document::Document(std::shared_ptr<Storage> storage)
+    : storage(std::move(storage)) {}
+
+Document Document::open(const std::string &filename) {
+#ifdef NBTVIEW_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapping =
+            mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error("Could not map " + filename);
+        }
+        auto s = std::make_shared<Storage>();
+        s->mapping = mapping;
+        s->mapping_length = info.st_size;
+        s->index();
+        return Document(std::move(s));
+    }
+    ::close(fd);
+#endif
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    return Document(std::vector<unsigned char>{
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>()});
+}
+
+Document::View Document::root() const { return View(storage, 0); }
+
+std::span<const unsigned char> Document::raw_bytes() const & {
+    return storage->raw_bytes();
+}
+
+std::span<const unsigned char> Document::bytes() const & {
+    return storage->bytes();
+}
+
+bool Document::is_mapped() const { return storage->mapping != nullptr; }
+
+TypeCode Document::View::type() const { return (*storage->tape)[index].type; }
+
+TypeCode Document::View::list_type() const {
+    return (*storage->tape)[index].list_type;
+}
+
+std::string_view Document::View::name() const & {
+    const auto &tape = *storage->tape;
+    return tape.name(tape[index]);
+}
+
+std::string_view Document::View::get_string() const & {
+    auto data = require(TypeCode::String);
+    return {reinterpret_cast<const char *>(data),
+            (*storage->tape)[index].count};
+}
+
+std::size_t Document::View::size() const {
+    const auto &entry = (*storage->tape)[index];
+    switch (entry.type) {
+    case TypeCode::Compound:
+    case TypeCode::List:
+    case TypeCode::Byte_Array:
+    case TypeCode::Int_Array:
+    case TypeCode::Long_Array:
+        return entry.count;
+    default:
+        return 0;
+    }
+}
+
+uint32_t Document::View::find_index(std::string_view key) const {
+    const auto &tape = *storage->tape;
+    require(TypeCode::Compound);
+    auto child = index + 1;
+    for (uint32_t i = 0; i < tape[index].count; ++i) {
+        if (tape.name(tape[child]) == key) {
+            return child;
+        }
+        child = tape[child].next;
+    }
+    return 0;
+}
+
+bool Document::View::contains(std::string_view key) const {
+    return find_index(key) != 0;
+}
+
+Document::View Document::View::operator[](std::string_view key) const {
+    auto child = find_index(key);
+    if (child == 0) {
+        throw std::out_of_range("Compound has no member '" +
+                                std::string(key) + "'");
+    }
+    return View(storage, child);
+}
+
+Document::View Document::View::operator[](std::size_t i) const {
+    const auto &tape = *storage->tape;
+    const auto &entry = tape[index];
+    require(TypeCode::List);
+    // Numeric Lists have no entries for their elements.
+    if (entry.next == index + 1 && entry.count != 0) {
+        throw std::runtime_error("List of " +
+                                 std::string(typecode_to_string(
+                                     entry.list_type)) +
+                                 " has no element views; use get_array()");
+    }
+    if (i >= entry.count) {
+        throw std::out_of_range("List index out of range");
+    }
+    auto child = index + 1;
+    for (std::size_t n = 0; n < i; ++n) {
+        child = tape[child].next;
+    }
+    return View(storage, child);
+}
+
+std::span<const unsigned char> Document::View::payload() const & {
+    const auto &entry = (*storage->tape)[index];
+    auto data = storage->bytes();
+    // Step back over the length prefix, if any, and skip to the end.
+    std::size_t begin = entry.payload;
+    switch (entry.type) {
+    case TypeCode::String:
+        begin -= 2;
+        break;
+    case TypeCode::Byte_Array:
+    case TypeCode::Int_Array:
+    case TypeCode::Long_Array:
+        begin -= 4;
+        break;
+    case TypeCode::List:
+        begin -= 5;
+        break;
+    default:
+        break;
+    }
+    BinaryReader reader(data.data() + begin, data.size() - begin);
+    skip_payload(reader, entry.type);
+    return data.subspan(begin, data.size() - begin - reader.remaining_length());
+}
+
+Tag Document::View::to_tag(const read_options &options) const {
+    return storage->tape->materialize(index, options);
+}
+
+const unsigned char *Document::View::require(TypeCode t) const {
+    const auto &entry = (*storage->tape)[index];
+    if (entry.type != t) {
+        throw std::runtime_error(std::string("Document tag is ") +
+                                 typecode_to_string(entry.type) + ", not " +
+                                 typecode_to_string(t));
+    }
+    return storage->bytes().data() + entry.payload;
+}
+
+const unsigned char *Document::View::require_elements(TypeCode t) const {
+    const auto &entry = (*storage->tape)[index];
+    bool matches = false;
+    switch (entry.type) {
+    case TypeCode::Byte_Array:
+        matches = t == TypeCode::Byte;
+        break;
+    case TypeCode::Int_Array:
+        matches = t == TypeCode::Int;
+        break;
+    case TypeCode::Long_Array:
+        matches = t == TypeCode::Long;
+        break;
+    case TypeCode::List:
+        matches = entry.list_type == t || entry.count == 0;
+        break;
+    default:
+        break;
+    }
+    if (!matches) {
+        throw std::runtime_error(std::string("get_array() element type ") +
+                                 typecode_to_string(t) + " does not match " +
+                                 typecode_to_string(entry.type));
+    }
+    return storage->bytes().data() + entry.payload;
+}
+
+} // namespace nbtview
@@ -0,0 +1,216 @@
+/**
+ * @file Document.hpp
+ * @brief Binary NBT data which owns its bytes and hands out views of them
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_DOCUMENT_H_
+#define NBT_DOCUMENT_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Deserializer.hpp"
+#include "Encoding.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief Document owns a block of binary NBT data, and the data inflated
+ * from it if it is compressed, and reads tags in place instead of copying
+ * them into Tag objects.
+ *
+ * The data is indexed by a Tape when the Document is made, so that it is
+ * validated once and any tag may be found without decoding its siblings.
+ * Strings and arrays are then read from the data itself.  The default
+ * limits of read_options apply, as for read_binary(): deeper nesting, or
+ * more tags, throws LimitExceededException.
+ *
+ * A Document is a cheap handle: copies share the same bytes.  Every View
+ * and Array_View also shares them, so the bytes live as long as any view
+ * does and a view cannot dangle.  Accessors which return a std::string_view
+ * or std::span borrow from the object they are called on, and so may not
+ * be called on a temporary; keep the View in a variable instead.
+ *
+ * Data must be Java NBT.
+ */
+class Document {
+  public:
+    class View;
+    template <typename T> class Array_View;
+
+    /**
+     * @brief Takes ownership of binary NBT data holding one root tag.
+     * @param bytes the data, which may be zlib or gzip compressed; it is
+     * kept as well as the data inflated from it
+     * @throw std::runtime_error if the data is not valid NBT
+     */
+    explicit Document(std::vector<unsigned char> bytes);
+
+    //! Maps a file into memory where the platform allows, or else reads it.
+    //! @throw std::runtime_error if the file cannot be read, or does not
+    //! hold valid NBT
+    static Document open(const std::string &filename);
+
+    View root() const;
+
+    //! The bytes as given, which may be compressed
+    std::span<const unsigned char> raw_bytes() const &;
+    std::span<const unsigned char> raw_bytes() const && = delete;
+
+    //! The uncompressed bytes which views read from
+    std::span<const unsigned char> bytes() const &;
+    std::span<const unsigned char> bytes() const && = delete;
+
+    //! True if the raw bytes are a memory mapping of a file
+    bool is_mapped() const;
+
+  private:
+    struct Storage;
+    std::shared_ptr<const Storage> storage;
+
+    explicit Document(std::shared_ptr<Storage> storage);
+};
+
+/**
+ * @brief View is a handle to one tag of a Document.
+ *
+ * Lookups walk the Document's Tape, so finding a member of a Compound
+ * takes time linear in the number of members, as in Tape::materialize().
+ */
+class Document::View {
+  public:
+    TypeCode type() const;
+    //! Element type of a List
+    TypeCode list_type() const;
+
+    //! The tag's name, or an empty name for an element of a List
+    std::string_view name() const &;
+    std::string_view name() const && = delete;
+
+    //! Returns a numeric value; T must match the tag type exactly.
+    template <typename T> T get() const;
+
+    std::string_view get_string() const &;
+    std::string_view get_string() const && = delete;
+
+    //! Returns the elements of an array, or of a List of numeric type.
+    template <typename T> Array_View<T> get_array() const;
+
+    //! Number of entries in a Compound, List or array
+    std::size_t size() const;
+
+    bool contains(std::string_view key) const;
+    //! Returns the named member of a Compound.
+    //! @throw std::out_of_range if there is no such member
+    View operator[](std::string_view key) const;
+    //! Returns the element at an index of a List of non-numeric type.
+    //! @throw std::out_of_range if the index is out of range
+    View operator[](std::size_t index) const;
+
+    //! The encoded payload, from just past the name to the end of the tag,
+    //! as written by write_binary() for an unnamed tag after its type
+    std::span<const unsigned char> payload() const &;
+    std::span<const unsigned char> payload() const && = delete;
+
+    //! Decodes the tag into an equivalent, independent Tag.
+    Tag to_tag(const read_options &options = {}) const;
+
+  private:
+    friend class Document;
+
+    std::shared_ptr<const Storage> storage;
+    uint32_t index;
+
+    View(std::shared_ptr<const Storage> storage, uint32_t index)
+        : storage(std::move(storage)), index(index) {}
+
+    //! Checks the tag's type, and returns its payload.
+    const unsigned char *require(TypeCode t) const;
+    //! Checks that the tag holds elements of type t, and returns them.
+    const unsigned char *require_elements(TypeCode t) const;
+    uint32_t find_index(std::string_view key) const;
+};
+
+/**
+ * @brief Array_View is a read-only sequence of big-endian numbers held in
+ * a Document.
+ *
+ * Elements are decoded as they are read; the array is never copied unless
+ * to_vector() is called.
+ */
+template <typename T> class Document::Array_View {
+  public:
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T operator[](std::size_t i) const {
+        using U = typename detail::uint_of_size<sizeof(T)>::type;
+        U bits;
+        std::memcpy(&bits, data + i * sizeof(T), sizeof(T));
+        return std::bit_cast<T>(detail::swap_bytes<Big_Endian>(bits));
+    }
+
+    //! Decodes every element into a vector.
+    std::vector<T> to_vector() const {
+        std::vector<T> elts(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            elts[i] = (*this)[i];
+        }
+        return elts;
+    }
+
+    //! The encoded elements
+    std::span<const unsigned char> bytes() const & {
+        return {data, count * sizeof(T)};
+    }
+    std::span<const unsigned char> bytes() const && = delete;
+
+  private:
+    friend class View;
+
+    std::shared_ptr<const Storage> storage;
+    const unsigned char *data;
+    std::size_t count;
+
+    Array_View(std::shared_ptr<const Storage> storage,
+               const unsigned char *data, std::size_t count)
+        : storage(std::move(storage)), data(data), count(count) {}
+};
+
+template <typename T> T Document::View::get() const {
+    static_assert(std::is_arithmetic_v<T>, "get<T>() requires a numeric T");
+    using U = typename detail::uint_of_size<sizeof(T)>::type;
+    U bits;
+    std::memcpy(&bits, require(typecode_of<T>), sizeof(T));
+    return std::bit_cast<T>(detail::swap_bytes<Big_Endian>(bits));
+}
+
+template <typename T>
+Document::Array_View<T> Document::View::get_array() const {
+    constexpr TypeCode elt_type = typecode_of<T>;
+    static_assert(elt_type == TypeCode::Byte || elt_type == TypeCode::Short ||
+                      elt_type == TypeCode::Int || elt_type == TypeCode::Long ||
+                      elt_type == TypeCode::Float ||
+                      elt_type == TypeCode::Double,
+                  "get_array<T>() requires a numeric T");
+    auto elts = require_elements(elt_type);
+    return {storage, elts, size()};
+}
+
+} // namespace nbtview
+
+#endif // NBT_DOCUMENT_H_
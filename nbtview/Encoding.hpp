@@ -0,0 +1,107 @@
+/**
+ * @file Encoding.hpp
+ * @brief Policies for the binary encodings of NBT used by Java and Bedrock
+ * Editions
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_ENCODING_H_
+#define NBT_ENCODING_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace nbtview {
+
+/**
+ * @name Encoding policies
+ * @{
+ * @brief Template arguments of BasicBinaryReader, BasicBinaryWriter and
+ * the classes built on them, which select how values are encoded at
+ * compile time.
+ *
+ * byte_order is the order of the bytes of fixed-width values.  When
+ * varints is true, Ints and Longs, and so the lengths of Lists and arrays,
+ * are written as zig-zag varints, and String lengths as unsigned varints.
+ */
+//! Java Edition NBT, in files and on the network
+struct Big_Endian {
+    static constexpr std::endian byte_order = std::endian::big;
+    static constexpr bool varints = false;
+};
+
+//! Bedrock Edition NBT files, such as level.dat and structure files
+struct Little_Endian {
+    static constexpr std::endian byte_order = std::endian::little;
+    static constexpr bool varints = false;
+};
+
+//! Bedrock Edition network NBT
+struct Network_Varint {
+    static constexpr std::endian byte_order = std::endian::little;
+    static constexpr bool varints = true;
+};
+/** @} */
+
+//! Selects an encoding policy at run time, for the functions of
+//! nbtview.hpp; each is dispatched once to code compiled for its policy.
+enum class Binary_Encoding {
+    big_endian,
+    little_endian,
+    network_varint,
+};
+
+namespace detail {
+
+    //! True if values of type T are varints in Encoding
+    template <typename Encoding, typename T>
+    inline constexpr bool is_varint =
+        Encoding::varints &&
+        (std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>);
+
+    //! The least number of bytes which encode a value of type T
+    template <typename Encoding, typename T>
+    inline constexpr std::size_t min_encoded_size =
+        is_varint<Encoding, T> ? 1 : sizeof(T);
+
+    //! The unsigned integer type of N bytes
+    template <std::size_t N> struct uint_of_size;
+    template <> struct uint_of_size<1> { using type = uint8_t; };
+    template <> struct uint_of_size<2> { using type = uint16_t; };
+    template <> struct uint_of_size<4> { using type = uint32_t; };
+    template <> struct uint_of_size<8> { using type = uint64_t; };
+
+    //! Converts the bytes of a fixed-width value between Encoding's byte
+    //! order and the native one.
+    template <typename Encoding, typename U> constexpr U swap_bytes(U bits) {
+        if constexpr (sizeof(U) > 1 &&
+                      Encoding::byte_order != std::endian::native) {
+            return std::byteswap(bits);
+        } else {
+            return bits;
+        }
+    }
+
+    //! Calls fn with a default-constructed policy selected by encoding.
+    template <typename Fn> auto with_encoding(Binary_Encoding encoding, Fn fn) {
+        switch (encoding) {
+        case Binary_Encoding::little_endian:
+            return fn(Little_Endian{});
+        case Binary_Encoding::network_varint:
+            return fn(Network_Varint{});
+        default:
+            return fn(Big_Endian{});
+        }
+    }
+
+} // namespace detail
+
+} // namespace nbtview
+
+#endif // NBT_ENCODING_H_
@@ -0,0 +1,349 @@
+// Entities.cpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "BinaryWriter.hpp"
+#include "Binding.hpp"
+#include "Entities.hpp"
+#include "KeyTable.hpp"
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    const char index_magic[4] = {'N', 'B', 'T', 'E'};
+
+    auto sort_key(const Entity_Record &r) {
+        return std::tie(r.type, r.x, r.z, r.y, r.source, r.region_x,
+                        r.region_z, r.chunk, r.offset);
+    }
+
+    // The walk of one chunk: records found are appended to records, with
+    // their source, region and chunk copied from location.
+    struct Chunk_Walk {
+        BinaryReader reader;
+        std::size_t data_length;
+        Entity_Record location;
+        std::vector<Entity_Record> &records;
+        KeyTable &types;
+
+        std::size_t offset() const {
+            return data_length - reader.remaining_length();
+        }
+    };
+
+    // Reads an entity or block entity Compound, recording it if it has an
+    // id and a position.
+    void read_entity(Chunk_Walk &walk, Entity_Kind kind) {
+        auto &reader = walk.reader;
+        Entity_Record record = walk.location;
+        record.kind = kind;
+        record.offset = static_cast<uint32_t>(walk.offset());
+        bool has_id = false;
+        int coordinates = 0;
+        while (true) {
+            auto type = static_cast<TypeCode>(reader.read<int8_t>());
+            if (type == TypeCode::End) {
+                break;
+            }
+            auto name = reader.read_string_view(reader.read<uint16_t>());
+            if (name == "id" && type == TypeCode::String) {
+                auto id = reader.read_string_view(reader.read<uint16_t>());
+                record.type = walk.types.intern(id).id;
+                has_id = true;
+            } else if (kind == Entity_Kind::entity && name == "Pos" &&
+                       type == TypeCode::List) {
+                auto element_type =
+                    static_cast<TypeCode>(reader.read<int8_t>());
+                auto length = reader.read<int32_t>();
+                if (element_type == TypeCode::Double && length == 3) {
+                    record.x = reader.read<Double>();
+                    record.y = reader.read<Double>();
+                    record.z = reader.read<Double>();
+                    coordinates = 3;
+                } else {
+                    for (int32_t i = 0; i < length; ++i) {
+                        skip_payload(reader, element_type);
+                    }
+                }
+            } else if (kind == Entity_Kind::block_entity &&
+                       type == TypeCode::Int &&
+                       (name == "x" || name == "y" || name == "z")) {
+                auto value = reader.read<Int>();
+                (name == "x"   ? record.x
+                 : name == "y" ? record.y
+                               : record.z) = value;
+                ++coordinates;
+            } else {
+                skip_payload(reader, type);
+            }
+        }
+        if (has_id && coordinates == 3 && std::isfinite(record.x) &&
+            std::isfinite(record.y) && std::isfinite(record.z)) {
+            walk.records.push_back(record);
+        }
+    }
+
+    void read_entity_list(Chunk_Walk &walk, Entity_Kind kind) {
+        auto element_type = static_cast<TypeCode>(walk.reader.read<int8_t>());
+        auto length = walk.reader.read<int32_t>();
+        if (length <= 0) {
+            return;
+        }
+        if (element_type != TypeCode::Compound) {
+            throw std::runtime_error("Entity list is not a List of "
+                                     "Compounds");
+        }
+        for (int32_t i = 0; i < length; ++i) {
+            read_entity(walk, kind);
+        }
+    }
+
+    // Walks a chunk's root Compound, or its Level Compound, reading only
+    // the entity lists.
+    void walk_compound(Chunk_Walk &walk, bool level) {
+        auto &reader = walk.reader;
+        while (true) {
+            auto type = static_cast<TypeCode>(reader.read<int8_t>());
+            if (type == TypeCode::End) {
+                return;
+            }
+            auto name = reader.read_string_view(reader.read<uint16_t>());
+            if (type == TypeCode::Compound && !level && name == "Level") {
+                // Before Minecraft 1.18
+                walk_compound(walk, true);
+            } else if (type == TypeCode::List && name == "Entities") {
+                read_entity_list(walk, Entity_Kind::entity);
+            } else if (type == TypeCode::List &&
+                       name == (level ? "TileEntities" : "block_entities")) {
+                read_entity_list(walk, Entity_Kind::block_entity);
+            } else {
+                skip_payload(reader, type);
+            }
+        }
+    }
+
+    void walk_chunk(Chunk_Walk &walk) {
+        auto &reader = walk.reader;
+        if (static_cast<TypeCode>(reader.read<int8_t>()) !=
+            TypeCode::Compound) {
+            throw std::runtime_error("Chunk root is not a Compound");
+        }
+        reader.skip(reader.read<uint16_t>());
+        walk_compound(walk, false);
+    }
+
+} // namespace
+
+Entity_Index::Entity_Index(std::vector<std::string> names,
+                           std::vector<Entity_Record> records)
+    : sorted(std::move(records)) {
+    // Only the types of some record are kept.
+    std::vector<bool> used(names.size());
+    for (const auto &record : sorted) {
+        if (record.type >= names.size()) {
+            throw std::runtime_error("Entity record has an unknown type");
+        }
+        used[record.type] = true;
+    }
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (used[i]) {
+            type_names.push_back(names[i]);
+        }
+    }
+    std::sort(type_names.begin(), type_names.end());
+    type_names.erase(std::unique(type_names.begin(), type_names.end()),
+                     type_names.end());
+    for (auto &record : sorted) {
+        record.type = static_cast<uint32_t>(
+            std::lower_bound(type_names.begin(), type_names.end(),
+                             names[record.type]) -
+            type_names.begin());
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto &a, const auto &b) {
+                  return sort_key(a) < sort_key(b);
+              });
+}
+
+std::optional<uint32_t> Entity_Index::type_index(std::string_view type) const {
+    auto it = std::lower_bound(type_names.begin(), type_names.end(), type);
+    if (it == type_names.end() || *it != type) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(it - type_names.begin());
+}
+
+void Entity_Index::add_matches(const Bounding_Box &box, uint32_t type,
+                               std::vector<Entity_Record> &matches) const {
+    // Records of a type are sorted by X, so the X bounds are found by
+    // binary search and the other bounds are checked for each record.
+    auto first = std::lower_bound(
+        sorted.begin(), sorted.end(), std::pair(type, box.min_x),
+        [](const Entity_Record &r, const std::pair<uint32_t, double> &key) {
+            return std::pair(r.type, r.x) < key;
+        });
+    for (auto it = first;
+         it != sorted.end() && it->type == type && it->x <= box.max_x; ++it) {
+        if (box.contains(it->x, it->y, it->z)) {
+            matches.push_back(*it);
+        }
+    }
+}
+
+std::vector<Entity_Record> Entity_Index::query(const Bounding_Box &box) const {
+    std::vector<Entity_Record> matches;
+    for (uint32_t type = 0; type < type_names.size(); ++type) {
+        add_matches(box, type, matches);
+    }
+    return matches;
+}
+
+std::vector<Entity_Record> Entity_Index::query(const Bounding_Box &box,
+                                               std::string_view type) const {
+    std::vector<Entity_Record> matches;
+    if (auto index = type_index(type)) {
+        add_matches(box, *index, matches);
+    }
+    return matches;
+}
+
+void Entity_Index::save(std::ostream &output) const {
+    output.write(index_magic, sizeof(index_magic));
+    BinaryWriter::write(static_cast<uint32_t>(type_names.size()), output);
+    for (const auto &name : type_names) {
+        BinaryWriter::write_string(name, output);
+    }
+    BinaryWriter::write(static_cast<uint64_t>(sorted.size()), output);
+    for (const auto &record : sorted) {
+        BinaryWriter::write(record.type, output);
+        BinaryWriter::write(static_cast<uint8_t>(record.kind), output);
+        BinaryWriter::write(static_cast<uint8_t>(record.source), output);
+        BinaryWriter::write(record.region_x, output);
+        BinaryWriter::write(record.region_z, output);
+        BinaryWriter::write(record.chunk, output);
+        BinaryWriter::write(record.offset, output);
+        BinaryWriter::write(record.x, output);
+        BinaryWriter::write(record.y, output);
+        BinaryWriter::write(record.z, output);
+    }
+}
+
+Entity_Index Entity_Index::load(std::istream &input) {
+    std::vector<unsigned char> bytes{std::istreambuf_iterator<char>(input),
+                                     std::istreambuf_iterator<char>()};
+    BinaryReader reader(bytes.data(), bytes.size());
+    auto magic = reader.read_string_view(sizeof(index_magic));
+    if (magic != std::string_view(index_magic, sizeof(index_magic))) {
+        throw std::runtime_error("Not an entity index file");
+    }
+    auto name_count = reader.read<uint32_t>();
+    // Each name takes at least its 2-byte length.
+    if (name_count > reader.remaining_length() / 2) {
+        throw UnexpectedEndOfInputException();
+    }
+    std::vector<std::string> names(name_count);
+    for (auto &name : names) {
+        name = reader.read_string(reader.read<uint16_t>());
+    }
+    auto record_count = reader.read<uint64_t>();
+    // Each record takes 44 bytes.
+    if (record_count > reader.remaining_length() / 44) {
+        throw UnexpectedEndOfInputException();
+    }
+    std::vector<Entity_Record> records(record_count);
+    for (auto &record : records) {
+        record.type = reader.read<uint32_t>();
+        auto kind = reader.read<uint8_t>();
+        auto source = reader.read<uint8_t>();
+        if (kind > 1 || source > 1) {
+            throw std::runtime_error("Entity record has an invalid kind or "
+                                     "source");
+        }
+        record.kind = static_cast<Entity_Kind>(kind);
+        record.source = static_cast<Entity_Source>(source);
+        record.region_x = reader.read<Int>();
+        record.region_z = reader.read<Int>();
+        record.chunk = reader.read<uint16_t>();
+        record.offset = reader.read<uint32_t>();
+        record.x = reader.read<Double>();
+        record.y = reader.read<Double>();
+        record.z = reader.read<Double>();
+    }
+    return Entity_Index(std::move(names), std::move(records));
+}
+
+Entity_Index build_entity_index(const std::vector<std::string> &region_files,
+                                const std::vector<std::string> &entity_files,
+                                unsigned thread_count) {
+    // Both kinds of file are walked together; those past the region files
+    // are entities files.
+    std::vector<std::string> filenames = region_files;
+    filenames.insert(filenames.end(), entity_files.begin(),
+                     entity_files.end());
+    std::vector<Entity_Record> locations(filenames.size());
+    for (std::size_t f = 0; f < filenames.size(); ++f) {
+        auto &location = locations[f];
+        if (!parse_region_filename(filenames[f], location.region_x,
+                                   location.region_z)) {
+            throw std::runtime_error("Region file name '" + filenames[f] +
+                                     "' does not have the form r.X.Z.mca");
+        }
+        if (f >= region_files.size()) {
+            location.source = Entity_Source::entities;
+        }
+    }
+
+    // Type IDs are interned in a table shared by every worker.
+    KeyTable types;
+    std::vector<std::vector<Entity_Record>> found(
+        detail::chunk_worker_count(thread_count, filenames.size()));
+    auto index_chunk = [&](std::size_t file, int i, const unsigned char *data,
+                           size_t data_length, unsigned worker) {
+        Chunk_Walk walk{BinaryReader(data, data_length), data_length,
+                        locations[file], found[worker], types};
+        walk.location.chunk = static_cast<uint16_t>(i);
+        walk_chunk(walk);
+    };
+    detail::for_each_chunk(filenames, thread_count, index_chunk);
+
+    std::vector<std::string> names;
+    for (uint32_t id = 0; id < types.size(); ++id) {
+        names.emplace_back(types.name(Key{id}));
+    }
+    std::vector<Entity_Record> records;
+    for (auto &worker_records : found) {
+        records.insert(records.end(), worker_records.begin(),
+                       worker_records.end());
+    }
+    return Entity_Index(std::move(names), std::move(records));
+}
+
+Entity_Index build_world_entity_index(const std::string &world_directory,
+                                      unsigned thread_count) {
+    std::filesystem::path world(world_directory);
+    std::vector<std::string> entity_files;
+    if (std::filesystem::is_directory(world / "entities")) {
+        entity_files = region_files((world / "entities").string());
+    }
+    return build_entity_index(region_files((world / "region").string()),
+                              entity_files, thread_count);
+}
+
+} // namespace nbtview
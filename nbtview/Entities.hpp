@@ -0,0 +1,164 @@
+/**
+ * @file Entities.hpp
+ * @brief A spatial index of the entities and block entities of a world
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_ENTITIES_H_
+#define NBT_ENTITIES_H_
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! Whether an indexed record is an entity or a block entity
+enum class Entity_Kind : uint8_t {
+    //! A mob, item, vehicle etc., from an Entities List
+    entity,
+    //! A chest, sign, spawner etc., from a TileEntities or block_entities
+    //! List
+    block_entity,
+};
+
+//! The kind of region file an indexed record was found in
+enum class Entity_Source : uint8_t {
+    //! A file of the world's region directory
+    region,
+    //! A file of the world's entities directory, used from Minecraft 1.17
+    entities,
+};
+
+/**
+ * @brief The type, position and location of an entity or block entity.
+ *
+ * offset is the position of the record's Compound payload within its
+ * chunk's inflated data, so that the whole record can be read back with
+ * Region_File::get_chunk_data() without searching the chunk.
+ */
+struct Entity_Record {
+    //! Index of the record's type ID, such as "minecraft:zombie", in
+    //! Entity_Index::types()
+    uint32_t type = 0;
+    Entity_Kind kind = Entity_Kind::entity;
+    Entity_Source source = Entity_Source::region;
+    //! Coordinates of the region file
+    Int region_x = 0;
+    Int region_z = 0;
+    //! Index of the chunk within the region file
+    uint16_t chunk = 0;
+    uint32_t offset = 0;
+    double x = 0;
+    double y = 0;
+    double z = 0;
+
+    bool operator==(const Entity_Record &) const = default;
+};
+
+//! An axis-aligned box of block coordinates, including its bounds
+struct Bounding_Box {
+    double min_x;
+    double min_y;
+    double min_z;
+    double max_x;
+    double max_y;
+    double max_z;
+
+    bool contains(double x, double y, double z) const {
+        return x >= min_x && x <= max_x && y >= min_y && y <= max_y &&
+               z >= min_z && z <= max_z;
+    }
+};
+
+/**
+ * @brief Entity_Index holds entity records sorted by type, then by X, Z
+ * and Y, so that the records of a type within a box are found by binary
+ * search.
+ *
+ * Type IDs are held once, in sorted order, and records refer to them by
+ * index.
+ */
+class Entity_Index {
+  public:
+    Entity_Index() = default;
+
+    //! Makes an index of records whose types index type_names, which need
+    //! not be sorted or unique.
+    Entity_Index(std::vector<std::string> type_names,
+                 std::vector<Entity_Record> records);
+
+    const std::vector<std::string> &types() const { return type_names; }
+    const std::vector<Entity_Record> &records() const { return sorted; }
+    std::size_t size() const { return sorted.size(); }
+
+    //! Returns the index of a type ID in types(), if any record has it.
+    std::optional<uint32_t> type_index(std::string_view type) const;
+
+    //! Returns the records within a box, ordered by type.
+    std::vector<Entity_Record> query(const Bounding_Box &box) const;
+    //! Returns the records of one type within a box.
+    std::vector<Entity_Record> query(const Bounding_Box &box,
+                                     std::string_view type) const;
+
+    /**
+     * @brief Writes the index as a compact binary file.
+     *
+     * All values are big-endian.  The file holds the magic bytes "NBTE",
+     * the type count as a uint32 and each type ID (a uint16 length and
+     * UTF-8 bytes), then the record count as a uint64 and the records in
+     * order, each as its type index (uint32), kind and source (bytes),
+     * region X and Z (Ints), chunk index (uint16), offset (uint32) and X,
+     * Y and Z (Doubles).
+     */
+    void save(std::ostream &output) const;
+
+    //! Reads a file written by save().
+    //! @throw std::runtime_error if the file is not a valid index
+    static Entity_Index load(std::istream &input);
+
+  private:
+    std::vector<std::string> type_names;
+    std::vector<Entity_Record> sorted;
+
+    void add_matches(const Bounding_Box &box, uint32_t type,
+                     std::vector<Entity_Record> &matches) const;
+};
+
+/**
+ * @brief Indexes the entities and block entities of some region files.
+ *
+ * Chunks are read, inflated and walked on several threads.  Records are
+ * taken from the Entities and TileEntities Lists of each chunk's Level,
+ * the block_entities List of chunks from Minecraft 1.18, and the Entities
+ * List of each chunk of an entities file.  An entity is placed by its Pos
+ * and a block entity by its x, y and z; records with no id or position
+ * are left out, as are riders within Passengers.
+ *
+ * @param region_files files of a world's region directory, named r.X.Z.mca
+ * @param entity_files files of a world's entities directory, named likewise
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * @throw std::runtime_error if a chunk cannot be read or decoded
+ */
+Entity_Index build_entity_index(const std::vector<std::string> &region_files,
+                                const std::vector<std::string> &entity_files,
+                                unsigned thread_count = 0);
+
+//! Indexes the entities and block entities of a world directory, from
+//! its region directory and, if there is one, its entities directory.
+Entity_Index build_world_entity_index(const std::string &world_directory,
+                                      unsigned thread_count = 0);
+
+} // namespace nbtview
+
+#endif // NBT_ENTITIES_H_
@@ -0,0 +1,514 @@
+// Hash.cpp
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Deserializer.hpp"
+#include "Hash.hpp"
+#include "Tag.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    constexpr uint64_t k0 = 0xa0761d6478bd642full;
+    constexpr uint64_t k1 = 0xe7037ed1a0b428dbull;
+    constexpr uint64_t k2 = 0x8ebc6af09c88c6e3ull;
+    constexpr uint64_t k3 = 0x589965cc75374cc3ull;
+
+    // Arrays are hashed in blocks of this many bytes, whatever their source,
+    // so that a block can be staged in a fixed buffer when converting
+    // elements to big-endian.
+    constexpr std::size_t block_size = 4096;
+
+    // Multiplies a and b to 128 bits and folds the halves together.
+    inline uint64_t mum(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+        auto r = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+        // The product of the 32-bit halves, in four parts
+        uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+        uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+        uint64_t lo_lo = a_lo * b_lo;
+        uint64_t hi_lo = a_hi * b_lo;
+        uint64_t lo_hi = a_lo * b_hi;
+        uint64_t hi_hi = a_hi * b_hi;
+        uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+        uint64_t low = (middle << 32) | (lo_lo & 0xffffffff);
+        uint64_t high = hi_hi + (hi_lo >> 32) + (middle >> 32);
+        return low ^ high;
+#endif
+    }
+
+    inline uint64_t load64(const unsigned char *p) {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) {
+            v = std::byteswap(v);
+        }
+        return v;
+    }
+
+    inline uint64_t combine(uint64_t a, uint64_t b) {
+        return mum(a ^ k0, b ^ k2);
+    }
+
+    inline uint64_t container_seed(TypeCode type, TypeCode elt_type,
+                                   uint64_t count) {
+        return combine(combine(static_cast<uint64_t>(type),
+                               static_cast<uint64_t>(elt_type)),
+                       count);
+    }
+
+    inline uint64_t compound_entry(std::string_view name, uint64_t hash) {
+        return combine(hash_bytes(name.data(), name.size(), k3), hash);
+    }
+
+    uint64_t hash_blocks(const unsigned char *data, std::size_t length,
+                         uint64_t h) {
+        for (std::size_t start = 0; start < length; start += block_size) {
+            h = hash_bytes(data + start, std::min(block_size, length - start),
+                           h);
+        }
+        return h;
+    }
+
+    template <typename T> inline void store_big_endian(T value, void *out) {
+        using U = std::make_unsigned_t<
+            std::conditional_t<std::is_floating_point_v<T>,
+                               std::conditional_t<sizeof(T) == 4, int32_t,
+                                                  int64_t>,
+                               T>>;
+        auto bits = detail::swap_bytes<Big_Endian>(std::bit_cast<U>(value));
+        std::memcpy(out, &bits, sizeof(bits));
+    }
+
+    // Hashes count numeric values, obtained as get(i), as if they were
+    // encoded big-endian and contiguous.
+    template <typename T, typename Get>
+    uint64_t hash_numeric(std::size_t count, Get get, uint64_t h) {
+        const std::size_t block_length = block_size / sizeof(T);
+        unsigned char block[block_size];
+        for (std::size_t start = 0; start < count; start += block_length) {
+            std::size_t n = std::min(block_length, count - start);
+            for (std::size_t i = 0; i < n; ++i) {
+                store_big_endian(get(start + i), block + i * sizeof(T));
+            }
+            h = hash_bytes(block, n * sizeof(T), h);
+        }
+        return h;
+    }
+
+    template <typename T>
+    uint64_t hash_numeric(const std::vector<T> &values, uint64_t h) {
+        if constexpr (sizeof(T) == 1) {
+            return hash_blocks(
+                reinterpret_cast<const unsigned char *>(values.data()),
+                values.size(), h);
+        } else {
+            return hash_numeric<T>(
+                values.size(), [&](std::size_t i) { return values[i]; }, h);
+        }
+    }
+
+    template <typename T> uint64_t hash_scalar(T value) {
+        unsigned char bytes[sizeof(T)];
+        store_big_endian(value, bytes);
+        return hash_bytes(bytes, sizeof(T),
+                          static_cast<uint64_t>(typecode_of<T>));
+    }
+
+    template <typename T>
+    uint64_t hash_array(TypeCode type, const std::vector<T> &values) {
+        return hash_numeric(
+            values, container_seed(type, typecode_of<T>, values.size()));
+    }
+
+    template <typename T> uint64_t hash_scalar_list(const List &lst) {
+        return hash_numeric<T>(
+            lst.size(), [&](std::size_t i) { return lst[i].get<T>(); },
+            container_seed(TypeCode::List, typecode_of<T>, lst.size()));
+    }
+
+    // The hash of each Tag within a tree, keyed by its address
+    using Hash_Memo = std::unordered_map<const Tag *, uint64_t>;
+
+    // TagHasher is used with std::visit to compute the hash of a Tag.  If
+    // memo is set, the hash of every Tag within the tree is recorded in it.
+    struct TagHasher {
+        Hash_Memo *memo = nullptr;
+
+        uint64_t hash_child(const Tag &elt) {
+            auto h = std::visit(*this, elt.get_value());
+            if (memo != nullptr) {
+                memo->emplace(&elt, h);
+            }
+            return h;
+        }
+
+        uint64_t operator()(const None &) {
+            return static_cast<uint64_t>(TypeCode::None);
+        }
+        uint64_t operator()(const End &) {
+            return static_cast<uint64_t>(TypeCode::End);
+        }
+        uint64_t operator()(const Byte &t) { return hash_scalar(t); }
+        uint64_t operator()(const Short &t) { return hash_scalar(t); }
+        uint64_t operator()(const Int &t) { return hash_scalar(t); }
+        uint64_t operator()(const Long &t) { return hash_scalar(t); }
+        uint64_t operator()(const Float &t) { return hash_scalar(t); }
+        uint64_t operator()(const Double &t) { return hash_scalar(t); }
+        uint64_t operator()(const Byte_Array &t) {
+            return hash_array(TypeCode::Byte_Array, t);
+        }
+        uint64_t operator()(const String &t) {
+            return hash_bytes(t.data(), t.size(),
+                              static_cast<uint64_t>(TypeCode::String));
+        }
+        uint64_t operator()(const List &t) {
+            auto elt_type = list_type(t);
+            switch (elt_type) {
+            case TypeCode::Byte:
+                return hash_scalar_list<Byte>(t);
+            case TypeCode::Short:
+                return hash_scalar_list<Short>(t);
+            case TypeCode::Int:
+                return hash_scalar_list<Int>(t);
+            case TypeCode::Long:
+                return hash_scalar_list<Long>(t);
+            case TypeCode::Float:
+                return hash_scalar_list<Float>(t);
+            case TypeCode::Double:
+                return hash_scalar_list<Double>(t);
+            default:
+                break;
+            }
+            auto h = container_seed(TypeCode::List, elt_type, t.size());
+            for (const Tag &elt : t) {
+                h = combine(h, hash_child(elt));
+            }
+            return h;
+        }
+        uint64_t operator()(const Compound &t) {
+            uint64_t sum = 0;
+            for (auto &[name, elt] : t) {
+                sum +=
+                    compound_entry(name, hash_child(elt));
+            }
+            return combine(container_seed(TypeCode::Compound, TypeCode::End,
+                                          t.size()),
+                           sum);
+        }
+        uint64_t operator()(const Int_Array &t) {
+            return hash_array(TypeCode::Int_Array, t);
+        }
+        uint64_t operator()(const Long_Array &t) {
+            return hash_array(TypeCode::Long_Array, t);
+        }
+        uint64_t operator()(const Packed_List &t) {
+            if (t.empty()) {
+                return container_seed(TypeCode::List, TypeCode::End, 0);
+            }
+            return std::visit(
+                [this, &t](const auto &elements) {
+                    using T = typename std::remove_cvref_t<
+                        decltype(elements)>::value_type;
+                    if constexpr (std::is_arithmetic_v<T>) {
+                        return hash_array(TypeCode::List, elements);
+                    } else {
+                        // As for a List of the same elements
+                        auto h = container_seed(
+                            TypeCode::List, list_type(t), elements.size());
+                        for (const auto &elt : elements) {
+                            h = combine(h, (*this)(elt));
+                        }
+                        return h;
+                    }
+                },
+                t.storage());
+        }
+    };
+
+    std::size_t element_size(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+            return 1;
+        case TypeCode::Short:
+            return 2;
+        case TypeCode::Int:
+        case TypeCode::Float:
+            return 4;
+        case TypeCode::Long:
+        case TypeCode::Double:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    // Hashes the encoded elements of an array or numeric List in place.
+    uint64_t hash_encoded_elements(BinaryReader &reader, TypeCode type,
+                                   TypeCode elt_type, int32_t length) {
+        if (length < 0) {
+            throw std::runtime_error("Negative array length");
+        }
+        if (length == 0 && type == TypeCode::List) {
+            elt_type = TypeCode::End;
+        }
+        auto bytes = static_cast<std::size_t>(length) * element_size(elt_type);
+        if (bytes > reader.remaining_length()) {
+            throw UnexpectedEndOfInputException();
+        }
+        auto data = reader.read_string_view(bytes);
+        return hash_blocks(reinterpret_cast<const unsigned char *>(data.data()),
+                           data.size(),
+                           container_seed(type, elt_type, length));
+    }
+
+    // Hashes a payload nested depth containers deep; containers are
+    // hashed recursively, so their nesting is limited.
+    uint64_t hash_nested_payload(BinaryReader &reader, TypeCode type,
+                                 std::size_t depth, std::size_t max_depth) {
+        if ((type == TypeCode::List || type == TypeCode::Compound) &&
+            depth >= max_depth) {
+            throw LimitExceededException("NBT data is nested more than " +
+                                         std::to_string(max_depth) +
+                                         " levels deep");
+        }
+        switch (type) {
+        case TypeCode::Byte:
+        case TypeCode::Short:
+        case TypeCode::Int:
+        case TypeCode::Long:
+        case TypeCode::Float:
+        case TypeCode::Double: {
+            auto value = reader.read_string_view(element_size(type));
+            return hash_bytes(value.data(), value.size(),
+                              static_cast<uint64_t>(type));
+        }
+        case TypeCode::Byte_Array:
+            return hash_encoded_elements(reader, type, TypeCode::Byte,
+                                         reader.read<int32_t>());
+        case TypeCode::Int_Array:
+            return hash_encoded_elements(reader, type, TypeCode::Int,
+                                         reader.read<int32_t>());
+        case TypeCode::Long_Array:
+            return hash_encoded_elements(reader, type, TypeCode::Long,
+                                         reader.read<int32_t>());
+        case TypeCode::String: {
+            auto str = reader.read_string_view(reader.read<uint16_t>());
+            return hash_bytes(str.data(), str.size(),
+                              static_cast<uint64_t>(TypeCode::String));
+        }
+        case TypeCode::List: {
+            auto elt_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            if (element_size(elt_type) != 0) {
+                return hash_encoded_elements(reader, type, elt_type, length);
+            }
+            if (length <= 0) {
+                return container_seed(TypeCode::List, TypeCode::End, 0);
+            }
+            auto h = container_seed(TypeCode::List, elt_type, length);
+            for (int32_t i = 0; i < length; ++i) {
+                h = combine(h, hash_nested_payload(reader, elt_type,
+                                                   depth + 1, max_depth));
+            }
+            return h;
+        }
+        case TypeCode::Compound: {
+            uint64_t sum = 0;
+            uint64_t count = 0;
+            while (true) {
+                auto elt_type = static_cast<TypeCode>(reader.read<int8_t>());
+                if (elt_type == TypeCode::End) {
+                    break;
+                }
+                auto name = reader.read_string_view(reader.read<uint16_t>());
+                sum += compound_entry(
+                    name, hash_nested_payload(reader, elt_type, depth + 1,
+                                              max_depth));
+                ++count;
+            }
+            return combine(
+                container_seed(TypeCode::Compound, TypeCode::End, count), sum);
+        }
+        default:
+            throw std::runtime_error("Unhandled tag type");
+        }
+    }
+
+} // namespace
+
+uint64_t hash_bytes(const void *data, std::size_t length, uint64_t seed) {
+    auto p = static_cast<const unsigned char *>(data);
+    seed ^= mum(seed ^ k0, k1);
+    std::size_t i = length;
+    if (i > 48) {
+        // Three independent lanes keep several multiplies in flight.
+        uint64_t seed1 = seed;
+        uint64_t seed2 = seed;
+        do {
+            seed = mum(load64(p) ^ k1, load64(p + 8) ^ seed);
+            seed1 = mum(load64(p + 16) ^ k2, load64(p + 24) ^ seed1);
+            seed2 = mum(load64(p + 32) ^ k3, load64(p + 40) ^ seed2);
+            p += 48;
+            i -= 48;
+        } while (i > 48);
+        seed ^= seed1 ^ seed2;
+    }
+    while (i > 16) {
+        seed = mum(load64(p) ^ k1, load64(p + 8) ^ seed);
+        p += 16;
+        i -= 16;
+    }
+    unsigned char tail[16] = {};
+    std::memcpy(tail, p, i);
+    return mum(k1 ^ length, mum(load64(tail) ^ k1, load64(tail + 8) ^ seed));
+}
+
+uint64_t hash_tag(const Tag &tag) {
+    return std::visit(TagHasher(), tag.get_value());
+}
+
+uint64_t hash_payload(BinaryReader &reader, TypeCode type,
+                      const read_options &options) {
+    return hash_nested_payload(reader, type, 0, options.max_depth);
+}
+
+uint64_t hash_binary(const unsigned char *data, std::size_t data_length,
+                     const read_options &options) {
+    std::vector<unsigned char> inflated_data_holder;
+    if (has_compression_header(data, data_length)) {
+        inflated_data_holder = decompress_data(data, data_length);
+        data = inflated_data_holder.data();
+        data_length = inflated_data_holder.size();
+    }
+    BinaryReader reader(data, data_length);
+    auto type = static_cast<TypeCode>(reader.read<int8_t>());
+    if (type == TypeCode::End) {
+        throw std::runtime_error("Root tag is an End tag");
+    }
+    reader.skip(reader.read<uint16_t>());
+    return hash_payload(reader, type, options);
+}
+
+namespace {
+
+    // Returns the elements of a List which holds Tags of a non-numeric type,
+    // or nullptr for any other tag.
+    const List *tag_list(const Tag &tag) {
+        if (!tag.is<List>()) {
+            return nullptr;
+        }
+        auto &lst = tag.get<List>();
+        return element_size(list_type(lst)) == 0 ? &lst : nullptr;
+    }
+
+    // State of a diff: the hash of every Tag in each tree, computed once
+    // beforehand, and the differences found so far
+    struct Diff_State {
+        Hash_Memo memo_a;
+        Hash_Memo memo_b;
+        std::vector<Difference> out;
+    };
+
+    void diff_tags(const Tag &a, const Tag &b, std::string &path,
+                   Diff_State &state);
+
+    // Appends the differences between a and b, found at path, unless their
+    // hashes match.
+    void diff_child(const Tag &a, const Tag &b, std::string &path,
+                    Diff_State &state) {
+        if (state.memo_a.at(&a) != state.memo_b.at(&b)) {
+            diff_tags(a, b, path, state);
+        }
+    }
+
+    void diff_tags(const Tag &a, const Tag &b, std::string &path,
+                   Diff_State &state) {
+        auto &out = state.out;
+        auto parent_length = path.size();
+        if (a.is<Compound>() && b.is<Compound>()) {
+            auto &lhs = a.get<Compound>();
+            auto &rhs = b.get<Compound>();
+            auto append_key = [&](const std::string &key) {
+                path.resize(parent_length);
+                if (!path.empty()) {
+                    path += '.';
+                }
+                path += key;
+            };
+            auto it_a = lhs.begin();
+            auto it_b = rhs.begin();
+            while (it_a != lhs.end() || it_b != rhs.end()) {
+                if (it_b == rhs.end() ||
+                    (it_a != lhs.end() && it_a->first < it_b->first)) {
+                    append_key(it_a->first);
+                    out.push_back({Difference::Kind::removed, path});
+                    ++it_a;
+                } else if (it_a == lhs.end() || it_b->first < it_a->first) {
+                    append_key(it_b->first);
+                    out.push_back({Difference::Kind::added, path});
+                    ++it_b;
+                } else {
+                    append_key(it_a->first);
+                    diff_child(it_a->second, it_b->second, path, state);
+                    ++it_a;
+                    ++it_b;
+                }
+            }
+        } else if (auto lhs = tag_list(a), rhs = tag_list(b);
+                   lhs != nullptr && rhs != nullptr &&
+                   list_type(*lhs) == list_type(*rhs)) {
+            auto append_index = [&](std::size_t i) {
+                path.resize(parent_length);
+                path += '[';
+                path += std::to_string(i);
+                path += ']';
+            };
+            auto common = std::min(lhs->size(), rhs->size());
+            for (std::size_t i = 0; i < common; ++i) {
+                append_index(i);
+                diff_child((*lhs)[i], (*rhs)[i], path, state);
+            }
+            for (std::size_t i = common; i < lhs->size(); ++i) {
+                append_index(i);
+                out.push_back({Difference::Kind::removed, path});
+            }
+            for (std::size_t i = common; i < rhs->size(); ++i) {
+                append_index(i);
+                out.push_back({Difference::Kind::added, path});
+            }
+        } else {
+            out.push_back({Difference::Kind::changed, path});
+        }
+        path.resize(parent_length);
+    }
+
+} // namespace
+
+std::vector<Difference> diff(const Tag &a, const Tag &b) {
+    Diff_State state;
+    state.memo_a.emplace(&a,
+                         std::visit(TagHasher{&state.memo_a}, a.get_value()));
+    state.memo_b.emplace(&b,
+                         std::visit(TagHasher{&state.memo_b}, b.get_value()));
+    std::string path;
+    diff_child(a, b, path, state);
+    return std::move(state.out);
+}
+
+} // namespace nbtview
@@ -0,0 +1,88 @@
+/**
+ * @file Hash.hpp
+ * @brief Structural hashing and comparison of NBT trees
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_HASH_H_
+#define NBT_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Deserializer.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief A 64-bit non-cryptographic hash of a byte sequence
+ *
+ * The result depends only on the bytes and the seed, not on the host.
+ */
+uint64_t hash_bytes(const void *data, std::size_t length, uint64_t seed = 0);
+
+/** @name Structural hashing
+ * @{
+ * A structural hash depends only on the data held by a tag: the same tag
+ * decoded from any encoding, on any host, has the same hash.  Compound
+ * entries are hashed independently of their order, a List of a numeric type
+ * hashes the same whether or not it is a Packed_List, and all empty Lists
+ * hash alike whatever their declared element type.  The name of a root tag
+ * is not part of its hash.
+ *
+ * Arrays and numeric Lists are hashed in bulk over their big-endian
+ * encoding, so hashing encoded data needs no per-element decoding.
+ * */
+//! Returns the structural hash of a tag.
+uint64_t hash_tag(const Tag &tag);
+
+//! Returns the structural hash of the payload of a tag of the given type
+//! which starts at the reader's position, and advances past it.  Only
+//! options.max_depth is consulted: deeper nesting throws
+//! LimitExceededException.
+uint64_t hash_payload(BinaryReader &reader, TypeCode type,
+                      const read_options &options = {});
+
+//! Returns the structural hash of the root tag of binary NBT data, which
+//! may be zlib or gzip compressed, without decoding it into a Tag.
+uint64_t hash_binary(const unsigned char *data, std::size_t data_length,
+                     const read_options &options = {});
+/**
+ * @}
+ * */
+
+//! One difference between two trees, as reported by diff()
+struct Difference {
+    enum class Kind { added, removed, changed };
+
+    Kind kind;
+    //! Path of the differing tag, such as "Level.Sections[2].Y"; empty for
+    //! the root
+    std::string path;
+
+    bool operator==(const Difference &other) const = default;
+};
+
+/**
+ * @brief Lists the differences between two trees.
+ *
+ * Entries present in only one Compound are reported as added or removed,
+ * as are trailing elements of Lists of unequal length.  Compounds and
+ * non-numeric Lists present in both trees are compared entry by entry;
+ * any other differing tag is reported as changed.  Every subtree of both
+ * trees is hashed once, up front, and subtrees whose hashes match are not
+ * descended into.
+ * */
+std::vector<Difference> diff(const Tag &a, const Tag &b);
+
+} // namespace nbtview
+
+#endif // NBT_HASH_H_
@@ -0,0 +1,306 @@
+// IncrementalParser.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "IncrementalParser.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // Returns the size of a number, or of an element of an array; or 0 for
+    // other types.
+    std::size_t value_size(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+        case TypeCode::Byte_Array:
+            return 1;
+        case TypeCode::Short:
+            return 2;
+        case TypeCode::Int:
+        case TypeCode::Float:
+        case TypeCode::Int_Array:
+            return 4;
+        case TypeCode::Long:
+        case TypeCode::Double:
+        case TypeCode::Long_Array:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    bool is_number(TypeCode type) {
+        return type >= TypeCode::Byte && type <= TypeCode::Double;
+    }
+
+    template <typename T>
+    TagValue numeric_list(BinaryReader &reader, int32_t length,
+                          bool packed) {
+        if (packed) {
+            return Packed_List(reader.read_array<T>(length));
+        }
+        List lst;
+        lst.reserve(length);
+        for (int32_t i = 0; i < length; ++i) {
+            lst.emplace_back(reader.read<T>());
+        }
+        return lst;
+    }
+
+} // namespace
+
+Incremental_Parser::Incremental_Parser(const read_options &options)
+    : options(options) {
+    if (options.encoding != Binary_Encoding::big_endian) {
+        throw std::runtime_error("Incremental_Parser reads Java NBT only");
+    }
+    reset();
+}
+
+Parse_Status Incremental_Parser::feed(const unsigned char *data,
+                                      size_t data_length) {
+    size_t used = 0;
+    while (step != Step::complete) {
+        const unsigned char *bytes;
+        if (token.empty() && data_length - used >= token_length) {
+            // The whole token is at hand; read it in place.
+            bytes = data + used;
+            used += token_length;
+        } else {
+            // The token grows only as its bytes arrive, so a bogus length
+            // cannot make the parser allocate more than it is fed.
+            auto n = std::min(token_length - token.size(), data_length - used);
+            token.insert(token.end(), data + used, data + used + n);
+            used += n;
+            if (token.size() < token_length) {
+                break;
+            }
+            bytes = token.data();
+        }
+        finish_token(bytes);
+    }
+    last_consumed = used;
+    return complete() ? Parse_Status::complete : Parse_Status::need_more_input;
+}
+
+std::pair<std::string, Tag> Incremental_Parser::take_result() {
+    if (!complete()) {
+        throw std::logic_error("The root tag is not complete");
+    }
+    auto root = std::move(result);
+    reset();
+    return root;
+}
+
+void Incremental_Parser::reset() {
+    stack.clear();
+    element_count = 0;
+    name.clear();
+    result = {};
+    expect(Step::tag_type, 1);
+}
+
+void Incremental_Parser::count_elements(std::size_t n) {
+    element_count += n;
+    if (element_count > options.max_elements) {
+        throw LimitExceededException("NBT data has more than " +
+                                     std::to_string(options.max_elements) +
+                                     " tags");
+    }
+}
+
+void Incremental_Parser::expect(Step next, std::size_t length) {
+    step = next;
+    token.clear();
+    token_length = length;
+}
+
+void Incremental_Parser::finish_token(const unsigned char *bytes) {
+    BinaryReader reader(bytes, token_length);
+    switch (step) {
+    case Step::tag_type:
+        type = static_cast<TypeCode>(reader.read<int8_t>());
+        if (type != TypeCode::End) {
+            expect(Step::name_length, 2);
+        } else if (stack.empty()) {
+            result = {"", Tag(End())};
+            step = Step::complete;
+        } else {
+            close_container();
+        }
+        break;
+    case Step::name_length:
+        expect(Step::name, reader.read<uint16_t>());
+        break;
+    case Step::name:
+        name.assign(reinterpret_cast<const char *>(bytes), token_length);
+        count_elements(1);
+        start_payload();
+        break;
+    case Step::string_length:
+        expect(Step::value, reader.read<uint16_t>());
+        break;
+    case Step::array_length: {
+        auto length = reader.read<int32_t>();
+        if (length < 0) {
+            throw std::runtime_error("Negative array length");
+        }
+        element_length = length;
+        expect(Step::value, length * value_size(element_type));
+        break;
+    }
+    case Step::list_header: {
+        element_type = static_cast<TypeCode>(reader.read<int8_t>());
+        // A negative List length is read as an empty List.
+        auto length = std::max(reader.read<int32_t>(), 0);
+        if (is_number(element_type)) {
+            count_elements(length);
+            element_length = length;
+            expect(Step::value, length * value_size(element_type));
+        } else {
+            open_container(TypeCode::List, length);
+            next_tag();
+        }
+        break;
+    }
+    case Step::value:
+        add_value(decode_value(bytes));
+        break;
+    case Step::complete:
+        break;
+    }
+}
+
+void Incremental_Parser::start_payload() {
+    switch (type) {
+    case TypeCode::Compound:
+        open_container(TypeCode::Compound, 0);
+        next_tag();
+        break;
+    case TypeCode::List:
+        expect(Step::list_header, 5);
+        break;
+    case TypeCode::String:
+        expect(Step::string_length, 2);
+        break;
+    case TypeCode::Byte_Array:
+    case TypeCode::Int_Array:
+    case TypeCode::Long_Array:
+        element_type = type;
+        expect(Step::array_length, 4);
+        break;
+    default:
+        if (!is_number(type)) {
+            throw std::runtime_error("Unhandled tag type");
+        }
+        expect(Step::value, value_size(type));
+        break;
+    }
+}
+
+TagValue Incremental_Parser::decode_value(const unsigned char *bytes) const {
+    BinaryReader reader(bytes, token_length);
+    bool packed = options.packed_lists;
+    switch (type) {
+    case TypeCode::Byte:
+        return reader.read<Byte>();
+    case TypeCode::Short:
+        return reader.read<Short>();
+    case TypeCode::Int:
+        return reader.read<Int>();
+    case TypeCode::Long:
+        return reader.read<Long>();
+    case TypeCode::Float:
+        return reader.read<Float>();
+    case TypeCode::Double:
+        return reader.read<Double>();
+    case TypeCode::String:
+        return std::string(reinterpret_cast<const char *>(bytes),
+                           token_length);
+    case TypeCode::Byte_Array:
+        return reader.read_array<Byte>(element_length);
+    case TypeCode::Int_Array:
+        return reader.read_array<Int>(element_length);
+    case TypeCode::Long_Array:
+        return reader.read_array<Long>(element_length);
+    default:
+        break;
+    }
+    // A List of numbers
+    switch (element_type) {
+    case TypeCode::Byte:
+        return numeric_list<Byte>(reader, element_length, packed);
+    case TypeCode::Short:
+        return numeric_list<Short>(reader, element_length, packed);
+    case TypeCode::Int:
+        return numeric_list<Int>(reader, element_length, packed);
+    case TypeCode::Long:
+        return numeric_list<Long>(reader, element_length, packed);
+    case TypeCode::Float:
+        return numeric_list<Float>(reader, element_length, packed);
+    default:
+        return numeric_list<Double>(reader, element_length, packed);
+    }
+}
+
+void Incremental_Parser::add_value(TagValue value) {
+    if (stack.empty()) {
+        result = {std::move(name), Tag(std::move(value))};
+        step = Step::complete;
+        return;
+    }
+    auto &parent = stack.back().value;
+    if (auto cmpd = std::get_if<Compound>(&parent)) {
+        cmpd->emplace(std::move(name), std::move(value));
+    } else {
+        detail::append_element(parent, std::move(value));
+    }
+    next_tag();
+}
+
+void Incremental_Parser::next_tag() {
+    auto &top = stack.back();
+    if (std::holds_alternative<Compound>(top.value)) {
+        expect(Step::tag_type, 1);
+    } else if (top.remaining > 0) {
+        --top.remaining;
+        count_elements(1);
+        type = top.list_type;
+        name.clear();
+        start_payload();
+    } else {
+        close_container();
+    }
+}
+
+void Incremental_Parser::open_container(TypeCode container_type,
+                                        int32_t length) {
+    if (stack.size() >= options.max_depth) {
+        throw LimitExceededException("NBT data is nested more than " +
+                                     std::to_string(options.max_depth) +
+                                     " levels deep");
+    }
+    Frame frame{Compound(), std::move(name), element_type, length};
+    if (container_type == TypeCode::List) {
+        frame.value = detail::empty_list(element_type, options, 0);
+    }
+    stack.push_back(std::move(frame));
+}
+
+void Incremental_Parser::close_container() {
+    auto frame = std::move(stack.back());
+    stack.pop_back();
+    name = std::move(frame.name);
+    add_value(std::move(frame.value));
+}
+
+} // namespace nbtview
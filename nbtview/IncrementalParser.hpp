@@ -0,0 +1,136 @@
+/**
+ * @file IncrementalParser.hpp
+ * @brief Decode binary NBT data which arrives in fragments
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_INCREMENTALPARSER_H_
+#define NBT_INCREMENTALPARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Deserializer.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! Result of Incremental_Parser::feed()
+enum class Parse_Status {
+    //! The root tag is not yet complete; feed more input.
+    need_more_input,
+    //! The root tag is complete; take it with take_result().
+    complete,
+};
+
+/**
+ * @brief Incremental_Parser decodes uncompressed binary NBT data fed to it
+ * in fragments of any size, such as network packets or reads from a pipe.
+ *
+ * The parser keeps its place between calls to feed(): each byte is
+ * examined once, and only the bytes of a single incomplete value (a name,
+ * number, String or array) are held back until the rest of it arrives.
+ * Containers are built on an explicit stack, as in BinaryDeserializer, and
+ * the limits of read_options apply.  The result is the same as that of
+ * read_binary() on the whole input.
+ *
+ * Input must be Java NBT; the Bedrock encodings are not supported.
+ */
+class Incremental_Parser {
+  public:
+    //! @throw std::runtime_error if options selects a Bedrock encoding
+    explicit Incremental_Parser(const read_options &options = {});
+
+    /**
+     * @brief Decodes as much of a fragment as possible.
+     *
+     * Once the root tag is complete, bytes after it are left unread, so
+     * that several tags may be read from one stream; consumed() gives the
+     * number of bytes used.  Feeding a parser which is complete reads
+     * nothing.
+     *
+     * @throw std::runtime_error if the input is not valid NBT, and
+     * LimitExceededException if it exceeds a limit of read_options; the
+     * parser must then be reset.
+     */
+    Parse_Status feed(const unsigned char *data, size_t data_length);
+
+    //! Number of bytes of the last fragment used by feed()
+    size_t consumed() const { return last_consumed; }
+
+    bool complete() const { return step == Step::complete; }
+
+    //! Returns the decoded root tag's name and payload, and resets the
+    //! parser for the next root tag.
+    //! @throw std::logic_error if the root tag is not complete
+    std::pair<std::string, Tag> take_result();
+
+    //! Forgets any partial input, to begin a new root tag.
+    void reset();
+
+  private:
+    // What the parser expects next
+    enum class Step {
+        tag_type,
+        name_length,
+        name,
+        string_length,
+        array_length,
+        list_header,
+        value,
+        complete,
+    };
+
+    // A Compound or List which is being read
+    struct Frame {
+        TagValue value;
+        std::string name;
+        TypeCode list_type;
+        int32_t remaining;
+    };
+
+    read_options options;
+    Step step = Step::tag_type;
+    std::vector<Frame> stack;
+    std::size_t element_count = 0;
+    std::size_t last_consumed = 0;
+
+    // The tag being read, and the bytes of its token when they arrive in
+    // more than one fragment
+    TypeCode type = TypeCode::End;
+    std::string name;
+    std::vector<unsigned char> token;
+    std::size_t token_length = 0;
+    // Element type and count, for arrays and Lists of numbers
+    TypeCode element_type = TypeCode::End;
+    int32_t element_length = 0;
+
+    std::pair<std::string, Tag> result;
+
+    void count_elements(std::size_t n);
+    void expect(Step next, std::size_t length);
+
+    //! Acts on a completed token.
+    void finish_token(const unsigned char *bytes);
+    //! Starts the payload of the tag whose type and name have been read.
+    void start_payload();
+    //! Adds a completed value to its container, or completes the root.
+    void add_value(TagValue value);
+    //! Moves on to the next tag of the innermost container.
+    void next_tag();
+    void open_container(TypeCode container_type, int32_t length);
+    //! Pops the completed container on top of the stack into its parent.
+    void close_container();
+    TagValue decode_value(const unsigned char *bytes) const;
+};
+
+} // namespace nbtview
+
+#endif // NBT_INCREMENTALPARSER_H_
@@ -0,0 +1,64 @@
+// KeyTable.cpp
+
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "KeyTable.hpp"
+
+namespace nbtview {
+
+KeyTable::~KeyTable() {
+    for (auto &segment : segments) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+std::optional<Key> KeyTable::find(std::string_view name) const {
+    std::shared_lock lock(mutex);
+    auto it = index.find(name);
+    if (it == index.end()) {
+        return std::nullopt;
+    }
+    return Key{it->second};
+}
+
+Key KeyTable::intern(std::string_view name) {
+    if (auto key = find(name)) {
+        return *key;
+    }
+
+    std::unique_lock lock(mutex);
+    // Another thread may have interned name since find() released its lock.
+    auto it = index.find(name);
+    if (it != index.end()) {
+        return Key{it->second};
+    }
+    if (count == max_segments * segment_length) {
+        throw std::length_error("KeyTable is full");
+    }
+    auto segment_index = count >> segment_bits;
+    auto segment = segments[segment_index].load(std::memory_order_relaxed);
+    if (segment == nullptr) {
+        segment = new std::string[segment_length];
+        segments[segment_index].store(segment, std::memory_order_release);
+    }
+    auto &stored = segment[count & (segment_length - 1)];
+    stored = name;
+    index.emplace(stored, count);
+    return Key{count++};
+}
+
+std::size_t KeyTable::size() const {
+    std::shared_lock lock(mutex);
+    return count;
+}
+
+KeyTable &KeyTable::global() {
+    static KeyTable table;
+    return table;
+}
+
+} // namespace nbtview
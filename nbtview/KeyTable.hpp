@@ -0,0 +1,82 @@
+/**
+ * @file KeyTable.hpp
+ * @brief A thread-safe table of interned Compound key names
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_KEYTABLE_H_
+#define NBT_KEYTABLE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace nbtview {
+
+//! Handle to a name interned in a KeyTable; equal names have equal Keys.
+struct Key {
+    uint32_t id;
+    bool operator==(const Key &other) const = default;
+};
+
+/**
+ * @brief KeyTable interns key names so that each distinct name is stored
+ * once and can be compared by its Key alone.
+ *
+ * intern() and find() may be called concurrently from any number of
+ * threads.  name() does not lock: the storage for an interned name never
+ * moves or changes once it has been published.
+ */
+class KeyTable {
+  public:
+    KeyTable() = default;
+    KeyTable(const KeyTable &) = delete;
+    KeyTable &operator=(const KeyTable &) = delete;
+    ~KeyTable();
+
+    //! Returns the Key for name, adding name to the table if necessary.
+    Key intern(std::string_view name);
+
+    //! Returns the Key for name if it has been interned.
+    std::optional<Key> find(std::string_view name) const;
+
+    //! Returns the name for a Key obtained from this table.
+    std::string_view name(Key key) const {
+        auto segment = segments[key.id >> segment_bits].load(
+            std::memory_order_acquire);
+        return segment[key.id & (segment_length - 1)];
+    }
+
+    //! Number of interned names
+    std::size_t size() const;
+
+    //! A process-wide table, for sharing keys between trees
+    static KeyTable &global();
+
+  private:
+    static const std::size_t segment_bits = 12;
+    static const std::size_t segment_length = std::size_t(1) << segment_bits;
+    static const std::size_t max_segments = 1024;
+
+    // Names are stored in fixed-size segments which are allocated as
+    // needed and never reallocated, so that views of them stay valid.
+    std::array<std::atomic<std::string *>, max_segments> segments{};
+    std::unordered_map<std::string_view, uint32_t> index;
+    uint32_t count = 0;
+    mutable std::shared_mutex mutex;
+};
+
+} // namespace nbtview
+
+#endif // NBT_KEYTABLE_H_
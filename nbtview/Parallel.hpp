@@ -0,0 +1,132 @@
+/**
+ * @file Parallel.hpp
+ * @brief A minimal pool of worker threads for independent tasks, such as
+ * the chunks of region files
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_PARALLEL_H_
+#define NBT_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Region.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace detail {
+
+    //! Returns the number of workers parallel_for() uses for count tasks;
+    //! a thread_count of 0 means one per hardware thread.
+    inline unsigned worker_count(unsigned thread_count, std::size_t count) {
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return static_cast<unsigned>(
+            std::max<std::size_t>(1, std::min<std::size_t>(thread_count,
+                                                           count)));
+    }
+
+    /**
+     * @brief Calls fn(index, worker) for each index in [0, count).
+     *
+     * Tasks are handed out in order to worker_count(thread_count, count)
+     * workers, numbered from 0, one of which is the calling thread; so
+     * state indexed by worker is never shared.  After a task throws, no
+     * more are started, and the exception is rethrown once every worker
+     * has finished.
+     */
+    template <typename Fn>
+    void parallel_for(std::size_t count, unsigned thread_count, Fn fn) {
+        std::atomic<std::size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto work = [&](unsigned worker) {
+            try {
+                for (auto i = next++; i < count; i = next++) {
+                    fn(i, worker);
+                }
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        };
+        std::vector<std::thread> workers;
+        auto workers_wanted = worker_count(thread_count, count);
+        for (unsigned w = 1; w < workers_wanted; ++w) {
+            workers.emplace_back(work, w);
+        }
+        work(0);
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    //! Chunks of a region file are handed out in jobs of this many
+    inline constexpr int chunk_job_length = 128;
+
+    //! Returns the number of workers for_each_chunk() uses for file_count
+    //! region files.
+    inline unsigned chunk_worker_count(unsigned thread_count,
+                                       std::size_t file_count) {
+        return worker_count(thread_count, file_count * (Region::chunk_count /
+                                                        chunk_job_length));
+    }
+
+    /**
+     * @brief Calls fn(file, chunk_index, data, data_length, worker) for
+     * each chunk present in some region files, with its inflated data.
+     *
+     * file is an index into filenames.  Chunks are read, inflated and
+     * handled by the workers of parallel_for(), each of which opens the
+     * region files it needs.  The data of an external chunk is read from
+     * its file c.X.Z.mcc, as by Region_File::get_chunk_data().
+     */
+    template <typename Fn>
+    void for_each_chunk(const std::vector<std::string> &filenames,
+                        unsigned thread_count, Fn fn) {
+        const std::size_t jobs_per_file =
+            Region::chunk_count / chunk_job_length;
+        auto run_job = [&](std::size_t job, unsigned worker) {
+            auto file = job / jobs_per_file;
+            int first = static_cast<int>(job % jobs_per_file) *
+                        chunk_job_length;
+            Region_File region(filenames[file]);
+            for (int i = first; i < first + chunk_job_length; ++i) {
+                if (region.chunk_length(i) == 0) {
+                    continue;
+                }
+                auto data = region.get_chunk_data(i);
+                if (has_compression_header(data.data(), data.size())) {
+                    data = decompress_data(data.data(), data.size());
+                }
+                fn(file, i, data.data(), data.size(), worker);
+            }
+        };
+        parallel_for(filenames.size() * jobs_per_file, thread_count,
+                     run_job);
+    }
+
+} // namespace detail
+
+} // namespace nbtview
+
+#endif // NBT_PARALLEL_H_
@@ -0,0 +1,389 @@
+/**
+ * @file Pipeline.hpp
+ * @brief A staged pipeline which reads, inflates and parses the chunks of
+ * region files on separate threads
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_PIPELINE_H_
+#define NBT_PIPELINE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace detail {
+
+    /**
+     * @brief A bounded queue for several producers and consumers, which
+     * never takes a lock.
+     *
+     * Each cell carries a sequence number telling whether it is ready to
+     * be written or read at a given position, so that producers and
+     * consumers claim positions with a single compare-and-swap.  The depth
+     * is rounded up to a power of two, and is at least 2.
+     */
+    template <typename T> class Bounded_Queue {
+      public:
+        explicit Bounded_Queue(std::size_t depth) {
+            std::size_t capacity = 2;
+            while (capacity < depth) {
+                capacity *= 2;
+            }
+            cells = std::make_unique<Cell[]>(capacity);
+            for (std::size_t i = 0; i < capacity; ++i) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            mask = capacity - 1;
+        }
+
+        std::size_t capacity() const { return mask + 1; }
+
+        //! Moves value into the queue, unless it is full.
+        bool try_push(T &value) {
+            auto position = tail.load(std::memory_order_relaxed);
+            while (true) {
+                auto &cell = cells[position & mask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto lag = static_cast<std::intptr_t>(sequence - position);
+                if (lag == 0) {
+                    if (tail.compare_exchange_weak(
+                            position, position + 1,
+                            std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1,
+                                            std::memory_order_release);
+                        return true;
+                    }
+                } else if (lag < 0) {
+                    return false;
+                } else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        //! Moves the oldest value out of the queue, unless it is empty.
+        bool try_pop(T &value) {
+            auto position = head.load(std::memory_order_relaxed);
+            while (true) {
+                auto &cell = cells[position & mask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto lag =
+                    static_cast<std::intptr_t>(sequence - (position + 1));
+                if (lag == 0) {
+                    if (head.compare_exchange_weak(
+                            position, position + 1,
+                            std::memory_order_relaxed)) {
+                        value = std::move(*cell.value);
+                        cell.value.reset();
+                        cell.sequence.store(position + mask + 1,
+                                            std::memory_order_release);
+                        return true;
+                    }
+                } else if (lag < 0) {
+                    return false;
+                } else {
+                    position = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+      private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            std::optional<T> value;
+        };
+        std::unique_ptr<Cell[]> cells;
+        std::size_t mask;
+        // Kept on separate cache lines, as producers and consumers each
+        // write only one of them.
+        alignas(64) std::atomic<std::size_t> head = 0;
+        alignas(64) std::atomic<std::size_t> tail = 0;
+    };
+
+    /**
+     * @brief Links two stages of a pipeline: a Bounded_Queue which
+     * producers block on while it is full, and consumers while it is
+     * empty, until every producer is done or the pipeline stops.
+     *
+     * A blocked thread spins briefly, in case the queue is about to
+     * change, then parks on an atomic wait until the other side pushes or
+     * pops, so that idle stages do not take cores from busy ones.
+     */
+    template <typename T> class Pipeline_Link {
+      public:
+        Pipeline_Link(std::size_t depth, unsigned producer_count,
+                      const std::atomic<bool> &stopped)
+            : queue(depth), producers(producer_count), stopped(stopped) {}
+
+        //! Returns false if the pipeline stopped first.
+        bool push(T value) {
+            for (int attempt = 0;; ++attempt) {
+                // Read before trying, so that a pop after a failed try
+                // changes it, and the wait below returns at once.
+                auto seen = pops.load(std::memory_order_acquire);
+                if (queue.try_push(value)) {
+                    signal(pushes, false);
+                    return true;
+                }
+                if (stopped.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                pause(pops, seen, attempt);
+            }
+        }
+
+        //! Returns false once the queue is empty and every producer is
+        //! done, or if the pipeline stopped.
+        bool pop(T &value) {
+            for (int attempt = 0;; ++attempt) {
+                auto seen = pushes.load(std::memory_order_acquire);
+                if (queue.try_pop(value)) {
+                    signal(pops, false);
+                    return true;
+                }
+                if (stopped.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                if (producers.load(std::memory_order_acquire) == 0) {
+                    // Values pushed before the last producer finished are
+                    // visible now.
+                    return queue.try_pop(value);
+                }
+                pause(pushes, seen, attempt);
+            }
+        }
+
+        //! Called by each producer once it has pushed its last value.
+        void producer_done() {
+            producers.fetch_sub(1, std::memory_order_release);
+            signal(pushes, true);
+        }
+
+        //! Wakes every parked thread, to see that the pipeline stopped.
+        void wake_all() {
+            signal(pushes, true);
+            signal(pops, true);
+        }
+
+      private:
+        // Number of tries which spin before a blocked thread parks
+        static constexpr int spin_attempts = 16;
+
+        Bounded_Queue<T> queue;
+        std::atomic<unsigned> producers;
+        const std::atomic<bool> &stopped;
+        // Counts of pushes and pops, which parked consumers and producers
+        // wait on to change
+        alignas(64) std::atomic<uint32_t> pushes = 0;
+        alignas(64) std::atomic<uint32_t> pops = 0;
+
+        static void signal(std::atomic<uint32_t> &count, bool all) {
+            count.fetch_add(1, std::memory_order_release);
+            if (all) {
+                count.notify_all();
+            } else {
+                count.notify_one();
+            }
+        }
+
+        static void pause(const std::atomic<uint32_t> &count, uint32_t seen,
+                          int attempt) {
+            if (attempt < spin_attempts) {
+                std::this_thread::yield();
+            } else {
+                count.wait(seen, std::memory_order_acquire);
+            }
+        }
+    };
+
+} // namespace detail
+
+//! The depth of the queues between the stages of run_pipeline(), and the
+//! number of threads of each stage.  A stage with 0 threads takes those of
+//! the hardware threads which the other stage does not; if both are 0,
+//! they take half each.
+struct Pipeline_Options {
+    std::size_t queue_depth = 64;
+    unsigned inflate_threads = 0;
+    unsigned parse_threads = 0;
+};
+
+//! A chunk passing through run_pipeline()
+struct Pipeline_Chunk {
+    //! Index of the region file in the list given
+    std::size_t file = 0;
+    //! Index of the chunk within its region
+    int chunk = 0;
+    //! The chunk's data: compressed on its way to the inflate stage, then
+    //! uncompressed
+    std::vector<unsigned char> data;
+};
+
+/**
+ * @brief Reads, inflates and parses the chunks of some region files in a
+ * pipeline of stages, each on its own threads.
+ *
+ * One thread reads each chunk's compressed data from the region files in
+ * turn, as by Region_File::get_chunk_data(), so that an external chunk is
+ * read from its file c.X.Z.mcc.  A pool of inflate workers inflates them, and a pool of parse
+ * workers calls parse(const Pipeline_Chunk &) on each, returning a Result.
+ * The calling thread is the consumer, calling consume(file, chunk, Result
+ * &&) with each result as it arrives, which need not be in order of file
+ * and chunk.  Result must be default-constructible and movable.
+ *
+ * Stages are linked by Bounded_Queues of options.queue_depth, so a stage
+ * which runs ahead blocks until the next one catches up, and at most a
+ * few queues' worth of chunks are held in memory at once.  Reading from
+ * disk thus overlaps inflating and parsing, rather than alternating with
+ * them as in a simple loop.
+ *
+ * If any stage throws, every stage stops, and the first exception is
+ * rethrown once all the threads have finished.
+ */
+template <typename Result, typename Parse, typename Consume>
+void run_pipeline(const std::vector<std::string> &filenames, Parse parse,
+                  Consume consume, const Pipeline_Options &options = {}) {
+    struct Parsed {
+        std::size_t file = 0;
+        int chunk = 0;
+        Result result;
+    };
+    // The two pools share the hardware threads, rather than each taking
+    // all of them.
+    const auto many = std::numeric_limits<std::size_t>::max();
+    auto hardware_threads = detail::worker_count(0, many);
+    auto inflate_threads = options.inflate_threads;
+    auto parse_threads = options.parse_threads;
+    if (inflate_threads == 0 && parse_threads == 0) {
+        inflate_threads = std::max(1u, hardware_threads / 2);
+    }
+    auto remaining = [&](unsigned other) {
+        return other < hardware_threads ? hardware_threads - other : 1u;
+    };
+    if (inflate_threads == 0) {
+        inflate_threads = remaining(parse_threads);
+    }
+    if (parse_threads == 0) {
+        parse_threads = remaining(inflate_threads);
+    }
+
+    std::atomic<bool> stopped = false;
+    detail::Pipeline_Link<Pipeline_Chunk> compressed(options.queue_depth, 1,
+                                                     stopped);
+    detail::Pipeline_Link<Pipeline_Chunk> inflated(
+        options.queue_depth, inflate_threads, stopped);
+    detail::Pipeline_Link<Parsed> parsed(options.queue_depth, parse_threads,
+                                         stopped);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto fail = [&] {
+        {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            stopped = true;
+        }
+        compressed.wake_all();
+        inflated.wake_all();
+        parsed.wake_all();
+    };
+
+    auto read_stage = [&] {
+        try {
+            for (std::size_t f = 0; f < filenames.size() && !stopped; ++f) {
+                Region_File region(filenames[f]);
+                for (int i = 0; i < Region::chunk_count; ++i) {
+                    if (region.chunk_length(i) == 0) {
+                        continue;
+                    }
+                    if (!compressed.push({f, i, region.get_chunk_data(i)})) {
+                        break;
+                    }
+                }
+            }
+        } catch (...) {
+            fail();
+        }
+        compressed.producer_done();
+    };
+    auto inflate_stage = [&] {
+        try {
+            Pipeline_Chunk chunk;
+            while (compressed.pop(chunk)) {
+                auto &data = chunk.data;
+                if (has_compression_header(data.data(), data.size())) {
+                    data = decompress_data(data.data(), data.size());
+                }
+                if (!inflated.push(std::move(chunk))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            fail();
+        }
+        inflated.producer_done();
+    };
+    auto parse_stage = [&] {
+        try {
+            Pipeline_Chunk chunk;
+            while (inflated.pop(chunk)) {
+                if (!parsed.push({chunk.file, chunk.chunk, parse(chunk)})) {
+                    break;
+                }
+            }
+        } catch (...) {
+            fail();
+        }
+        parsed.producer_done();
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(read_stage);
+    for (unsigned t = 0; t < inflate_threads; ++t) {
+        threads.emplace_back(inflate_stage);
+    }
+    for (unsigned t = 0; t < parse_threads; ++t) {
+        threads.emplace_back(parse_stage);
+    }
+    try {
+        Parsed item;
+        while (parsed.pop(item)) {
+            consume(item.file, item.chunk, std::move(item.result));
+        }
+    } catch (...) {
+        fail();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace nbtview
+
+#endif // NBT_PIPELINE_H_
@@ -1,10 +1,21 @@
 // Region.cpp
 
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
 #include <fstream>
 #include <ios>
+#include <iterator>
+#include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define NBTVIEW_HAVE_GETPID 1
+#endif
+
 #include "Region.hpp"
 
 namespace nbtview {
@@ -72,7 +83,7 @@ uint32_t chunk_data_length(const std::vector<unsigned char> &chunk_header) {
     }
     uint32_t length = (chunk_header[0] << 24) + (chunk_header[1] << 16) +
                       (chunk_header[2] << 8) + chunk_header[3];
-    uint8_t compression_type = chunk_header[4];
+    uint8_t compression_type = chunk_header[4] & ~Region::external_flag;
     if (compression_type > 3) {
         throw std::runtime_error("Chunk header has unknown compression type.");
     }
@@ -90,6 +101,9 @@ std::vector<unsigned char> Region_File::get_chunk_data(int chunk_index) {
     uint64_t chunk_offset = Region::sector_length * sector_offset;
     auto chunk_header = read_data(chunk_offset, chunk_header_length);
     uint32_t data_length = chunk_data_length(chunk_header);
+    if (chunk_header[4] & Region::external_flag) {
+        return read_external_chunk(name, chunk_index);
+    }
 
     if ((data_length + 5) > sector_count * Region::sector_length) {
         throw std::runtime_error("Reported encoded chunk length exceeds "
@@ -101,4 +115,81 @@ std::vector<unsigned char> Region_File::get_chunk_data(int chunk_index) {
     return chunk_data;
 }
 
+bool parse_region_filename(const std::string &filename, int &region_x,
+                           int &region_z) {
+    auto name = std::filesystem::path(filename).filename().string();
+    const char *p = name.data();
+    const char *end = p + name.size();
+    if (name.size() < 9 || name.compare(0, 2, "r.") != 0 ||
+        name.compare(name.size() - 4, 4, ".mca") != 0) {
+        return false;
+    }
+    auto [x_end, x_error] = std::from_chars(p + 2, end - 4, region_x);
+    if (x_error != std::errc() || x_end >= end - 4 || *x_end != '.') {
+        return false;
+    }
+    auto [z_end, z_error] = std::from_chars(x_end + 1, end - 4, region_z);
+    return z_error == std::errc() && z_end == end - 4;
+}
+
+std::string external_chunk_path(const std::string &region_filename,
+                                int chunk_index) {
+    int region_x, region_z;
+    if (!parse_region_filename(region_filename, region_x, region_z)) {
+        return {};
+    }
+    auto chunk_x = region_x * Region::region_width +
+                   chunk_index % Region::region_width;
+    auto chunk_z = region_z * Region::region_width +
+                   chunk_index / Region::region_width;
+    auto name = "c." + std::to_string(chunk_x) + "." +
+                std::to_string(chunk_z) + ".mcc";
+    return (std::filesystem::path(region_filename).parent_path() / name)
+        .string();
+}
+
+std::vector<unsigned char>
+read_external_chunk(const std::string &region_filename, int chunk_index) {
+    auto path = external_chunk_path(region_filename, chunk_index);
+    if (path.empty()) {
+        throw std::runtime_error("Region file name " + region_filename +
+                                 " does not give the coordinates of its "
+                                 "external chunk");
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open external chunk file " +
+                                 path);
+    }
+    std::vector<unsigned char> data(std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>{});
+    if (file.bad()) {
+        throw std::runtime_error("Could not read external chunk file " +
+                                 path);
+    }
+    return data;
+}
+
+std::string temporary_path(const std::string &path) {
+    thread_local std::mt19937_64 random(std::random_device{}());
+    auto name = path + '.';
+#ifdef NBTVIEW_HAVE_GETPID
+    name += std::to_string(getpid()) + '.';
+#endif
+    return name + std::to_string(random()) + ".tmp";
+}
+
+std::vector<std::string> region_files(const std::string &directory) {
+    std::vector<std::string> files;
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        int x, z;
+        if (entry.is_regular_file() &&
+            parse_region_filename(entry.path().string(), x, z)) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
 } // namespace nbtview
@@ -14,6 +14,7 @@
 #include <array>
 #include <cstdint>
 #include <fstream>
+#include <string>
 #include <vector>
 
 namespace nbtview {
@@ -35,6 +36,10 @@ struct Region {
     //! Length of a region file data sector in bytes
     static const int sector_length = 4096;
 
+    //! Flag set in a chunk's compression type when its data is too large
+    //! for the region file, and is stored in a file c.X.Z.mcc beside it
+    static const uint8_t external_flag = 0x80;
+
     //! Contains the bytes for a single sector
     using Sector_Data = std::vector<unsigned char>;
 
@@ -79,7 +84,8 @@ class Region_File {
         return metadata.chunk.at(chunk_index).timestamp;
     }
 
-    //! Returns the encoded data for the given chunk
+    //! Returns the encoded data for the given chunk; that of an external
+    //! chunk is read from its file c.X.Z.mcc
     std::vector<unsigned char> get_chunk_data(int chunk_index);
 
   private:
@@ -91,6 +97,33 @@ class Region_File {
     Region::Sector_Data read_data(uint64_t offset, size_t data_length);
 };
 
+//! Parses the region coordinates from the name of a region file,
+//! r.X.Z.mca, which may be preceded by a directory.  Returns false if the
+//! name does not have that form.
+bool parse_region_filename(const std::string &filename, int &region_x,
+                           int &region_z);
+
+//! Returns the path of the file c.X.Z.mcc, beside a region file, which
+//! holds the data of an external chunk of the region; returns an empty
+//! string if the region file's name does not give its coordinates.
+std::string external_chunk_path(const std::string &region_filename,
+                                int chunk_index);
+
+//! Returns the encoded data of an external chunk of a region, the whole of
+//! the file c.X.Z.mcc beside the region file.  Throws std::runtime_error if
+//! the region file's name does not give its coordinates, or if that file
+//! cannot be read.
+std::vector<unsigned char>
+read_external_chunk(const std::string &region_filename, int chunk_index);
+
+//! Returns a name for a temporary file beside path, which no other process
+//! or thread writing path at the same time will choose.  Files kept beside
+//! region files are written under such a name, then renamed into place.
+std::string temporary_path(const std::string &path);
+
+//! Returns the paths of the region files r.X.Z.mca in a directory, sorted.
+std::vector<std::string> region_files(const std::string &directory);
+
 } // namespace nbtview
 
 #endif // NBT_REGION_H_
@@ -0,0 +1,237 @@
+// RegionIndex.cpp
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "BinaryWriter.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "RegionIndex.hpp"
+#include "Scanner.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    const char index_magic[4] = {'N', 'B', 'T', 'X'};
+
+    std::vector<std::string> split_path(const std::string &path) {
+        std::vector<std::string> names;
+        std::string_view rest = path;
+        while (true) {
+            auto dot = rest.find('.');
+            auto name = rest.substr(0, dot);
+            if (name.empty()) {
+                throw std::runtime_error("Invalid index path '" + path + "'");
+            }
+            names.emplace_back(name);
+            if (dot == std::string_view::npos) {
+                return names;
+            }
+            rest = rest.substr(dot + 1);
+        }
+    }
+
+    // True if a summary was made from the chunk which the region header
+    // now describes
+    bool is_current(const Chunk_Summary &summary, const Region_File &region,
+                    int i) {
+        return summary.timestamp == region.chunk_timestamp(i) &&
+               summary.sector_offset == region.chunk_offset(i) &&
+               summary.sector_count == region.chunk_length(i);
+    }
+
+} // namespace
+
+Region_Index::Region_Index(std::vector<std::string> paths)
+    : path_names(std::move(paths)) {
+    for (const auto &path : path_names) {
+        split_paths.push_back(split_path(path));
+    }
+}
+
+Chunk_Summary Region_Index::summarize(const unsigned char *data,
+                                      size_t data_length) const {
+    Chunk_Summary summary;
+    summary.inflated_length = static_cast<uint32_t>(data_length);
+    summary.hash = hash_bytes(data, data_length);
+    for (const auto &path : split_paths) {
+        auto location = find_tag(data, data_length, path);
+        summary.locations.push_back(
+            location.value_or(Tag_Location{TypeCode::None, 0, 0}));
+    }
+    return summary;
+}
+
+std::size_t Region_Index::update(const std::string &region_filename,
+                                 unsigned thread_count) {
+    Region_File region(region_filename);
+    std::vector<int> stale;
+    for (int i = 0; i < Region::chunk_count; ++i) {
+        if (region.chunk_length(i) == 0) {
+            chunks[i] = Chunk_Summary();
+        } else if (!is_current(chunks[i], region, i)) {
+            stale.push_back(i);
+        }
+    }
+
+    // Each worker reads through its own handle on the file.
+    std::vector<std::optional<Region_File>> files(
+        detail::worker_count(thread_count, stale.size()));
+    auto index_chunk = [&](std::size_t job, unsigned worker) {
+        auto &file = files[worker];
+        if (!file) {
+            file.emplace(region_filename);
+        }
+        int i = stale[job];
+        Chunk_Summary summary;
+        try {
+            auto data = file->get_chunk_data(i);
+            if (has_compression_header(data.data(), data.size())) {
+                data = decompress_data(data.data(), data.size());
+            }
+            summary = summarize(data.data(), data.size());
+        } catch (const std::runtime_error &) {
+            // A chunk which cannot be read or decoded is recorded with
+            // nothing found in it, rather than failing the whole index;
+            // the file is reopened, as a failed read leaves it unusable.
+            summary.locations.assign(split_paths.size(),
+                                     Tag_Location{TypeCode::None, 0, 0});
+            file.reset();
+        }
+        summary.timestamp = region.chunk_timestamp(i);
+        summary.sector_offset = region.chunk_offset(i);
+        summary.sector_count = region.chunk_length(i);
+        chunks[i] = std::move(summary);
+    };
+    detail::parallel_for(stale.size(), thread_count, index_chunk);
+    return stale.size();
+}
+
+Region_Index Region_Index::open(const std::string &region_filename,
+                                const std::vector<std::string> &paths,
+                                unsigned thread_count) {
+    auto sidecar = sidecar_path(region_filename);
+    Region_Index index(paths);
+    bool loaded = false;
+    if (std::ifstream file(sidecar, std::ios::binary); file) {
+        try {
+            auto saved = load(file);
+            if (saved.paths() == paths) {
+                index = std::move(saved);
+                loaded = true;
+            }
+        } catch (const std::runtime_error &) {
+            // A damaged sidecar is rebuilt.
+        }
+    }
+    if (index.update(region_filename, thread_count) > 0 || !loaded) {
+        // Written in full under a name of its own, then renamed over the
+        // sidecar, so that readers never see a partial file.
+        auto temporary = temporary_path(sidecar);
+        {
+            std::ofstream file(temporary, std::ios::binary);
+            index.save(file);
+            if (!file) {
+                file.close();
+                std::filesystem::remove(temporary);
+                throw std::runtime_error("Could not write " + temporary);
+            }
+        }
+        std::filesystem::rename(temporary, sidecar);
+    }
+    return index;
+}
+
+std::optional<Tag_Location> Region_Index::find(int chunk_index,
+                                               std::size_t path) const {
+    const auto &summary = chunks.at(chunk_index);
+    if (!summary.present() ||
+        summary.locations.at(path).type == TypeCode::None) {
+        return std::nullopt;
+    }
+    return summary.locations[path];
+}
+
+void Region_Index::save(std::ostream &output) const {
+    output.write(index_magic, sizeof(index_magic));
+    BinaryWriter::write(static_cast<uint32_t>(path_names.size()), output);
+    for (const auto &path : path_names) {
+        BinaryWriter::write_string(path, output);
+    }
+    for (const auto &summary : chunks) {
+        BinaryWriter::write(summary.timestamp, output);
+        BinaryWriter::write(summary.sector_offset, output);
+        BinaryWriter::write(summary.sector_count, output);
+        BinaryWriter::write(summary.inflated_length, output);
+        BinaryWriter::write(summary.hash, output);
+        for (std::size_t p = 0; p < path_names.size(); ++p) {
+            auto location = summary.present()
+                                ? summary.locations[p]
+                                : Tag_Location{TypeCode::None, 0, 0};
+            BinaryWriter::write(static_cast<int8_t>(location.type), output);
+            BinaryWriter::write(static_cast<uint32_t>(location.offset),
+                                output);
+            BinaryWriter::write(static_cast<uint32_t>(location.payload),
+                                output);
+        }
+    }
+}
+
+Region_Index Region_Index::load(std::istream &input) {
+    std::vector<unsigned char> bytes{std::istreambuf_iterator<char>(input),
+                                     std::istreambuf_iterator<char>()};
+    BinaryReader reader(bytes.data(), bytes.size());
+    auto magic = reader.read_string_view(sizeof(index_magic));
+    if (magic != std::string_view(index_magic, sizeof(index_magic))) {
+        throw std::runtime_error("Not a region index file");
+    }
+    auto path_count = reader.read<uint32_t>();
+    // Each path takes at least 3 bytes.
+    if (path_count > reader.remaining_length() / 3) {
+        throw UnexpectedEndOfInputException();
+    }
+    std::vector<std::string> paths(path_count);
+    for (auto &path : paths) {
+        path = reader.read_string(reader.read<uint16_t>());
+    }
+    Region_Index index(std::move(paths));
+    for (auto &summary : index.chunks) {
+        summary.timestamp = reader.read<uint32_t>();
+        summary.sector_offset = reader.read<uint32_t>();
+        summary.sector_count = reader.read<uint8_t>();
+        summary.inflated_length = reader.read<uint32_t>();
+        summary.hash = reader.read<uint64_t>();
+        summary.locations.resize(path_count);
+        for (auto &location : summary.locations) {
+            location.type = static_cast<TypeCode>(reader.read<int8_t>());
+            location.offset = reader.read<uint32_t>();
+            location.payload = reader.read<uint32_t>();
+            if ((location.type < TypeCode::End ||
+                 location.type > TypeCode::Long_Array) &&
+                location.type != TypeCode::None) {
+                throw std::runtime_error("Region index has an invalid "
+                                         "TypeCode");
+            }
+        }
+    }
+    if (reader.remaining_length() != 0) {
+        throw std::runtime_error("Region index has trailing data");
+    }
+    return index;
+}
+
+} // namespace nbtview
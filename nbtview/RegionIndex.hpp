@@ -0,0 +1,139 @@
+/**
+ * @file RegionIndex.hpp
+ * @brief A persistent sidecar index of the chunks of a region file
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_REGIONINDEX_H_
+#define NBT_REGIONINDEX_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Region.hpp"
+#include "Scanner.hpp"
+
+namespace nbtview {
+
+//! What a Region_Index records of one chunk
+struct Chunk_Summary {
+    //! The chunk's entry in the region header when it was indexed; a
+    //! sector_count of 0 means the chunk is absent or not yet indexed
+    uint32_t timestamp = 0;
+    uint32_t sector_offset = 0;
+    uint8_t sector_count = 0;
+    //! Length of the chunk's uncompressed data
+    uint32_t inflated_length = 0;
+    //! hash_bytes() of the uncompressed data
+    uint64_t hash = 0;
+    //! Where each of the index's paths was found in the uncompressed data;
+    //! the type is None where it was not found.  A chunk which could not
+    //! be read or decoded has an inflated_length and hash of 0, and none of
+    //! the paths found.
+    std::vector<Tag_Location> locations;
+
+    bool present() const { return sector_count != 0; }
+};
+
+/**
+ * @brief Region_Index records, for each chunk of a region file, the size
+ * and a hash of its uncompressed data and where some chosen tags lie
+ * within it.
+ *
+ * Size and hash queries are answered without reading the region file at
+ * all; and a chosen tag may be decoded with read_tag_at() straight after
+ * inflating its chunk, without searching for it.
+ *
+ * The index is meant to be kept beside its region file as a sidecar,
+ * r.X.Z.mca.idx, by open().  A chunk's summary is stale once its entry in
+ * the region header (its timestamp, or the sectors it occupies) changes,
+ * and update() indexes only the chunks which are stale.
+ */
+class Region_Index {
+  public:
+    /**
+     * @brief Makes an empty index of some paths.
+     * @param paths paths of tags within each chunk, as names of nested
+     * Compounds separated by '.', such as "Level.Sections"
+     * @throw std::runtime_error if a path has an empty name
+     */
+    explicit Region_Index(std::vector<std::string> paths = {});
+
+    /**
+     * @brief Loads the sidecar of a region file, if it is valid and has
+     * the same paths, brings it up to date, and saves it if it changed.
+     *
+     * The sidecar is replaced atomically, so that readers never see a
+     * partly written index.
+     *
+     * @param thread_count number of threads; 0 uses one per hardware thread
+     * @throw std::runtime_error if the region file cannot be read
+     */
+    static Region_Index open(const std::string &region_filename,
+                             const std::vector<std::string> &paths,
+                             unsigned thread_count = 0);
+
+    //! The sidecar of a region file: its name followed by ".idx"
+    static std::string sidecar_path(const std::string &region_filename) {
+        return region_filename + ".idx";
+    }
+
+    /**
+     * @brief Indexes each chunk of a region file whose summary is stale,
+     * on several threads, and forgets chunks which are no longer present.
+     * An external chunk is read from its file c.X.Z.mcc.
+     * @return the number of chunks indexed, including those which could
+     * not be read
+     */
+    std::size_t update(const std::string &region_filename,
+                       unsigned thread_count = 0);
+
+    const std::vector<std::string> &paths() const { return path_names; }
+
+    const Chunk_Summary &operator[](int chunk_index) const {
+        return chunks.at(chunk_index);
+    }
+
+    //! Returns where a path lies in a chunk's uncompressed data, if the
+    //! chunk has such a tag.
+    std::optional<Tag_Location> find(int chunk_index,
+                                     std::size_t path) const;
+
+    /**
+     * @brief Writes the index as a compact binary file.
+     *
+     * All values are big-endian.  The file holds the magic bytes "NBTX",
+     * the path count as a uint32 and each path (a uint16 length and UTF-8
+     * bytes), then a summary of each of the region's chunks in order: its
+     * timestamp and sector offset (uint32), sector count (byte), inflated
+     * length (uint32) and hash (uint64), then for each path its TypeCode
+     * (byte) and the offsets of the tag and its payload (uint32).
+     */
+    void save(std::ostream &output) const;
+
+    //! Reads a file written by save().
+    //! @throw std::runtime_error if the file is not a valid index
+    static Region_Index load(std::istream &input);
+
+  private:
+    std::vector<std::string> path_names;
+    //! Each path split into its names
+    std::vector<std::vector<std::string>> split_paths;
+    std::array<Chunk_Summary, Region::chunk_count> chunks;
+
+    Chunk_Summary summarize(const unsigned char *data,
+                            size_t data_length) const;
+};
+
+} // namespace nbtview
+
+#endif // NBT_REGIONINDEX_H_
@@ -0,0 +1,310 @@
+// Scanner.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Binding.hpp"
+#include "Deserializer.hpp"
+#include "Hash.hpp"
+#include "Scanner.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // Longer windows allow longer skips, but shifts must fit in a byte.
+    constexpr std::size_t max_window = 64;
+
+    std::string encode_header(const Scan_Pattern &pattern) {
+        if (pattern.name.empty()) {
+            throw std::runtime_error("Scan patterns must have a name");
+        }
+        if (pattern.name.size() > UINT16_MAX) {
+            throw std::runtime_error("Scan pattern name is too long");
+        }
+        auto length = pattern.name.size();
+        std::string header;
+        header.reserve(3 + length);
+        header.push_back(static_cast<char>(pattern.type));
+        header.push_back(static_cast<char>(length >> 8));
+        header.push_back(static_cast<char>(length & 0xff));
+        header += pattern.name;
+        return header;
+    }
+
+    inline uint16_t byte_pair(const unsigned char *p) {
+        return static_cast<uint16_t>((p[0] << 8) | p[1]);
+    }
+
+    std::size_t numeric_size(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+            return sizeof(Byte);
+        case TypeCode::Short:
+            return sizeof(Short);
+        case TypeCode::Int:
+        case TypeCode::Float:
+            return sizeof(Int);
+        case TypeCode::Long:
+        case TypeCode::Double:
+            return sizeof(Long);
+        default:
+            return 0;
+        }
+    }
+
+} // namespace
+
+// ScanWalker walks an NBT document, looking up the header of each named
+// tag among the scanner's patterns.  Arrays and Lists of numeric type are
+// skipped without being examined.
+class ScanWalker {
+  public:
+    ScanWalker(const Scanner &scanner, const unsigned char *data,
+               size_t data_length, std::vector<Scan_Hit> &hits)
+        : scanner(scanner), data(data), reader(data, data_length),
+          data_length(data_length), hits(hits) {}
+
+    void run() {
+        auto type = read_header();
+        if (type == TypeCode::End) {
+            throw std::runtime_error("Root tag is an End tag");
+        }
+        walk(type, 0);
+    }
+
+  private:
+    const Scanner &scanner;
+    const unsigned char *data;
+    BinaryReader reader;
+    size_t data_length;
+    std::vector<Scan_Hit> &hits;
+    std::size_t max_depth = read_options{}.max_depth;
+
+    std::size_t offset() const {
+        return data_length - reader.remaining_length();
+    }
+
+    // Reads the type and name of a named tag, recording a hit for each
+    // pattern which it matches.
+    TypeCode read_header() {
+        auto start = offset();
+        auto type = static_cast<TypeCode>(reader.read<int8_t>());
+        if (type == TypeCode::End) {
+            return type;
+        }
+        reader.skip(reader.read<uint16_t>());
+        auto length = offset() - start;
+        auto hash = hash_bytes(data + start, length);
+        auto it = std::lower_bound(scanner.header_hashes.begin(),
+                                   scanner.header_hashes.end(),
+                                   std::pair<uint64_t, uint32_t>(hash, 0));
+        for (; it != scanner.header_hashes.end() && it->first == hash;
+             ++it) {
+            const auto &header = scanner.headers[it->second];
+            if (header.size() == length &&
+                std::memcmp(data + start, header.data(), length) == 0) {
+                hits.push_back({it->second, start, start + length});
+            }
+        }
+        return type;
+    }
+
+    void skip_array(std::size_t element_size) {
+        auto length = reader.read<int32_t>();
+        if (length < 0) {
+            throw std::runtime_error("Negative array length");
+        }
+        reader.skip(element_size * static_cast<std::size_t>(length));
+    }
+
+    void walk(TypeCode type, std::size_t depth) {
+        if (auto size = numeric_size(type); size != 0) {
+            reader.skip(size);
+            return;
+        }
+        switch (type) {
+        case TypeCode::Byte_Array:
+            skip_array(sizeof(Byte));
+            return;
+        case TypeCode::Int_Array:
+            skip_array(sizeof(Int));
+            return;
+        case TypeCode::Long_Array:
+            skip_array(sizeof(Long));
+            return;
+        case TypeCode::String:
+            reader.skip(reader.read<uint16_t>());
+            return;
+        default:
+            break;
+        }
+        if (depth >= max_depth) {
+            throw LimitExceededException("NBT data is nested too deeply");
+        }
+        if (type == TypeCode::List) {
+            auto element_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            if (length <= 0) {
+                return;
+            }
+            if (auto size = numeric_size(element_type); size != 0) {
+                reader.skip(size * static_cast<std::size_t>(length));
+                return;
+            }
+            for (int32_t i = 0; i < length; ++i) {
+                walk(element_type, depth + 1);
+            }
+        } else if (type == TypeCode::Compound) {
+            for (auto member = read_header(); member != TypeCode::End;
+                 member = read_header()) {
+                walk(member, depth + 1);
+            }
+        } else {
+            throw std::runtime_error("Unhandled tag type");
+        }
+    }
+};
+
+Scanner::Scanner(std::vector<Scan_Pattern> patterns)
+    : patterns(std::move(patterns)) {
+    if (this->patterns.empty()) {
+        throw std::runtime_error("Scanner has no patterns");
+    }
+    window = max_window;
+    for (const auto &pattern : this->patterns) {
+        headers.push_back(encode_header(pattern));
+        window = std::min(window, headers.back().size());
+    }
+
+    // A pair of bytes which ends the window can only occur at position j
+    // of a header if the window skips ahead by window - 1 - j, so it is
+    // safe to skip the least such distance.  Pairs which occur in no
+    // header allow the window to skip past them entirely.
+    shift.fill(static_cast<uint8_t>(window - 1));
+    for (uint32_t k = 0; k < headers.size(); ++k) {
+        auto header =
+            reinterpret_cast<const unsigned char *>(headers[k].data());
+        for (std::size_t j = 1; j < window; ++j) {
+            auto &s = shift[byte_pair(header + j - 1)];
+            s = std::min(s, static_cast<uint8_t>(window - 1 - j));
+        }
+        candidates.emplace_back(byte_pair(header + window - 2), k);
+        header_hashes.emplace_back(
+            hash_bytes(headers[k].data(), headers[k].size()), k);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    std::sort(header_hashes.begin(), header_hashes.end());
+}
+
+std::vector<Scan_Hit> Scanner::scan(const unsigned char *data,
+                                    size_t data_length, bool validate) const {
+    std::vector<Scan_Hit> hits;
+    scan(data, data_length, hits, validate);
+    return hits;
+}
+
+void Scanner::scan(const unsigned char *data, size_t data_length,
+                   std::vector<Scan_Hit> &hits, bool validate) const {
+    hits.clear();
+    if (validate) {
+        ScanWalker(*this, data, data_length, hits).run();
+        return;
+    }
+    // pos is the offset of the last byte in the window.
+    for (std::size_t pos = window - 1; pos < data_length;) {
+        auto pair = byte_pair(data + pos - 1);
+        if (auto s = shift[pair]; s != 0) {
+            pos += s;
+            continue;
+        }
+        auto start = pos + 1 - window;
+        auto it = std::lower_bound(candidates.begin(), candidates.end(),
+                                   std::pair<uint16_t, uint32_t>(pair, 0));
+        for (; it != candidates.end() && it->first == pair; ++it) {
+            const auto &header = headers[it->second];
+            if (header.size() <= data_length - start &&
+                std::memcmp(data + start, header.data(), header.size()) ==
+                    0) {
+                hits.push_back({it->second, start, start + header.size()});
+            }
+        }
+        ++pos;
+    }
+}
+
+namespace {
+
+    template <typename Path>
+    std::optional<Tag_Location> find_tag_on_path(const unsigned char *data,
+                                                 size_t data_length,
+                                                 const Path &path) {
+        BinaryReader reader(data, data_length);
+        Tag_Location location{};
+        location.type = static_cast<TypeCode>(reader.read<int8_t>());
+        reader.skip(reader.read<uint16_t>());
+        location.payload = data_length - reader.remaining_length();
+        for (const auto &name : path) {
+            if (location.type != TypeCode::Compound) {
+                return std::nullopt;
+            }
+            while (true) {
+                location.offset = data_length - reader.remaining_length();
+                location.type = static_cast<TypeCode>(reader.read<int8_t>());
+                if (location.type == TypeCode::End) {
+                    return std::nullopt;
+                }
+                auto member = reader.read_string_view(reader.read<uint16_t>());
+                if (member == name) {
+                    break;
+                }
+                skip_payload(reader, location.type);
+            }
+            location.payload = data_length - reader.remaining_length();
+        }
+        return location;
+    }
+
+} // namespace
+
+std::optional<Tag_Location>
+find_tag(const unsigned char *data, size_t data_length,
+         std::initializer_list<std::string_view> path) {
+    return find_tag_on_path(data, data_length, path);
+}
+
+std::optional<Tag_Location> find_tag(const unsigned char *data,
+                                     size_t data_length,
+                                     const std::vector<std::string> &path) {
+    return find_tag_on_path(data, data_length, path);
+}
+
+Tag read_tag_at(const unsigned char *data, size_t data_length,
+                const Tag_Location &location) {
+    if (location.payload > data_length) {
+        throw UnexpectedEndOfInputException();
+    }
+    // Copy the payload behind an unnamed header, to decode it alone.
+    BinaryReader reader(data + location.payload,
+                        data_length - location.payload);
+    skip_payload(reader, location.type);
+    auto payload_end = data_length - reader.remaining_length();
+    std::vector<unsigned char> tag_data{
+        static_cast<unsigned char>(location.type), 0, 0};
+    tag_data.insert(tag_data.end(), data + location.payload,
+                    data + payload_end);
+    return read_binary(tag_data).second;
+}
+
+} // namespace nbtview
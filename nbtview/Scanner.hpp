@@ -0,0 +1,139 @@
+/**
+ * @file Scanner.hpp
+ * @brief Find many named tags in binary NBT data in a single pass
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_SCANNER_H_
+#define NBT_SCANNER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+//! A named tag to search for
+struct Scan_Pattern {
+    TypeCode type;
+    std::string name;
+};
+
+//! A place where the encoding of a pattern's tag header was found
+struct Scan_Hit {
+    //! Index of the pattern which was found
+    std::size_t pattern;
+    //! Offset of the tag's type byte
+    std::size_t offset;
+    //! Offset of the tag's payload, just past its name
+    std::size_t payload;
+};
+
+/**
+ * @brief Scanner searches uncompressed binary NBT data for the headers of
+ * several named tags at once, without decoding the data.
+ *
+ * The header of a named tag is its type byte, the length of its name as a
+ * big-endian uint16, and the name itself.  The headers of all patterns are
+ * found in one pass with the Wu-Manber algorithm: a table indexed by each
+ * pair of bytes gives how far the search may safely skip ahead, so that
+ * most of the data is never examined.
+ *
+ * Without validation, a hit may be a false positive when a header's bytes
+ * occur inside some other payload, and its payload is not known to lie
+ * within the data; but damaged or partial data may be searched.  With
+ * validation, the data is instead walked as an NBT document and the header
+ * of each named tag is looked up among the patterns.  Since arrays are
+ * skipped without being examined, this is usually the faster way to search
+ * whole documents.
+ */
+class Scanner {
+  public:
+    //! @throw std::runtime_error if there are no patterns, or a pattern's
+    //! name is empty
+    explicit Scanner(std::vector<Scan_Pattern> patterns);
+
+    std::size_t size() const { return patterns.size(); }
+    const Scan_Pattern &operator[](std::size_t index) const {
+        return patterns[index];
+    }
+
+    //! Returns every hit, in order of offset.
+    //! @param validate whether to find only hits which begin a named tag;
+    //! the data must then hold one complete root tag
+    //! @throw std::runtime_error if validating and the data is not valid NBT
+    std::vector<Scan_Hit> scan(const unsigned char *data, size_t data_length,
+                               bool validate = false) const;
+
+    //! Replaces the contents of hits with every hit, reusing its storage.
+    void scan(const unsigned char *data, size_t data_length,
+              std::vector<Scan_Hit> &hits, bool validate = false) const;
+
+  private:
+    friend class ScanWalker;
+
+    std::vector<Scan_Pattern> patterns;
+    //! Encoded header of each pattern
+    std::vector<std::string> headers;
+    //! Length of the search window; no greater than any header
+    std::size_t window;
+    //! Distance to skip for each pair of bytes ending the window
+    std::array<uint8_t, 65536> shift;
+    //! (pair of bytes, pattern) for each pattern whose window ends with
+    //! that pair, sorted
+    std::vector<std::pair<uint16_t, uint32_t>> candidates;
+    //! (hash of header, pattern) for each pattern, sorted
+    std::vector<std::pair<uint64_t, uint32_t>> header_hashes;
+};
+
+//! Where find_tag() found a tag
+struct Tag_Location {
+    TypeCode type;
+    //! Offset of the tag's type byte
+    std::size_t offset;
+    //! Offset of the tag's payload, just past its name
+    std::size_t payload;
+};
+
+/**
+ * @brief Finds the tag at a path in uncompressed binary NBT data.
+ *
+ * The path names a member of the root Compound, then a member of that
+ * member, and so on; an empty path finds the root.  Only the Compounds on
+ * the path are read, and everything else is skipped.
+ *
+ * @return the tag's location, or std::nullopt if there is no such tag
+ * @throw std::runtime_error if the data ends before the tag is found
+ */
+std::optional<Tag_Location>
+find_tag(const unsigned char *data, size_t data_length,
+         std::initializer_list<std::string_view> path);
+
+//! Finds the tag at a path given at run time; see above.
+std::optional<Tag_Location> find_tag(const unsigned char *data,
+                                     size_t data_length,
+                                     const std::vector<std::string> &path);
+
+/**
+ * @brief Decodes the tag found by find_tag(), or recorded by a
+ * Region_Index, without reading the rest of the data.
+ * @throw std::runtime_error if the tag is not valid NBT
+ */
+Tag read_tag_at(const unsigned char *data, size_t data_length,
+                const Tag_Location &location);
+
+} // namespace nbtview
+
+#endif // NBT_SCANNER_H_
@@ -13,58 +13,82 @@
 
 #include <ostream>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "BinaryWriter.hpp"
+#include "Encoding.hpp"
 #include "Tag.hpp"
 
 namespace nbtview {
 
 namespace detail {
 
-    struct PayloadSerializer {
+    //! Writes the payload of each kind of tag in the encoding given by
+    //! Encoding (Encoding.hpp).
+    template <typename Encoding> struct BasicPayloadSerializer {
+        using Writer = BasicBinaryWriter<Encoding>;
+
         std::ostream &output;
 
         void operator()(const None &t) {}
-        void operator()(const End &t) { BinaryWriter::write(t, output); }
-        void operator()(const Byte &t) { BinaryWriter::write(t, output); }
-        void operator()(const Short &t) { BinaryWriter::write(t, output); }
-        void operator()(const Int &t) { BinaryWriter::write(t, output); }
-        void operator()(const Long &t) { BinaryWriter::write(t, output); }
-        void operator()(const Float &t) { BinaryWriter::write(t, output); }
-        void operator()(const Double &t) { BinaryWriter::write(t, output); }
+        void operator()(const End &t) { Writer::write(t, output); }
+        void operator()(const Byte &t) { Writer::write(t, output); }
+        void operator()(const Short &t) { Writer::write(t, output); }
+        void operator()(const Int &t) { Writer::write(t, output); }
+        void operator()(const Long &t) { Writer::write(t, output); }
+        void operator()(const Float &t) { Writer::write(t, output); }
+        void operator()(const Double &t) { Writer::write(t, output); }
         void operator()(const Byte_Array &t) {
-            BinaryWriter::write_vector(t, output);
-        }
-        void operator()(const String &t) {
-            BinaryWriter::write_string(t, output);
+            Writer::write_vector(t, output);
         }
+        void operator()(const String &t) { Writer::write_string(t, output); }
         void operator()(const List &t) {
-            BinaryWriter::write(static_cast<Byte>(list_type(t)), output);
-            BinaryWriter::write(static_cast<Int>(t.size()), output);
+            Writer::write(static_cast<Byte>(list_type(t)), output);
+            Writer::write(static_cast<Int>(t.size()), output);
             for (const Tag &elt : t) {
                 std::visit(*this, elt.get_value());
             }
         }
         void operator()(const Compound &t) {
             for (auto &[tag_name, tag_data] : t) {
-                BinaryWriter::write(std::visit(TagID(), tag_data.get_value()),
-                                    output);
-                BinaryWriter::write_string(tag_name, output);
+                Writer::write(std::visit(TagID(), tag_data.get_value()),
+                              output);
+                Writer::write_string(tag_name, output);
                 std::visit(*this, tag_data.get_value());
             }
-            BinaryWriter::write(End(0), output);
+            Writer::write(End(0), output);
         }
         void operator()(const Int_Array &t) {
-            BinaryWriter::write_vector(t, output);
+            Writer::write_vector(t, output);
         }
         void operator()(const Long_Array &t) {
-            BinaryWriter::write_vector(t, output);
+            Writer::write_vector(t, output);
+        }
+        void operator()(const Packed_List &t) {
+            Writer::write(static_cast<Byte>(list_type(t)), output);
+            std::visit(
+                [this](const auto &elements) {
+                    using T = typename std::remove_cvref_t<
+                        decltype(elements)>::value_type;
+                    if constexpr (std::is_arithmetic_v<T>) {
+                        Writer::write_vector(elements, output);
+                    } else {
+                        Writer::write(static_cast<Int>(elements.size()),
+                                      output);
+                        for (const auto &elt : elements) {
+                            (*this)(elt);
+                        }
+                    }
+                },
+                t.storage());
         }
     };
 
+    using PayloadSerializer = BasicPayloadSerializer<Big_Endian>;
+
 } // namespace detail
 
 } // namespace nbtview
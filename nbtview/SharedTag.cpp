@@ -0,0 +1,127 @@
+// SharedTag.cpp
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "SharedTag.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // Converts the value of a Tag; Source is Tag & or const Tag &, so that
+    // strings and arrays are moved out of an rvalue Tag.
+    template <typename Source> SharedTag::Value to_shared_value(Source &&tag) {
+        return std::visit(
+            [](auto &&v) -> SharedTag::Value {
+                using T = std::remove_cvref_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, List>) {
+                    SharedTag::List lst;
+                    lst.reserve(v.size());
+                    for (auto &elt : v) {
+                        lst.emplace_back(SharedTag::Value(
+                            to_shared_value(std::forward<Source>(elt))));
+                    }
+                    return lst;
+                } else if constexpr (std::is_same_v<T, Compound>) {
+                    SharedTag::Compound cmpd;
+                    for (auto &[key, elt] : v) {
+                        cmpd.emplace_hint(cmpd.end(), key,
+                                          SharedTag::Value(to_shared_value(
+                                              std::forward<Source>(elt))));
+                    }
+                    return cmpd;
+                } else if constexpr (std::is_const_v<
+                                         std::remove_reference_t<Source>>) {
+                    return v;
+                } else {
+                    return std::move(v);
+                }
+            },
+            tag.get_value());
+    }
+
+} // namespace
+
+SharedTag::SharedTag(const Tag &tag)
+    : node(new Node(to_shared_value(tag))) {}
+
+SharedTag::SharedTag(Tag &&tag)
+    : node(new Node(to_shared_value(tag))) {}
+
+Tag SharedTag::to_tag() const {
+    return std::visit(
+        [](const auto &v) -> Tag {
+            using T = std::remove_cvref_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, SharedTag::List>) {
+                nbtview::List lst;
+                lst.reserve(v.size());
+                for (auto &elt : v) {
+                    lst.push_back(elt.to_tag());
+                }
+                return lst;
+            } else if constexpr (std::is_same_v<T, SharedTag::Compound>) {
+                nbtview::Compound cmpd;
+                for (auto &[key, elt] : v) {
+                    cmpd.emplace_hint(cmpd.end(), key, elt.to_tag());
+                }
+                return cmpd;
+            } else {
+                return v;
+            }
+        },
+        node->value);
+}
+
+TypeCode SharedTag::get_id() const {
+    return std::visit(
+        [](const auto &v) {
+            using T = std::remove_cvref_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, SharedTag::List>) {
+                return TypeCode::List;
+            } else if constexpr (std::is_same_v<T, SharedTag::Compound>) {
+                return TypeCode::Compound;
+            } else {
+                return TagID()(v);
+            }
+        },
+        node->value);
+}
+
+std::size_t SharedTag::size() const {
+    if (auto cmpd = std::get_if<Compound>(&node->value)) {
+        return cmpd->size();
+    } else if (auto lst = std::get_if<List>(&node->value)) {
+        return lst->size();
+    } else if (auto packed = std::get_if<Packed_List>(&node->value)) {
+        return packed->size();
+    }
+    throw std::runtime_error(
+        "Called size() on a SharedTag which is neither Compound nor List.");
+}
+
+const SharedTag &SharedTag::at(std::string_view key) const {
+    auto &cmpd = get<Compound>();
+    auto it = cmpd.find(key);
+    if (it == cmpd.end()) {
+        throw std::out_of_range("SharedTag compound has no key '" +
+                                std::string(key) + "'");
+    }
+    return it->second;
+}
+
+std::size_t SharedTag::erase(std::string_view key) {
+    // Avoid cloning the node when there is nothing to erase.
+    if (!contains(key)) {
+        return 0;
+    }
+    auto &cmpd = get<Compound>();
+    cmpd.erase(cmpd.find(key));
+    return 1;
+}
+
+} // namespace nbtview
@@ -0,0 +1,180 @@
+/**
+ * @file SharedTag.hpp
+ * @brief An NBT tag whose subtrees are shared between copies until written
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_SHAREDTAG_H_
+#define NBT_SHAREDTAG_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief SharedTag holds the same data as a Tag, but copying it is O(1).
+ *
+ * Each SharedTag refers to a reference-counted node.  Copies share nodes,
+ * and a node is cloned only when it is modified through a handle which does
+ * not own it exclusively.  Cloning a Compound or List node copies only the
+ * handles of its children, so a modification costs O(depth) node copies
+ * and the unmodified subtrees remain shared with every other copy.
+ *
+ * Non-const member functions may clone the node; use the const overloads
+ * (or at()) to read a SharedTag without detaching it from its copies.
+ * Distinct SharedTag objects may be used from different threads even when
+ * they share nodes, but a single SharedTag object is no more thread-safe
+ * than a Tag.  To that end each node counts its owners itself: a handle
+ * which finds itself the only owner, with an acquire load, sees every read
+ * of the node made through handles since released, and so may modify it in
+ * place.
+ */
+class SharedTag {
+  public:
+    using List = std::vector<SharedTag>;
+    using Compound = std::map<std::string, SharedTag, std::less<>>;
+    using Value =
+        std::variant<None, End, Byte, Short, Int, Long, Float, Double,
+                     Byte_Array, String, List, Compound, Int_Array, Long_Array,
+                     Packed_List>;
+
+    SharedTag() : node(new Node(None{})) {}
+
+    template <typename T>
+        requires std::constructible_from<Value, T>
+    SharedTag(T &&v) : node(new Node(std::forward<T>(v))) {}
+
+    SharedTag(const SharedTag &other) : node(retain(other.node)) {}
+    SharedTag(SharedTag &&other) noexcept
+        : node(std::exchange(other.node, nullptr)) {}
+    SharedTag &operator=(const SharedTag &other) {
+        auto *copy = retain(other.node);
+        release();
+        node = copy;
+        return *this;
+    }
+    SharedTag &operator=(SharedTag &&other) noexcept {
+        if (this != &other) {
+            release();
+            node = std::exchange(other.node, nullptr);
+        }
+        return *this;
+    }
+    ~SharedTag() { release(); }
+
+    //! Converts a Tag, copying its data.
+    explicit SharedTag(const Tag &tag);
+    //! Converts a Tag, moving its strings and arrays.
+    explicit SharedTag(Tag &&tag);
+
+    //! Builds an equivalent, independent Tag.
+    Tag to_tag() const;
+
+    template <typename T> const T &get() const {
+        return std::get<T>(node->value);
+    }
+    //! Returns the value for modification, cloning the node if it is shared.
+    template <typename T> T &get() { return std::get<T>(mutable_value()); }
+
+    const Value &get_value() const { return node->value; }
+    Value &get_value() { return mutable_value(); }
+
+    TypeCode get_id() const;
+
+    template <typename T> bool is() const {
+        return std::holds_alternative<T>(node->value);
+    }
+
+    std::size_t size() const;
+    bool empty() const { return size() == 0; }
+
+    //! Tests whether this tag and other refer to the same node.
+    bool shares(const SharedTag &other) const { return node == other.node; }
+
+    //! Number of SharedTag objects referring to this tag's node
+    long use_count() const {
+        return node->owners.load(std::memory_order_acquire);
+    }
+
+    // Compound wrapper methods
+    bool contains(std::string_view key) const {
+        return get<Compound>().contains(key);
+    }
+    //! Returns the named child of a Compound.
+    const SharedTag &at(std::string_view key) const;
+    const SharedTag &operator[](std::string_view key) const { return at(key); }
+    //! Returns the named child of a Compound for modification, inserting it
+    //! if necessary.
+    SharedTag &operator[](const std::string &key) {
+        return get<Compound>()[key];
+    }
+    std::pair<Compound::iterator, bool> emplace(std::string name,
+                                                SharedTag t) {
+        return get<Compound>().emplace(std::move(name), std::move(t));
+    }
+    std::size_t erase(std::string_view key);
+
+    // List wrapper methods
+    const SharedTag &at(std::size_t index) const {
+        return get<List>().at(index);
+    }
+    const SharedTag &operator[](std::size_t index) const {
+        return get<List>()[index];
+    }
+    SharedTag &operator[](std::size_t index) { return get<List>()[index]; }
+    void push_back(SharedTag t) { get<List>().push_back(std::move(t)); }
+
+  private:
+    //! A value and the number of SharedTags which refer to it
+    struct Node {
+        template <typename T>
+        explicit Node(T &&v) : value(std::forward<T>(v)) {}
+
+        Value value;
+        std::atomic<long> owners = 1;
+    };
+    Node *node;
+
+    static Node *retain(Node *n) {
+        n->owners.fetch_add(1, std::memory_order_relaxed);
+        return n;
+    }
+
+    void release() {
+        // The last owner deletes the node only after every other owner's
+        // use of it, which their releases publish.
+        if (node != nullptr &&
+            node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete node;
+        }
+    }
+
+    Value &mutable_value() {
+        if (node->owners.load(std::memory_order_acquire) > 1) {
+            // Copying a container copies only its children's handles.
+            auto *copy = new Node(node->value);
+            release();
+            node = copy;
+        }
+        return node->value;
+    }
+};
+
+} // namespace nbtview
+
+#endif // NBT_SHAREDTAG_H_
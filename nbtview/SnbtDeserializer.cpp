@@ -0,0 +1,286 @@
+// SnbtDeserializer.cpp
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "SnbtDeserializer.hpp"
+#include "Tag.hpp"
+#include "utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // Parses the whole of text as a number of type T, allowing a leading '+'.
+    template <typename T> bool parse_number(std::string_view text, T &value) {
+        if (!text.empty() && text[0] == '+') {
+            text.remove_prefix(1);
+            if (!text.empty() && text[0] == '-') {
+                return false;
+            }
+        }
+        if (text.empty()) {
+            return false;
+        }
+        auto [ptr, ec] =
+            std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && ptr == text.data() + text.size();
+    }
+
+    // Floating point literals must start with a digit or a decimal point,
+    // which excludes "inf" and "nan".
+    bool looks_like_decimal(std::string_view text) {
+        if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+            text.remove_prefix(1);
+        }
+        return !text.empty() &&
+               ((text[0] >= '0' && text[0] <= '9') || text[0] == '.');
+    }
+
+    template <typename T> bool parse_decimal(std::string_view text, T &value) {
+        return looks_like_decimal(text) && parse_number(text, value);
+    }
+
+    // Interprets an unquoted token as a number or boolean where it is one,
+    // and as a String otherwise.
+    TagValue interpret_token(std::string_view token) {
+        if (token == "true") {
+            return Byte(1);
+        }
+        if (token == "false") {
+            return Byte(0);
+        }
+        std::string_view digits = token.substr(0, token.size() - 1);
+        switch (token.back()) {
+        case 'b':
+        case 'B':
+            if (Byte b; parse_number(digits, b)) {
+                return b;
+            }
+            break;
+        case 's':
+        case 'S':
+            if (Short s; parse_number(digits, s)) {
+                return s;
+            }
+            break;
+        case 'l':
+        case 'L':
+            if (Long l; parse_number(digits, l)) {
+                return l;
+            }
+            break;
+        case 'f':
+        case 'F':
+            if (Float f; parse_decimal(digits, f)) {
+                return f;
+            }
+            break;
+        case 'd':
+        case 'D':
+            if (Double d; parse_decimal(digits, d)) {
+                return d;
+            }
+            break;
+        default:
+            break;
+        }
+        if (Int i; parse_number(token, i)) {
+            return i;
+        }
+        if (token.find_first_of(".eE") != std::string_view::npos) {
+            if (Double d; parse_decimal(token, d)) {
+                return d;
+            }
+        }
+        return String(token);
+    }
+
+} // namespace
+
+std::pair<std::string, Tag> SnbtDeserializer::deserialize() {
+    Tag root(parse_value());
+    skip_whitespace();
+    if (!at_end()) {
+        fail("trailing characters after value");
+    }
+    return {"", std::move(root)};
+}
+
+void SnbtDeserializer::skip_whitespace() {
+    while (cursor != end && (*cursor == ' ' || *cursor == '\t' ||
+                             *cursor == '\n' || *cursor == '\r')) {
+        ++cursor;
+    }
+}
+
+char SnbtDeserializer::peek() {
+    skip_whitespace();
+    if (at_end()) {
+        fail("unexpected end of input");
+    }
+    return *cursor;
+}
+
+void SnbtDeserializer::expect(char c) {
+    if (peek() != c) {
+        fail(std::string("expected '") + c + "'");
+    }
+    ++cursor;
+}
+
+void SnbtDeserializer::fail(const std::string &what) const {
+    throw SnbtSyntaxError(what, cursor - begin);
+}
+
+TagValue SnbtDeserializer::parse_value() {
+    switch (peek()) {
+    case '{':
+        return parse_compound();
+    case '[':
+        return parse_list();
+    case '"':
+    case '\'':
+        return parse_quoted_string();
+    default:
+        return interpret_token(parse_unquoted_token());
+    }
+}
+
+std::string_view SnbtDeserializer::parse_unquoted_token() {
+    skip_whitespace();
+    const char *start = cursor;
+    while (cursor != end && detail::snbt_unquoted_char(*cursor)) {
+        ++cursor;
+    }
+    if (cursor == start) {
+        fail(at_end() ? "unexpected end of input" : "expected a value");
+    }
+    return std::string_view(start, cursor - start);
+}
+
+std::string SnbtDeserializer::parse_quoted_string() {
+    const char quote = *cursor++;
+    const char *run_start = cursor;
+    std::string result;
+    while (cursor != end) {
+        char c = *cursor;
+        if (c == quote) {
+            result.append(run_start, cursor);
+            ++cursor;
+            return result;
+        }
+        if (c == '\\') {
+            result.append(run_start, cursor);
+            ++cursor;
+            if (cursor == end ||
+                (*cursor != '\\' && *cursor != '"' && *cursor != '\'')) {
+                fail("invalid escape sequence in string");
+            }
+            run_start = cursor;
+        }
+        ++cursor;
+    }
+    fail("unterminated string");
+}
+
+std::string SnbtDeserializer::parse_key() {
+    char c = peek();
+    if (c == '"' || c == '\'') {
+        return parse_quoted_string();
+    }
+    return std::string(parse_unquoted_token());
+}
+
+Compound SnbtDeserializer::parse_compound() {
+    ++cursor; // '{'
+    if (++depth > max_depth) {
+        fail("maximum nesting depth exceeded");
+    }
+    Compound cmpd;
+    if (peek() != '}') {
+        while (true) {
+            std::string key = parse_key();
+            expect(':');
+            cmpd.insert_or_assign(std::move(key), Tag(parse_value()));
+            if (peek() == '}') {
+                break;
+            }
+            expect(',');
+        }
+    }
+    ++cursor; // '}'
+    --depth;
+    return cmpd;
+}
+
+TagValue SnbtDeserializer::parse_list() {
+    ++cursor; // '['
+    if (end - cursor >= 2 && cursor[1] == ';') {
+        char array_type = cursor[0];
+        if (array_type == 'B' || array_type == 'I' || array_type == 'L') {
+            cursor += 2;
+            switch (array_type) {
+            case 'B':
+                return parse_array<Byte>('b');
+            case 'I':
+                return parse_array<Int>('\0');
+            default:
+                return parse_array<Long>('l');
+            }
+        }
+        fail("unknown array type");
+    }
+
+    if (++depth > max_depth) {
+        fail("maximum nesting depth exceeded");
+    }
+    List lst;
+    if (peek() != ']') {
+        while (true) {
+            const char *element_start = cursor;
+            lst.emplace_back(parse_value());
+            if (lst.back().get_id() != lst.front().get_id()) {
+                cursor = element_start;
+                fail("list elements must all have the same type");
+            }
+            if (peek() == ']') {
+                break;
+            }
+            expect(',');
+        }
+    }
+    ++cursor; // ']'
+    --depth;
+    return lst;
+}
+
+template <typename T>
+std::vector<T> SnbtDeserializer::parse_array(char suffix) {
+    std::vector<T> values;
+    if (peek() != ']') {
+        while (true) {
+            std::string_view token = parse_unquoted_token();
+            if (suffix != '\0' && (token.back() | 0x20) == suffix) {
+                token.remove_suffix(1);
+            }
+            T value;
+            if (!parse_number(token, value)) {
+                fail("invalid array element");
+            }
+            values.push_back(value);
+            if (peek() == ']') {
+                break;
+            }
+            expect(',');
+        }
+    }
+    ++cursor; // ']'
+    return values;
+}
+
+} // namespace nbtview
@@ -0,0 +1,83 @@
+/**
+ * @file SnbtDeserializer.hpp
+ * @brief Read NBT data encoded in the SNBT text format
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef SNBTDESERIALIZER_H_
+#define SNBTDESERIALIZER_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "Deserializer.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+class SnbtSyntaxError : public std::runtime_error {
+  public:
+    SnbtSyntaxError(const std::string &what, std::size_t position)
+        : std::runtime_error("SNBT syntax error at offset " +
+                             std::to_string(position) + ": " + what),
+          position_(position) {}
+
+    //! Offset into the input at which the error was detected
+    std::size_t position() const { return position_; }
+
+  private:
+    std::size_t position_;
+};
+
+/**
+ * @brief SnbtDeserializer parses SNBT text in a single pass.
+ *
+ * Numeric suffixes (b, s, L, f, d), the typed array literals [B;...],
+ * [I;...] and [L;...], quoted and unquoted strings, and the keywords
+ * true/false are recognized.  SNBT carries no root tag name, so
+ * deserialize() always returns an empty name.
+ */
+class SnbtDeserializer : public Deserializer {
+  private:
+    const char *begin;
+    const char *cursor;
+    const char *end;
+    std::size_t depth = 0;
+
+  public:
+    //! Compounds and lists may not be nested more deeply than this.
+    static const std::size_t max_depth = 512;
+
+    SnbtDeserializer(std::string_view text)
+        : begin(text.data()), cursor(text.data()),
+          end(text.data() + text.size()) {}
+    ~SnbtDeserializer() = default;
+
+    std::pair<std::string, Tag> deserialize() override;
+
+  private:
+    TagValue parse_value();
+    Compound parse_compound();
+    TagValue parse_list();
+    template <typename T> std::vector<T> parse_array(char suffix);
+    std::string parse_quoted_string();
+    std::string_view parse_unquoted_token();
+    std::string parse_key();
+
+    void skip_whitespace();
+    bool at_end() const { return cursor == end; }
+    char peek();
+    void expect(char c);
+    [[noreturn]] void fail(const std::string &what) const;
+};
+
+} // namespace nbtview
+
+#endif // SNBTDESERIALIZER_H_
@@ -0,0 +1,232 @@
+// SnbtWriter.cpp
+
+#include <charconv>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "SnbtWriter.hpp"
+#include "Tag.hpp"
+#include "utils.hpp"
+
+namespace nbtview {
+
+void SnbtWriter::write(const Tag &tag) {
+    write_value(tag.get_value());
+    maybe_flush();
+}
+
+void SnbtWriter::write_key(std::string_view key) {
+    if (snbt_requires_quoting(key)) {
+        append_quoted_string(buffer, key);
+    } else {
+        buffer.append(key);
+    }
+}
+
+void SnbtWriter::flush() {
+    if (output != nullptr) {
+        output->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void SnbtWriter::newline() {
+    buffer += '\n';
+    buffer.append(depth * format.indent_width, ' ');
+}
+
+template <typename T> void SnbtWriter::write_number(T value) {
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+void SnbtWriter::write_value(const TagValue &value) {
+    std::visit([this](const auto &x) { write_payload(x); }, value);
+}
+
+void SnbtWriter::write_payload(None) { buffer += "<<NONE>>"; }
+
+void SnbtWriter::write_payload(End) { buffer += "<<END_TAG>>"; }
+
+void SnbtWriter::write_payload(Byte x) {
+    write_number(x);
+    buffer += 'b';
+}
+
+void SnbtWriter::write_payload(Short x) {
+    write_number(x);
+    buffer += 's';
+}
+
+void SnbtWriter::write_payload(Int x) { write_number(x); }
+
+void SnbtWriter::write_payload(Long x) {
+    write_number(x);
+    buffer += 'L';
+}
+
+void SnbtWriter::write_payload(Float x) {
+    write_number(x);
+    buffer += 'f';
+}
+
+void SnbtWriter::write_payload(Double x) {
+    write_number(x);
+    buffer += 'd';
+}
+
+void SnbtWriter::write_payload(const Byte_Array &x) {
+    write_array(x, "B;", 'b');
+}
+
+void SnbtWriter::write_payload(const String &x) {
+    append_quoted_string(buffer, x);
+}
+
+void SnbtWriter::write_payload(const Int_Array &x) {
+    write_array(x, "I;", '\0');
+}
+
+void SnbtWriter::write_payload(const Long_Array &x) {
+    write_array(x, "L;", 'L');
+}
+
+void SnbtWriter::write_payload(const Compound &cmpd) {
+    if (cmpd.empty()) {
+        buffer += "{}";
+        return;
+    }
+    if (depth >= format.max_depth) {
+        buffer += "{...}";
+        return;
+    }
+    buffer += '{';
+    ++depth;
+    bool first = true;
+    for (const auto &[key, tag] : cmpd) {
+        if (!first) {
+            buffer += ',';
+        }
+        first = false;
+        if (format.pretty) {
+            newline();
+        }
+        write_key(key);
+        buffer += format.pretty ? ": " : ":";
+        write_value(tag.get_value());
+        maybe_flush();
+    }
+    --depth;
+    if (format.pretty) {
+        newline();
+    }
+    buffer += '}';
+}
+
+void SnbtWriter::write_payload(const List &lst) {
+    write_list(list_type(lst), lst,
+               [this](const Tag &elt) { write_value(elt.get_value()); });
+}
+
+void SnbtWriter::write_payload(const Packed_List &lst) {
+    std::visit(
+        [this, &lst](const auto &elements) {
+            write_list(list_type(lst), elements,
+                       [this](const auto &elt) { write_payload(elt); });
+        },
+        lst.storage());
+}
+
+template <typename Elements, typename Write>
+void SnbtWriter::write_list(TypeCode elt_type, const Elements &elements,
+                            Write write_element) {
+    if (elements.empty()) {
+        buffer += "[]";
+        return;
+    }
+    if (depth >= format.max_depth) {
+        buffer += "[...]";
+        return;
+    }
+    bool multiline = format.pretty && (elt_type == TypeCode::Compound ||
+                                       elt_type == TypeCode::List);
+    std::string_view separator = (format.pretty && !multiline) ? ", " : ",";
+    buffer += '[';
+    ++depth;
+    std::size_t count = 0;
+    for (const auto &elt : elements) {
+        if (count != 0) {
+            buffer += separator;
+        }
+        if (multiline) {
+            newline();
+        }
+        if (count == format.max_array_length) {
+            buffer += "...";
+            break;
+        }
+        write_element(elt);
+        maybe_flush();
+        ++count;
+    }
+    --depth;
+    if (multiline) {
+        newline();
+    }
+    buffer += ']';
+}
+
+template <typename T>
+void SnbtWriter::write_array(const std::vector<T> &arr,
+                             std::string_view prefix, char elt_suffix) {
+    std::string_view separator = format.pretty ? ", " : ",";
+    buffer += '[';
+    buffer += prefix;
+    std::size_t count = 0;
+    for (auto elt : arr) {
+        if (count != 0) {
+            buffer += separator;
+        }
+        if (count == format.max_array_length) {
+            buffer += "...";
+            break;
+        }
+        write_number(elt);
+        if (elt_suffix != '\0') {
+            buffer += elt_suffix;
+        }
+        ++count;
+        maybe_flush();
+    }
+    buffer += ']';
+}
+
+void write_snbt(const Tag &tag, std::string &buffer,
+                const snbt_format &format) {
+    SnbtWriter writer(buffer, format);
+    writer.write(tag);
+}
+
+void write_snbt(const Tag &tag, std::ostream &os, const snbt_format &format) {
+    std::string buffer;
+    SnbtWriter writer(buffer, os, format);
+    writer.write(tag);
+    writer.flush();
+}
+
+std::string to_string(const Tag &tag) {
+    std::string output;
+    write_snbt(tag, output);
+    return output;
+}
+
+std::ostream &operator<<(std::ostream &os, const Tag &tag) {
+    write_snbt(tag, os);
+    return os;
+}
+
+} // namespace nbtview
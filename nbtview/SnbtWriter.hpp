@@ -0,0 +1,117 @@
+/**
+ * @file SnbtWriter.hpp
+ * @brief Write NBT tags in the SNBT text format
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef SNBTWRITER_H_
+#define SNBTWRITER_H_
+
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief Parameter object which provides options for SNBT output.
+ */
+struct snbt_format {
+    //! Emit newlines and indentation within compounds and nested lists.
+    bool pretty = false;
+    //! Number of spaces per nesting level when pretty printing.
+    int indent_width = 4;
+    //! Compounds and lists nested deeper than this are elided as {...}/[...]
+    std::size_t max_depth = std::numeric_limits<std::size_t>::max();
+    //! Lists and arrays longer than this are truncated with a trailing ...
+    std::size_t max_array_length = std::numeric_limits<std::size_t>::max();
+};
+
+/**
+ * @brief SnbtWriter appends the SNBT representation of tags to a string
+ * buffer, optionally flushing the buffer to an output stream as it fills.
+ *
+ * The buffer is supplied by the caller so that its capacity can be reused
+ * across many calls.
+ */
+class SnbtWriter {
+  public:
+    //! Appends output to buffer.
+    SnbtWriter(std::string &buffer, const snbt_format &format = {})
+        : buffer(buffer), output(nullptr), format(format) {}
+
+    //! Streams output to os, using buffer as intermediate storage.
+    SnbtWriter(std::string &buffer, std::ostream &os,
+               const snbt_format &format = {})
+        : buffer(buffer), output(&os), format(format) {}
+
+    //! Writes the SNBT representation of tag.
+    void write(const Tag &tag);
+
+    //! Writes a compound key, quoting it if necessary.
+    void write_key(std::string_view key);
+
+    //! Writes any buffered output to the stream, if there is one.
+    void flush();
+
+  private:
+    std::string &buffer;
+    std::ostream *output;
+    snbt_format format;
+    std::size_t depth = 0;
+
+    //! Buffered output is flushed to the stream beyond this many bytes.
+    static const std::size_t flush_threshold = 1 << 16;
+
+    void write_value(const TagValue &value);
+    void write_payload(None);
+    void write_payload(End);
+    void write_payload(Byte x);
+    void write_payload(Short x);
+    void write_payload(Int x);
+    void write_payload(Long x);
+    void write_payload(Float x);
+    void write_payload(Double x);
+    void write_payload(const Byte_Array &x);
+    void write_payload(const String &x);
+    void write_payload(const List &lst);
+    void write_payload(const Compound &cmpd);
+    void write_payload(const Int_Array &x);
+    void write_payload(const Long_Array &x);
+    void write_payload(const Packed_List &lst);
+    //! Writes the elements of a List or Packed_List, each by write_element.
+    template <typename Elements, typename Write>
+    void write_list(TypeCode elt_type, const Elements &elements,
+                    Write write_element);
+    template <typename T>
+    void write_array(const std::vector<T> &arr, std::string_view prefix,
+                     char elt_suffix);
+    template <typename T> void write_number(T value);
+
+    void newline();
+    void maybe_flush() {
+        if (output != nullptr && buffer.size() >= flush_threshold) {
+            flush();
+        }
+    }
+};
+
+//! Appends the SNBT representation of tag to buffer.
+void write_snbt(const Tag &tag, std::string &buffer,
+                const snbt_format &format = {});
+
+//! Writes the SNBT representation of tag to an output stream.
+void write_snbt(const Tag &tag, std::ostream &os,
+                const snbt_format &format = {});
+
+} // namespace nbtview
+
+#endif // SNBTWRITER_H_
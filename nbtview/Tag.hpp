@@ -14,6 +14,7 @@
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -74,9 +75,77 @@ using Int_Array = std::vector<Int>;
 //! array of Long
 using Long_Array = std::vector<Long>;
 
+//! The TypeCode of a tag holding a value of type T
+template <typename T> inline constexpr TypeCode typecode_of = TypeCode::None;
+template <> inline constexpr TypeCode typecode_of<Byte> = TypeCode::Byte;
+template <> inline constexpr TypeCode typecode_of<Short> = TypeCode::Short;
+template <> inline constexpr TypeCode typecode_of<Int> = TypeCode::Int;
+template <> inline constexpr TypeCode typecode_of<Long> = TypeCode::Long;
+template <> inline constexpr TypeCode typecode_of<Float> = TypeCode::Float;
+template <> inline constexpr TypeCode typecode_of<Double> = TypeCode::Double;
+template <>
+inline constexpr TypeCode typecode_of<Byte_Array> = TypeCode::Byte_Array;
+template <> inline constexpr TypeCode typecode_of<String> = TypeCode::String;
+template <> inline constexpr TypeCode typecode_of<List> = TypeCode::List;
+template <>
+inline constexpr TypeCode typecode_of<Compound> = TypeCode::Compound;
+template <>
+inline constexpr TypeCode typecode_of<Int_Array> = TypeCode::Int_Array;
+template <>
+inline constexpr TypeCode typecode_of<Long_Array> = TypeCode::Long_Array;
+
+/**
+ * @brief A List whose elements are all of one type, stored unboxed.
+ *
+ * A Packed_List is encoded exactly like a List of the same element type,
+ * but holds its elements in a std::vector of that type rather than as one
+ * Tag per element.  The elements may be numbers, Strings or Compounds.
+ */
+class Packed_List {
+  public:
+    using Storage =
+        std::variant<std::vector<Byte>, std::vector<Short>, std::vector<Int>,
+                     std::vector<Long>, std::vector<Float>,
+                     std::vector<Double>, std::vector<String>,
+                     std::vector<Compound>>;
+
+    template <typename T>
+        requires std::constructible_from<Storage, std::vector<T>>
+    explicit Packed_List(std::vector<T> elements)
+        : elements(std::move(elements)) {}
+
+    //! The TypeCode of the list elements
+    TypeCode element_type() const {
+        return std::visit(
+            [](const auto &v) {
+                using T = typename std::remove_cvref_t<decltype(v)>::value_type;
+                return typecode_of<T>;
+            },
+            elements);
+    }
+
+    std::size_t size() const {
+        return std::visit([](const auto &v) { return v.size(); }, elements);
+    }
+    bool empty() const { return size() == 0; }
+
+    template <typename T> std::vector<T> &get() {
+        return std::get<std::vector<T>>(elements);
+    }
+    template <typename T> const std::vector<T> &get() const {
+        return std::get<std::vector<T>>(elements);
+    }
+
+    Storage &storage() { return elements; }
+    const Storage &storage() const { return elements; }
+
+  private:
+    Storage elements;
+};
+
 using TagValue =
     std::variant<None, End, Byte, Short, Int, Long, Float, Double, Byte_Array,
-                 String, List, Compound, Int_Array, Long_Array>;
+                 String, List, Compound, Int_Array, Long_Array, Packed_List>;
 
 //! TagID is used with std::visit to get the TypeCode of a given Tag
 struct TagID {
@@ -94,6 +163,7 @@ struct TagID {
     auto operator()(const Compound &x) { return TypeCode::Compound; }
     auto operator()(const Int_Array &x) { return TypeCode::Int_Array; }
     auto operator()(const Long_Array &x) { return TypeCode::Long_Array; }
+    auto operator()(const Packed_List &x) { return TypeCode::List; }
 };
 
 class Tag {
@@ -123,6 +193,8 @@ class Tag {
             return std::get<Compound>(value).size();
         } else if (std::holds_alternative<List>(value)) {
             return std::get<List>(value).size();
+        } else if (std::holds_alternative<Packed_List>(value)) {
+            return std::get<Packed_List>(value).size();
         }
         throw std::runtime_error(
             "Called size() on a Tag which is neither Compound nor List.");
@@ -133,6 +205,8 @@ class Tag {
             return std::get<Compound>(value).empty();
         } else if (std::holds_alternative<List>(value)) {
             return std::get<List>(value).empty();
+        } else if (std::holds_alternative<Packed_List>(value)) {
+            return std::get<Packed_List>(value).empty();
         }
         throw std::runtime_error(
             "Called empty() on a Tag which is neither Compound nor List.");
@@ -175,13 +249,29 @@ class Tag {
     }
     void push_back(const Tag &t) { std::get<List>(value).push_back(t); }
     void push_back(Tag &&t) { std::get<List>(value).push_back(std::move(t)); }
+
+    // Packed_List wrapper methods
+    /**
+     *  @brief Returns the elements of a Packed_List Tag
+     *
+     *  @tparam T the element type, which must match the stored elements
+     *  @throw std::bad_variant_access if the Tag is not a Packed_List of T
+     */
+    template <typename T> std::vector<T> &get_list() {
+        return std::get<Packed_List>(value).get<T>();
+    }
+    template <typename T> const std::vector<T> &get_list() const {
+        return std::get<Packed_List>(value).get<T>();
+    }
 };
 
-inline const TypeCode list_type(const List &lst) {
+inline TypeCode list_type(const List &lst) {
     return lst.empty() ? TypeCode::End : lst[0].get_id();
 }
 
-inline std::string to_string(const Tag &tag);
+inline TypeCode list_type(const Packed_List &lst) {
+    return lst.element_type();
+}
 
 inline const char *typecode_to_string(TypeCode type) {
     switch (type) {
@@ -220,7 +310,10 @@ inline const char *typecode_to_string(TypeCode type) {
 
 inline std::string tag_id_string(const Tag &tag) {
     auto id = tag.get_id();
-    if (id == TypeCode::List) {
+    if (tag.is<Packed_List>()) {
+        return std::string("List of ") +
+               typecode_to_string(list_type(tag.get<Packed_List>()));
+    } else if (id == TypeCode::List) {
         return tag.empty() ? "List of End"
                            : std::string("List of ") +
                                  typecode_to_string(tag[0].get_id());
@@ -229,100 +322,8 @@ inline std::string tag_id_string(const Tag &tag) {
     }
 }
 
-template <typename T> std::string associative_to_string(const T &iterable) {
-    std::string output_string;
-    for (const auto &elt : iterable) {
-        if (output_string.empty()) {
-            output_string = "{";
-        } else {
-            output_string += ",";
-        }
-        if (snbt_requires_quoting(elt.first)) {
-            output_string += quoted_string(elt.first);
-        } else {
-            output_string += elt.first;
-        }
-
-        output_string += ":" + to_string(elt.second);
-    }
-    output_string += "}";
-    return output_string;
-}
-
-template <typename T>
-std::string sequential_to_string(const T &iterable,
-                                 const std::string &array_prefix) {
-    std::string output_string;
-    for (const auto &elt : iterable) {
-        if (output_string.empty()) {
-            output_string = "[" + array_prefix;
-        } else {
-            output_string += ",";
-        }
-        output_string += to_string(elt);
-    }
-    output_string += "]";
-    return output_string;
-}
-
-template <typename T>
-std::string array_to_string(const T &iterable, const std::string &array_prefix,
-                            const std::string &element_suffix) {
-    std::string output_string;
-    for (const auto &elt : iterable) {
-        if (output_string.empty()) {
-            output_string = "[" + array_prefix;
-        } else {
-            output_string += ",";
-        }
-        output_string += std::to_string(elt) + element_suffix;
-    }
-    output_string += "]";
-    return output_string;
-}
-
-inline std::string to_string(const Tag &tag) {
-    struct ToStringVisitor {
-        std::string operator()(const None x) const { return "<<NONE>>"; }
-        std::string operator()(const End x) const { return "<<END_TAG>>"; }
-        std::string operator()(const Compound &x) const {
-            return associative_to_string(x);
-        }
-        std::string operator()(const Byte x) const {
-            return std::to_string(x) + "b";
-        }
-        std::string operator()(const Short x) const {
-            return std::to_string(x) + "s";
-        }
-        std::string operator()(const Int x) const { return std::to_string(x); }
-        std::string operator()(const Long x) const {
-            return std::to_string(x) + "L";
-        }
-        std::string operator()(const Float x) const {
-            return std::to_string(x) + "f";
-        }
-        std::string operator()(const Double x) const {
-            return std::to_string(x) + "d";
-        }
-        std::string operator()(const Byte_Array &x) const {
-            return array_to_string(x, "B;", "b");
-        }
-        std::string operator()(const String &x) const {
-            return quoted_string(x);
-        }
-        std::string operator()(const List &x) const {
-            return sequential_to_string(x, "");
-        }
-        std::string operator()(const Int_Array &x) const {
-            return array_to_string(x, "I;", "");
-        }
-        std::string operator()(const Long_Array &x) const {
-            return array_to_string(x, "L;", "L");
-        }
-    };
-
-    return std::visit(ToStringVisitor{}, tag.get_value());
-}
+//! Returns the SNBT representation of a tag.
+std::string to_string(const Tag &tag);
 
 /** @name Output interface
  * @{
@@ -335,9 +336,7 @@ inline std::string to_string(const Tag &tag) {
  *
  * @note The string representation of the tag structure is in the SNBT format.
  * */
-inline std::ostream &operator<<(std::ostream &os, const Tag &tag) {
-    return (os << to_string(tag));
-}
+std::ostream &operator<<(std::ostream &os, const Tag &tag);
 /**
  * @}
  * */
@@ -0,0 +1,439 @@
+// Tape.cpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Encoding.hpp"
+#include "Tag.hpp"
+#include "Tape.hpp"
+#include "nbtview.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    std::size_t numeric_size(TypeCode type) {
+        switch (type) {
+        case TypeCode::Byte:
+            return sizeof(Byte);
+        case TypeCode::Short:
+            return sizeof(Short);
+        case TypeCode::Int:
+            return sizeof(Int);
+        case TypeCode::Long:
+            return sizeof(Long);
+        case TypeCode::Float:
+            return sizeof(Float);
+        case TypeCode::Double:
+            return sizeof(Double);
+        default:
+            return 0;
+        }
+    }
+
+} // namespace
+
+// TapeBuilder scans binary NBT data once, checking that every length lies
+// within the data, and appends an entry to the tape for each tag.
+// Containers being read are kept on an explicit stack rather than the
+// native one, and their depth and the number of tags are limited as by
+// read_options.
+class TapeBuilder {
+  public:
+    TapeBuilder(Tape &tape, const unsigned char *data, size_t data_length,
+                const read_options &options)
+        : tape(tape), reader(data, data_length), data_length(data_length),
+          options(options) {
+        if (data_length > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("NBT data is too large to index");
+        }
+    }
+
+    void build() {
+        Tape::Entry root{};
+        root.type = static_cast<TypeCode>(reader.read<int8_t>());
+        if (root.type == TypeCode::End) {
+            throw std::runtime_error("Root tag is an End tag");
+        }
+        read_name(root);
+        read_entry(root);
+        while (!stack.empty()) {
+            auto &top = stack.back();
+            auto &entry = tape.entries[top.index];
+            Tape::Entry child{};
+            if (entry.type == TypeCode::Compound) {
+                child.type = static_cast<TypeCode>(reader.read<int8_t>());
+                if (child.type != TypeCode::End) {
+                    read_name(child);
+                    ++entry.count;
+                    read_entry(child);
+                    continue;
+                }
+            } else if (top.remaining > 0) {
+                --top.remaining;
+                child.type = entry.list_type;
+                read_entry(child);
+                continue;
+            }
+            entry.next = static_cast<uint32_t>(tape.entries.size());
+            stack.pop_back();
+        }
+    }
+
+  private:
+    // A Compound or List whose members are still being read
+    struct Frame {
+        std::size_t index;
+        //! Number of elements still to be read, for a List
+        uint32_t remaining;
+    };
+
+    Tape &tape;
+    BinaryReader reader;
+    size_t data_length;
+    const read_options &options;
+    std::vector<Frame> stack;
+    std::size_t element_count = 0;
+
+    uint32_t offset() const {
+        return static_cast<uint32_t>(data_length - reader.remaining_length());
+    }
+
+    void count_elements(std::size_t n) {
+        element_count += n;
+        if (element_count > options.max_elements) {
+            throw LimitExceededException("NBT data has more than " +
+                                         std::to_string(options.max_elements) +
+                                         " tags");
+        }
+    }
+
+    void read_name(Tape::Entry &entry) {
+        entry.name_length = reader.read<uint16_t>();
+        entry.name = offset();
+        reader.skip(entry.name_length);
+    }
+
+    void read_elements(Tape::Entry &entry, std::size_t element_size) {
+        entry.payload = offset();
+        reader.skip(entry.count * element_size);
+    }
+
+    uint32_t read_array_length() {
+        auto length = reader.read<int32_t>();
+        if (length < 0) {
+            throw std::runtime_error("Negative array length");
+        }
+        return static_cast<uint32_t>(length);
+    }
+
+    // Appends the entry for a tag whose type and name have been read.  A
+    // Compound, or a List of non-numeric type, is pushed on the stack, and
+    // its entry is completed once its members have been read.
+    void read_entry(Tape::Entry entry) {
+        count_elements(1);
+        auto index = tape.entries.size();
+        tape.entries.push_back(entry);
+        switch (entry.type) {
+        case TypeCode::Byte:
+        case TypeCode::Short:
+        case TypeCode::Int:
+        case TypeCode::Long:
+        case TypeCode::Float:
+        case TypeCode::Double:
+            entry.count = 1;
+            read_elements(entry, numeric_size(entry.type));
+            break;
+        case TypeCode::Byte_Array:
+            entry.count = read_array_length();
+            read_elements(entry, sizeof(Byte));
+            break;
+        case TypeCode::Int_Array:
+            entry.count = read_array_length();
+            read_elements(entry, sizeof(Int));
+            break;
+        case TypeCode::Long_Array:
+            entry.count = read_array_length();
+            read_elements(entry, sizeof(Long));
+            break;
+        case TypeCode::String:
+            entry.count = reader.read<uint16_t>();
+            read_elements(entry, 1);
+            break;
+        case TypeCode::List: {
+            open_container();
+            entry.list_type = static_cast<TypeCode>(reader.read<int8_t>());
+            auto length = reader.read<int32_t>();
+            // A negative List length is read as an empty List.
+            entry.count = length > 0 ? static_cast<uint32_t>(length) : 0;
+            entry.payload = offset();
+            if (auto size = numeric_size(entry.list_type); size != 0) {
+                read_elements(entry, size);
+                count_elements(entry.count);
+                break;
+            }
+            entry.next = 0;
+            tape.entries[index] = entry;
+            stack.push_back({index, entry.count});
+            return;
+        }
+        case TypeCode::Compound:
+            open_container();
+            entry.payload = offset();
+            entry.count = 0;
+            tape.entries[index] = entry;
+            stack.push_back({index, 0});
+            return;
+        default:
+            throw std::runtime_error("Unhandled tag type");
+        }
+        entry.next = static_cast<uint32_t>(tape.entries.size());
+        tape.entries[index] = entry;
+    }
+
+    void open_container() {
+        if (stack.size() >= options.max_depth) {
+            throw LimitExceededException("NBT data is nested more than " +
+                                         std::to_string(options.max_depth) +
+                                         " levels deep");
+        }
+    }
+};
+
+Tape::Tape(const unsigned char *data, size_t data_length,
+           const read_options &options)
+    : data(data) {
+    TapeBuilder builder(*this, data, data_length, options);
+    builder.build();
+}
+
+template <typename T>
+TagValue Tape::materialize_numeric_list(const Entry &entry,
+                                        const read_options &options) const {
+    BinaryReader reader(data + entry.payload, entry.count * sizeof(T));
+    if (options.packed_lists) {
+        return Packed_List(reader.read_array<T>(entry.count));
+    }
+    List lst;
+    lst.reserve(entry.count);
+    for (uint32_t i = 0; i < entry.count; ++i) {
+        lst.emplace_back(reader.read<T>());
+    }
+    return lst;
+}
+
+Tag Tape::materialize(std::size_t index, const read_options &options) const {
+    const Entry &entry = entries.at(index);
+    auto payload = data + entry.payload;
+    switch (entry.type) {
+    case TypeCode::Byte:
+        return BinaryReader(payload, sizeof(Byte)).read<Byte>();
+    case TypeCode::Short:
+        return BinaryReader(payload, sizeof(Short)).read<Short>();
+    case TypeCode::Int:
+        return BinaryReader(payload, sizeof(Int)).read<Int>();
+    case TypeCode::Long:
+        return BinaryReader(payload, sizeof(Long)).read<Long>();
+    case TypeCode::Float:
+        return BinaryReader(payload, sizeof(Float)).read<Float>();
+    case TypeCode::Double:
+        return BinaryReader(payload, sizeof(Double)).read<Double>();
+    case TypeCode::Byte_Array:
+        return BinaryReader(payload, entry.count)
+            .read_array<Byte>(entry.count);
+    case TypeCode::Int_Array:
+        return BinaryReader(payload, entry.count * sizeof(Int))
+            .read_array<Int>(entry.count);
+    case TypeCode::Long_Array:
+        return BinaryReader(payload, entry.count * sizeof(Long))
+            .read_array<Long>(entry.count);
+    case TypeCode::String:
+        return String(reinterpret_cast<const char *>(payload), entry.count);
+    case TypeCode::List: {
+        switch (entry.list_type) {
+        case TypeCode::Byte:
+            return materialize_numeric_list<Byte>(entry, options);
+        case TypeCode::Short:
+            return materialize_numeric_list<Short>(entry, options);
+        case TypeCode::Int:
+            return materialize_numeric_list<Int>(entry, options);
+        case TypeCode::Long:
+            return materialize_numeric_list<Long>(entry, options);
+        case TypeCode::Float:
+            return materialize_numeric_list<Float>(entry, options);
+        case TypeCode::Double:
+            return materialize_numeric_list<Double>(entry, options);
+        default:
+            break;
+        }
+        auto lst = detail::empty_list(entry.list_type, options, entry.count);
+        auto child = index + 1;
+        for (uint32_t i = 0; i < entry.count; ++i) {
+            detail::append_element(
+                lst, std::move(materialize(child, options).get_value()));
+            child = entries[child].next;
+        }
+        return lst;
+    }
+    case TypeCode::Compound: {
+        Compound cmpd;
+        auto child = index + 1;
+        for (uint32_t i = 0; i < entry.count; ++i) {
+            cmpd.emplace(std::string(name(entries[child])),
+                         materialize(child, options));
+            child = entries[child].next;
+        }
+        return cmpd;
+    }
+    default:
+        return Tag();
+    }
+}
+
+namespace {
+
+    // A subtree to be decoded into a Tag which has already been allocated.
+    // The element of a packed List of Compounds is filled in instead,
+    // if element is set.
+    struct Job {
+        Tag *slot;
+        Compound *element;
+        std::size_t index;
+        std::size_t entry_count;
+    };
+
+    // Splits the subtree at index into jobs of at most grain entries where
+    // possible.  Containers which are split are built here, with default
+    // Tags in place of their members; these are filled in by the jobs.
+    // Lists take the same form as from read_binary() with these options.
+    void plan_jobs(const Tape &tape, Tag &slot, std::size_t index,
+                   std::size_t grain, const read_options &options,
+                   std::vector<Job> &jobs) {
+        const auto &entry = tape[index];
+        auto entry_count = entry.next - index;
+        bool has_child_entries = entry_count > 1;
+        if (!has_child_entries || entry_count <= grain) {
+            jobs.push_back({&slot, nullptr, index, entry_count});
+            return;
+        }
+        auto child = index + 1;
+        if (entry.type == TypeCode::List &&
+            !std::holds_alternative<List>(
+                detail::empty_list(entry.list_type, options, 0))) {
+            // The elements of a Packed_List are not Tags; those of a List
+            // of Compounds are decoded by a job each, and a List of
+            // Strings is decoded whole.
+            if (entry.list_type != TypeCode::Compound) {
+                jobs.push_back({&slot, nullptr, index, entry_count});
+                return;
+            }
+            slot = Packed_List(std::vector<Compound>(entry.count));
+            auto &elements = slot.get<Packed_List>().get<Compound>();
+            for (uint32_t i = 0; i < entry.count; ++i) {
+                jobs.push_back({nullptr, &elements[i], child,
+                                tape[child].next - child});
+                child = tape[child].next;
+            }
+        } else if (entry.type == TypeCode::Compound) {
+            slot = Compound{};
+            auto &cmpd = slot.get<Compound>();
+            for (uint32_t i = 0; i < entry.count; ++i) {
+                auto [it, inserted] =
+                    cmpd.emplace(std::string(tape.name(tape[child])), Tag());
+                if (inserted) {
+                    plan_jobs(tape, it->second, child, grain, options,
+                              jobs);
+                }
+                child = tape[child].next;
+            }
+        } else {
+            slot = List(entry.count);
+            auto &lst = slot.get<List>();
+            for (uint32_t i = 0; i < entry.count; ++i) {
+                plan_jobs(tape, lst[i], child, grain, options, jobs);
+                child = tape[child].next;
+            }
+        }
+    }
+
+} // namespace
+
+std::pair<std::string, Tag>
+read_binary_parallel(const unsigned char *data, size_t data_length,
+                     unsigned thread_count, const read_options &options) {
+    std::vector<unsigned char> inflated_data_holder;
+    if (has_compression_header(data, data_length)) {
+        inflated_data_holder = decompress_data(data, data_length);
+        data = inflated_data_holder.data();
+        data_length = inflated_data_holder.size();
+    }
+    // Tapes are built from Java NBT only.
+    if (options.encoding != Binary_Encoding::big_endian) {
+        return read_binary(data, data_length, options);
+    }
+    Tape tape(data, data_length, options);
+    std::pair<std::string, Tag> result(tape.name(tape[0]), Tag());
+
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (thread_count == 1) {
+        result.second = tape.materialize(0, options);
+        return result;
+    }
+
+    // Aim for several jobs per thread, so that they balance out.
+    const std::size_t min_grain = 256;
+    auto grain = std::max(min_grain, tape.size() / (8 * thread_count));
+    std::vector<Job> jobs;
+    plan_jobs(tape, result.second, 0, grain, options, jobs);
+    std::sort(jobs.begin(), jobs.end(), [](const Job &a, const Job &b) {
+        return a.entry_count > b.entry_count;
+    });
+
+    std::atomic<std::size_t> next_job = 0;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto work = [&] {
+        try {
+            for (auto i = next_job++; i < jobs.size(); i = next_job++) {
+                auto tag = tape.materialize(jobs[i].index, options);
+                if (jobs[i].element != nullptr) {
+                    *jobs[i].element = std::move(tag.get<Compound>());
+                } else {
+                    *jobs[i].slot = std::move(tag);
+                }
+            }
+        } catch (...) {
+            std::lock_guard lock(error_mutex);
+            error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> workers;
+    auto worker_count = std::min<std::size_t>(thread_count, jobs.size());
+    for (std::size_t i = 1; i < worker_count; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return result;
+}
+
+} // namespace nbtview
@@ -0,0 +1,106 @@
+/**
+ * @file Tape.hpp
+ * @brief A structural index of binary NBT data, for parallel decoding
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_TAPE_H_
+#define NBT_TAPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Deserializer.hpp"
+#include "Tag.hpp"
+
+namespace nbtview {
+
+/**
+ * @brief Tape records the type, position and length of every tag in a
+ * block of uncompressed binary NBT data, in a single validating pass.
+ *
+ * Entries are stored in document order.  The entries for the members of a
+ * Compound, or the elements of a List of non-numeric type, follow the
+ * container's own entry, and each entry records the index just past its
+ * subtree so that whole subtrees can be skipped.  Arrays and Lists of
+ * numeric type are a single entry.
+ *
+ * Any subtree may then be decoded independently with materialize().  The
+ * data must outlive the Tape.
+ *
+ * The data is scanned without recursion, and the nesting depth and total
+ * number of tags are limited as by read_options; exceeding either throws
+ * LimitExceededException.
+ */
+class Tape {
+  public:
+    struct Entry {
+        TypeCode type;
+        //! Element type, for List entries
+        TypeCode list_type;
+        uint16_t name_length;
+        //! Offset of the name; unnamed list elements have no name
+        uint32_t name;
+        //! Offset of the payload, after any length prefix
+        uint32_t payload;
+        //! Number of bytes in a String, elements in an array or List, or
+        //! members of a Compound
+        uint32_t count;
+        //! Index of the first entry after this subtree
+        uint32_t next;
+    };
+
+    //! Indexes uncompressed binary NBT data holding one named root tag.
+    //! Only the limits of options are consulted.
+    Tape(const unsigned char *data, size_t data_length,
+         const read_options &options = {});
+
+    std::size_t size() const { return entries.size(); }
+    const Entry &operator[](std::size_t index) const { return entries[index]; }
+
+    std::string_view name(const Entry &entry) const {
+        return {reinterpret_cast<const char *>(data) + entry.name,
+                entry.name_length};
+    }
+
+    //! Decodes the subtree whose root is at index into a Tag.
+    Tag materialize(std::size_t index, const read_options &options = {}) const;
+
+  private:
+    friend class TapeBuilder;
+
+    const unsigned char *data;
+    std::vector<Entry> entries;
+
+    template <typename T>
+    TagValue materialize_numeric_list(const Entry &entry,
+                                      const read_options &options) const;
+};
+
+/**
+ * @brief Decodes binary NBT data on several threads.
+ *
+ * A Tape is built first; then subtrees are decoded concurrently into their
+ * places in the result.  The result is the same as that of read_binary().
+ * Input in a Bedrock encoding is decoded by read_binary() on one thread.
+ *
+ * @param data binary NBT data, which may be zlib or gzip compressed
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * */
+std::pair<std::string, Tag>
+read_binary_parallel(const unsigned char *data, size_t data_length,
+                     unsigned thread_count = 0,
+                     const read_options &options = {});
+
+} // namespace nbtview
+
+#endif // NBT_TAPE_H_
@@ -0,0 +1,309 @@
+// Validation.cpp
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Parallel.hpp"
+#include "Region.hpp"
+#include "Tape.hpp"
+#include "Validation.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbtview {
+
+namespace {
+
+    // A chunk whose header entry is sound, to be read and decoded
+    struct Chunk_Job {
+        std::size_t file;
+        int chunk;
+        uint32_t sector;
+        uint8_t sector_count;
+    };
+
+    const int chunk_header_length = 5;
+
+    // Checks the header of a region file, adding a job for each chunk
+    // whose sectors are sound.
+    void check_header(std::size_t file, Region_Report &report,
+                      std::vector<Chunk_Job> &jobs) {
+        auto file_length = std::filesystem::file_size(report.filename);
+        if (file_length == 0) {
+            return;
+        }
+        if (file_length < 2 * Region::sector_length) {
+            report.faults.push_back({-1, Region_Problem::truncated_header, 0,
+                                     "File is too short for a region "
+                                     "header"});
+            return;
+        }
+        Region::Sector_Data offsets(Region::sector_length);
+        Region::Sector_Data timestamps(Region::sector_length);
+        std::ifstream input(report.filename, std::ios::binary);
+        input.read(reinterpret_cast<char *>(offsets.data()), offsets.size());
+        input.read(reinterpret_cast<char *>(timestamps.data()),
+                   timestamps.size());
+        if (!input) {
+            throw std::runtime_error("Could not read the header of region "
+                                     "file " +
+                                     report.filename);
+        }
+        Region region;
+        region.load_from_sectors(offsets, timestamps);
+
+        auto file_sectors = (file_length + Region::sector_length - 1) /
+                            Region::sector_length;
+        std::vector<Chunk_Job> sound;
+        for (int i = 0; i < Region::chunk_count; ++i) {
+            const auto &entry = region.chunk[i];
+            if (entry.offset == 0 && entry.length == 0) {
+                continue;
+            }
+            ++report.chunk_count;
+            if (entry.length == 0) {
+                report.faults.push_back({i, Region_Problem::bad_length,
+                                         entry.offset,
+                                         "Chunk occupies no sectors"});
+            } else if (entry.offset < 2 ||
+                       entry.offset + entry.length > file_sectors) {
+                report.faults.push_back(
+                    {i, Region_Problem::sector_out_of_range, entry.offset,
+                     "Sectors " + std::to_string(entry.offset) + " to " +
+                         std::to_string(entry.offset + entry.length - 1) +
+                         " lie outside sectors 2 to " +
+                         std::to_string(file_sectors - 1) + " of the file"});
+            } else {
+                sound.push_back({file, i, entry.offset, entry.length});
+            }
+        }
+
+        // Sweep the chunks in order of their sectors, remembering the one
+        // which reaches furthest, to find each pair which overlaps.
+        std::sort(sound.begin(), sound.end(),
+                  [](const Chunk_Job &a, const Chunk_Job &b) {
+                      return a.sector < b.sector;
+                  });
+        // partner[j] is a chunk which overlaps sound[j], if any.
+        std::vector<int> partner(sound.size(), -1);
+        std::size_t furthest = 0;
+        for (std::size_t j = 1; j < sound.size(); ++j) {
+            const auto &reach = sound[furthest];
+            if (sound[j].sector < reach.sector + reach.sector_count) {
+                partner[j] = reach.chunk;
+                if (partner[furthest] < 0) {
+                    partner[furthest] = sound[j].chunk;
+                }
+            }
+            if (sound[j].sector + sound[j].sector_count >
+                reach.sector + reach.sector_count) {
+                furthest = j;
+            }
+        }
+        for (std::size_t j = 0; j < sound.size(); ++j) {
+            if (partner[j] >= 0) {
+                report.faults.push_back(
+                    {sound[j].chunk, Region_Problem::overlapping_sectors,
+                     sound[j].sector,
+                     "Sectors overlap those of chunk " +
+                         std::to_string(partner[j])});
+            } else {
+                jobs.push_back(sound[j]);
+            }
+        }
+    }
+
+    // Reads, inflates and indexes one chunk; returns its fault, if any.
+    std::optional<Region_Fault> check_chunk(const Chunk_Job &job,
+                                            const std::string &filename,
+                                            std::ifstream &input,
+                                            std::vector<unsigned char> &bytes,
+                                            std::size_t max_chunk_length) {
+        auto fault = [&](Region_Problem problem, uint32_t sector,
+                         std::string message) {
+            return Region_Fault{job.chunk, problem, sector,
+                                std::move(message)};
+        };
+        // The last sector of a file need not be padded out in full.
+        bytes.resize(std::size_t(job.sector_count) * Region::sector_length);
+        input.clear();
+        input.seekg(std::streamoff(job.sector) * Region::sector_length);
+        input.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+        bytes.resize(input.gcount());
+        if (bytes.size() < chunk_header_length) {
+            return fault(Region_Problem::bad_length, job.sector,
+                         "Chunk header lies past the end of the file");
+        }
+
+        uint32_t length = (uint32_t(bytes[0]) << 24) |
+                          (uint32_t(bytes[1]) << 16) |
+                          (uint32_t(bytes[2]) << 8) | bytes[3];
+        if (length == 0 || length > bytes.size() - 4) {
+            return fault(Region_Problem::bad_length, job.sector,
+                         "Length " + std::to_string(length) +
+                             " does not fit in " +
+                             std::to_string(job.sector_count) + " sectors");
+        }
+        auto compression = bytes[4];
+        const unsigned char *data = bytes.data() + chunk_header_length;
+        std::size_t data_length = length - 1;
+
+        // An external chunk's data is the whole of its .mcc file.
+        std::vector<unsigned char> external;
+        bool is_external = (compression & Region::external_flag) != 0;
+        if (is_external) {
+            compression &= ~Region::external_flag;
+            try {
+                external = read_external_chunk(filename, job.chunk);
+            } catch (const std::runtime_error &e) {
+                return fault(Region_Problem::missing_external, job.sector,
+                             e.what());
+            }
+            data = external.data();
+            data_length = external.size();
+        }
+
+        std::vector<unsigned char> inflated;
+        if (compression == 1 || compression == 2) {
+            auto [output, status] =
+                inflate_sectors(data, data_length, max_chunk_length);
+            if (status.too_large) {
+                return fault(Region_Problem::oversized_data, job.sector,
+                             "Data inflates to more than " +
+                                 std::to_string(max_chunk_length) +
+                                 " bytes");
+            }
+            if (status.corrupt) {
+                // The sectors of an external chunk are those of its
+                // header alone.
+                auto sector = is_external
+                                  ? job.sector
+                                  : job.sector + (chunk_header_length +
+                                                  status.input_used) /
+                                                     Region::sector_length;
+                return fault(Region_Problem::corrupt_data,
+                             static_cast<uint32_t>(sector),
+                             "Compressed data is invalid after " +
+                                 std::to_string(status.input_used) +
+                                 " bytes");
+            }
+            if (!status.complete) {
+                return fault(Region_Problem::truncated_data, job.sector,
+                             "Compressed data ends early");
+            }
+            inflated = std::move(output);
+            data = inflated.data();
+            data_length = inflated.size();
+        } else if (compression != 3) {
+            return fault(Region_Problem::bad_compression, job.sector,
+                         "Unknown compression type " +
+                             std::to_string(bytes[4]));
+        } else if (data_length > max_chunk_length) {
+            return fault(Region_Problem::oversized_data, job.sector,
+                         "Data is longer than " +
+                             std::to_string(max_chunk_length) + " bytes");
+        }
+
+        try {
+            Tape tape(data, data_length);
+        } catch (const std::runtime_error &e) {
+            return fault(Region_Problem::invalid_nbt, job.sector, e.what());
+        }
+        return std::nullopt;
+    }
+
+} // namespace
+
+const char *region_problem_name(Region_Problem problem) {
+    switch (problem) {
+    case Region_Problem::truncated_header:
+        return "truncated_header";
+    case Region_Problem::sector_out_of_range:
+        return "sector_out_of_range";
+    case Region_Problem::overlapping_sectors:
+        return "overlapping_sectors";
+    case Region_Problem::bad_length:
+        return "bad_length";
+    case Region_Problem::bad_compression:
+        return "bad_compression";
+    case Region_Problem::missing_external:
+        return "missing_external";
+    case Region_Problem::corrupt_data:
+        return "corrupt_data";
+    case Region_Problem::truncated_data:
+        return "truncated_data";
+    case Region_Problem::oversized_data:
+        return "oversized_data";
+    case Region_Problem::invalid_nbt:
+        return "invalid_nbt";
+    }
+    return "unknown";
+}
+
+std::vector<Region_Report>
+validate_regions(const std::vector<std::string> &filenames,
+                 unsigned thread_count, std::size_t max_chunk_length) {
+    std::vector<Region_Report> reports(filenames.size());
+    std::vector<Chunk_Job> jobs;
+    for (std::size_t f = 0; f < filenames.size(); ++f) {
+        reports[f].filename = filenames[f];
+        check_header(f, reports[f], jobs);
+    }
+
+    // Each worker keeps the file of its last job open, and a buffer.
+    struct Worker {
+        std::size_t file = 0;
+        std::ifstream input;
+        std::vector<unsigned char> bytes;
+    };
+    std::vector<Worker> workers(
+        detail::worker_count(thread_count, jobs.size()));
+    std::vector<std::optional<Region_Fault>> job_faults(jobs.size());
+    auto run_job = [&](std::size_t j, unsigned w) {
+        auto &worker = workers[w];
+        if (!worker.input.is_open() || worker.file != jobs[j].file) {
+            worker.input.close();
+            worker.input.open(filenames[jobs[j].file], std::ios::binary);
+            if (!worker.input) {
+                throw std::runtime_error("Could not open region file " +
+                                         filenames[jobs[j].file]);
+            }
+            worker.file = jobs[j].file;
+        }
+        job_faults[j] =
+            check_chunk(jobs[j], filenames[jobs[j].file], worker.input,
+                        worker.bytes, max_chunk_length);
+    };
+    detail::parallel_for(jobs.size(), thread_count, run_job);
+
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        auto &report = reports[jobs[j].file];
+        if (job_faults[j]) {
+            report.faults.push_back(std::move(*job_faults[j]));
+        } else {
+            ++report.valid_chunk_count;
+        }
+    }
+    for (auto &report : reports) {
+        std::stable_sort(report.faults.begin(), report.faults.end(),
+                         [](const Region_Fault &a, const Region_Fault &b) {
+                             return a.chunk < b.chunk;
+                         });
+    }
+    return reports;
+}
+
+Region_Report validate_region(const std::string &filename,
+                              unsigned thread_count,
+                              std::size_t max_chunk_length) {
+    return std::move(
+        validate_regions({filename}, thread_count, max_chunk_length)[0]);
+}
+
+} // namespace nbtview
@@ -0,0 +1,113 @@
+/**
+ * @file Validation.hpp
+ * @brief Check region files for damage, and locate it
+ * @author Michael Spitznagel
+ * @copyright Copyright 2023 Michael Spitznagel. Released under the Boost
+ * Software License 1.0
+ *
+ * https://github.com/maspitz/nbtview
+ */
+
+#ifndef NBT_VALIDATION_H_
+#define NBT_VALIDATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nbtview {
+
+//! A kind of damage found by validate_region()
+enum class Region_Problem : uint8_t {
+    //! The file is too short to hold the two header sectors.
+    truncated_header,
+    //! The chunk's sectors overlap the header or run past the end of the
+    //! file.
+    sector_out_of_range,
+    //! The chunk's sectors overlap those of another chunk.
+    overlapping_sectors,
+    //! The chunk's length field is zero, or exceeds its sectors.
+    bad_length,
+    //! The chunk's compression type is not gzip, zlib or none.
+    bad_compression,
+    //! The chunk is stored outside the region file, and its .mcc file
+    //! cannot be read.
+    missing_external,
+    //! The chunk's compressed data is invalid.
+    corrupt_data,
+    //! The chunk's compressed data ends early.
+    truncated_data,
+    //! The chunk's data inflates to more than the limit.
+    oversized_data,
+    //! The chunk's data is not valid NBT.
+    invalid_nbt,
+};
+
+//! The default limit on the inflated length of a chunk's data, far more
+//! than any chunk Minecraft writes
+inline constexpr std::size_t default_max_chunk_length = 256 << 20;
+
+//! Returns a short name for a problem, such as "overlapping_sectors".
+const char *region_problem_name(Region_Problem problem);
+
+//! One problem found in a region file
+struct Region_Fault {
+    //! Index of the chunk within the region, or -1 for the file as a whole
+    int chunk;
+    Region_Problem problem;
+    //! Index of the sector of the file where the problem lies: for
+    //! corrupt_data, the sector where inflation failed, which is no earlier
+    //! than the damage (damage to stored data is found only by the
+    //! checksum at its end); otherwise the chunk's first sector
+    uint32_t sector;
+    std::string message;
+};
+
+//! The result of validating one region file
+struct Region_Report {
+    std::string filename;
+    //! Number of chunks the header lists
+    std::size_t chunk_count = 0;
+    //! Number of those which passed every check
+    std::size_t valid_chunk_count = 0;
+    //! Every problem found, ordered by chunk
+    std::vector<Region_Fault> faults;
+
+    bool ok() const { return faults.empty(); }
+};
+
+/**
+ * @brief Validates region files, on several threads.
+ *
+ * The header of each file is checked first: each chunk's sectors must lie
+ * between the header and the end of the file, and no two chunks may share
+ * a sector.  Every chunk which passes is then read, its length field and
+ * compression type checked, and its data inflated and indexed as NBT, as
+ * by Tape, without decoding it into Tags.  Chunks are handed out to the
+ * workers across all the files together, and each worker reads through
+ * its own handles on the files.
+ *
+ * An empty file is a valid region with no chunks.  A chunk stored outside
+ * the region file is checked by reading its file c.X.Z.mcc beside the
+ * region file, which must then be named r.X.Z.mca.
+ *
+ * @param thread_count number of threads; 0 uses one per hardware thread
+ * @param max_chunk_length chunks whose data inflates to more bytes than
+ * this are reported as oversized_data, without inflating the rest
+ * @return a report for each file, in the order given
+ * @throw std::runtime_error if a file cannot be read
+ */
+std::vector<Region_Report>
+validate_regions(const std::vector<std::string> &filenames,
+                 unsigned thread_count = 0,
+                 std::size_t max_chunk_length = default_max_chunk_length);
+
+//! Validates one region file; see validate_regions().
+Region_Report
+validate_region(const std::string &filename, unsigned thread_count = 0,
+                std::size_t max_chunk_length = default_max_chunk_length);
+
+} // namespace nbtview
+
+#endif // NBT_VALIDATION_H_
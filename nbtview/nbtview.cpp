@@ -1,13 +1,20 @@
 #include <algorithm>
+#include <cstddef>
 #include <istream>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "zlib_utils.hpp"
 
 #include "BinaryDeserializer.hpp"
+#include "BinaryReader.hpp"
+#include "Encoding.hpp"
+#include "IncrementalParser.hpp"
 #include "Serializer.hpp"
+#include "SnbtDeserializer.hpp"
 #include "Tag.hpp"
 #include "nbtview.hpp"
 
@@ -18,58 +25,110 @@ fast_find_named_tag(std::vector<unsigned char>::const_iterator nbt_start,
                     std::vector<unsigned char>::const_iterator nbt_stop,
                     TypeCode tag_type, const std::string &tag_name) {
 
-    auto loc = nbt_start;
-    const char byte_1 = static_cast<char>(tag_type);
-    const char byte_2 = tag_name.length() / 16;
-    const char byte_3 = tag_name.length() % 16;
-    while (1) {
-        loc = std::search(loc, nbt_stop, tag_name.begin(), tag_name.end());
-        if (loc == nbt_stop) {
-            return nbt_stop;
-        }
-        if (loc - nbt_start >= 3 && *(loc - 3) == byte_1 &&
-            *(loc - 2) == byte_2 && *(loc - 1) == byte_3 &&
-            tag_name.length() < nbt_stop - loc) {
-            return loc + tag_name.length();
-        }
-        loc++;
+    // The tag's header: its type, the big-endian length of its name, and
+    // the name itself.
+    std::vector<unsigned char> header{
+        static_cast<unsigned char>(tag_type),
+        static_cast<unsigned char>(tag_name.length() >> 8),
+        static_cast<unsigned char>(tag_name.length() & 0xff)};
+    header.insert(header.end(), tag_name.begin(), tag_name.end());
+    auto loc = std::search(nbt_start, nbt_stop, header.begin(), header.end());
+    if (loc == nbt_stop ||
+        nbt_stop - loc <= static_cast<std::ptrdiff_t>(header.size())) {
+        return nbt_stop;
     }
+    return loc + header.size();
 }
 
-std::pair<std::string, Tag> read_binary(std::istream &input) {
-    // Get stream size
-    input.seekg(0, input.end);
-    std::streampos n_bytes = input.tellg();
-    input.seekg(0, input.beg);
+std::pair<std::string, Tag> read_binary(std::istream &input,
+                                        const read_options &options) {
+    if (options.encoding != Binary_Encoding::big_endian) {
+        std::vector<unsigned char> bytes{std::istreambuf_iterator<char>(input),
+                                         std::istreambuf_iterator<char>()};
+        return read_binary(bytes, options);
+    }
+
+    auto block_size = std::max<std::size_t>(options.stream_block_size, 4);
+    std::vector<unsigned char> block(block_size);
+    // Waits for min_length bytes, or the end of the input, then takes
+    // whatever more has already arrived, so that a pipe or socket which
+    // has sent the last of the data is not waited on for a full block.
+    auto read_block = [&](std::size_t min_length = 1) {
+        auto data = reinterpret_cast<char *>(block.data());
+        input.read(data, min_length);
+        auto length = static_cast<std::size_t>(input.gcount());
+        if (length == min_length) {
+            length += input.readsome(data + length, block_size - length);
+        }
+        return length;
+    };
+
+    Incremental_Parser parser(options);
+    // The first block holds enough to tell whether the data is compressed.
+    auto length = read_block(4);
+    if (!has_compression_header(block.data(), length)) {
+        while (parser.feed(block.data(), length) !=
+               Parse_Status::complete) {
+            if ((length = read_block()) == 0) {
+                throw UnexpectedEndOfInputException();
+            }
+        }
+        return parser.take_result();
+    }
 
-    // Read stream into vector of bytes
-    std::vector<unsigned char> bytes(n_bytes);
-    input.read(reinterpret_cast<char *>(bytes.data()), n_bytes);
-    return read_binary(bytes);
+    Stream_Inflater inflater;
+    std::vector<unsigned char> inflated(block_size);
+    inflater.set_input(block.data(), length);
+    for (;;) {
+        auto n = inflater.inflate(inflated.data(), inflated.size());
+        if (n > 0) {
+            if (parser.feed(inflated.data(), n) == Parse_Status::complete) {
+                return parser.take_result();
+            }
+        } else if (inflater.finished() || (length = read_block()) == 0) {
+            throw UnexpectedEndOfInputException();
+        } else {
+            inflater.set_input(block.data(), length);
+        }
+    }
 }
 
 std::pair<std::string, Tag> read_binary(const unsigned char *data,
-                                        size_t data_length) {
+                                        size_t data_length,
+                                        const read_options &options) {
     std::vector<unsigned char> inflated_data_holder;
     if (has_compression_header(data, data_length)) {
         inflated_data_holder = decompress_data(data, data_length);
         data = inflated_data_holder.data();
         data_length = inflated_data_holder.size();
     }
-    BinaryDeserializer reader(data, data_length);
-    auto root_data = reader.deserialize();
-    auto &root_name = root_data.first;
-    return {root_name, std::move(root_data.second)};
+    return detail::with_encoding(options.encoding, [&](auto encoding) {
+        BasicBinaryDeserializer<decltype(encoding)> reader(data, data_length,
+                                                           options);
+        return reader.deserialize();
+    });
+}
+
+std::pair<std::string, Tag> read_binary(std::vector<unsigned char> bytes,
+                                        const read_options &options) {
+    return read_binary(bytes.data(), bytes.size(), options);
 }
 
-std::pair<std::string, Tag> read_binary(std::vector<unsigned char> bytes) {
-    return read_binary(bytes.data(), bytes.size());
+Tag read_snbt(std::string_view text) {
+    SnbtDeserializer reader(text);
+    return std::move(reader.deserialize().second);
 }
 
-void write_binary(const Tag &tag, std::string_view name, std::ostream &output) {
-    BinaryWriter::write(std::visit(TagID(), tag.get_value()), output);
-    BinaryWriter::write_string(name, output);
-    std::visit(detail::PayloadSerializer{output}, tag.get_value());
+void write_binary(const Tag &tag, std::string_view name, std::ostream &output,
+                  Binary_Encoding encoding) {
+    detail::with_encoding(encoding, [&](auto policy) {
+        using Encoding = decltype(policy);
+        using Writer = BasicBinaryWriter<Encoding>;
+        Writer::write(std::visit(TagID(), tag.get_value()), output);
+        Writer::write_string(name, output);
+        std::visit(detail::BasicPayloadSerializer<Encoding>{output},
+                   tag.get_value());
+    });
 }
 
 } // namespace nbtview
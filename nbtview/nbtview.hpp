@@ -13,9 +13,12 @@
 
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "Deserializer.hpp"
+#include "Encoding.hpp"
 #include "Tag.hpp"
 
 class List;
@@ -35,6 +38,9 @@ namespace nbtview {
 // (2) It is the calling code's responsibility to check that the
 // remaining NBT data is large enough to contain the tag's expected
 // payload.
+//
+// To find several tags, use a Scanner (Scanner.hpp), which finds them
+// all in one pass and can validate what it finds.
 
 std::vector<unsigned char>::const_iterator
 fast_find_named_tag(std::vector<unsigned char>::const_iterator nbt_start,
@@ -47,23 +53,46 @@ fast_find_named_tag(std::vector<unsigned char>::const_iterator nbt_start,
  * */
 /**
  * @brief Deserializes from a stream.
+ *
+ * The stream need not be seekable: Java NBT is pulled through a buffer of
+ * options.stream_block_size bytes, inflated block by block if it is
+ * compressed, and decoded as it arrives, so pipes and sockets may be read
+ * without holding the whole input in memory.  Each read takes what has
+ * already arrived, up to a block, rather than waiting for a full block.
+ * Input past the end of the root tag may be consumed.  Bedrock input is read in full before it is
+ * decoded.
+ *
  * @param input An istream opened with ios::binary.
+ * @param options Options controlling how the tags are stored, and the
+ * encoding of the input.
  * @return A pair consisting of the decoded root tag's name and payload.
  *
  * @throw std::runtime_error if the input could not be decoded successfully.
  * */
-std::pair<std::string, Tag> read_binary(std::istream &input);
+std::pair<std::string, Tag> read_binary(std::istream &input,
+                                        const read_options &options = {});
 /**
  * @brief Deserializes from a vector of bytes.
  * @param bytes A vector of unsigned char.
+ * @param options Options controlling how the tags are stored.
  * @return A pair consisting of the decoded root tag's name and payload.
  *
  * @throw std::runtime_error if the input could not be decoded successfully.
  * */
-std::pair<std::string, Tag> read_binary(std::vector<unsigned char> bytes);
+std::pair<std::string, Tag> read_binary(std::vector<unsigned char> bytes,
+                                        const read_options &options = {});
 
 std::pair<std::string, Tag> read_binary(const unsigned char *data,
-                                        size_t data_length);
+                                        size_t data_length,
+                                        const read_options &options = {});
+/**
+ * @brief Deserializes from SNBT text.
+ * @param text The SNBT representation of a tag.
+ * @return The decoded tag.
+ *
+ * @throw SnbtSyntaxError if the text is not valid SNBT.
+ * */
+Tag read_snbt(std::string_view text);
 /**
  * @}
  * */
@@ -76,10 +105,12 @@ std::pair<std::string, Tag> read_binary(const unsigned char *data,
  * @param tag The tag to be serialized.
  * @param name The name specified for the tag.
  * @param output An ostream opened with ios::binary.
+ * @param encoding Java NBT by default, or one of Bedrock's encodings.
  *
  * @note The binary encoding of the tag is in the NBT format.
  * */
-void write_binary(const Tag &tag, std::string_view name, std::ostream &output);
+void write_binary(const Tag &tag, std::string_view name, std::ostream &output,
+                  Binary_Encoding encoding = Binary_Encoding::big_endian);
 /**
  * @}
  * */
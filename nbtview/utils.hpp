@@ -11,21 +11,69 @@
 #ifndef NBT_UTILS_H_
 #define NBT_UTILS_H_
 
-#include <regex>
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace nbtview {
 
-inline bool snbt_requires_quoting(const std::string &str) {
-    std::regex pattern("^[a-zA-Z0-9_\\-\\.\\+]*$");
-    return std::regex_match(str, pattern) == false;
+namespace detail {
+
+    //! Characters which may appear in an unquoted SNBT key
+    constexpr std::array<bool, 256> snbt_unquoted_char_table = [] {
+        std::array<bool, 256> table{};
+        for (int c = 'a'; c <= 'z'; ++c) {
+            table[c] = true;
+        }
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            table[c] = true;
+        }
+        for (int c = '0'; c <= '9'; ++c) {
+            table[c] = true;
+        }
+        table['_'] = table['-'] = table['.'] = table['+'] = true;
+        return table;
+    }();
+
+    inline bool snbt_unquoted_char(char c) {
+        return snbt_unquoted_char_table[static_cast<unsigned char>(c)];
+    }
+
+} // namespace detail
+
+inline bool snbt_requires_quoting(std::string_view str) {
+    if (str.empty()) {
+        return true;
+    }
+    for (char c : str) {
+        if (!detail::snbt_unquoted_char(c)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! Appends str to output as a double-quoted SNBT string, escaping as needed.
+inline void append_quoted_string(std::string &output, std::string_view str) {
+    output += '"';
+    size_t run_start = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '"' || str[i] == '\\') {
+            output.append(str.data() + run_start, i - run_start);
+            output += '\\';
+            run_start = i;
+        }
+    }
+    output.append(str.data() + run_start, str.size() - run_start);
+    output += '"';
 }
 
-inline std::string quoted_string(const std::string &str) {
-    std::regex pattern("\"");
-    // std::regex replacement("\\\"");
-    return "\"" + std::regex_replace(str, pattern, "\\\"") + "\"";
+inline std::string quoted_string(std::string_view str) {
+    std::string output;
+    output.reserve(str.size() + 2);
+    append_quoted_string(output, str);
+    return output;
 }
 
 /**
@@ -1,6 +1,11 @@
 // zlib_utils.cpp
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -73,9 +78,13 @@ namespace zlib {
          *
          * Returns Z_NEED_DICT, Z_STREAM_ERROR, Z_MEM_ERROR, Z_BUF_ERROR:
          * for various other conditions under which inflation cannot continue.
+         *
+         * Inflation stops, returning Z_OK, once the output would grow past
+         * max_output bytes; output_limited() then returns true.
          * */
         int do_inflate(const unsigned char *input, size_t input_length,
-                       std::vector<unsigned char> &output) {
+                       std::vector<unsigned char> &output,
+                       size_t max_output = std::numeric_limits<size_t>::max()) {
             if (stream_.avail_in > 0) {
                 std::cerr << "Warning: new input overrides existing unconsumed "
                              "input in Inflater."
@@ -84,34 +93,87 @@ namespace zlib {
             stream_.avail_in = static_cast<uInt>(input_length);
             stream_.next_in = static_cast<const Bytef *>(input);
 
+            // Inflate straight into the output, growing it geometrically.
             int status = Z_OK;
-            while ((stream_.avail_in > 0) && (status == Z_OK)) {
-                stream_.avail_out = buffer_size_;
-                stream_.next_out = reinterpret_cast<Bytef *>(buffer_);
+            bool output_full = false;
+            output_limited_ = false;
+            while (status == Z_OK && (stream_.avail_in > 0 || output_full)) {
+                auto used = output.size();
+                if (used >= max_output) {
+                    output_limited_ = true;
+                    break;
+                }
+                auto room = std::min(std::max<size_t>(min_growth_, used),
+                                     max_output - used);
+                output.resize(used + room);
+                stream_.avail_out = static_cast<uInt>(room);
+                stream_.next_out = output.data() + used;
 
                 status = inflate(&stream_, Z_NO_FLUSH);
 
-                int output_byte_count = buffer_size_ - stream_.avail_out;
-                output.insert(output.end(), buffer_,
-                              buffer_ + output_byte_count);
+                output_full = stream_.avail_out == 0;
+                output.resize(output.size() - stream_.avail_out);
             }
-
             input_bytes_read_ = input_length - stream_.avail_in;
             return status;
         }
 
-        int input_bytes_read() { return input_bytes_read_; }
+        /**
+         * inflate_into() inflates the compressed data given to set_input()
+         * into a fixed buffer, returning the number of bytes written and
+         * the status as for do_inflate().  Z_BUF_ERROR means only that no
+         * progress was possible.
+         * */
+        std::pair<size_t, int> inflate_into(unsigned char *output,
+                                            size_t output_length) {
+            stream_.avail_out = static_cast<uInt>(output_length);
+            stream_.next_out = static_cast<Bytef *>(output);
+            int status = inflate(&stream_, Z_NO_FLUSH);
+            return {output_length - stream_.avail_out, status};
+        }
+
+        void set_input(const unsigned char *input, size_t input_length) {
+            stream_.avail_in = static_cast<uInt>(input_length);
+            stream_.next_in = static_cast<const Bytef *>(input);
+        }
+
+        size_t input_bytes_read() { return input_bytes_read_; }
+        bool output_limited() { return output_limited_; }
         const char *err_msg() { return stream_.msg; }
 
       private:
-        int input_bytes_read_;
+        size_t input_bytes_read_;
+        bool output_limited_ = false;
         z_stream stream_;
-        static const int buffer_size_ = 128;
-        char buffer_[buffer_size_];
+        static constexpr size_t min_growth_ = 16384;
     };
 
 } // namespace zlib
 
+Stream_Inflater::Stream_Inflater()
+    : inflater_(std::make_unique<zlib::Inflater>()) {}
+
+Stream_Inflater::~Stream_Inflater() = default;
+
+void Stream_Inflater::set_input(const unsigned char *data,
+                                size_t data_length) {
+    inflater_->set_input(data, data_length);
+}
+
+size_t Stream_Inflater::inflate(unsigned char *output, size_t output_length) {
+    if (finished_) {
+        return 0;
+    }
+    auto [length, status] = inflater_->inflate_into(output, output_length);
+    if (status == Z_STREAM_END) {
+        finished_ = true;
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+        throw std::runtime_error(
+            "Could not decompress data (likely corrupt or incomplete)");
+    }
+    return length;
+}
+
 std::vector<unsigned char> decompress_data(const unsigned char *data,
                                            size_t data_length) {
     zlib::Inflater stream;
@@ -124,20 +186,49 @@ std::vector<unsigned char> decompress_data(const unsigned char *data,
     return output_data;
 }
 
+std::vector<unsigned char> compress_data(const unsigned char *data,
+                                         size_t data_length, int level) {
+    auto length = compressBound(data_length);
+    std::vector<unsigned char> output(length);
+    int status = compress2(output.data(), &length, data, data_length, level);
+    if (status != Z_OK) {
+        throw std::runtime_error("Could not compress data with error code " +
+                                 std::to_string(status));
+    }
+    output.resize(length);
+    return output;
+}
+
 std::pair<std::vector<unsigned char>, Inflation_Status>
-inflate_sectors(const unsigned char *input_data, size_t input_length) {
+inflate_sectors(const unsigned char *input_data, size_t input_length,
+                size_t max_output) {
     zlib::Inflater stream;
     std::vector<unsigned char> output;
-    Inflation_Status stat{
-        .complete = false, .corrupt = false, .corrupt_sector = -1};
-
-    int status = stream.do_inflate(input_data, input_length, output);
-    if (status == Z_STREAM_END) {
+    Inflation_Status stat{.complete = false,
+                          .corrupt = false,
+                          .too_large = false,
+                          .corrupt_sector = -1,
+                          .input_used = 0};
+
+    // One byte past the limit tells data which inflates to exactly
+    // max_output bytes from data which inflates to more.
+    auto limit = max_output < std::numeric_limits<size_t>::max()
+                     ? max_output + 1
+                     : max_output;
+    int status = stream.do_inflate(input_data, input_length, output, limit);
+    stat.input_used = stream.input_bytes_read();
+    if (output.size() > max_output) {
+        stat.too_large = true;
+        output.resize(max_output);
+    } else if (status == Z_STREAM_END) {
         stat.complete = true;
-    } else if (status != Z_OK) {
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+        // zlib stops where it finds the data to be invalid.
         stat.corrupt = true;
+        stat.corrupt_sector =
+            static_cast<int>(stat.input_used / inflation_sector_length);
     }
-    return {output, stat};
+    return {std::move(output), stat};
 }
 
 } // namespace nbtview
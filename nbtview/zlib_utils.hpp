@@ -11,26 +11,89 @@
 #ifndef ZLIB_UTILS_H_
 #define ZLIB_UTILS_H_
 
+#include <cstddef>
+#include <limits>
+#include <memory>
 #include <utility>
 #include <vector>
 
 namespace nbtview {
 
+namespace zlib {
+    class Inflater;
+}
+
 bool has_compression_header(const unsigned char *data, size_t data_length);
 
 //! Decompress data into a vector of bytes.
 std::vector<unsigned char> decompress_data(const unsigned char *compressed_data,
                                            size_t data_length);
 
+//! Compress data into a zlib stream, at a zlib compression level from 0
+//! (none) to 9 (smallest).
+std::vector<unsigned char> compress_data(const unsigned char *data,
+                                         size_t data_length, int level = 6);
+
+//! Length of the sectors counted by Inflation_Status::corrupt_sector, as
+//! in region files
+inline constexpr std::size_t inflation_sector_length = 4096;
+
 struct Inflation_Status {
+    //! True if the end of the compressed data was reached
     bool complete;
+    //! True if the compressed data is invalid; if none of the flags is
+    //! set, the input ended before the compressed data did
     bool corrupt;
+    //! True if inflation stopped because the data inflates to more than
+    //! the output limit
+    bool too_large;
+    //! Index of the sector of the input, counting from its start, where
+    //! inflation failed; -1 unless corrupt
     int corrupt_sector;
+    //! Number of input bytes read before inflation stopped
+    std::size_t input_used;
 };
 
-//! Decompress compressed data into a vector of bytes.
+//! Decompress compressed data into a vector of bytes, as far as it can be
+//! inflated, reporting where it was found to be corrupt.  No more than
+//! max_output bytes are inflated.
 std::pair<std::vector<unsigned char>, Inflation_Status>
-inflate_sectors(const unsigned char *input_data, size_t input_length);
+inflate_sectors(const unsigned char *input_data, size_t input_length,
+                size_t max_output = std::numeric_limits<size_t>::max());
+
+/**
+ * @brief Stream_Inflater decompresses zlib or gzip data which arrives in
+ * pieces, into output buffers of the caller's choosing.
+ *
+ * Neither the input nor the output need be held in full, so data of any
+ * size may be inflated in a fixed amount of memory.
+ */
+class Stream_Inflater {
+  public:
+    Stream_Inflater();
+    ~Stream_Inflater();
+    Stream_Inflater(const Stream_Inflater &) = delete;
+    Stream_Inflater &operator=(const Stream_Inflater &) = delete;
+
+    //! Supplies the next piece of compressed data, which must remain valid
+    //! until inflate() has used it up.
+    void set_input(const unsigned char *data, size_t data_length);
+
+    /**
+     * @brief Inflates as much as fits in the output buffer.
+     * @return The number of bytes written, which is 0 once the end of the
+     * compressed data is reached, or when more input is needed.
+     * @throw std::runtime_error if the compressed data is corrupt.
+     */
+    size_t inflate(unsigned char *output, size_t output_length);
+
+    //! True once the end of the compressed data has been reached
+    bool finished() const { return finished_; }
+
+  private:
+    std::unique_ptr<zlib::Inflater> inflater_;
+    bool finished_ = false;
+};
 
 } // namespace nbtview
 
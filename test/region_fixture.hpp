@@ -0,0 +1,72 @@
+// region_fixture.hpp
+//
+// Builds small region files for the tests.
+
+#ifndef NBT_TEST_REGION_FIXTURE_H_
+#define NBT_TEST_REGION_FIXTURE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace region_fixture {
+
+// A chunk to be written to a region file
+struct Test_Chunk {
+    int index;
+    uint8_t compression;
+    std::string data;
+};
+
+// Returns a region file holding the chunks, each in as many sectors as it
+// needs, in the order given.
+inline std::string region_bytes(const std::vector<Test_Chunk> &chunks) {
+    nbtview::Region region{};
+    std::string body;
+    uint32_t sector = 2;
+    for (const auto &[index, compression, data] : chunks) {
+        uint32_t length = data.size() + 1;
+        std::string chunk{static_cast<char>(length >> 24),
+                          static_cast<char>(length >> 16),
+                          static_cast<char>(length >> 8),
+                          static_cast<char>(length),
+                          static_cast<char>(compression)};
+        chunk += data;
+        auto sectors = (chunk.size() + nbtview::Region::sector_length - 1) /
+                       nbtview::Region::sector_length;
+        chunk.resize(sectors * nbtview::Region::sector_length);
+        region.chunk[index] = {sector, static_cast<uint8_t>(sectors), 1};
+        sector += sectors;
+        body += chunk;
+    }
+    nbtview::Region::Sector_Data offsets(nbtview::Region::sector_length);
+    nbtview::Region::Sector_Data timestamps(nbtview::Region::sector_length);
+    region.save_to_sectors(offsets, timestamps);
+    return std::string(offsets.begin(), offsets.end()) +
+           std::string(timestamps.begin(), timestamps.end()) + body;
+}
+
+// Writes a region file holding uncompressed chunks at the given indices.
+inline void
+write_region(const std::filesystem::path &path,
+             const std::vector<std::pair<int, nbtview::Tag>> &chunks) {
+    std::vector<Test_Chunk> encoded;
+    for (const auto &[index, tag] : chunks) {
+        std::ostringstream os;
+        nbtview::write_binary(tag, "", os);
+        encoded.push_back({index, 3, os.str()});
+    }
+    std::ofstream(path, std::ios::binary) << region_bytes(encoded);
+}
+
+} // namespace region_fixture
+
+#endif // NBT_TEST_REGION_FIXTURE_H_
@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Archive.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "Validation.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+class ArchiveTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "world");
+        std::filesystem::copy_file("test_data/r.0.0.mca",
+                                   dir / "world" / "r.0.0.mca");
+        // An empty region file holds no chunks.
+        std::ofstream(dir / "world" / "r.1.-1.mca");
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "nbtview_archive";
+};
+
+TEST_F(ArchiveTest, ExportAndReadChunks) {
+    auto archive_name = (dir / "world.nbtw").string();
+    nbt::export_world_archive((dir / "world").string(), archive_name,
+                              nbt::Export_Mode::create, 2);
+    nbt::World_Archive archive(archive_name);
+
+    nbt::Region_File region("test_data/r.0.0.mca");
+    std::size_t chunk_count = 0;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        auto entry = archive.find(0, 0, i);
+        if (region.chunk_length(i) == 0) {
+            EXPECT_FALSE(entry);
+            continue;
+        }
+        ++chunk_count;
+        ASSERT_TRUE(entry);
+        EXPECT_EQ(entry->timestamp, region.chunk_timestamp(i));
+        EXPECT_EQ(archive.find(0, 0, i, entry->timestamp), entry);
+        EXPECT_FALSE(archive.find(0, 0, i, entry->timestamp + 1));
+
+        auto data = region.get_chunk_data(i);
+        EXPECT_EQ(archive.read_chunk(*entry),
+                  nbt::decompress_data(data.data(), data.size()));
+    }
+    EXPECT_EQ(archive.entries().size(), chunk_count);
+    EXPECT_FALSE(archive.find(1, -1, 0));
+    EXPECT_FALSE(archive.find(0, 0, nbt::Region::chunk_count));
+}
+
+TEST_F(ArchiveTest, ImportRegions) {
+    auto archive_name = (dir / "world.nbtw").string();
+    nbt::export_world_archive((dir / "world").string(), archive_name);
+    nbt::World_Archive archive(archive_name);
+    std::filesystem::create_directories(dir / "restored");
+    archive.import_regions((dir / "restored").string(), 2);
+
+    auto restored = nbt::region_files((dir / "restored").string());
+    ASSERT_EQ(restored.size(), 1);
+    auto report = nbt::validate_region(restored[0]);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.valid_chunk_count, archive.entries().size());
+
+    nbt::Region_File original("test_data/r.0.0.mca");
+    nbt::Region_File copy(restored[0]);
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        EXPECT_EQ(copy.chunk_timestamp(i), original.chunk_timestamp(i));
+        // get_chunk_data() also returns the byte after the data, which is
+        // padding.
+        auto copied = copy.get_chunk_data(i);
+        auto data = original.get_chunk_data(i);
+        ASSERT_EQ(copied.size(), data.size());
+        if (!data.empty()) {
+            EXPECT_TRUE(std::equal(data.begin(), data.end() - 1,
+                                   copied.begin()));
+        }
+    }
+}
+
+TEST_F(ArchiveTest, AppendsNewVersions) {
+    auto archive_name = (dir / "world.nbtw").string();
+    auto region_name = dir / "world" / "r.0.0.mca";
+    nbt::export_world_archive((dir / "world").string(), archive_name,
+                              nbt::Export_Mode::append);
+    auto first_count = nbt::World_Archive(archive_name).entries().size();
+
+    // Unchanged chunks are not added again.
+    nbt::export_world_archive((dir / "world").string(), archive_name,
+                              nbt::Export_Mode::append);
+    EXPECT_EQ(nbt::World_Archive(archive_name).entries().size(),
+              first_count);
+
+    // A chunk with a new timestamp is added as a new version.
+    nbt::Region_File original(region_name.string());
+    auto old_timestamp = original.chunk_timestamp(2);
+    {
+        std::fstream file(region_name,
+                          std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(nbt::Region::sector_length + 4 * 2);
+        file.write("\x7f\x00\x00\x01", 4);
+    }
+    nbt::export_world_archive((dir / "world").string(), archive_name,
+                              nbt::Export_Mode::append, 2);
+    nbt::World_Archive archive(archive_name);
+    EXPECT_EQ(archive.entries().size(), first_count + 1);
+    auto latest = archive.find(0, 0, 2);
+    ASSERT_TRUE(latest);
+    EXPECT_EQ(latest->timestamp, 0x7f000001u);
+    auto old = archive.find(0, 0, 2, old_timestamp);
+    ASSERT_TRUE(old);
+    EXPECT_EQ(archive.read_chunk(*old), archive.read_chunk(*latest));
+
+    // Creating the archive again drops the old version.
+    nbt::export_world_archive((dir / "world").string(), archive_name);
+    EXPECT_EQ(nbt::World_Archive(archive_name).entries().size(),
+              first_count);
+}
+
+TEST_F(ArchiveTest, ExternalChunks) {
+    // Chunk 1 of r.0.0.mca is too large for a region file, and is stored
+    // in c.1.0.mcc.
+    std::mt19937 random(7);
+    nbt::Byte_Array noise(1100000);
+    for (auto &b : noise) {
+        b = static_cast<nbt::Byte>(random());
+    }
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(nbt::Compound{{"Noise", noise}}, "", encoded);
+    auto data = encoded.str();
+    auto compressed = nbt::compress_data(
+        reinterpret_cast<const unsigned char *>(data.data()), data.size());
+    auto big = dir / "big";
+    std::filesystem::create_directories(big);
+    std::ofstream(big / "r.0.0.mca", std::ios::binary)
+        << region_bytes({{1, 0x82, ""}});
+    std::ofstream(big / "c.1.0.mcc", std::ios::binary)
+        << std::string(compressed.begin(), compressed.end());
+
+    auto archive_name = (dir / "big.nbtw").string();
+    nbt::export_world_archive(big.string(), archive_name);
+    nbt::World_Archive archive(archive_name);
+    auto entry = archive.find(0, 0, 1);
+    ASSERT_TRUE(entry);
+    auto chunk = archive.read_chunk(*entry);
+    EXPECT_EQ(std::string(chunk.begin(), chunk.end()), data);
+
+    // Imported, it is stored outside the region file again.
+    auto restored = dir / "restored";
+    std::filesystem::create_directories(restored);
+    archive.import_regions(restored.string());
+    EXPECT_TRUE(std::filesystem::exists(restored / "c.1.0.mcc"));
+    auto report = nbt::validate_region((restored / "r.0.0.mca").string());
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.valid_chunk_count, 1);
+}
+
+TEST_F(ArchiveTest, FailedExportKeepsArchive) {
+    auto world = (dir / "world").string();
+    auto archive_name = (dir / "world.nbtw").string();
+    nbt::export_world_archive(world, archive_name);
+    auto entries = nbt::World_Archive(archive_name).entries();
+    auto length = std::filesystem::file_size(archive_name);
+
+    // The chunks of r.2.0.mca fill a batch of frames, which is written
+    // before chunk 0 of r.3.0.mca, of unknown compression type 9, fails.
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(nbt::Compound{}, "", encoded);
+    std::vector<Test_Chunk> chunks;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        chunks.push_back({i, 3, encoded.str()});
+    }
+    std::ofstream(dir / "world" / "r.2.0.mca", std::ios::binary)
+        << region_bytes(chunks);
+    std::ofstream(dir / "world" / "r.3.0.mca", std::ios::binary)
+        << region_bytes({{0, 9, encoded.str()}});
+
+    for (auto mode : {nbt::Export_Mode::append, nbt::Export_Mode::create}) {
+        EXPECT_THROW(nbt::export_world_archive(world, archive_name, mode),
+                     std::runtime_error);
+        EXPECT_EQ(std::filesystem::file_size(archive_name), length);
+        EXPECT_EQ(nbt::World_Archive(archive_name).entries(), entries);
+    }
+    // No temporary file is left behind.
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(dir),
+                            std::filesystem::directory_iterator()),
+              2);
+}
+
+TEST_F(ArchiveTest, RejectsInvalidArchive) {
+    auto archive_name = (dir / "world.nbtw").string();
+    nbt::export_world_archive((dir / "world").string(), archive_name);
+    std::filesystem::resize_file(archive_name,
+                                 std::filesystem::file_size(archive_name) -
+                                     1);
+    EXPECT_THROW(nbt::World_Archive{archive_name}, std::runtime_error);
+    EXPECT_THROW(nbt::World_Archive{"test_data/r.0.0.mca"},
+                 std::runtime_error);
+}
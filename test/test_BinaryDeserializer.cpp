@@ -30,3 +30,83 @@ TEST(BinaryDeserializer, RootStringTag) {
     EXPECT_TRUE(root_data.is<nbt::String>());
     EXPECT_EQ(root_data.get<nbt::String>(), "Hello");
 }
+
+TEST(BinaryDeserializer, DeserializesTwiceInARow) {
+    // Two roots in one buffer: {a: {b: 1b}} then {c: [2s]}
+    auto bytes = std::vector<unsigned char>{
+        0x0a, 0x00, 0x00, 0x0a, 0x00, 0x01, 'a',  0x01, 0x00, 0x01,
+        'b',  0x01, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x09, 0x00, 0x01,
+        'c',  0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00};
+    nbt::BinaryDeserializer reader(bytes.data(), bytes.size(),
+                                   {.max_elements = 4});
+    auto [first_name, first] = reader.deserialize();
+    EXPECT_EQ(first.size(), 1);
+    EXPECT_EQ(first["a"]["b"].get<nbt::Byte>(), 1);
+
+    auto [second_name, second] = reader.deserialize();
+    EXPECT_EQ(second.size(), 1);
+    EXPECT_FALSE(second.contains("a"));
+    EXPECT_EQ(second["c"][0].get<nbt::Short>(), 2);
+}
+
+// Returns a root List nested depth levels deep: [[[...[]...]]]
+static std::vector<unsigned char> nested_lists(int depth) {
+    std::vector<unsigned char> bytes{0x09, 0x00, 0x00};
+    for (int i = 1; i < depth; ++i) {
+        bytes.insert(bytes.end(), {0x09, 0x00, 0x00, 0x00, 0x01});
+    }
+    bytes.insert(bytes.end(), {0x00, 0x00, 0x00, 0x00, 0x00});
+    return bytes;
+}
+
+TEST(BinaryDeserializer, DepthLimit) {
+    auto bytes = nested_lists(512);
+    nbt::BinaryDeserializer reader(bytes.data(), bytes.size());
+    auto [root_name, root_data] = reader.deserialize();
+    EXPECT_EQ(root_data.size(), 1);
+    EXPECT_EQ(root_data[0].size(), 1);
+
+    nbt::BinaryDeserializer shallow(bytes.data(), bytes.size(),
+                                    {.max_depth = 511});
+    EXPECT_THROW(shallow.deserialize(), nbt::LimitExceededException);
+
+    // Far deeper than the native stack could recurse is still rejected
+    // cleanly.
+    auto deep = nested_lists(1000000);
+    nbt::BinaryDeserializer deep_reader(deep.data(), deep.size());
+    EXPECT_THROW(deep_reader.deserialize(), nbt::LimitExceededException);
+}
+
+TEST(BinaryDeserializer, ElementLimit) {
+    // {a:[I;1,2], b:[3s,4s,5s]}
+    std::vector<unsigned char> bytes{
+        0x0a, 0x00, 0x00, 0x0b, 0x00, 0x01, 'a',  0x00, 0x00, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x09,
+        0x00, 0x01, 'b',  0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03,
+        0x00, 0x04, 0x00, 0x05, 0x00};
+    nbt::BinaryDeserializer reader(bytes.data(), bytes.size(),
+                                   {.max_elements = 6});
+    auto [root_name, root_data] = reader.deserialize();
+    EXPECT_EQ(root_data["b"].size(), 3);
+    EXPECT_EQ(root_data["a"].get<nbt::Int_Array>().size(), 2);
+
+    nbt::BinaryDeserializer limited(bytes.data(), bytes.size(),
+                                    {.max_elements = 5});
+    EXPECT_THROW(limited.deserialize(), nbt::LimitExceededException);
+}
+
+TEST(BinaryDeserializer, ListLengths) {
+    // A List of Compounds claiming 2^31-1 elements must not be allocated
+    // before the input runs out.
+    std::vector<unsigned char> huge{0x09, 0x00, 0x00, 0x0a,
+                                    0x7f, 0xff, 0xff, 0xff, 0x00};
+    nbt::BinaryDeserializer reader(huge.data(), huge.size());
+    EXPECT_THROW(reader.deserialize(), nbt::UnexpectedEndOfInputException);
+
+    std::vector<unsigned char> negative{0x09, 0x00, 0x00, 0x0a,
+                                        0xff, 0xff, 0xff, 0xff};
+    nbt::BinaryDeserializer negative_reader(negative.data(), negative.size());
+    auto [root_name, root_data] = negative_reader.deserialize();
+    EXPECT_TRUE(root_data.is<nbt::List>());
+    EXPECT_TRUE(root_data.empty());
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <limits>
 #include <vector>
 
 #include "BinaryReader.hpp"
@@ -82,3 +83,48 @@ TEST(BinaryReader, Vector) {
     EXPECT_THROW(auto _ = scanner4.read_array<int32_t>(2),
                  nbtview::UnexpectedEndOfInputException);
 }
+
+TEST(BinaryReader, LittleEndian) {
+    const unsigned char v[] = {0xff, 0x01, 0x67, 0x45, 0x23, 0x01,
+                               0x00, 0xc0, 0x78, 0xc3};
+    nbtview::BasicBinaryReader<nbtview::Little_Endian> s(v, sizeof(v));
+    EXPECT_EQ(s.read<int16_t>(), 0x01ff);
+    EXPECT_EQ(s.read<int32_t>(), 0x01234567);
+    EXPECT_EQ(s.read<float>(), -248.75);
+
+    const unsigned char a[] = {0x02, 0x00, 0x01, 0x00, 0x03, 0x00};
+    nbtview::BasicBinaryReader<nbtview::Little_Endian> sa(a, sizeof(a));
+    EXPECT_EQ(sa.read_array<int16_t>(2), (std::vector<int16_t>{2, 1}));
+    EXPECT_EQ(sa.read_string_length(), 3);
+    EXPECT_THROW(auto _ = sa.read<int16_t>(),
+                 nbtview::UnexpectedEndOfInputException);
+}
+
+TEST(BinaryReader, Varints) {
+    // Ints and Longs are zig-zag varints; Shorts stay little-endian.
+    const unsigned char v[] = {0x00, 0x01, 0x02, 0xac, 0x02, 0xff, 0xff,
+                               0xff, 0xff, 0x0f, 0x34, 0x12, 0x05};
+    nbtview::BasicBinaryReader<nbtview::Network_Varint> s(v, sizeof(v));
+    EXPECT_EQ(s.read<int32_t>(), 0);
+    EXPECT_EQ(s.read<int32_t>(), -1);
+    EXPECT_EQ(s.read<int64_t>(), 1);
+    EXPECT_EQ(s.read<int32_t>(), 150);
+    EXPECT_EQ(s.read<int32_t>(), std::numeric_limits<int32_t>::min());
+    EXPECT_EQ(s.read<int16_t>(), 0x1234);
+    // String lengths are unsigned varints.
+    EXPECT_EQ(s.read_string_length(), 5);
+
+    const unsigned char a[] = {0x04, 0x03, 0xfe, 0x03};
+    nbtview::BasicBinaryReader<nbtview::Network_Varint> sa(a, sizeof(a));
+    EXPECT_EQ(sa.read_array<int32_t>(3), (std::vector<int32_t>{2, -2, 255}));
+
+    const unsigned char long_varint[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0x01};
+    nbtview::BasicBinaryReader<nbtview::Network_Varint> sl(
+        long_varint, sizeof(long_varint));
+    EXPECT_THROW(auto _ = sl.read<int32_t>(), std::runtime_error);
+
+    const unsigned char cut[] = {0x80, 0x80};
+    nbtview::BasicBinaryReader<nbtview::Network_Varint> sc(cut, sizeof(cut));
+    EXPECT_THROW(auto _ = sc.read<int64_t>(),
+                 nbtview::UnexpectedEndOfInputException);
+}
@@ -4,6 +4,7 @@
 #include <sstream>
 #include <vector>
 
+#include "BinaryReader.hpp"
 #include "BinaryWriter.hpp"
 
 namespace nbt = nbtview;
@@ -172,3 +173,47 @@ TEST(BinaryWriter, VectorInt64) {
                                      static_cast<char>(0xef)};
     EXPECT_EQ(stream_chars(output), correct_output);
 }
+
+TEST(BinaryWriter, LittleEndian) {
+    using Writer = nbt::BasicBinaryWriter<nbt::Little_Endian>;
+    std::ostringstream output(std::ios::binary);
+    Writer::write(int32_t{0x01234567}, output);
+    Writer::write(-248.75f, output);
+    Writer::write_string("ab", output);
+    Writer::write_vector(std::vector<int16_t>{0x0102}, output);
+    std::vector<char> expect_result{0x67, 0x45, 0x23, 0x01,
+                                    0x00, static_cast<char>(0xc0),
+                                    0x78, static_cast<char>(0xc3),
+                                    0x02, 0x00, 'a', 'b',
+                                    0x01, 0x00, 0x00, 0x00,
+                                    0x02, 0x01};
+    EXPECT_EQ(stream_chars(output), expect_result);
+}
+
+TEST(BinaryWriter, Varints) {
+    using Writer = nbt::BasicBinaryWriter<nbt::Network_Varint>;
+    std::ostringstream output(std::ios::binary);
+    Writer::write(int32_t{-1}, output);
+    Writer::write(int32_t{150}, output);
+    Writer::write(int64_t{-2}, output);
+    Writer::write(int16_t{0x1234}, output);
+    Writer::write_string("ab", output);
+    Writer::write_vector(std::vector<int32_t>{2, -2, 255}, output);
+    std::vector<char> expect_result{
+        0x01, static_cast<char>(0xac), 0x02, 0x03, 0x34, 0x12, 0x02, 'a',
+        'b',  0x06, 0x04, 0x03, static_cast<char>(0xfe), 0x03};
+    EXPECT_EQ(stream_chars(output), expect_result);
+
+    // Values which span many blocks of the array encoder
+    std::vector<int64_t> values(5000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int64_t>(i * i * i) * (i % 2 ? -1 : 1);
+    }
+    std::ostringstream array_output(std::ios::binary);
+    Writer::write_array(values.data(), values.size(), array_output);
+    auto bytes = array_output.str();
+    nbt::BasicBinaryReader<nbt::Network_Varint> reader(
+        reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+    EXPECT_EQ(reader.read_array<int64_t>(values.size()), values);
+    EXPECT_EQ(reader.remaining_length(), 0);
+}
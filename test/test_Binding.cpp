@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Binding.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+struct Food {
+    std::string name;
+    nbt::Float value = 0;
+};
+
+struct Nested {
+    Food egg;
+    Food ham;
+};
+
+struct Created {
+    nbt::Long created_on = 0;
+    std::string name;
+};
+
+struct BigtestSummary {
+    nbt::Int intTest = 0;
+    nbt::Byte byteTest = 0;
+    std::string stringTest;
+    nbt::Double doubleTest = 0;
+    Nested nested;
+    std::vector<nbt::Long> longs;
+    std::vector<Created> compounds;
+    nbt::Byte_Array bytes;
+    std::optional<nbt::Int> missing;
+};
+
+template <> struct nbt::Schema<Food> {
+    static constexpr auto fields = std::tuple{
+        nbt::field<"name">(&Food::name), nbt::field<"value">(&Food::value)};
+};
+
+template <> struct nbt::Schema<Nested> {
+    static constexpr auto fields = std::tuple{
+        nbt::field<"egg">(&Nested::egg), nbt::field<"ham">(&Nested::ham)};
+};
+
+template <> struct nbt::Schema<Created> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"created-on">(&Created::created_on),
+                   nbt::field<"name">(&Created::name)};
+};
+
+template <> struct nbt::Schema<BigtestSummary> {
+    static constexpr auto fields = std::tuple{
+        nbt::field<"intTest">(&BigtestSummary::intTest),
+        nbt::field<"byteTest">(&BigtestSummary::byteTest),
+        nbt::field<"stringTest">(&BigtestSummary::stringTest),
+        nbt::field<"doubleTest">(&BigtestSummary::doubleTest),
+        nbt::field<"nested compound test">(&BigtestSummary::nested),
+        nbt::field<"listTest (long)">(&BigtestSummary::longs),
+        nbt::field<"listTest (compound)">(&BigtestSummary::compounds),
+        nbt::field<"byteArrayTest (the first 1000 values of (n*n*255+n*7)%100"
+                   ", starting with n=0 (0, 62, 34, 16, 8, ...))">(
+            &BigtestSummary::bytes),
+        nbt::field<"missing">(&BigtestSummary::missing)};
+};
+
+TEST(Binding, Bigtest) {
+    std::ifstream bigtest_stream("test_data/bigtest.nbt", std::ios::binary);
+    std::vector<unsigned char> bytes(
+        std::istreambuf_iterator<char>(bigtest_stream), {});
+    auto summary = nbt::read_binary_as<BigtestSummary>(bytes);
+    EXPECT_EQ(summary.intTest, 2147483647);
+    EXPECT_EQ(summary.byteTest, 127);
+    EXPECT_EQ(summary.stringTest, "HELLO WORLD THIS IS A TEST STRING ÅÄÖ!");
+    EXPECT_NEAR(summary.doubleTest, 0.4931287132182315, 1e-9);
+    EXPECT_EQ(summary.nested.egg.name, "Eggbert");
+    EXPECT_EQ(summary.nested.ham.value, 0.75);
+    EXPECT_EQ(summary.longs, (std::vector<nbt::Long>{11, 12, 13, 14, 15}));
+    ASSERT_EQ(summary.compounds.size(), 2);
+    EXPECT_EQ(summary.compounds[1].created_on, 1264099775885L);
+    EXPECT_EQ(summary.compounds[1].name, "Compound tag #1");
+    ASSERT_EQ(summary.bytes.size(), 1000);
+    EXPECT_EQ(summary.bytes[3], 16);
+    EXPECT_FALSE(summary.missing.has_value());
+}
+
+struct WrongType {
+    nbt::Short intTest = 0;
+};
+
+template <> struct nbt::Schema<WrongType> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"intTest">(&WrongType::intTest)};
+};
+
+TEST(Binding, TypeMismatch) {
+    std::ifstream bigtest_stream("test_data/bigtest.nbt", std::ios::binary);
+    std::vector<unsigned char> bytes(
+        std::istreambuf_iterator<char>(bigtest_stream), {});
+    EXPECT_THROW(nbt::read_binary_as<WrongType>(bytes), std::runtime_error);
+}
+
+struct Level {
+    nbt::Int xPos = -1;
+    nbt::Int zPos = -1;
+    nbt::Long LastUpdate = 0;
+    std::optional<nbt::Long> InhabitedTime;
+};
+
+struct Chunk {
+    Level level;
+};
+
+template <> struct nbt::Schema<Level> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"xPos">(&Level::xPos),
+                   nbt::field<"zPos">(&Level::zPos),
+                   nbt::field<"LastUpdate">(&Level::LastUpdate),
+                   nbt::field<"InhabitedTime">(&Level::InhabitedTime)};
+};
+
+template <> struct nbt::Schema<Chunk> {
+    static constexpr auto fields =
+        std::tuple{nbt::field<"Level">(&Chunk::level)};
+};
+
+TEST(Binding, ChunksMatchTagTree) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto chunk_data = reg.get_chunk_data(i);
+        auto chunk = nbt::read_binary_as<Chunk>(chunk_data);
+        auto [root_name, root_tag] = nbt::read_binary(chunk_data);
+        auto &level = root_tag["Level"];
+        EXPECT_EQ(chunk.level.xPos, level["xPos"].get<nbt::Int>());
+        EXPECT_EQ(chunk.level.zPos, level["zPos"].get<nbt::Int>());
+        EXPECT_EQ(chunk.level.LastUpdate, level["LastUpdate"].get<nbt::Long>());
+        // These chunks predate the InhabitedTime field.
+        EXPECT_FALSE(chunk.level.InhabitedTime.has_value());
+    }
+}
+
+// Returns the encoding of a root Compound holding one named payload.
+static std::vector<unsigned char>
+root_with(nbt::TypeCode type, const std::string &name,
+          const std::vector<unsigned char> &payload) {
+    std::vector<unsigned char> bytes{
+        10, 0, 0, static_cast<unsigned char>(type), 0,
+        static_cast<unsigned char>(name.size())};
+    bytes.insert(bytes.end(), name.begin(), name.end());
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    bytes.push_back(0);
+    return bytes;
+}
+
+TEST(Binding, SkipsDeeplyNestedLists) {
+    // Lists nested far deeper than the call stack could recurse
+    const int depth = 1000000;
+    std::vector<unsigned char> lists;
+    for (int i = 0; i < depth; ++i) {
+        lists.insert(lists.end(), {9, 0, 0, 0, 1});
+    }
+    lists.insert(lists.end(), {1, 0, 0, 0, 0});
+    auto bytes = root_with(nbt::TypeCode::List, "deep", lists);
+    bytes.pop_back();
+    bytes.insert(bytes.end(), {3, 0, 4, 'x', 'P', 'o', 's', 0, 0, 0, 7, 0});
+    auto level = nbt::read_binary_as<Level>(bytes);
+    EXPECT_EQ(level.xPos, 7);
+}
+
+TEST(Binding, ListLengthIsCheckedBeforeAllocating) {
+    auto bytes = root_with(nbt::TypeCode::List, "listTest (long)",
+                           {4, 0x7f, 0xff, 0xff, 0xff, 0, 0, 0, 0});
+    EXPECT_THROW(nbt::read_binary_as<BigtestSummary>(bytes),
+                 nbt::UnexpectedEndOfInputException);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "BlockCounts.hpp"
+#include "BlockStates.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+static nbt::List palette_of(const std::vector<std::string> &names) {
+    nbt::List palette;
+    for (const auto &name : names) {
+        palette.push_back(nbt::Compound{{"Name", nbt::String(name)}});
+    }
+    return palette;
+}
+
+static nbt::Long_Array pack(const std::array<uint16_t, 4096> &indices,
+                            unsigned bits, nbt::Bit_Packing packing) {
+    nbt::Long_Array packed(nbt::packed_length(4096, bits, packing));
+    nbt::pack_indices(indices, bits, packing, packed);
+    return packed;
+}
+
+TEST(BlockCounts, PaletteSections) {
+    // A chunk in the 1.18 format, with stone and some diamond ore in one
+    // section and air in another.
+    std::array<uint16_t, 4096> ore{};
+    for (std::size_t i = 0; i < ore.size(); i += 100) {
+        ore[i] = 1;
+    }
+    nbt::Tag modern = nbt::Compound{
+        {"sections",
+         nbt::List{
+             nbt::Compound{
+                 {"Y", nbt::Byte(-1)},
+                 {"block_states",
+                  nbt::Compound{
+                      {"palette", palette_of({"minecraft:stone",
+                                              "minecraft:diamond_ore"})},
+                      {"data", pack(ore, 4, nbt::Bit_Packing::aligned)}}}},
+             nbt::Compound{
+                 {"Y", nbt::Byte(0)},
+                 {"block_states",
+                  nbt::Compound{
+                      {"palette", palette_of({"minecraft:air"})}}}}}}};
+
+    // A chunk in the 1.13 format, with 17 block states packed at 5 bits.
+    std::vector<std::string> names;
+    for (int i = 0; i < 17; ++i) {
+        names.push_back("minecraft:b" + std::to_string(i));
+    }
+    std::array<uint16_t, 4096> mixed;
+    for (std::size_t i = 0; i < mixed.size(); ++i) {
+        mixed[i] = i % 17;
+    }
+    nbt::Tag older = nbt::Compound{
+        {"Level",
+         nbt::Compound{
+             {"Sections",
+              nbt::List{nbt::Compound{
+                  {"Y", nbt::Byte(2)},
+                  {"Palette", palette_of(names)},
+                  {"BlockStates",
+                   pack(mixed, 5, nbt::Bit_Packing::spanning)}}}}}}};
+
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_blockcounts";
+    std::filesystem::create_directories(dir);
+    write_region(dir / "r.1.-1.mca", {{0, modern}, {33, older}});
+
+    auto world = nbt::count_world_blocks(dir.string(),
+                                         nbt::Count_Grouping::world, 2);
+    EXPECT_EQ(world.count("minecraft:diamond_ore"), 41);
+    EXPECT_EQ(world.count("minecraft:stone"), 4096 - 41);
+    EXPECT_EQ(world.count("minecraft:air"), 4096);
+    EXPECT_EQ(world.count("minecraft:b0"), 241);
+    EXPECT_EQ(world.count("minecraft:b16"), 240);
+    EXPECT_EQ(world.count("minecraft:nothing"), 0);
+    EXPECT_EQ(world.groups.size(), 1);
+
+    auto chunks = nbt::count_world_blocks(dir.string(),
+                                          nbt::Count_Grouping::chunk, 1);
+    EXPECT_EQ(chunks.count({32, -32, 0}, "minecraft:diamond_ore"), 41);
+    EXPECT_EQ(chunks.count({33, -31, 0}, "minecraft:b3"), 241);
+    EXPECT_EQ(chunks.count({33, -31, 0}, "minecraft:diamond_ore"), 0);
+
+    auto regions = nbt::count_world_blocks(dir.string(),
+                                           nbt::Count_Grouping::region);
+    EXPECT_EQ(regions.count({1, -1, 0}, "minecraft:air"), 4096);
+
+    auto levels = nbt::count_world_blocks(dir.string(),
+                                          nbt::Count_Grouping::y_level);
+    // Ore is at every 100th block: in layers 0, 1, 2, ... of section -1.
+    EXPECT_EQ(levels.count({0, 0, -16}, "minecraft:diamond_ore"), 3);
+    EXPECT_EQ(levels.count({0, 0, -1}, "minecraft:stone"), 256 - 2);
+    EXPECT_EQ(levels.count({0, 0, 5}, "minecraft:air"), 256);
+    EXPECT_EQ(levels.count("minecraft:diamond_ore"), 41);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(BlockCounts, LegacyRegion) {
+    // Count legacy block IDs directly from decoded chunks.
+    std::map<std::string, uint64_t> expected;
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto root = nbt::read_binary(reg.get_chunk_data(i)).second;
+        for (auto &section : root["Level"]["Sections"].get<nbt::List>()) {
+            const auto &blocks = section["Blocks"].get<nbt::Byte_Array>();
+            nbt::Byte_Array add(2048);
+            if (section.contains("Add")) {
+                add = section["Add"].get<nbt::Byte_Array>();
+            }
+            for (std::size_t b = 0; b < blocks.size(); ++b) {
+                // Nibbles are stored low first.
+                int high = (add[b / 2] >> (b % 2 * 4)) & 0xf;
+                int id = static_cast<uint8_t>(blocks[b]) | high << 8;
+                ++expected["legacy:" + std::to_string(id)];
+            }
+        }
+    }
+
+    auto counts = nbt::count_blocks({"test_data/r.0.0.mca"},
+                                    nbt::Count_Grouping::world, 3);
+    ASSERT_EQ(counts.names.size(), expected.size());
+    for (const auto &[name, count] : expected) {
+        EXPECT_EQ(counts.count(name), count) << name;
+    }
+
+    auto by_chunk = nbt::count_blocks({"test_data/r.0.0.mca"},
+                                      nbt::Count_Grouping::chunk, 2);
+    auto by_level = nbt::count_blocks({"test_data/r.0.0.mca"},
+                                      nbt::Count_Grouping::y_level, 2);
+    for (const auto &[name, count] : expected) {
+        EXPECT_EQ(by_chunk.count(name), count);
+        EXPECT_EQ(by_level.count(name), count);
+    }
+}
+
+TEST(BlockCounts, ExternalAndTruncatedChunks) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_external";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 1 keeps its data in c.1.0.mcc.
+    nbt::Tag air = nbt::Compound{
+        {"sections",
+         nbt::List{nbt::Compound{
+             {"Y", nbt::Byte(0)},
+             {"block_states",
+              nbt::Compound{{"palette", palette_of({"minecraft:air"})}}}}}}};
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(air, "", encoded);
+    std::ofstream(dir / "r.0.0.mca", std::ios::binary)
+        << region_bytes({{1, 0x83, ""}});
+    std::ofstream(dir / "c.1.0.mcc", std::ios::binary) << encoded.str();
+    auto counts = nbt::count_world_blocks(dir.string(),
+                                          nbt::Count_Grouping::world, 1);
+    EXPECT_EQ(counts.count("minecraft:air"), 4096);
+
+    // A BlockStates array longer than the chunk is rejected before any
+    // room is made for it.
+    nbt::Tag states = nbt::Compound{
+        {"Level",
+         nbt::Compound{
+             {"Sections", nbt::List{nbt::Compound{
+                              {"Y", nbt::Byte(0)},
+                              {"Palette", palette_of({"minecraft:air"})},
+                              {"BlockStates", nbt::Long_Array{1}}}}}}}};
+    std::ostringstream truncated(std::ios::binary);
+    nbt::write_binary(states, "", truncated);
+    auto data = truncated.str();
+    auto length = data.find("BlockStates") + std::string("BlockStates").size();
+    data.replace(length, 4, "\x7f\xff\xff\xff");
+    std::ofstream(dir / "r.0.0.mca", std::ios::binary)
+        << region_bytes({{0, 3, data}});
+    EXPECT_THROW(nbt::count_world_blocks(dir.string(),
+                                         nbt::Count_Grouping::world, 1),
+                 nbt::UnexpectedEndOfInputException);
+    std::filesystem::remove_all(dir);
+}
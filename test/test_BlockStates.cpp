@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "BlockStates.hpp"
+#include "Tag.hpp"
+
+namespace nbt = nbtview;
+
+// Packs indices one bit at a time, as a reference for the unpacker.
+static nbt::Long_Array pack_reference(const std::vector<uint16_t> &indices,
+                                      unsigned bits, nbt::Bit_Packing packing) {
+    nbt::Long_Array packed(nbt::packed_length(indices.size(), bits, packing));
+    std::size_t per_word = 64 / bits;
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        std::size_t start = packing == nbt::Bit_Packing::spanning
+                                ? i * bits
+                                : (i / per_word) * 64 + (i % per_word) * bits;
+        for (unsigned b = 0; b < bits; ++b) {
+            if ((indices[i] >> b) & 1) {
+                auto bit = start + b;
+                packed[bit / 64] |= nbt::Long(uint64_t(1) << (bit % 64));
+            }
+        }
+    }
+    return packed;
+}
+
+TEST(BlockStates, PackedLength) {
+    using enum nbt::Bit_Packing;
+    EXPECT_EQ(nbt::packed_length(4096, 4, spanning), 256);
+    EXPECT_EQ(nbt::packed_length(4096, 4, aligned), 256);
+    EXPECT_EQ(nbt::packed_length(4096, 5, spanning), 320);
+    EXPECT_EQ(nbt::packed_length(4096, 5, aligned), 342);
+    EXPECT_EQ(nbt::packed_length(4096, 7, aligned), 456);
+    EXPECT_EQ(nbt::detect_packing(342, 4096, 5), aligned);
+    EXPECT_EQ(nbt::detect_packing(320, 4096, 5), spanning);
+    EXPECT_EQ(nbt::detect_packing(256, 4096, 4), aligned);
+    EXPECT_THROW(nbt::detect_packing(300, 4096, 5), std::runtime_error);
+}
+
+TEST(BlockStates, PaletteBits) {
+    EXPECT_EQ(nbt::palette_bits(1), 4);
+    EXPECT_EQ(nbt::palette_bits(16), 4);
+    EXPECT_EQ(nbt::palette_bits(17), 5);
+    EXPECT_EQ(nbt::palette_bits(4096), 12);
+    EXPECT_EQ(nbt::palette_bits(3, 1), 2);
+}
+
+TEST(BlockStates, AllWidthsAndLayouts) {
+    std::mt19937 rng(1234);
+    // 4096 block states, 64 biomes, and a count which leaves partial groups
+    for (std::size_t count : {4096, 64, 1000}) {
+        for (unsigned bits = 1; bits <= 16; ++bits) {
+            std::uniform_int_distribution<uint32_t> dist(0,
+                                                         (1u << bits) - 1);
+            std::vector<uint16_t> indices(count);
+            for (auto &index : indices) {
+                index = static_cast<uint16_t>(dist(rng));
+            }
+            for (auto packing :
+                 {nbt::Bit_Packing::spanning, nbt::Bit_Packing::aligned}) {
+                auto packed = pack_reference(indices, bits, packing);
+                std::vector<uint16_t> unpacked(count);
+                nbt::unpack_indices(packed, bits, packing, unpacked);
+                EXPECT_EQ(unpacked, indices)
+                    << count << " entries of " << bits << " bits";
+                std::fill(unpacked.begin(), unpacked.end(), 0);
+                nbt::unpack_indices(packed, bits, unpacked);
+                EXPECT_EQ(unpacked, indices)
+                    << count << " entries of " << bits << " bits";
+            }
+        }
+    }
+}
+
+TEST(BlockStates, Section) {
+    std::vector<uint16_t> indices(nbt::section_volume);
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        indices[i] = static_cast<uint16_t>((i * 7) % 20);
+    }
+    auto packed = pack_reference(indices, 5, nbt::Bit_Packing::spanning);
+    std::array<uint16_t, nbt::section_volume> out;
+    nbt::unpack_block_states(packed, 20, out);
+    EXPECT_TRUE(std::equal(out.begin(), out.end(), indices.begin()));
+
+    out.fill(9);
+    nbt::unpack_block_states({}, 1, out);
+    EXPECT_EQ(std::count(out.begin(), out.end(), 0), out.size());
+
+    EXPECT_THROW(
+        nbt::unpack_block_states(nbt::Long_Array(100), 20, out),
+        std::runtime_error);
+    std::vector<uint16_t> small(10);
+    EXPECT_THROW(nbt::unpack_indices(packed, 17, nbt::Bit_Packing::aligned,
+                                     small),
+                 std::runtime_error);
+}
+
+TEST(BlockStates, PackMatchesReference) {
+    std::mt19937 rng(99);
+    for (std::size_t count : {4096, 64, 1000}) {
+        for (unsigned bits = 1; bits <= 16; ++bits) {
+            std::uniform_int_distribution<uint32_t> dist(0,
+                                                         (1u << bits) - 1);
+            std::vector<uint16_t> indices(count);
+            for (auto &index : indices) {
+                index = static_cast<uint16_t>(dist(rng));
+            }
+            for (auto packing :
+                 {nbt::Bit_Packing::spanning, nbt::Bit_Packing::aligned}) {
+                auto expected = pack_reference(indices, bits, packing);
+                // Stale bits in the output must be cleared.
+                nbt::Long_Array packed(expected.size(), -1);
+                nbt::pack_indices(indices, bits, packing, packed);
+                EXPECT_EQ(packed, expected)
+                    << count << " entries of " << bits << " bits";
+            }
+        }
+    }
+}
+
+TEST(BlockStates, Packer) {
+    std::array<uint32_t, nbt::section_volume> blocks;
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        // Layers of stone, dirt and air, with some scattered ore
+        blocks[i] = i < 1024 ? 1 : i < 2048 ? 3 : 0;
+        if (i % 97 == 0) {
+            blocks[i] = 100000 + static_cast<uint32_t>(i % 5);
+        }
+    }
+    nbt::Block_State_Packer packer;
+    for (auto packing :
+         {nbt::Bit_Packing::spanning, nbt::Bit_Packing::aligned}) {
+        packer.pack(blocks, packing);
+        EXPECT_EQ(packer.palette(),
+                  (std::vector<uint32_t>{100000, 1, 100002, 100004, 100001,
+                                         100003, 3, 0}));
+        EXPECT_EQ(packer.bits(), 4);
+
+        std::array<uint16_t, nbt::section_volume> unpacked;
+        nbt::unpack_block_states(packer.data(), packer.palette().size(),
+                                 unpacked);
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            ASSERT_EQ(packer.palette()[unpacked[i]], blocks[i]);
+        }
+    }
+
+    // A wider palette widens the indices.
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = static_cast<uint32_t>(i % 40) * 1000;
+    }
+    packer.pack(blocks, nbt::Bit_Packing::spanning);
+    EXPECT_EQ(packer.palette().size(), 40);
+    EXPECT_EQ(packer.bits(), 6);
+    EXPECT_EQ(packer.data().size(), 384);
+
+    // Compacting an existing palette's indices
+    std::array<uint16_t, nbt::section_volume> old_indices;
+    old_indices.fill(7);
+    old_indices[10] = 2;
+    auto data_buffer = packer.data().data();
+    packer.pack(old_indices, nbt::Bit_Packing::aligned, 1);
+    EXPECT_EQ(packer.palette(), (std::vector<uint32_t>{7, 2}));
+    EXPECT_EQ(packer.bits(), 1);
+    EXPECT_EQ(packer.data().size(), 64);
+    EXPECT_EQ(packer.indices()[10], 1);
+    // The packed buffer is reused rather than reallocated.
+    EXPECT_EQ(packer.data().data(), data_buffer);
+}
+
+TEST(BlockStates, Nibbles) {
+    std::mt19937 rng(7);
+    nbt::Byte_Array light(nbt::nibble_array_length);
+    for (auto &b : light) {
+        b = static_cast<nbt::Byte>(rng());
+    }
+    // An odd length exercises the conversion of a partial block.
+    for (std::size_t length : {light.size(), std::size_t(77)}) {
+        std::span<const nbt::Byte> nibbles(light.data(), length);
+        std::vector<uint8_t> values(2 * length);
+        nbt::unpack_nibbles(nibbles, values);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQ(values[i], nbt::get_nibble(nibbles, i)) << i;
+        }
+        nbt::Byte_Array packed(length);
+        nbt::pack_nibbles(values, packed);
+        EXPECT_TRUE(std::equal(packed.begin(), packed.end(), light.begin()));
+    }
+
+    // Entries are ordered by Y, then Z, then X, low nibble first.
+    nbt::Byte_Array sky(nbt::nibble_array_length);
+    nbt::set_nibble(sky, nbt::section_index(1, 0, 0), 15);
+    nbt::set_nibble(sky, nbt::section_index(0, 1, 2), 0x3a);
+    EXPECT_EQ(sky[0], static_cast<nbt::Byte>(0xf0));
+    EXPECT_EQ(sky[(256 + 32) / 2], 0xa);
+    nbt::set_nibble(sky, nbt::section_index(1, 0, 0), 1);
+    EXPECT_EQ(nbt::get_nibble(sky, 1), 1);
+
+    std::vector<uint8_t> short_values(10);
+    EXPECT_THROW(nbt::unpack_nibbles(sky, short_values), std::runtime_error);
+    EXPECT_THROW(nbt::pack_nibbles(std::vector<uint8_t>(3), sky),
+                 std::runtime_error);
+}
+
+TEST(BlockStates, LegacyBlockIds) {
+    nbt::Byte_Array blocks(nbt::section_volume);
+    nbt::Byte_Array add(nbt::nibble_array_length);
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = static_cast<nbt::Byte>(i * 7);
+        nbt::set_nibble(add, i, static_cast<uint8_t>(i / 300));
+    }
+    std::span<const nbt::Byte, nbt::section_volume> block_span(
+        blocks.data(), nbt::section_volume);
+    std::array<uint16_t, nbt::section_volume> ids;
+    nbt::legacy_block_ids(block_span, add, ids);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        ASSERT_EQ(ids[i], (i * 7 & 0xff) | (i / 300 % 16) << 8) << i;
+    }
+    nbt::legacy_block_ids(block_span, {}, ids);
+    EXPECT_EQ(ids[100], 700 & 0xff);
+    add.pop_back();
+    EXPECT_THROW(nbt::legacy_block_ids(block_span, add, ids),
+                 std::runtime_error);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Columns.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+static const std::vector<std::string> chunk_paths = {
+    "Level.xPos", "Level.zPos", "Level.LastUpdate", "Level.TerrainPopulated",
+    "Level.InhabitedTime"};
+
+TEST(Columns, RegionFile) {
+    auto table = nbt::extract_columns("test_data/r.0.0.mca", chunk_paths, 4);
+    ASSERT_EQ(table.columns.size(), chunk_paths.size());
+    const auto &x = table.columns[0];
+    const auto &z = table.columns[1];
+    const auto &last_update = table.columns[2];
+    const auto &populated = table.columns[3];
+    EXPECT_EQ(x.path, "Level.xPos");
+    EXPECT_EQ(x.type, nbt::TypeCode::Int);
+    EXPECT_EQ(last_update.type, nbt::TypeCode::Long);
+    EXPECT_EQ(populated.type, nbt::TypeCode::Byte);
+
+    // This region predates InhabitedTime.
+    const auto &inhabited = table.columns[4];
+    EXPECT_EQ(inhabited.type, nbt::TypeCode::None);
+    EXPECT_EQ(inhabited.present, std::vector<bool>(table.size(), false));
+
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    std::size_t row = 0;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        ASSERT_LT(row, table.size());
+        auto level = nbt::read_binary(reg.get_chunk_data(i)).second["Level"];
+        EXPECT_EQ(table.chunk_x[row], i % 32);
+        EXPECT_EQ(table.chunk_z[row], i / 32);
+        EXPECT_TRUE(x.present[row]);
+        EXPECT_EQ(x.get<nbt::Int>()[row], level["xPos"].get<nbt::Int>());
+        EXPECT_EQ(z.get<nbt::Int>()[row], level["zPos"].get<nbt::Int>());
+        EXPECT_EQ(last_update.get<nbt::Long>()[row],
+                  level["LastUpdate"].get<nbt::Long>());
+        EXPECT_EQ(populated.get<nbt::Byte>()[row],
+                  level["TerrainPopulated"].get<nbt::Byte>());
+        ++row;
+    }
+    EXPECT_EQ(row, table.size());
+}
+
+TEST(Columns, World) {
+    auto region = nbt::extract_columns("test_data/r.0.0.mca", chunk_paths, 1);
+    auto world = nbt::extract_world_columns("test_data", chunk_paths, 2);
+    ASSERT_EQ(world.size(), region.size());
+    EXPECT_EQ(world.chunk_x, region.chunk_x);
+    EXPECT_EQ(world.chunk_z, region.chunk_z);
+    for (std::size_t c = 0; c < region.columns.size(); ++c) {
+        EXPECT_EQ(world.columns[c].type, region.columns[c].type);
+        EXPECT_EQ(world.columns[c].values, region.columns[c].values);
+        EXPECT_EQ(world.columns[c].present, region.columns[c].present);
+    }
+}
+
+static std::string encoded_level(nbt::Int x) {
+    std::ostringstream os(std::ios::binary);
+    nbt::write_binary(nbt::Compound{{"Level", nbt::Compound{{"xPos", x}}}},
+                      "", os);
+    return os.str();
+}
+
+TEST(Columns, ExternalChunk) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_columns";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 33 of r.0.-1.mca keeps its data in c.1.-31.mcc.
+    std::ofstream(dir / "r.0.-1.mca", std::ios::binary)
+        << region_bytes({{0, 3, encoded_level(0)}, {33, 0x83, ""}});
+    std::ofstream(dir / "c.1.-31.mcc", std::ios::binary) << encoded_level(1);
+
+    auto table = nbt::extract_columns((dir / "r.0.-1.mca").string(),
+                                      {"Level.xPos"}, 2);
+    ASSERT_EQ(table.size(), 2);
+    EXPECT_EQ(table.chunk_x, (std::vector<nbt::Int>{0, 1}));
+    EXPECT_EQ(table.chunk_z, (std::vector<nbt::Int>{-32, -31}));
+    EXPECT_EQ(table.columns[0].get<nbt::Int>(),
+              (std::vector<nbt::Int>{0, 1}));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Columns, ColumnarFile) {
+    auto table = nbt::extract_columns("test_data/r.0.0.mca", chunk_paths);
+    std::stringstream file;
+    nbt::write_columns(table, file);
+    auto copy = nbt::read_columns(file);
+    ASSERT_EQ(copy.size(), table.size());
+    EXPECT_EQ(copy.chunk_x, table.chunk_x);
+    EXPECT_EQ(copy.chunk_z, table.chunk_z);
+    ASSERT_EQ(copy.columns.size(), table.columns.size());
+    for (std::size_t c = 0; c < table.columns.size(); ++c) {
+        EXPECT_EQ(copy.columns[c].path, table.columns[c].path);
+        EXPECT_EQ(copy.columns[c].type, table.columns[c].type);
+        EXPECT_EQ(copy.columns[c].values, table.columns[c].values);
+        EXPECT_EQ(copy.columns[c].present, table.columns[c].present);
+    }
+
+    std::stringstream truncated(file.str().substr(0, 100));
+    EXPECT_THROW(nbt::read_columns(truncated), std::runtime_error);
+}
+
+TEST(Columns, InvalidPaths) {
+    EXPECT_THROW(nbt::extract_columns("test_data/r.0.0.mca", {"Level..xPos"}),
+                 std::runtime_error);
+    EXPECT_THROW(
+        nbt::extract_columns("test_data/r.0.0.mca", {"Level.x", "Level.x"}),
+        std::runtime_error);
+    EXPECT_THROW(nbt::extract_columns("test_data/bigtest.nbt", {"Level.x"}),
+                 std::runtime_error);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "CompactTree.hpp"
+#include "Deserializer.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+class CompactBigTest : public ::testing::Test {
+  protected:
+    std::vector<unsigned char> bytes;
+    nbt::CompactTree tree;
+
+    virtual void SetUp() {
+        std::ifstream bigtest_stream("test_data/bigtest.nbt",
+                                     std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(bigtest_stream), {});
+        tree = nbt::CompactTree(bytes.data(), bytes.size());
+    }
+};
+
+TEST(CompactTree, NodeSize) {
+    EXPECT_EQ(sizeof(nbt::CompactTree::Node), 16);
+}
+
+TEST_F(CompactBigTest, Values) {
+    auto root = tree.root();
+    EXPECT_EQ(tree.root_name(), "Level");
+    EXPECT_EQ(root.type(), nbt::TypeCode::Compound);
+    EXPECT_EQ(root["byteTest"].get<nbt::Byte>(), 127);
+    EXPECT_EQ(root["shortTest"].get<nbt::Short>(), 32767);
+    EXPECT_EQ(root["intTest"].get<nbt::Int>(), 2147483647);
+    EXPECT_EQ(root["longTest"].get<nbt::Long>(), 9223372036854775807L);
+    EXPECT_NEAR(root["floatTest"].get<nbt::Float>(), 0.49823147, 1e-5);
+    EXPECT_NEAR(root["doubleTest"].get<nbt::Double>(), 0.4931287132182315,
+                1e-9);
+    EXPECT_EQ(root["stringTest"].get_string(),
+              "HELLO WORLD THIS IS A TEST STRING ÅÄÖ!");
+    EXPECT_EQ(root["nested compound test"]["egg"]["name"].get_string(),
+              "Eggbert");
+    EXPECT_FALSE(root.contains("Not_Present"));
+    EXPECT_THROW(root["Not_Present"], std::out_of_range);
+    EXPECT_THROW(root["intTest"].get<nbt::Long>(), std::runtime_error);
+}
+
+TEST_F(CompactBigTest, ListsAndArrays) {
+    auto root = tree.root();
+    auto longs = root["listTest (long)"];
+    EXPECT_EQ(longs.list_type(), nbt::TypeCode::Long);
+    auto values = longs.get_array<nbt::Long>();
+    EXPECT_EQ(std::vector<nbt::Long>(values.begin(), values.end()),
+              (std::vector<nbt::Long>{11, 12, 13, 14, 15}));
+
+    auto compounds = root["listTest (compound)"];
+    EXPECT_EQ(compounds.size(), 2);
+    EXPECT_EQ(compounds[1]["name"].get_string(), "Compound tag #1");
+    EXPECT_EQ(compounds[1]["created-on"].get<nbt::Long>(), 1264099775885L);
+
+    auto ints = root["intArrayTest"].get_array<nbt::Int>();
+    EXPECT_EQ(ints.size(), 4);
+    EXPECT_THROW(root["intArrayTest"].get_array<nbt::Long>(),
+                 std::runtime_error);
+}
+
+TEST_F(CompactBigTest, ToTagMatchesTag) {
+    auto [root_name, root_tag] = nbt::read_binary(bytes);
+    EXPECT_EQ(nbt::to_string(tree.root().to_tag()), nbt::to_string(root_tag));
+}
+
+TEST(CompactTree, ChunksMatchTag) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto chunk_data = reg.get_chunk_data(i);
+        nbt::CompactTree tree(chunk_data.data(), chunk_data.size());
+        auto [root_name, root_tag] = nbt::read_binary(chunk_data);
+        EXPECT_EQ(tree.root()["Level"]["xPos"].get<nbt::Int>(),
+                  root_tag["Level"]["xPos"].get<nbt::Int>());
+        EXPECT_EQ(nbt::to_string(tree.root().to_tag()),
+                  nbt::to_string(root_tag));
+    }
+}
+
+TEST_F(CompactBigTest, InternedKeys) {
+    nbt::KeyTable keys;
+    nbt::CompactTree interned(bytes.data(), bytes.size(), keys);
+    auto root = interned.root();
+    EXPECT_EQ(interned.root_name(), "Level");
+    EXPECT_EQ(root["intTest"].get<nbt::Int>(), 2147483647);
+    auto name_key = keys.intern("name");
+    EXPECT_EQ(root["nested compound test"]["ham"][name_key].get_string(),
+              "Hampus");
+    EXPECT_FALSE(root.contains("Never interned"));
+    EXPECT_THROW(tree.root()[name_key], std::runtime_error);
+    EXPECT_EQ(nbt::to_string(root.to_tag()),
+              nbt::to_string(tree.root().to_tag()));
+    EXPECT_LT(interned.memory_usage(), tree.memory_usage());
+}
+
+TEST(CompactTree, DepthLimit) {
+    // A root List nested a million levels deep
+    std::vector<unsigned char> deep{0x09, 0x00, 0x00};
+    for (int i = 1; i < 1000000; ++i) {
+        deep.insert(deep.end(), {0x09, 0x00, 0x00, 0x00, 0x01});
+    }
+    deep.insert(deep.end(), {0x00, 0x00, 0x00, 0x00, 0x00});
+    EXPECT_THROW(nbt::CompactTree(deep.data(), deep.size()),
+                 nbt::LimitExceededException);
+
+    // Three Lists, within the limit of three but not of two
+    std::vector<unsigned char> shallow{0x09, 0x00, 0x00, 0x09, 0x00, 0x00,
+                                       0x00, 0x01, 0x09, 0x00, 0x00, 0x00,
+                                       0x01, 0x00, 0x00, 0x00, 0x00, 0x00};
+    nbt::CompactTree tree(shallow.data(), shallow.size(), {.max_depth = 3});
+    EXPECT_EQ(tree.root()[std::size_t(0)][std::size_t(0)].size(), 0);
+    EXPECT_THROW(
+        nbt::CompactTree(shallow.data(), shallow.size(), {.max_depth = 2}),
+        nbt::LimitExceededException);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Document.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+static std::vector<unsigned char> file_bytes(const std::string &filename) {
+    std::ifstream input(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(input),
+            std::istreambuf_iterator<char>()};
+}
+
+static std::string serialized(const nbt::Tag &tag) {
+    std::ostringstream output(std::ios::binary);
+    nbt::write_binary(tag, "", output);
+    return output.str();
+}
+
+TEST(Document, Views) {
+    auto bytes = file_bytes("test_data/bigtest.nbt");
+    auto raw_size = bytes.size();
+    auto expected = nbt::read_binary(bytes);
+    nbt::Document doc(std::move(bytes));
+    EXPECT_EQ(doc.raw_bytes().size(), raw_size);
+    EXPECT_GT(doc.bytes().size(), raw_size);
+    EXPECT_FALSE(doc.is_mapped());
+
+    auto root = doc.root();
+    EXPECT_EQ(root.name(), "Level");
+    EXPECT_EQ(root.type(), nbt::TypeCode::Compound);
+    EXPECT_EQ(root.size(), expected.second.size());
+    EXPECT_EQ(serialized(root.to_tag()), serialized(expected.second));
+
+    EXPECT_EQ(root["intTest"].get<nbt::Int>(), 2147483647);
+    EXPECT_EQ(root["floatTest"].get<nbt::Float>(), 0.49823147f);
+    EXPECT_THROW(root["intTest"].get<nbt::Long>(), std::runtime_error);
+    EXPECT_THROW(root["missing"], std::out_of_range);
+    EXPECT_FALSE(root.contains("missing"));
+
+    // Strings and arrays are read in place.
+    auto str = root["stringTest"];
+    EXPECT_EQ(str.get_string(),
+              expected.second["stringTest"].get<nbt::String>());
+    EXPECT_GE(str.get_string().data(),
+              reinterpret_cast<const char *>(doc.bytes().data()));
+    auto ints = root["intArrayTest"].get_array<nbt::Int>();
+    EXPECT_EQ(ints.to_vector(),
+              expected.second["intArrayTest"].get<nbt::Int_Array>());
+    auto longs = root["listTest (long)"].get_array<nbt::Long>();
+    ASSERT_EQ(longs.size(), 5);
+    EXPECT_EQ(longs[4], 15);
+    EXPECT_THROW(root["intArrayTest"].get_array<nbt::Long>(),
+                 std::runtime_error);
+    EXPECT_TRUE(root["listTest (end)"].get_array<nbt::Int>().empty());
+
+    auto compounds = root["listTest (compound)"];
+    ASSERT_EQ(compounds.size(), 2);
+    auto second = compounds[1];
+    // String views may not be taken from temporaries.
+    auto second_name = second["name"];
+    EXPECT_EQ(second_name.get_string(), "Compound tag #1");
+    EXPECT_EQ(second.name(), "");
+    EXPECT_THROW(compounds[2], std::out_of_range);
+    EXPECT_THROW(root["listTest (long)"][0], std::runtime_error);
+
+    // A payload re-read as an unnamed root is the same tag.
+    auto egg = root["nested compound test"]["egg"];
+    auto payload = egg.payload();
+    std::vector<unsigned char> egg_data{
+        static_cast<unsigned char>(nbt::TypeCode::Compound), 0, 0};
+    egg_data.insert(egg_data.end(), payload.begin(), payload.end());
+    EXPECT_EQ(serialized(nbt::read_binary(egg_data).second),
+              serialized(egg.to_tag()));
+}
+
+TEST(Document, Lifetime) {
+    // Views keep the bytes alive after the Document is gone.
+    nbt::Document::Array_View<nbt::Byte> bytes_view = [] {
+        nbt::Document doc(file_bytes("test_data/bigtest.nbt"));
+        return doc.root()["byteArrayTest (the first 1000 values of "
+                          "(n*n*255+n*7)%100, starting with n=0 (0, 62, 34, "
+                          "16, 8, ...))"]
+            .get_array<nbt::Byte>();
+    }();
+    ASSERT_EQ(bytes_view.size(), 1000);
+    EXPECT_EQ(bytes_view[1], 62);
+
+    auto nested = [] {
+        auto doc = nbt::Document::open("test_data/bigtest.nbt");
+        return doc.root()["nested compound test"];
+    }();
+    EXPECT_EQ(nested["ham"]["value"].get<nbt::Float>(), 0.75f);
+
+    EXPECT_THROW(nbt::Document::open("test_data/no_such_file"),
+                 std::runtime_error);
+    EXPECT_THROW(nbt::Document(std::vector<unsigned char>{0x0a, 0x00}),
+                 std::runtime_error);
+}
+
+TEST(Document, DeepInput) {
+    // A root List nested a million levels deep is rejected, as by
+    // read_binary(), rather than overflowing the stack.
+    std::vector<unsigned char> bytes{0x09, 0x00, 0x00};
+    for (int i = 1; i < 1000000; ++i) {
+        bytes.insert(bytes.end(), {0x09, 0x00, 0x00, 0x00, 0x01});
+    }
+    bytes.insert(bytes.end(), {0x00, 0x00, 0x00, 0x00, 0x00});
+    EXPECT_THROW(nbt::read_binary(bytes), nbt::LimitExceededException);
+    EXPECT_THROW(nbt::Document{bytes}, nbt::LimitExceededException);
+}
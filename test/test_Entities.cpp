@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Entities.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+static nbt::Compound entity(const std::string &id, double x, double y,
+                            double z) {
+    return nbt::Compound{{"id", nbt::String(id)},
+                         {"Pos", nbt::List{x, y, z}},
+                         {"Motion", nbt::List{0.0, 0.0, 0.0}}};
+}
+
+static nbt::Compound block_entity(const std::string &id, int x, int y,
+                                  int z) {
+    return nbt::Compound{{"id", nbt::String(id)},
+                         {"x", nbt::Int(x)},
+                         {"y", nbt::Int(y)},
+                         {"z", nbt::Int(z)}};
+}
+
+static const nbt::Bounding_Box everywhere{
+    -std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::infinity(),
+    std::numeric_limits<double>::infinity()};
+
+TEST(Entities, LegacyRegion) {
+    // Collect the records of each chunk by decoding it in full.
+    std::vector<std::pair<std::string, nbt::Entity_Kind>> expected;
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto level = nbt::read_binary(reg.get_chunk_data(i)).second["Level"];
+        for (auto &e : level["Entities"].get<nbt::List>()) {
+            expected.emplace_back(e["id"].get<nbt::String>(),
+                                  nbt::Entity_Kind::entity);
+        }
+        for (auto &e : level["TileEntities"].get<nbt::List>()) {
+            expected.emplace_back(e["id"].get<nbt::String>(),
+                                  nbt::Entity_Kind::block_entity);
+        }
+    }
+
+    auto index = nbt::build_entity_index({"test_data/r.0.0.mca"}, {}, 3);
+    ASSERT_EQ(index.size(), expected.size());
+    ASSERT_FALSE(index.types().empty());
+    EXPECT_TRUE(std::is_sorted(index.types().begin(), index.types().end()));
+    for (const auto &[id, kind] : expected) {
+        auto type = index.type_index(id);
+        ASSERT_TRUE(type.has_value()) << id;
+    }
+
+    // Each record's offset locates its Compound within the chunk.
+    for (const auto &record : index.records()) {
+        auto compressed = reg.get_chunk_data(record.chunk);
+        auto data =
+            nbt::decompress_data(compressed.data(), compressed.size());
+        ASSERT_LT(record.offset, data.size());
+        std::vector<unsigned char> entity_data{
+            static_cast<unsigned char>(nbt::TypeCode::Compound), 0, 0};
+        entity_data.insert(entity_data.end(), data.begin() + record.offset,
+                           data.end());
+        auto e = nbt::read_binary(entity_data).second;
+        EXPECT_EQ(e["id"].get<nbt::String>(), index.types()[record.type]);
+        EXPECT_EQ(record.source, nbt::Entity_Source::region);
+        EXPECT_EQ(record.region_x, 0);
+        EXPECT_EQ(record.region_z, 0);
+        if (record.kind == nbt::Entity_Kind::block_entity) {
+            EXPECT_EQ(static_cast<int>(record.x) / 16 & 31, record.chunk % 32);
+            EXPECT_EQ(static_cast<int>(record.z) / 16 & 31, record.chunk / 32);
+        }
+    }
+    EXPECT_EQ(index.query(everywhere).size(), index.size());
+}
+
+TEST(Entities, WorldQueries) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_entities";
+    std::filesystem::create_directories(dir / "region");
+    std::filesystem::create_directories(dir / "entities");
+
+    // A 1.18 chunk with block entities, and a 1.17 entities file.
+    nbt::Tag chunk = nbt::Compound{
+        {"xPos", nbt::Int(-32)},
+        {"zPos", nbt::Int(1)},
+        {"block_entities",
+         nbt::List{block_entity("minecraft:chest", -510, 64, 20),
+                   block_entity("minecraft:chest", -500, -10, 30),
+                   block_entity("minecraft:sign", -505, 70, 25),
+                   nbt::Compound{{"id", nbt::String("minecraft:bed")}}}}};
+    write_region(dir / "region" / "r.-1.0.mca", {{1 * 32 + 0, chunk}});
+    nbt::Tag entities = nbt::Compound{
+        {"Position", nbt::Int_Array{-32, 1}},
+        {"Entities",
+         nbt::List{entity("minecraft:zombie", -510.5, 64.0, 20.5),
+                   entity("minecraft:zombie", -490.5, 64.0, 30.5),
+                   entity("minecraft:cow", -505.0, 65.0, 25.0)}}};
+    write_region(dir / "entities" / "r.-1.0.mca", {{1 * 32 + 0, entities}});
+
+    auto index = nbt::build_world_entity_index(dir.string(), 2);
+    EXPECT_EQ(index.size(), 6);
+    EXPECT_EQ(index.types(),
+              (std::vector<std::string>{"minecraft:chest", "minecraft:cow",
+                                        "minecraft:sign",
+                                        "minecraft:zombie"}));
+
+    nbt::Bounding_Box box{-512, 0, 16, -496, 128, 32};
+    auto zombies = index.query(box, "minecraft:zombie");
+    ASSERT_EQ(zombies.size(), 1);
+    EXPECT_EQ(zombies[0].x, -510.5);
+    EXPECT_EQ(zombies[0].kind, nbt::Entity_Kind::entity);
+    EXPECT_EQ(zombies[0].source, nbt::Entity_Source::entities);
+    EXPECT_EQ(zombies[0].region_x, -1);
+    EXPECT_EQ(zombies[0].chunk, 32);
+
+    auto chests = index.query(box, "minecraft:chest");
+    ASSERT_EQ(chests.size(), 1);
+    EXPECT_EQ(chests[0].y, 64);
+    EXPECT_EQ(chests[0].kind, nbt::Entity_Kind::block_entity);
+    EXPECT_EQ(chests[0].source, nbt::Entity_Source::region);
+
+    EXPECT_EQ(index.query(box).size(), 4);
+    EXPECT_TRUE(index.query(box, "minecraft:pig").empty());
+
+    std::stringstream file;
+    index.save(file);
+    auto copy = nbt::Entity_Index::load(file);
+    EXPECT_EQ(copy.types(), index.types());
+    EXPECT_EQ(copy.records(), index.records());
+
+    std::stringstream truncated(file.str().substr(0, file.str().size() - 1));
+    EXPECT_THROW(nbt::Entity_Index::load(truncated), std::runtime_error);
+    // A count of names which the file is too short to hold is rejected
+    // before they are allocated.
+    std::stringstream huge(std::string("NBTE\xff\xff\xff\xff", 8));
+    EXPECT_THROW(nbt::Entity_Index::load(huge), std::runtime_error);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Entities, ExternalChunk) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_external";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 0 of r.0.0.mca keeps its data in c.0.0.mcc.
+    nbt::Tag chunk = nbt::Compound{
+        {"block_entities",
+         nbt::List{block_entity("minecraft:chest", 1, 64, 2)}}};
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(chunk, "", encoded);
+    std::ofstream(dir / "r.0.0.mca", std::ios::binary)
+        << region_bytes({{0, 0x83, ""}});
+    std::ofstream(dir / "c.0.0.mcc", std::ios::binary) << encoded.str();
+
+    auto index = nbt::build_entity_index({(dir / "r.0.0.mca").string()}, {},
+                                         1);
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index.types(), std::vector<std::string>{"minecraft:chest"});
+    const auto &record = index.records()[0];
+    EXPECT_EQ(record.y, 64);
+    nbt::Region_File reg((dir / "r.0.0.mca").string());
+    auto data = reg.get_chunk_data(record.chunk);
+    ASSERT_LT(record.offset, data.size());
+    std::vector<unsigned char> entity_data{
+        static_cast<unsigned char>(nbt::TypeCode::Compound), 0, 0};
+    entity_data.insert(entity_data.end(), data.begin() + record.offset,
+                       data.end());
+    EXPECT_EQ(nbt::read_binary(entity_data).second["x"].get<nbt::Int>(), 1);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Deserializer.hpp"
+#include "Hash.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+class HashBigTest : public ::testing::Test {
+  protected:
+    std::vector<unsigned char> bytes;
+    nbt::Tag tag;
+
+    virtual void SetUp() {
+        std::ifstream bigtest_stream("test_data/bigtest.nbt",
+                                     std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(bigtest_stream), {});
+        tag = nbt::read_binary(bytes).second;
+    }
+};
+
+TEST(Hash, Bytes) {
+    std::string text(1000, 'x');
+    auto h = nbt::hash_bytes(text.data(), text.size());
+    EXPECT_EQ(h, nbt::hash_bytes(text.data(), text.size()));
+    EXPECT_NE(h, nbt::hash_bytes(text.data(), text.size(), 1));
+    EXPECT_NE(h, nbt::hash_bytes(text.data(), text.size() - 1));
+    text[500] = 'y';
+    EXPECT_NE(h, nbt::hash_bytes(text.data(), text.size()));
+    EXPECT_NE(nbt::hash_bytes("", 0), nbt::hash_bytes("\0", 1));
+}
+
+TEST_F(HashBigTest, EncodedMatchesDecoded) {
+    auto h = nbt::hash_tag(tag);
+    EXPECT_EQ(nbt::hash_binary(bytes.data(), bytes.size()), h);
+
+    auto packed = nbt::read_binary(bytes, {.packed_lists = true}).second;
+    EXPECT_EQ(nbt::hash_tag(packed), h);
+
+    std::ostringstream os;
+    nbt::write_binary(tag, "renamed", os);
+    auto encoded = os.str();
+    EXPECT_EQ(nbt::hash_binary(
+                  reinterpret_cast<const unsigned char *>(encoded.data()),
+                  encoded.size()),
+              h);
+}
+
+TEST_F(HashBigTest, SensitiveToValues) {
+    auto h = nbt::hash_tag(tag);
+    auto copy = tag;
+    copy["nested compound test"]["egg"]["value"] = nbt::Float(0.25);
+    EXPECT_NE(nbt::hash_tag(copy), h);
+    copy = tag;
+    copy["intTest"] = nbt::Long(2147483647);
+    EXPECT_NE(nbt::hash_tag(copy), h);
+}
+
+TEST(Hash, CompoundOrder) {
+    // {a:1b,b:2b} encoded with its entries in either order
+    std::vector<unsigned char> ab{10, 0, 0, 1, 0, 1, 'a', 1,
+                                  1,  0, 1, 'b', 2, 0};
+    std::vector<unsigned char> ba{10, 0, 0, 1, 0, 1, 'b', 2,
+                                  1,  0, 1, 'a', 1, 0};
+    EXPECT_EQ(nbt::hash_binary(ab.data(), ab.size()),
+              nbt::hash_binary(ba.data(), ba.size()));
+    nbt::Tag cmpd(nbt::Compound{});
+    cmpd.emplace("a", nbt::Byte(1));
+    cmpd.emplace("b", nbt::Byte(2));
+    EXPECT_EQ(nbt::hash_tag(cmpd), nbt::hash_binary(ab.data(), ab.size()));
+
+    // Swapping values between keys changes the hash.
+    std::vector<unsigned char> swapped{10, 0, 0, 1, 0, 1, 'a', 2,
+                                       1,  0, 1, 'b', 1, 0};
+    EXPECT_NE(nbt::hash_binary(ab.data(), ab.size()),
+              nbt::hash_binary(swapped.data(), swapped.size()));
+}
+
+TEST(Hash, Lists) {
+    nbt::Tag empty(nbt::List{});
+    nbt::Tag empty_packed(nbt::Packed_List(std::vector<nbt::Int>{}));
+    EXPECT_EQ(nbt::hash_tag(empty), nbt::hash_tag(empty_packed));
+
+    nbt::Tag ints(nbt::List{});
+    ints.push_back(nbt::Int(1));
+    ints.push_back(nbt::Int(2));
+    nbt::Tag packed(nbt::Packed_List(std::vector<nbt::Int>{1, 2}));
+    nbt::Tag array(nbt::Int_Array{1, 2});
+    EXPECT_EQ(nbt::hash_tag(ints), nbt::hash_tag(packed));
+    EXPECT_NE(nbt::hash_tag(ints), nbt::hash_tag(array));
+    EXPECT_NE(nbt::hash_tag(ints), nbt::hash_tag(empty));
+}
+
+TEST(Hash, DepthLimit) {
+    // A root List nested a million levels deep
+    std::vector<unsigned char> deep{0x09, 0x00, 0x00};
+    for (int i = 1; i < 1000000; ++i) {
+        deep.insert(deep.end(), {0x09, 0x00, 0x00, 0x00, 0x01});
+    }
+    deep.insert(deep.end(), {0x00, 0x00, 0x00, 0x00, 0x00});
+    EXPECT_THROW(nbt::hash_binary(deep.data(), deep.size()),
+                 nbt::LimitExceededException);
+
+    // Two Lists, within the limit of two but not of one
+    std::vector<unsigned char> shallow{0x09, 0x00, 0x00, 0x09, 0x00,
+                                       0x00, 0x00, 0x01, 0x00, 0x00,
+                                       0x00, 0x00, 0x00};
+    EXPECT_EQ(nbt::hash_binary(shallow.data(), shallow.size(),
+                               {.max_depth = 2}),
+              nbt::hash_tag(nbt::read_binary(shallow).second));
+    EXPECT_THROW(
+        nbt::hash_binary(shallow.data(), shallow.size(), {.max_depth = 1}),
+        nbt::LimitExceededException);
+}
+
+TEST(Hash, Chunks) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    std::vector<uint64_t> hashes;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto chunk_data = reg.get_chunk_data(i);
+        auto [root_name, root_tag] = nbt::read_binary(chunk_data);
+        auto h = nbt::hash_binary(chunk_data.data(), chunk_data.size());
+        EXPECT_EQ(nbt::hash_tag(root_tag), h);
+        hashes.push_back(h);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    EXPECT_EQ(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+TEST_F(HashBigTest, Diff) {
+    using Kind = nbt::Difference::Kind;
+    EXPECT_TRUE(nbt::diff(tag, tag).empty());
+
+    auto copy = tag;
+    copy["nested compound test"]["ham"]["value"] = nbt::Float(1.5);
+    copy["listTest (compound)"][1]["name"] = nbt::String("renamed");
+    copy["listTest (compound)"].push_back(nbt::Compound{});
+    copy.get<nbt::Compound>().erase("shortTest");
+    copy.emplace("newTest", nbt::Byte(0));
+    copy["listTest (long)"][0] = nbt::Long(0);
+
+    std::vector<nbt::Difference> expected{
+        {Kind::changed, "listTest (compound)[1].name"},
+        {Kind::added, "listTest (compound)[2]"},
+        {Kind::changed, "listTest (long)"},
+        {Kind::changed, "nested compound test.ham.value"},
+        {Kind::added, "newTest"},
+        {Kind::removed, "shortTest"},
+    };
+    EXPECT_EQ(nbt::diff(tag, copy), expected);
+
+    nbt::Tag other(nbt::Int(1));
+    std::vector<nbt::Difference> replaced{{Kind::changed, ""}};
+    EXPECT_EQ(nbt::diff(tag, other), replaced);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "IncrementalParser.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+
+static std::vector<unsigned char> bigtest_bytes() {
+    std::ifstream input("test_data/bigtest.nbt", std::ios::binary);
+    std::vector<unsigned char> compressed{std::istreambuf_iterator<char>(input),
+                                          std::istreambuf_iterator<char>()};
+    return nbt::decompress_data(compressed.data(), compressed.size());
+}
+
+static std::string serialized(const std::pair<std::string, nbt::Tag> &root) {
+    std::ostringstream output(std::ios::binary);
+    nbt::write_binary(root.second, root.first, output);
+    return output.str();
+}
+
+TEST(IncrementalParser, Fragments) {
+    auto bytes = bigtest_bytes();
+    auto expected = serialized(nbt::read_binary(bytes));
+    for (std::size_t fragment : {1, 3, 7, 64, 1000, 100000}) {
+        nbt::Incremental_Parser parser;
+        std::size_t offset = 0;
+        auto status = nbt::Parse_Status::need_more_input;
+        while (offset < bytes.size()) {
+            auto n = std::min(fragment, bytes.size() - offset);
+            status = parser.feed(bytes.data() + offset, n);
+            EXPECT_EQ(parser.consumed(), n);
+            offset += n;
+            if (offset < bytes.size()) {
+                ASSERT_EQ(status, nbt::Parse_Status::need_more_input);
+            }
+        }
+        ASSERT_EQ(status, nbt::Parse_Status::complete) << fragment;
+        EXPECT_EQ(serialized(parser.take_result()), expected);
+        EXPECT_FALSE(parser.complete());
+    }
+}
+
+TEST(IncrementalParser, SeveralRoots) {
+    // Three tags back to back, of which the last 10 bytes arrive in a
+    // second fragment.
+    std::ostringstream output(std::ios::binary);
+    nbt::Tag first = nbt::Compound{{"a", nbt::List{nbt::Int(1), nbt::Int(2)}},
+                                   {"b", nbt::String("bee")}};
+    nbt::Tag second = nbt::Compound{
+        {"c", nbt::List{nbt::Compound{{"d", nbt::Long_Array{5, 6}}},
+                        nbt::Compound{}}}};
+    nbt::write_binary(first, "one", output);
+    auto one_length = output.str().size();
+    nbt::write_binary(second, "two", output);
+    nbt::write_binary(first, "three", output);
+    auto data = output.str();
+    auto bytes = reinterpret_cast<const unsigned char *>(data.data());
+
+    nbt::Incremental_Parser parser;
+    auto length = data.size() - 10;
+    EXPECT_EQ(parser.feed(bytes, length), nbt::Parse_Status::complete);
+    auto offset = parser.consumed();
+    EXPECT_EQ(offset, one_length);
+    auto one = parser.take_result();
+    EXPECT_EQ(one.first, "one");
+    EXPECT_EQ(one.second["b"].get<nbt::String>(), "bee");
+
+    EXPECT_EQ(parser.feed(bytes + offset, length - offset),
+              nbt::Parse_Status::complete);
+    offset += parser.consumed();
+    auto two = parser.take_result();
+    EXPECT_EQ(two.first, "two");
+    EXPECT_EQ(two.second["c"][0]["d"].get<nbt::Long_Array>(),
+              (nbt::Long_Array{5, 6}));
+
+    EXPECT_EQ(parser.feed(bytes + offset, length - offset),
+              nbt::Parse_Status::need_more_input);
+    EXPECT_THROW(parser.take_result(), std::logic_error);
+    EXPECT_EQ(parser.feed(bytes + length, 10), nbt::Parse_Status::complete);
+    EXPECT_EQ(parser.take_result().first, "three");
+}
+
+TEST(IncrementalParser, InvalidInput) {
+    nbt::Incremental_Parser parser;
+    const unsigned char bad_type[] = {0x0a, 0x00, 0x00, 0x0e, 0x00, 0x00};
+    EXPECT_THROW(parser.feed(bad_type, sizeof(bad_type)), std::runtime_error);
+
+    parser.reset();
+    const unsigned char bad_array[] = {0x07, 0x00, 0x00, 0xff,
+                                       0xff, 0xff, 0xff};
+    EXPECT_THROW(parser.feed(bad_array, sizeof(bad_array)),
+                 std::runtime_error);
+
+    // Depth is limited as in read_binary().
+    nbt::read_options options;
+    options.max_depth = 2;
+    nbt::Incremental_Parser shallow(options);
+    const unsigned char deep[] = {0x0a, 0x00, 0x00, 0x0a, 0x00, 0x00,
+                                  0x0a, 0x00, 0x00};
+    EXPECT_THROW(shallow.feed(deep, sizeof(deep)),
+                 nbt::LimitExceededException);
+
+    options = {};
+    options.encoding = nbt::Binary_Encoding::little_endian;
+    EXPECT_THROW(nbt::Incremental_Parser{options}, std::runtime_error);
+}
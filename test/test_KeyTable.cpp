@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "KeyTable.hpp"
+
+namespace nbt = nbtview;
+
+TEST(KeyTable, Intern) {
+    nbt::KeyTable keys;
+    auto level = keys.intern("Level");
+    auto xpos = keys.intern("xPos");
+    EXPECT_NE(level, xpos);
+    EXPECT_EQ(keys.intern(std::string("Level")), level);
+    EXPECT_EQ(keys.name(level), "Level");
+    EXPECT_EQ(keys.name(xpos), "xPos");
+    EXPECT_EQ(keys.size(), 2);
+    EXPECT_EQ(keys.find("xPos"), xpos);
+    EXPECT_FALSE(keys.find("zPos").has_value());
+}
+
+TEST(KeyTable, ManyNames) {
+    nbt::KeyTable keys;
+    std::vector<nbt::Key> interned;
+    for (int i = 0; i < 10000; ++i) {
+        interned.push_back(keys.intern("key" + std::to_string(i)));
+    }
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(keys.name(interned[i]), "key" + std::to_string(i));
+    }
+}
+
+TEST(KeyTable, ConcurrentIntern) {
+    nbt::KeyTable keys;
+    const int thread_count = 4;
+    const int name_count = 2000;
+    std::vector<std::vector<nbt::Key>> results(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < name_count; ++i) {
+                results[t].push_back(keys.intern("name" + std::to_string(i)));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(keys.size(), name_count);
+    for (int t = 1; t < thread_count; ++t) {
+        EXPECT_EQ(results[t], results[0]);
+    }
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Pipeline.hpp"
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+TEST(BoundedQueue, FirstInFirstOut) {
+    nbt::detail::Bounded_Queue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    int value = 4;
+    EXPECT_FALSE(queue.try_push(value));
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_EQ(nbt::detail::Bounded_Queue<int>(1).capacity(), 2);
+}
+
+TEST(BoundedQueue, SeveralProducersAndConsumers) {
+    nbt::detail::Bounded_Queue<int> queue(8);
+    const int count = 20000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p) {
+        producers.emplace_back([&, p] {
+            for (int i = p; i < count; i += 2) {
+                int value = i;
+                while (!queue.try_push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<long> sums(2);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; ++c) {
+        consumers.emplace_back([&, c] {
+            for (int n = 0; n < count / 2; ++n) {
+                int value;
+                while (!queue.try_pop(value)) {
+                    std::this_thread::yield();
+                }
+                sums[c] += value;
+            }
+        });
+    }
+    for (auto &thread : producers) {
+        thread.join();
+    }
+    for (auto &thread : consumers) {
+        thread.join();
+    }
+    EXPECT_EQ(sums[0] + sums[1], long(count) * (count - 1) / 2);
+}
+
+// Returns the xPos of each chunk of the test region, read in a loop.
+static std::map<int, nbt::Int> chunk_x_positions() {
+    std::map<int, nbt::Int> positions;
+    nbt::Region_File region("test_data/r.0.0.mca");
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (region.chunk_length(i) == 0) {
+            continue;
+        }
+        auto data = region.get_chunk_data(i);
+        data = nbt::decompress_data(data.data(), data.size());
+        auto [name, root] = nbt::read_binary(data.data(), data.size());
+        positions[i] = root["Level"]["xPos"].get<nbt::Int>();
+    }
+    return positions;
+}
+
+TEST(Pipeline, ParsesEveryChunk) {
+    auto expected = chunk_x_positions();
+    for (std::size_t depth : {1, 4, 64}) {
+        std::map<int, nbt::Int> positions;
+        nbt::Pipeline_Options options{depth, 2, 3};
+        nbt::run_pipeline<nbt::Int>(
+            {"test_data/r.0.0.mca"},
+            [](const nbt::Pipeline_Chunk &chunk) {
+                auto [name, root] =
+                    nbt::read_binary(chunk.data.data(), chunk.data.size());
+                return root["Level"]["xPos"].get<nbt::Int>();
+            },
+            [&](std::size_t file, int chunk, nbt::Int x) {
+                EXPECT_EQ(file, 0);
+                EXPECT_TRUE(positions.emplace(chunk, x).second);
+            },
+            options);
+        EXPECT_EQ(positions, expected);
+    }
+}
+
+TEST(Pipeline, ReadsExternalChunks) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_pipeline";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 1 keeps its data in c.1.0.mcc.
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(nbt::Compound{{"xPos", nbt::Int(1)}}, "", encoded);
+    std::ofstream(dir / "r.0.0.mca", std::ios::binary)
+        << region_bytes({{0, 3, encoded.str()}, {1, 0x83, ""}});
+    std::ofstream(dir / "c.1.0.mcc", std::ios::binary) << encoded.str();
+
+    std::map<int, nbt::Int> positions;
+    nbt::run_pipeline<nbt::Int>(
+        {(dir / "r.0.0.mca").string()},
+        [](const nbt::Pipeline_Chunk &chunk) {
+            auto [name, root] =
+                nbt::read_binary(chunk.data.data(), chunk.data.size());
+            return root["xPos"].get<nbt::Int>();
+        },
+        [&](std::size_t, int chunk, nbt::Int x) { positions[chunk] = x; },
+        {2, 1, 1});
+    EXPECT_EQ(positions, (std::map<int, nbt::Int>{{0, 1}, {1, 1}}));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Pipeline, StagesWaitForASlowConsumer) {
+    // With a consumer this slow, the other stages fill their queues and
+    // park until it catches up.
+    std::size_t count = 0;
+    nbt::run_pipeline<int>(
+        {"test_data/r.0.0.mca"},
+        [](const nbt::Pipeline_Chunk &chunk) { return chunk.chunk; },
+        [&](std::size_t, int, int) {
+            if (count++ < 8) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        },
+        {1, 2, 2});
+    EXPECT_EQ(count, chunk_x_positions().size());
+}
+
+TEST(Pipeline, RethrowsFirstError) {
+    auto parse = [](const nbt::Pipeline_Chunk &chunk) {
+        if (chunk.chunk > 100) {
+            throw std::runtime_error("parse");
+        }
+        return 0;
+    };
+    auto consume = [](std::size_t, int, int) {};
+    EXPECT_THROW(nbt::run_pipeline<int>({"test_data/r.0.0.mca"}, parse,
+                                        consume, {2, 1, 1}),
+                 std::runtime_error);
+    auto failing_consume = [](std::size_t, int, int) {
+        throw std::logic_error("consume");
+    };
+    EXPECT_THROW(nbt::run_pipeline<int>(
+                     {"test_data/r.0.0.mca"},
+                     [](const nbt::Pipeline_Chunk &) { return 0; },
+                     failing_consume, {2, 1, 1}),
+                 std::logic_error);
+    EXPECT_THROW(nbt::run_pipeline<int>({"test_data/missing.mca"}, parse,
+                                        consume),
+                 std::runtime_error);
+}
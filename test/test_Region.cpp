@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
 #include "Region.hpp"
+#include "region_fixture.hpp"
 
 namespace nbt = nbtview;
 
@@ -36,3 +42,35 @@ TEST(RegionTest, TimestampData) {
     EXPECT_EQ(reg.chunk_timestamp(2), 0x6004c6d7);
     EXPECT_EQ(reg.chunk_timestamp(3), 0x00000000);
 }
+
+// Test for region file names
+TEST(RegionTest, FileNames) {
+    int x = 0, z = 0;
+    EXPECT_TRUE(nbt::parse_region_filename("world/region/r.-3.12.mca", x, z));
+    EXPECT_EQ(x, -3);
+    EXPECT_EQ(z, 12);
+    EXPECT_FALSE(nbt::parse_region_filename("r.1.mca", x, z));
+    EXPECT_FALSE(nbt::parse_region_filename("r.1.2.mcr", x, z));
+    EXPECT_FALSE(nbt::parse_region_filename("r.a.2.mca", x, z));
+
+    auto files = nbt::region_files("test_data");
+    ASSERT_EQ(files.size(), 1);
+    EXPECT_TRUE(files[0].ends_with("r.0.0.mca"));
+}
+
+// Test for external chunks, stored in c.X.Z.mcc beside the region file
+TEST(RegionTest, ExternalChunk) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_region";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "r.-1.2.mca", std::ios::binary)
+        << region_fixture::region_bytes({{33, 0x83, ""}, {34, 0x83, ""}});
+    std::ofstream(dir / "c.-31.65.mcc", std::ios::binary) << "external";
+
+    nbt::Region_File reg((dir / "r.-1.2.mca").string());
+    auto data = reg.get_chunk_data(33);
+    EXPECT_EQ(std::string(data.begin(), data.end()), "external");
+    EXPECT_THROW(reg.get_chunk_data(34), std::runtime_error);
+    EXPECT_THROW(nbt::read_external_chunk("region.mca", 0),
+                 std::runtime_error);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Hash.hpp"
+#include "Region.hpp"
+#include "RegionIndex.hpp"
+#include "Scanner.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+static const std::vector<std::string> index_paths = {
+    "Level.xPos", "Level.Sections", "Level.Missing"};
+
+static std::vector<unsigned char> inflated_chunk(nbt::Region_File &reg,
+                                                 int i) {
+    auto data = reg.get_chunk_data(i);
+    return nbt::decompress_data(data.data(), data.size());
+}
+
+TEST(RegionIndex, Summaries) {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    std::size_t chunk_count = 0;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        chunk_count += reg.chunk_length(i) != 0;
+    }
+    auto index = nbt::Region_Index(index_paths);
+    EXPECT_EQ(index.update("test_data/r.0.0.mca", 2), chunk_count);
+    EXPECT_EQ(index.update("test_data/r.0.0.mca", 2), 0);
+
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        const auto &summary = index[i];
+        ASSERT_EQ(summary.present(), reg.chunk_length(i) != 0);
+        if (!summary.present()) {
+            continue;
+        }
+        EXPECT_EQ(summary.timestamp, reg.chunk_timestamp(i));
+        auto data = inflated_chunk(reg, i);
+        EXPECT_EQ(summary.inflated_length, data.size());
+        EXPECT_EQ(summary.hash, nbt::hash_bytes(data.data(), data.size()));
+
+        // Recorded tags decode straight from their locations.
+        auto root = nbt::read_binary(data).second;
+        auto x = index.find(i, 0);
+        ASSERT_TRUE(x.has_value());
+        auto x_tag = nbt::read_tag_at(data.data(), data.size(), *x);
+        EXPECT_EQ(x_tag.get<nbt::Int>(), root["Level"]["xPos"].get<nbt::Int>());
+        auto sections = index.find(i, 1);
+        ASSERT_TRUE(sections.has_value());
+        EXPECT_EQ(sections->type, nbt::TypeCode::List);
+        auto sections_tag =
+            nbt::read_tag_at(data.data(), data.size(), *sections);
+        EXPECT_EQ(sections_tag.size(), root["Level"]["Sections"].size());
+        EXPECT_FALSE(index.find(i, 2).has_value());
+    }
+
+    std::stringstream file;
+    index.save(file);
+    auto copy = nbt::Region_Index::load(file);
+    EXPECT_EQ(copy.paths(), index_paths);
+    EXPECT_EQ(copy[1].hash, index[1].hash);
+    EXPECT_EQ(copy.find(1, 1)->payload, index.find(1, 1)->payload);
+    EXPECT_EQ(copy.update("test_data/r.0.0.mca"), 0);
+
+    std::stringstream truncated(file.str().substr(0, file.str().size() - 1));
+    EXPECT_THROW(nbt::Region_Index::load(truncated), std::runtime_error);
+    EXPECT_THROW(nbt::Region_Index({"Level..xPos"}), std::runtime_error);
+}
+
+TEST(RegionIndex, Sidecar) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_index";
+    std::filesystem::create_directories(dir);
+    auto region = (dir / "r.0.0.mca").string();
+    std::filesystem::copy_file(
+        "test_data/r.0.0.mca", region,
+        std::filesystem::copy_options::overwrite_existing);
+    auto sidecar = nbt::Region_Index::sidecar_path(region);
+    std::filesystem::remove(sidecar);
+
+    auto index = nbt::Region_Index::open(region, index_paths, 2);
+    ASSERT_TRUE(std::filesystem::exists(sidecar));
+    auto written = std::filesystem::last_write_time(sidecar);
+
+    // An up-to-date sidecar is loaded, and not rewritten.
+    auto reopened = nbt::Region_Index::open(region, index_paths, 2);
+    EXPECT_EQ(std::filesystem::last_write_time(sidecar), written);
+    EXPECT_EQ(reopened[2].hash, index[2].hash);
+
+    // A new timestamp makes just that chunk stale.
+    {
+        std::fstream file(region,
+                          std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(nbt::Region::sector_length + 4 * 2);
+        file.write("\x7f\x00\x00\x01", 4);
+    }
+    std::ifstream saved(sidecar, std::ios::binary);
+    auto stale = nbt::Region_Index::load(saved);
+    EXPECT_EQ(stale.update(region), 1);
+    EXPECT_EQ(stale[2].timestamp, 0x7f000001u);
+    EXPECT_EQ(stale[2].hash, index[2].hash);
+
+    // Other paths, or a damaged sidecar, cause a rebuild.
+    auto other = nbt::Region_Index::open(region, {"Level.zPos"}, 1);
+    EXPECT_EQ(other.paths(), std::vector<std::string>{"Level.zPos"});
+    EXPECT_TRUE(other.find(0, 0).has_value());
+    std::ofstream(sidecar, std::ios::binary) << "junk";
+    EXPECT_EQ(nbt::Region_Index::open(region, index_paths)[2].timestamp,
+              0x7f000001u);
+
+    // Writers racing to replace the sidecar each use their own temporary
+    // file, and leave none behind.
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 4; ++i) {
+                auto paths = (t + i) % 2 ? index_paths
+                                         : std::vector<std::string>{"a"};
+                nbt::Region_Index::open(region, paths, 1);
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    std::ifstream raced(sidecar, std::ios::binary);
+    EXPECT_NO_THROW(nbt::Region_Index::load(raced));
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(dir),
+                            std::filesystem::directory_iterator()),
+              2);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(RegionIndex, ExternalAndUnreadableChunks) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_index";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 0 keeps its data in c.0.0.mcc, chunk 1 is not valid zlib data,
+    // and chunk 2 is external with no c.2.0.mcc.
+    std::ostringstream encoded(std::ios::binary);
+    nbt::write_binary(nbt::Compound{{"Level", nbt::Compound{
+                                                  {"xPos", nbt::Int(7)}}}},
+                      "", encoded);
+    auto data = encoded.str();
+    auto compressed = nbt::compress_data(
+        reinterpret_cast<const unsigned char *>(data.data()), data.size());
+    auto region = (dir / "r.0.0.mca").string();
+    std::ofstream(region, std::ios::binary)
+        << region_bytes({{0, 0x82, ""},
+                         {1, 2, "\x78\x9c not zlib"},
+                         {2, 0x82, ""}});
+    std::ofstream(dir / "c.0.0.mcc", std::ios::binary)
+        << std::string(compressed.begin(), compressed.end());
+
+    nbt::Region_Index index(index_paths);
+    EXPECT_EQ(index.update(region, 2), 3);
+    EXPECT_EQ(index[0].inflated_length, data.size());
+    auto x = index.find(0, 0);
+    ASSERT_TRUE(x.has_value());
+    EXPECT_EQ(nbt::read_tag_at(reinterpret_cast<const unsigned char *>(
+                                   data.data()),
+                               data.size(), *x)
+                  .get<nbt::Int>(),
+              7);
+
+    // The unreadable chunks are recorded as such, and not read again until
+    // they change.
+    for (int i : {1, 2}) {
+        EXPECT_TRUE(index[i].present());
+        EXPECT_EQ(index[i].inflated_length, 0);
+        EXPECT_FALSE(index.find(i, 0).has_value());
+    }
+    EXPECT_EQ(index.update(region, 2), 0);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BinaryReader.hpp"
+#include "Region.hpp"
+#include "Scanner.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+
+static std::vector<unsigned char> encode(const nbt::Tag &tag) {
+    std::ostringstream os;
+    nbt::write_binary(tag, "root", os);
+    auto s = os.str();
+    return {s.begin(), s.end()};
+}
+
+static nbt::Int read_int(const std::vector<unsigned char> &data,
+                         std::size_t offset) {
+    return nbt::BinaryReader(data.data() + offset, data.size() - offset)
+        .read<nbt::Int>();
+}
+
+TEST(Scanner, FastFindLongName) {
+    // Names of 16 or more bytes have a length whose high nibble is set.
+    std::string name = "a_rather_long_tag_name";
+    nbt::Tag root = nbt::Compound{{"short", nbt::Int(1)}, {name, nbt::Int(2)}};
+    auto data = encode(root);
+    auto it = nbt::fast_find_named_tag(data.begin(), data.end(),
+                                       nbt::TypeCode::Int, name);
+    ASSERT_NE(it, data.end());
+    EXPECT_EQ(read_int(data, it - data.begin()), 2);
+}
+
+TEST(Scanner, FindsEveryPattern) {
+    std::string long_name(300, 'n');
+    nbt::Tag root = nbt::Compound{
+        {"xPos", nbt::Int(-3)},
+        {"zPos", nbt::Int(7)},
+        {"Level", nbt::Compound{{"xPos", nbt::Int(11)}}},
+        {long_name, nbt::Int(42)},
+        {"name", nbt::String("value")}};
+    auto data = encode(root);
+    nbt::Scanner scanner({{nbt::TypeCode::Int, "xPos"},
+                          {nbt::TypeCode::Int, "zPos"},
+                          {nbt::TypeCode::Int, long_name},
+                          {nbt::TypeCode::Long, "name"}});
+    ASSERT_EQ(scanner.size(), 4);
+    EXPECT_EQ(scanner[2].name, long_name);
+
+    auto hits = scanner.scan(data.data(), data.size());
+    ASSERT_EQ(hits.size(), 4);
+    std::vector<nbt::Int> x_values;
+    for (std::size_t i = 0; i < hits.size(); ++i) {
+        if (i > 0) {
+            EXPECT_LT(hits[i - 1].offset, hits[i].offset);
+        }
+        EXPECT_EQ(data[hits[i].offset],
+                  static_cast<unsigned char>(nbt::TypeCode::Int));
+        auto value = read_int(data, hits[i].payload);
+        switch (hits[i].pattern) {
+        case 0:
+            x_values.push_back(value);
+            break;
+        case 1:
+            EXPECT_EQ(value, 7);
+            break;
+        case 2:
+            EXPECT_EQ(value, 42);
+            EXPECT_EQ(hits[i].payload - hits[i].offset, 303);
+            break;
+        default:
+            ADD_FAILURE() << "unexpected pattern " << hits[i].pattern;
+        }
+    }
+    std::sort(x_values.begin(), x_values.end());
+    EXPECT_EQ(x_values, (std::vector<nbt::Int>{-3, 11}));
+}
+
+TEST(Scanner, Validation) {
+    // The string's contents look like the header of an Int named xPos.
+    std::string decoy{'\x03', '\x00', '\x04', 'x', 'P', 'o', 's', 'a', 'b',
+                      'c',    'd'};
+    nbt::Tag root = nbt::Compound{{"decoy", nbt::String(decoy)},
+                                  {"items", nbt::List{nbt::Compound{
+                                                {"xPos", nbt::Int(5)}}}}};
+    auto data = encode(root);
+    nbt::Scanner scanner({{nbt::TypeCode::Int, "xPos"}});
+
+    auto hits = scanner.scan(data.data(), data.size());
+    EXPECT_EQ(hits.size(), 2);
+
+    scanner.scan(data.data(), data.size(), hits, true);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(read_int(data, hits[0].payload), 5);
+
+    data.pop_back();
+    EXPECT_THROW(scanner.scan(data.data(), data.size(), true),
+                 std::runtime_error);
+    EXPECT_EQ(scanner.scan(data.data(), data.size()).size(), 2);
+}
+
+TEST(Scanner, InvalidPatterns) {
+    EXPECT_THROW(nbt::Scanner({}), std::runtime_error);
+    EXPECT_THROW(nbt::Scanner({{nbt::TypeCode::Int, ""}}), std::runtime_error);
+}
+
+TEST(Scanner, RegionChunks) {
+    nbt::Scanner scanner({{nbt::TypeCode::Int, "xPos"},
+                          {nbt::TypeCode::Int, "zPos"},
+                          {nbt::TypeCode::Long, "LastUpdate"},
+                          {nbt::TypeCode::Byte, "TerrainPopulated"}});
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    std::vector<nbt::Scan_Hit> hits;
+    int chunks = 0;
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        auto data = reg.get_chunk_data(i);
+        while (nbt::has_compression_header(data.data(), data.size())) {
+            data = nbt::decompress_data(data.data(), data.size());
+        }
+        auto level = nbt::read_binary(data).second["Level"];
+        scanner.scan(data.data(), data.size(), hits, true);
+        ASSERT_EQ(hits.size(), 4);
+        for (const auto &hit : hits) {
+            nbt::BinaryReader reader(data.data() + hit.payload,
+                                     data.size() - hit.payload);
+            const auto &name = scanner[hit.pattern].name;
+            switch (scanner[hit.pattern].type) {
+            case nbt::TypeCode::Byte:
+                EXPECT_EQ(reader.read<nbt::Byte>(),
+                          level[name].get<nbt::Byte>());
+                break;
+            case nbt::TypeCode::Int:
+                EXPECT_EQ(reader.read<nbt::Int>(), level[name].get<nbt::Int>());
+                break;
+            default:
+                EXPECT_EQ(reader.read<nbt::Long>(),
+                          level[name].get<nbt::Long>());
+            }
+        }
+        ++chunks;
+    }
+    EXPECT_GT(chunks, 0);
+}
+
+TEST(Scanner, FindTag) {
+    nbt::Tag root = nbt::Compound{
+        {"skipped", nbt::List{nbt::Compound{{"xPos", nbt::Int(1)}}}},
+        {"Level", nbt::Compound{{"xPos", nbt::Int(9)}}}};
+    auto data = encode(root);
+
+    auto location = nbt::find_tag(data.data(), data.size(), {"Level", "xPos"});
+    ASSERT_TRUE(location);
+    EXPECT_EQ(location->type, nbt::TypeCode::Int);
+    EXPECT_EQ(location->payload - location->offset, 7);
+    EXPECT_EQ(read_int(data, location->payload), 9);
+
+    auto level = nbt::find_tag(data.data(), data.size(), {"Level"});
+    ASSERT_TRUE(level);
+    EXPECT_EQ(level->type, nbt::TypeCode::Compound);
+    auto tag_root = nbt::find_tag(data.data(), data.size(), {});
+    ASSERT_TRUE(tag_root);
+    EXPECT_EQ(tag_root->offset, 0);
+
+    EXPECT_FALSE(nbt::find_tag(data.data(), data.size(), {"xPos"}));
+    EXPECT_FALSE(
+        nbt::find_tag(data.data(), data.size(), {"Level", "xPos", "a"}));
+}
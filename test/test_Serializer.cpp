@@ -1,11 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <fstream>
 #include <ios>
 #include <sstream>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "Hash.hpp"
 #include "Tag.hpp"
 #include "nbtview.hpp"
 
@@ -80,6 +82,41 @@ TEST(SerializerTest, ListLongs) {
     expect_serialized_bytes_eq(list_tag, list_tag_name, expected_bytes);
 }
 
+TEST(SerializerTest, PackedListFloats) {
+    nbt::Tag list_tag(nbt::Packed_List(std::vector<nbt::Float>{0.75, 0.5}));
+    auto expected_bytes = std::vector<unsigned char>{
+        0x09,                   // TypeCode::List
+        0x00, 0x01,             // Name length
+        'A',                    // "A"
+        0x05,                   // TypeCode::Float
+        0x00, 0x00, 0x00, 0x02, // list length of 2
+        0x3f, 0x40, 0x00, 0x00, // 0.75
+        0x3f, 0x00, 0x00, 0x00  // 0.50
+    };
+    expect_serialized_bytes_eq(list_tag, "A", expected_bytes);
+}
+
+TEST(SerializerTest, PackedListStringsAndCompounds) {
+    nbt::Tag strings(nbt::Packed_List(std::vector<nbt::String>{"x", "yz"}));
+    expect_serialized_bytes_eq(strings, "A",
+                               {0x09, 0x00, 0x01, 'A', // List named "A"
+                                0x08, 0x00, 0x00, 0x00, 0x02, // 2 Strings
+                                0x00, 0x01, 'x', 0x00, 0x02, 'y', 'z'});
+
+    nbt::Compound cmpd;
+    cmpd.emplace("b", nbt::Byte(3));
+    nbt::Tag compounds(nbt::Packed_List(std::vector<nbt::Compound>{cmpd}));
+    nbt::List boxed;
+    boxed.emplace_back(cmpd);
+    std::ostringstream packed_output(std::ios::binary);
+    std::ostringstream boxed_output(std::ios::binary);
+    nbt::write_binary(compounds, "A", packed_output);
+    nbt::write_binary(nbt::Tag(boxed), "A", boxed_output);
+    EXPECT_EQ(packed_output.str(), boxed_output.str());
+    EXPECT_EQ(nbt::hash_tag(compounds), nbt::hash_tag(nbt::Tag(boxed)));
+    EXPECT_EQ(nbt::to_string(compounds), "[{b:3b}]");
+}
+
 TEST(SerializerTest, NestedCompounds) {
     nbt::Tag ham(nbt::Compound{});
     ham.emplace("Hampus", nbt::Float(0.75));
@@ -121,3 +158,67 @@ TEST(SerializerTest, NestedCompounds) {
 
     expect_serialized_bytes_eq(nested, "nested", v_nested);
 }
+
+TEST(SerializerTest, BedrockEncodings) {
+    nbt::Tag tag = nbt::Compound{{"n", nbt::Int(-3)},
+                                 {"s", nbt::Short(0x0102)},
+                                 {"l", nbt::List{nbt::Long(1), nbt::Long(2)}}};
+    std::ostringstream little(std::ios::binary);
+    nbt::write_binary(tag, "", little, nbt::Binary_Encoding::little_endian);
+    std::vector<unsigned char> v_little{
+        0x0a, 0x00, 0x00,                         // Compound ""
+        0x09, 0x01, 0x00, 'l', 0x04,              // List "l" of Longs
+        0x02, 0x00, 0x00, 0x00,                   // length 2
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 1
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 2
+        0x03, 0x01, 0x00, 'n',                    // Int "n"
+        0xfd, 0xff, 0xff, 0xff,                   // -3
+        0x02, 0x01, 0x00, 's', 0x02, 0x01,        // Short "s"
+        0x00};                                    // End
+    auto little_view = little.view();
+    EXPECT_EQ(std::vector<unsigned char>(little_view.begin(),
+                                         little_view.end()),
+              v_little);
+
+    std::ostringstream network(std::ios::binary);
+    nbt::write_binary(tag, "", network, nbt::Binary_Encoding::network_varint);
+    std::vector<unsigned char> v_network{
+        0x0a, 0x00,                         // Compound ""
+        0x09, 0x01, 'l', 0x04, 0x04,        // List "l" of 2 Longs
+        0x02, 0x04,                         // 1, 2
+        0x03, 0x01, 'n', 0x05,              // Int "n"
+        0x02, 0x01, 's', 0x02, 0x01, 0x00}; // Short "s", End
+    auto network_view = network.view();
+    EXPECT_EQ(std::vector<unsigned char>(network_view.begin(),
+                                         network_view.end()),
+              v_network);
+}
+
+TEST(SerializerTest, BedrockRoundTrip) {
+    std::ifstream input("test_data/bigtest.nbt", std::ios::binary);
+    auto [name, tag] = nbt::read_binary(input);
+    std::ostringstream java(std::ios::binary);
+    nbt::write_binary(tag, name, java);
+    for (auto encoding : {nbt::Binary_Encoding::little_endian,
+                          nbt::Binary_Encoding::network_varint}) {
+        std::ostringstream output(std::ios::binary);
+        nbt::write_binary(tag, name, output, encoding);
+        auto bytes = output.str();
+        nbt::read_options options;
+        options.encoding = encoding;
+        auto copy = nbt::read_binary(
+            std::vector<unsigned char>(bytes.begin(), bytes.end()), options);
+        EXPECT_EQ(copy.first, name);
+        std::ostringstream copy_java(std::ios::binary);
+        nbt::write_binary(copy.second, copy.first, copy_java);
+        EXPECT_EQ(copy_java.str(), java.str());
+
+        // Packed Lists are written and read in the same encoding.
+        options.packed_lists = true;
+        auto packed = nbt::read_binary(
+            std::vector<unsigned char>(bytes.begin(), bytes.end()), options);
+        std::ostringstream repacked(std::ios::binary);
+        nbt::write_binary(packed.second, name, repacked, encoding);
+        EXPECT_EQ(repacked.str(), bytes);
+    }
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "SharedTag.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+class SharedBigTest : public ::testing::Test {
+  protected:
+    nbt::Tag tag;
+
+    virtual void SetUp() {
+        std::ifstream bigtest_stream("test_data/bigtest.nbt",
+                                     std::ios::binary);
+        std::vector<unsigned char> bytes(
+            std::istreambuf_iterator<char>(bigtest_stream), {});
+        tag = std::move(nbt::read_binary(bytes).second);
+    }
+};
+
+TEST_F(SharedBigTest, RoundTrip) {
+    nbt::SharedTag shared(tag);
+    EXPECT_EQ(shared.get_id(), nbt::TypeCode::Compound);
+    EXPECT_EQ(shared["intTest"].get<nbt::Int>(), 2147483647);
+    EXPECT_EQ(shared.at("nested compound test")
+                  .at("ham")
+                  .at("name")
+                  .get<nbt::String>(),
+              "Hampus");
+    EXPECT_EQ(shared["listTest (long)"].size(), 5);
+    EXPECT_THROW(shared.at("absent"), std::out_of_range);
+    EXPECT_EQ(nbt::to_string(shared.to_tag()), nbt::to_string(tag));
+}
+
+TEST_F(SharedBigTest, CopyOnWrite) {
+    const nbt::SharedTag original(tag);
+    nbt::SharedTag copy = original;
+    EXPECT_TRUE(copy.shares(original));
+
+    copy["nested compound test"]["ham"]["value"] = nbt::Float(1.5);
+
+    // The modified path is cloned; everything else is still shared.
+    EXPECT_FALSE(copy.shares(original));
+    EXPECT_FALSE(copy["nested compound test"].shares(
+        original["nested compound test"]));
+    EXPECT_TRUE(std::as_const(copy)["nested compound test"]["egg"].shares(
+        original["nested compound test"]["egg"]));
+    EXPECT_TRUE(std::as_const(copy)["listTest (compound)"].shares(
+        original["listTest (compound)"]));
+    EXPECT_TRUE(std::as_const(copy)["byteArrayTest (the first 1000 values of "
+                                    "(n*n*255+n*7)%100, starting with n=0 "
+                                    "(0, 62, 34, 16, 8, ...))"]
+                    .shares(original["byteArrayTest (the first 1000 values "
+                                     "of (n*n*255+n*7)%100, starting with "
+                                     "n=0 (0, 62, 34, 16, 8, ...))"]));
+
+    EXPECT_EQ(copy.at("nested compound test")
+                  .at("ham")
+                  .at("value")
+                  .get<nbt::Float>(),
+              1.5f);
+    EXPECT_NEAR(original["nested compound test"]["ham"]["value"]
+                    .get<nbt::Float>(),
+                0.75, 1e-6);
+    EXPECT_EQ(nbt::to_string(original.to_tag()), nbt::to_string(tag));
+}
+
+TEST(SharedTag, UniqueNodesAreModifiedInPlace) {
+    nbt::SharedTag lst(nbt::SharedTag::List{});
+    lst.push_back(nbt::Int(1));
+    auto before = &lst.get_value();
+    lst.push_back(nbt::Int(2));
+    EXPECT_EQ(&lst.get_value(), before);
+    EXPECT_EQ(lst.size(), 2);
+
+    auto snapshot = lst;
+    lst[0] = nbt::Int(5);
+    EXPECT_EQ(lst[0].get<nbt::Int>(), 5);
+    EXPECT_EQ(snapshot[0].get<nbt::Int>(), 1);
+}
+
+TEST(SharedTag, Erase) {
+    nbt::SharedTag cmpd(nbt::SharedTag::Compound{});
+    cmpd.emplace("a", nbt::Int(1));
+    cmpd.emplace("b", nbt::String("x"));
+    auto snapshot = cmpd;
+    EXPECT_EQ(cmpd.erase("c"), 0);
+    EXPECT_TRUE(cmpd.shares(snapshot));
+    EXPECT_EQ(cmpd.erase("a"), 1);
+    EXPECT_FALSE(cmpd.contains("a"));
+    EXPECT_TRUE(snapshot.contains("a"));
+    EXPECT_TRUE(std::as_const(cmpd)["b"].shares(snapshot["b"]));
+}
+
+TEST_F(SharedBigTest, CopiesModifiedOnSeveralThreads) {
+    nbt::SharedTag original(tag);
+    std::vector<nbt::SharedTag> copies(4, original);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < copies.size(); ++t) {
+        threads.emplace_back([&copies, t] {
+            for (int i = 0; i < 1000; ++i) {
+                auto copy = copies[t];
+                copy["intTest"] = nbt::Int(i);
+                copies[t] = std::move(copy);
+                copies[t]["nested compound test"]["egg"]["value"] =
+                    nbt::Float(static_cast<float>(t));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(nbt::to_string(original.to_tag()), nbt::to_string(tag));
+    for (std::size_t t = 0; t < copies.size(); ++t) {
+        EXPECT_EQ(copies[t]["intTest"].get<nbt::Int>(), 999);
+        EXPECT_EQ(copies[t]["nested compound test"]["egg"]["value"]
+                      .get<nbt::Float>(),
+                  static_cast<float>(t));
+        const auto *key = "byteArrayTest (the first 1000 values of "
+                          "(n*n*255+n*7)%100, starting with n=0 (0, 62, 34, "
+                          "16, 8, ...))";
+        EXPECT_TRUE(std::as_const(copies[t])[key].shares(
+            std::as_const(original)[key]));
+    }
+}
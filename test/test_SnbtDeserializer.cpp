@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "SnbtDeserializer.hpp"
+#include "Tag.hpp"
+#include "nbtview.hpp"
+
+namespace nbt = nbtview;
+
+TEST(SnbtDeserializer, Scalars) {
+    EXPECT_EQ(nbt::read_snbt("12b").get<nbt::Byte>(), 12);
+    EXPECT_EQ(nbt::read_snbt("-300s").get<nbt::Short>(), -300);
+    EXPECT_EQ(nbt::read_snbt("+70000").get<nbt::Int>(), 70000);
+    EXPECT_EQ(nbt::read_snbt("9223372036854775807L").get<nbt::Long>(),
+              9223372036854775807L);
+    EXPECT_EQ(nbt::read_snbt("0.75f").get<nbt::Float>(), 0.75f);
+    EXPECT_EQ(nbt::read_snbt("0.1d").get<nbt::Double>(), 0.1);
+    EXPECT_EQ(nbt::read_snbt("1.5").get<nbt::Double>(), 1.5);
+    EXPECT_EQ(nbt::read_snbt("1e3").get<nbt::Double>(), 1000.0);
+    EXPECT_EQ(nbt::read_snbt("true").get<nbt::Byte>(), 1);
+    EXPECT_EQ(nbt::read_snbt("false").get<nbt::Byte>(), 0);
+}
+
+TEST(SnbtDeserializer, Strings) {
+    EXPECT_EQ(nbt::read_snbt("stone").get<nbt::String>(), "stone");
+    EXPECT_EQ(nbt::read_snbt("300b").get<nbt::String>(), "300b");
+    EXPECT_EQ(nbt::read_snbt("\"a \\\"b\\\" \\\\\"").get<nbt::String>(),
+              "a \"b\" \\");
+    EXPECT_EQ(nbt::read_snbt("'it\\'s'").get<nbt::String>(), "it's");
+}
+
+TEST(SnbtDeserializer, CompoundsListsAndArrays) {
+    auto tag = nbt::read_snbt(
+        " { \"a b\" : 1 , list: [ 1s, 2s ], empty: [], inner: {x: 'y'},"
+        " bytes: [B; 1b, -2b], ints: [I;3, 4], longs: [L; 5L, 6] } ");
+    ASSERT_TRUE(tag.is<nbt::Compound>());
+    EXPECT_EQ(tag.size(), 7);
+    EXPECT_EQ(tag["a b"].get<nbt::Int>(), 1);
+    EXPECT_EQ(tag["list"].size(), 2);
+    EXPECT_EQ(tag["list"][1].get<nbt::Short>(), 2);
+    EXPECT_TRUE(tag["empty"].empty());
+    EXPECT_EQ(tag["inner"]["x"].get<nbt::String>(), "y");
+    EXPECT_EQ(tag["bytes"].get<nbt::Byte_Array>(), (nbt::Byte_Array{1, -2}));
+    EXPECT_EQ(tag["ints"].get<nbt::Int_Array>(), (nbt::Int_Array{3, 4}));
+    EXPECT_EQ(tag["longs"].get<nbt::Long_Array>(), (nbt::Long_Array{5, 6}));
+}
+
+TEST(SnbtDeserializer, SyntaxErrors) {
+    EXPECT_THROW(nbt::read_snbt(""), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("{a:1"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("{a 1}"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("[1, 2b]"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("[B; 1000]"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("[X; 1]"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("\"open"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt("1 2"), nbt::SnbtSyntaxError);
+    EXPECT_THROW(nbt::read_snbt(std::string(1000, '[')),
+                 nbt::SnbtSyntaxError);
+    try {
+        nbt::read_snbt("{a:1,}");
+        FAIL() << "expected SnbtSyntaxError";
+    } catch (const nbt::SnbtSyntaxError &e) {
+        EXPECT_EQ(e.position(), 5);
+    }
+}
+
+TEST(SnbtDeserializer, BigtestRoundTrip) {
+    std::ifstream bigtest_stream("test_data/bigtest.nbt");
+    auto [root_name, root_tag] = nbt::read_binary(bigtest_stream);
+    auto snbt = nbt::to_string(root_tag);
+    auto reparsed = nbt::read_snbt(snbt);
+    EXPECT_EQ(nbt::to_string(reparsed), snbt);
+    EXPECT_EQ(reparsed["listTest (long)"][4].get<nbt::Long>(), 15);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+#include "SnbtWriter.hpp"
+#include "Tag.hpp"
+#include "utils.hpp"
+
+namespace nbt = nbtview;
+
+TEST(SnbtWriter, Quoting) {
+    EXPECT_FALSE(nbt::snbt_requires_quoting("xPos"));
+    EXPECT_FALSE(nbt::snbt_requires_quoting("minecraft.stone_1+-"));
+    EXPECT_TRUE(nbt::snbt_requires_quoting(""));
+    EXPECT_TRUE(nbt::snbt_requires_quoting("a b"));
+    EXPECT_TRUE(nbt::snbt_requires_quoting("minecraft:stone"));
+    EXPECT_EQ(nbt::quoted_string("Hello"), "\"Hello\"");
+    EXPECT_EQ(nbt::quoted_string("say \"hi\""), "\"say \\\"hi\\\"\"");
+    EXPECT_EQ(nbt::quoted_string("a\\b"), "\"a\\\\b\"");
+}
+
+TEST(SnbtWriter, Scalars) {
+    EXPECT_EQ(nbt::to_string(nbt::Byte(-5)), "-5b");
+    EXPECT_EQ(nbt::to_string(nbt::Short(300)), "300s");
+    EXPECT_EQ(nbt::to_string(nbt::Int(70000)), "70000");
+    EXPECT_EQ(nbt::to_string(nbt::Long(9223372036854775807L)),
+              "9223372036854775807L");
+    EXPECT_EQ(nbt::to_string(nbt::Float(0.75)), "0.75f");
+    EXPECT_EQ(nbt::to_string(nbt::Double(0.1)), "0.1d");
+    EXPECT_EQ(nbt::to_string(nbt::String("x")), "\"x\"");
+}
+
+TEST(SnbtWriter, CompoundAndArrays) {
+    nbt::Tag root(nbt::Compound{});
+    root.emplace("a b", nbt::Int(1));
+    root.emplace("bytes", nbt::Byte_Array{1, 2});
+    root.emplace("ints", nbt::Int_Array{3, 4});
+    root.emplace("longs", nbt::Long_Array{5});
+    nbt::Tag lst(nbt::List{});
+    lst.push_back(nbt::Short(7));
+    root.emplace("list", std::move(lst));
+    EXPECT_EQ(nbt::to_string(root), "{\"a b\":1,bytes:[B;1b,2b],ints:[I;3,4],"
+                                    "list:[7s],longs:[L;5L]}");
+
+    std::ostringstream os;
+    os << root;
+    EXPECT_EQ(os.str(), nbt::to_string(root));
+}
+
+TEST(SnbtWriter, PackedList) {
+    nbt::Tag doubles(nbt::Packed_List(std::vector<nbt::Double>{0.5, -1}));
+    EXPECT_EQ(nbt::to_string(doubles), "[0.5d,-1d]");
+    nbt::Tag empty(nbt::Packed_List(std::vector<nbt::Int>{}));
+    EXPECT_EQ(nbt::to_string(empty), "[]");
+}
+
+TEST(SnbtWriter, PrettyPrint) {
+    nbt::Tag inner(nbt::Compound{});
+    inner.emplace("x", nbt::Int(1));
+    nbt::Tag root(nbt::Compound{});
+    root.emplace("inner", std::move(inner));
+    root.emplace("ints", nbt::Int_Array{1, 2});
+
+    std::string buffer;
+    nbt::write_snbt(root, buffer, {.pretty = true, .indent_width = 2});
+    EXPECT_EQ(buffer, "{\n  inner: {\n    x: 1\n  },\n  ints: [I;1, 2]\n}");
+}
+
+TEST(SnbtWriter, Limits) {
+    nbt::Tag inner(nbt::Compound{});
+    inner.emplace("x", nbt::Int(1));
+    nbt::Tag root(nbt::Compound{});
+    root.emplace("inner", std::move(inner));
+    root.emplace("longs", nbt::Long_Array{1, 2, 3, 4});
+
+    std::string buffer;
+    nbt::write_snbt(root, buffer, {.max_depth = 1, .max_array_length = 2});
+    EXPECT_EQ(buffer, "{inner:{...},longs:[L;1L,2L,...]}");
+}
+
+TEST(SnbtWriter, ReusesBuffer) {
+    std::string buffer;
+    nbt::SnbtWriter writer(buffer);
+    writer.write(nbt::Int(1));
+    writer.write(nbt::Int(2));
+    EXPECT_EQ(buffer, "12");
+}
+
+// A stream buffer which records the largest single write it receives
+class Largest_Write_Buffer : public std::stringbuf {
+  public:
+    std::streamsize largest = 0;
+
+  protected:
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        largest = std::max(largest, n);
+        return std::stringbuf::xsputn(s, n);
+    }
+};
+
+TEST(SnbtWriter, FlushesWithinArrays) {
+    nbt::Tag longs(nbt::Long_Array(100000, 1234567890123));
+    nbt::Tag packed(
+        nbt::Packed_List(std::vector<nbt::Long>(100000, 1234567890123)));
+    for (const auto *tag : {&longs, &packed}) {
+        Largest_Write_Buffer output;
+        std::ostream stream(&output);
+        std::string buffer;
+        nbt::SnbtWriter writer(buffer, stream);
+        writer.write(*tag);
+        writer.flush();
+        EXPECT_EQ(output.str(), nbt::to_string(*tag));
+        EXPECT_LT(output.largest, 1 << 17);
+    }
+}
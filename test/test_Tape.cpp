@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "Tape.hpp"
+#include "nbtview.hpp"
+#include "zlib_utils.hpp"
+
+namespace nbt = nbtview;
+
+class TapeBigTest : public ::testing::Test {
+  protected:
+    std::vector<unsigned char> bytes;
+
+    virtual void SetUp() {
+        std::ifstream bigtest_stream("test_data/bigtest.nbt",
+                                     std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(bigtest_stream), {});
+        bytes = nbt::decompress_data(bytes.data(), bytes.size());
+    }
+};
+
+TEST_F(TapeBigTest, Entries) {
+    nbt::Tape tape(bytes.data(), bytes.size());
+    auto &root = tape[0];
+    EXPECT_EQ(root.type, nbt::TypeCode::Compound);
+    EXPECT_EQ(tape.name(root), "Level");
+    EXPECT_EQ(root.count, nbt::read_binary(bytes).second.size());
+    EXPECT_EQ(root.next, tape.size());
+
+    // Numeric lists and arrays are single entries.
+    for (std::size_t i = 1; i < tape.size(); i = tape[i].next) {
+        auto &entry = tape[i];
+        if (tape.name(entry) == "listTest (long)") {
+            EXPECT_EQ(entry.type, nbt::TypeCode::List);
+            EXPECT_EQ(entry.list_type, nbt::TypeCode::Long);
+            EXPECT_EQ(entry.count, 5);
+            EXPECT_EQ(entry.next, i + 1);
+        } else if (tape.name(entry) == "listTest (compound)") {
+            EXPECT_EQ(entry.count, 2);
+            EXPECT_GT(entry.next, i + 2);
+        }
+    }
+}
+
+TEST_F(TapeBigTest, Materialize) {
+    auto expected = nbt::read_binary(bytes).second;
+    nbt::Tape tape(bytes.data(), bytes.size());
+    EXPECT_EQ(nbt::to_string(tape.materialize(0)), nbt::to_string(expected));
+
+    auto packed = tape.materialize(0, {.packed_lists = true});
+    EXPECT_TRUE(packed["listTest (long)"].is<nbt::Packed_List>());
+    EXPECT_EQ(nbt::to_string(packed), nbt::to_string(expected));
+}
+
+TEST_F(TapeBigTest, Parallel) {
+    auto expected = nbt::read_binary(bytes);
+    for (unsigned threads : {1, 2, 4}) {
+        auto [name, tag] =
+            nbt::read_binary_parallel(bytes.data(), bytes.size(), threads);
+        EXPECT_EQ(name, expected.first);
+        EXPECT_EQ(nbt::to_string(tag), nbt::to_string(expected.second));
+    }
+}
+
+TEST_F(TapeBigTest, Truncated) {
+    for (std::size_t length : {std::size_t(0), std::size_t(5),
+                               bytes.size() / 2, bytes.size() - 1}) {
+        EXPECT_THROW(nbt::Tape(bytes.data(), length), std::runtime_error);
+    }
+}
+
+// Returns a List of every chunk in the test region, so that there are many
+// more entries than the smallest job, in a root Compound.
+static nbt::Tag region_document() {
+    nbt::Region_File reg("test_data/r.0.0.mca");
+    nbt::Tag chunks(nbt::List{});
+    for (int i = 0; i < nbt::Region::chunk_count; ++i) {
+        if (reg.chunk_length(i) == 0) {
+            continue;
+        }
+        chunks.push_back(nbt::read_binary(reg.get_chunk_data(i)).second);
+    }
+    nbt::Tag root(nbt::Compound{});
+    root.emplace("chunks", std::move(chunks));
+    return root;
+}
+
+// Expects a and b to hold the same values in the same alternatives, such
+// as Packed_List rather than List.
+static void expect_same_form(const nbt::Tag &a, const nbt::Tag &b) {
+    ASSERT_EQ(a.get_value().index(), b.get_value().index());
+    if (a.is<nbt::Compound>()) {
+        for (const auto &[key, member] : a.get<nbt::Compound>()) {
+            ASSERT_TRUE(b.contains(key));
+            expect_same_form(member, b.get<nbt::Compound>().at(key));
+        }
+    } else if (a.is<nbt::List>()) {
+        ASSERT_EQ(a.size(), b.size());
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            expect_same_form(a[i], b[i]);
+        }
+    }
+    EXPECT_EQ(nbt::to_string(a), nbt::to_string(b));
+}
+
+TEST(Tape, LargeDocument) {
+    auto root = region_document();
+    std::ostringstream os;
+    nbt::write_binary(root, "world", os);
+    auto encoded = os.str();
+
+    auto [name, tag] = nbt::read_binary_parallel(
+        reinterpret_cast<const unsigned char *>(encoded.data()),
+        encoded.size(), 4, {.packed_lists = true});
+    EXPECT_EQ(name, "world");
+    EXPECT_EQ(nbt::to_string(tag), nbt::to_string(root));
+}
+
+TEST(Tape, ParallelMatchesSerial) {
+    std::ostringstream os;
+    nbt::write_binary(region_document(), "world", os);
+    auto encoded = os.str();
+    auto data = reinterpret_cast<const unsigned char *>(encoded.data());
+    for (bool packed : {false, true}) {
+        nbt::read_options options{.packed_lists = packed};
+        auto serial = nbt::read_binary(data, encoded.size(), options);
+        auto [name, tag] =
+            nbt::read_binary_parallel(data, encoded.size(), 4, options);
+        EXPECT_EQ(name, serial.first);
+        expect_same_form(tag, serial.second);
+    }
+}
+
+// Returns a root List nested depth levels deep: [[[...[]...]]]
+static std::vector<unsigned char> nested_lists(int depth) {
+    std::vector<unsigned char> bytes{0x09, 0x00, 0x00};
+    for (int i = 1; i < depth; ++i) {
+        bytes.insert(bytes.end(), {0x09, 0x00, 0x00, 0x00, 0x01});
+    }
+    bytes.insert(bytes.end(), {0x00, 0x00, 0x00, 0x00, 0x00});
+    return bytes;
+}
+
+TEST(Tape, Limits) {
+    // Far deeper than the native stack could recurse is rejected cleanly,
+    // as by read_binary().
+    auto deep = nested_lists(1000000);
+    EXPECT_THROW(nbt::Tape(deep.data(), deep.size()),
+                 nbt::LimitExceededException);
+    EXPECT_THROW(nbt::read_binary_parallel(deep.data(), deep.size(), 2),
+                 nbt::LimitExceededException);
+
+    auto bytes = nested_lists(600);
+    EXPECT_THROW(nbt::Tape(bytes.data(), bytes.size()),
+                 nbt::LimitExceededException);
+    nbt::Tape tape(bytes.data(), bytes.size(), {.max_depth = 600});
+    EXPECT_EQ(tape.size(), 600);
+    EXPECT_EQ(tape[0].next, 600);
+    EXPECT_THROW(nbt::Tape(bytes.data(), bytes.size(),
+                           {.max_depth = 600, .max_elements = 599}),
+                 nbt::LimitExceededException);
+}
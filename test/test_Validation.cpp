@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#include "Region.hpp"
+#include "Tag.hpp"
+#include "Validation.hpp"
+#include "nbtview.hpp"
+#include "region_fixture.hpp"
+
+namespace nbt = nbtview;
+using namespace region_fixture;
+
+static std::string zlib_compressed(const std::string &data) {
+    uLongf length = compressBound(data.size());
+    std::string output(length, '\0');
+    compress(reinterpret_cast<Bytef *>(output.data()), &length,
+             reinterpret_cast<const Bytef *>(data.data()), data.size());
+    output.resize(length);
+    return output;
+}
+
+static std::string encoded_chunk(std::size_t array_length) {
+    std::mt19937 random(7);
+    nbt::Byte_Array noise(array_length);
+    for (auto &b : noise) {
+        b = static_cast<nbt::Byte>(random());
+    }
+    std::ostringstream output(std::ios::binary);
+    nbt::write_binary(nbt::Compound{{"Noise", noise}}, "", output);
+    return output.str();
+}
+
+static void write_file(const std::filesystem::path &path,
+                       const std::string &bytes) {
+    std::ofstream(path, std::ios::binary) << bytes;
+}
+
+TEST(Validation, SoundRegion) {
+    auto report = nbt::validate_region("test_data/r.0.0.mca", 2);
+    EXPECT_TRUE(report.ok());
+    EXPECT_EQ(report.chunk_count, 131);
+    EXPECT_EQ(report.valid_chunk_count, 131);
+}
+
+TEST(Validation, Faults) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_validation";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 3 spans five sectors, 2 to 6, and has a bad byte in sector 5;
+    // chunk 4 takes sectors 7 to 11.
+    auto big = zlib_compressed(encoded_chunk(18000));
+    ASSERT_GT(big.size(), 4 * nbt::Region::sector_length);
+    auto damaged = big;
+    damaged[3 * nbt::Region::sector_length + 100] ^= 0x55;
+    auto bytes = region_bytes(
+        {{3, 2, damaged},
+         {4, 2, big},
+         {5, 3, encoded_chunk(10)},
+         {6, 3, encoded_chunk(10).substr(0, 12)},
+         {7, 2, big.substr(0, 3000)},
+         {8, 9, encoded_chunk(10)},
+         {9, 2, zlib_compressed(encoded_chunk(10))}});
+    auto entry = [&](int chunk) { return bytes.data() + 4 * chunk; };
+    // Chunk 9 is moved into the middle of chunk 4, and chunk 10 past the
+    // end of the file.
+    entry(9)[2] = 9;
+    entry(10)[2] = 100;
+    entry(10)[3] = 1;
+    // Chunk 5's length field exceeds its sector.
+    auto chunk5 = bytes.data() + 12 * nbt::Region::sector_length;
+    chunk5[2] = 0x20;
+    write_file(dir / "r.0.0.mca", bytes);
+    write_file(dir / "r.0.1.mca", "");
+    write_file(dir / "r.1.0.mca", std::string(100, '\0'));
+
+    auto reports = nbt::validate_regions(
+        {(dir / "r.0.0.mca").string(), (dir / "r.0.1.mca").string(),
+         (dir / "r.1.0.mca").string()},
+        3);
+    ASSERT_EQ(reports.size(), 3);
+    const auto &report = reports[0];
+    EXPECT_EQ(report.chunk_count, 8);
+    EXPECT_EQ(report.valid_chunk_count, 0);
+    std::vector<std::pair<int, nbt::Region_Problem>> found;
+    for (const auto &fault : report.faults) {
+        found.emplace_back(fault.chunk, fault.problem);
+        if (fault.problem == nbt::Region_Problem::corrupt_data) {
+            // The damage lies in stored data, so it is found only by the
+            // checksum in the last sector.
+            EXPECT_EQ(fault.sector, 6);
+        }
+    }
+    using P = nbt::Region_Problem;
+    EXPECT_EQ(found, (std::vector<std::pair<int, nbt::Region_Problem>>{
+                         {3, P::corrupt_data},
+                         {4, P::overlapping_sectors},
+                         {5, P::bad_length},
+                         {6, P::invalid_nbt},
+                         {7, P::truncated_data},
+                         {8, P::bad_compression},
+                         {9, P::overlapping_sectors},
+                         {10, P::sector_out_of_range}}));
+
+    EXPECT_TRUE(reports[1].ok());
+    ASSERT_EQ(reports[2].faults.size(), 1);
+    EXPECT_EQ(reports[2].faults[0].problem, P::truncated_header);
+    EXPECT_EQ(reports[2].faults[0].chunk, -1);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Validation, ExternalAndOversizedChunks) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_external";
+    std::filesystem::create_directories(dir);
+
+    // Chunks 0 and 33 keep their data in c.0.0.mcc and c.1.1.mcc, of which
+    // only the first exists; chunks 2 and 3 inflate to more than 2000
+    // bytes.
+    auto big = encoded_chunk(3000);
+    write_file(dir / "r.0.0.mca",
+               region_bytes({{0, 0x82, ""},
+                             {33, 0x82, ""},
+                             {2, 2, zlib_compressed(big)},
+                             {3, 3, big},
+                             {4, 2, zlib_compressed(encoded_chunk(100))}}));
+    write_file(dir / "c.0.0.mcc", zlib_compressed(encoded_chunk(100)));
+
+    auto report =
+        nbt::validate_region((dir / "r.0.0.mca").string(), 2, 2000);
+    EXPECT_EQ(report.chunk_count, 5);
+    EXPECT_EQ(report.valid_chunk_count, 2);
+    std::vector<std::pair<int, nbt::Region_Problem>> found;
+    for (const auto &fault : report.faults) {
+        found.emplace_back(fault.chunk, fault.problem);
+    }
+    using P = nbt::Region_Problem;
+    EXPECT_EQ(found, (std::vector<std::pair<int, nbt::Region_Problem>>{
+                         {2, P::oversized_data},
+                         {3, P::oversized_data},
+                         {33, P::missing_external}}));
+
+    // With the default limit, only the missing file is a problem.
+    EXPECT_EQ(nbt::validate_region((dir / "r.0.0.mca").string()).faults.size(),
+              1);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Validation, DeeplyNestedChunk) {
+    auto dir = std::filesystem::temp_directory_path() / "nbtview_deep";
+    std::filesystem::create_directories(dir);
+
+    // Chunk 0 is a List nested a million levels deep, which is reported
+    // rather than overflowing the stack.
+    std::string deep{0x09, 0x00, 0x00};
+    for (int i = 1; i < 1000000; ++i) {
+        deep += std::string{0x09, 0x00, 0x00, 0x00, 0x01};
+    }
+    deep += std::string(5, '\0');
+    write_file(dir / "r.0.0.mca",
+               region_bytes({{0, 2, zlib_compressed(deep)},
+                             {1, 2, zlib_compressed(encoded_chunk(100))}}));
+
+    auto report = nbt::validate_region((dir / "r.0.0.mca").string(), 2);
+    EXPECT_EQ(report.valid_chunk_count, 1);
+    ASSERT_EQ(report.faults.size(), 1);
+    EXPECT_EQ(report.faults[0].chunk, 0);
+    EXPECT_EQ(report.faults[0].problem, nbt::Region_Problem::invalid_nbt);
+    std::filesystem::remove_all(dir);
+}
@@ -74,3 +74,26 @@ TEST_F(BigTest, ByteArray) {
         EXPECT_EQ(byte_array[n], (n * n * 255 + n * 7) % 100);
     }
 }
+
+TEST(BigTestPacked, ListOfLongs) {
+    std::ifstream bigtest_stream("test_data/bigtest.nbt");
+    auto [root_name, root_tag] =
+        read_binary(bigtest_stream, {.packed_lists = true});
+    auto &list_long = root_tag["listTest (long)"];
+    EXPECT_TRUE(list_long.is<Packed_List>());
+    EXPECT_EQ(list_long.get_id(), TypeCode::List);
+    EXPECT_EQ(tag_id_string(list_long), "List of Long");
+    EXPECT_EQ(list_long.size(), 5);
+    EXPECT_EQ(list_long.get_list<Long>(),
+              (std::vector<Long>{11, 12, 13, 14, 15}));
+    EXPECT_THROW(list_long.get_list<Int>(), std::bad_variant_access);
+
+    // Lists of Compounds are packed too.
+    auto &list_compound = root_tag["listTest (compound)"];
+    EXPECT_TRUE(list_compound.is<Packed_List>());
+    EXPECT_EQ(tag_id_string(list_compound), "List of Compound");
+    auto &compounds = list_compound.get_list<nbtview::Compound>();
+    ASSERT_EQ(compounds.size(), 2);
+    EXPECT_EQ(compounds[1].at("name").get<nbtview::String>(),
+              "Compound tag #1");
+}
@@ -1,9 +1,18 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <streambuf>
+#include <string>
 #include <vector>
 
+#include "BinaryReader.hpp"
 #include "Tag.hpp"
 #include "nbtview.hpp"
+#include "zlib_utils.hpp"
 
 namespace nbt = nbtview;
 
@@ -105,3 +114,75 @@ TEST(NbtviewTest, CompoundWithFloatingPoint) {
     EXPECT_TRUE(!inner_tag["Float"].is<nbt::Double>());
     EXPECT_TRUE(!inner_tag["Double"].is<nbt::Float>());
 }
+
+// A stream buffer which, like a pipe, hands out its data a few bytes at a
+// time and cannot seek.
+class Pipe_Buffer : public std::streambuf {
+  public:
+    Pipe_Buffer(std::string data, std::size_t piece)
+        : data(std::move(data)), piece(piece) {}
+
+    //! True once more was asked for than the data holds, as would block a
+    //! pipe which is still open
+    bool read_past_end = false;
+
+  protected:
+    int_type underflow() override {
+        if (position == data.size()) {
+            read_past_end = true;
+            return traits_type::eof();
+        }
+        auto n = std::min(piece, data.size() - position);
+        std::memcpy(buffer, data.data() + position, n);
+        position += n;
+        setg(buffer, buffer, buffer + n);
+        return traits_type::to_int_type(buffer[0]);
+    }
+
+  private:
+    std::string data;
+    std::size_t piece;
+    std::size_t position = 0;
+    char buffer[16];
+};
+
+static std::string serialized(const std::pair<std::string, nbt::Tag> &root) {
+    std::ostringstream output(std::ios::binary);
+    nbt::write_binary(root.second, root.first, output);
+    return output.str();
+}
+
+TEST(NbtviewTest, NonSeekableStream) {
+    std::ifstream file("test_data/bigtest.nbt", std::ios::binary);
+    std::string compressed{std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>()};
+    auto bytes = reinterpret_cast<const unsigned char *>(compressed.data());
+    auto inflated = nbt::decompress_data(bytes, compressed.size());
+    auto expected = serialized(nbt::read_binary(inflated));
+    std::string uncompressed(inflated.begin(), inflated.end());
+
+    for (std::size_t block_size : {1, 5, 100, 64 * 1024}) {
+        nbt::read_options options;
+        options.stream_block_size = block_size;
+        for (const auto &data : {compressed, uncompressed}) {
+            Pipe_Buffer pipe(data, 7);
+            std::istream input(&pipe);
+            ASSERT_EQ(input.tellg(), -1);
+            EXPECT_EQ(serialized(nbt::read_binary(input, options)), expected)
+                << block_size;
+            // The root tag is complete without waiting on more input.
+            EXPECT_FALSE(pipe.read_past_end) << block_size;
+        }
+    }
+
+    // Truncated input, compressed or not
+    for (const auto &data : {compressed, uncompressed}) {
+        Pipe_Buffer pipe(data.substr(0, data.size() - 20), 7);
+        std::istream input(&pipe);
+        EXPECT_THROW(nbt::read_binary(input),
+                     nbt::UnexpectedEndOfInputException);
+    }
+    std::istringstream corrupt(compressed.substr(0, 40) +
+                               std::string(100, 'x'));
+    EXPECT_THROW(nbt::read_binary(corrupt), std::runtime_error);
+}